@@ -0,0 +1,440 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  mobility-scenario-helper.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  mobility-scenario-helper.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with mobility-scenario-helper.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "mobility-scenario-helper.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+
+#include <ns3-dev/ns3/assert.h>
+#include <ns3-dev/ns3/config.h>
+#include <ns3-dev/ns3/double.h>
+#include <ns3-dev/ns3/integer.h>
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/node-list.h>
+#include <ns3-dev/ns3/simulator.h>
+#include <ns3-dev/ns3/uinteger.h>
+#include <ns3-dev/ns3/ndnSIM/helper/ndn-app-helper.h>
+#include <ns3-dev/ns3/ndnSIM/utils/tracers/l2-rate-tracer.h>
+#include <ns3-dev/ns3/ndnSIM/utils/tracers/ndn-app-delay-tracer.h>
+#include <ns3-dev/ns3/ndnSIM/utils/tracers/ndn-cs-tracer.h>
+#include <ns3-dev/ns3/ndnSIM/utils/tracers/ndn-l3-aggregate-tracer.h>
+#include <ns3-dev/ns3/ndnSIM/utils/tracers/ndn-l3-rate-tracer.h>
+
+#include "../../utils/result-cache.h"
+#include "../../utils/tracers/aggregating-trace-sink.h"
+#include "../../utils/tracers/async-trace-sink.h"
+#include "../../utils/tracers/columnar-app-delay-tracer.h"
+#include "../../utils/tracers/columnar-app-histogram-tracer.h"
+#include "../../utils/tracers/columnar-cs-tracer.h"
+#include "../../utils/tracers/columnar-l2-tracer.h"
+#include "../../utils/tracers/columnar-l3-tracer.h"
+#include "../../utils/tracers/columnar-trace-writer.h"
+#include "../../utils/tracers/handoff-recorder.h"
+#include "../../utils/tracers/text-trace-sink.h"
+#include "../../utils/tracers/trace-schedule.h"
+
+NS_LOG_COMPONENT_DEFINE ("MobilityScenarioHelper");
+
+namespace ns3 {
+
+const uint32_t MobilityScenarioHelper::PAYLOAD_SIZE;
+
+MobilityScenarioHelper::MobilityScenarioHelper (SectorTopologyHelper &topology)
+  : m_topology (topology)
+  , m_binaryTraces (false)
+  , m_reducedTraces (false)
+  , m_byClass (false)
+  , m_asyncTraces (false)
+  , m_delayHistograms (false)
+  , m_handoffs (0)
+  , m_received (0)
+  , m_retransmitted (0)
+  , m_delay (0)
+{
+}
+
+bool
+MobilityScenarioHelper::IsStrategy (const std::string &strategy)
+{
+  return strategy == "flood" || strategy == "smart" || strategy == "bestr";
+}
+
+void
+MobilityScenarioHelper::AddTraceOptions (ResultCache &cache, bool trace, bool binary, bool reduced, bool byClass,
+                                         bool delayHistograms, double finePeriod, double fineWindow, double coarsePeriod,
+                                         bool handoffs, const std::string &traced)
+{
+  cache.Add ("trace", trace);
+  if (!trace)
+    return;
+
+  cache.Add ("binTrace", binary);
+  cache.Add ("aggTrace", reduced);
+  cache.Add ("byClass", reduced && byClass);
+  cache.Add ("delayHist", delayHistograms);
+  cache.Add ("finePeriod", finePeriod);
+  if (finePeriod > 0)
+    {
+      cache.Add ("fineWindow", fineWindow);
+      cache.Add ("coarsePeriod", coarsePeriod);
+    }
+  cache.Add ("handoffTrace", handoffs);
+  cache.Add ("traceNodes", traced);
+}
+
+void
+MobilityScenarioHelper::InstallNdn (const std::string &strategy, uint32_t csSize)
+{
+  NS_ASSERT_MSG (IsStrategy (strategy), "Unknown forwarding strategy " << strategy);
+
+  ndn::StackHelper routers;
+  if (strategy == "smart")
+    {
+      NS_LOG_INFO ("NDN Utilizing SmartFlooding");
+      routers.SetForwardingStrategy ("ns3::ndn::fw::SmartFlooding::PerOutFaceLimits", "Limit", "ns3::ndn::Limits::Window");
+    }
+  else if (strategy == "bestr")
+    {
+      NS_LOG_INFO ("NDN Utilizing BestRoute");
+      routers.SetForwardingStrategy ("ns3::ndn::fw::BestRoute::PerOutFaceLimits", "Limit", "ns3::ndn::Limits::Window");
+    }
+  else
+    {
+      NS_LOG_INFO ("NDN Utilizing Flooding");
+      routers.SetForwardingStrategy ("ns3::ndn::fw::Flooding::PerOutFaceLimits", "Limit", "ns3::ndn::Limits::Window");
+    }
+  routers.SetContentStore ("ns3::ndn::cs::Freshness::Lru", "MaxSize", boost::lexical_cast<std::string> (csSize));
+  routers.SetDefaultRoutes (true);
+
+  // The mobile terminals and servers have only one interface, so
+  // BestRoute forwarding makes sense, and no Content Store
+  ndn::StackHelper users;
+  users.SetForwardingStrategy ("ns3::ndn::fw::BestRoute");
+  users.SetContentStore ("ns3::ndn::cs::Nocache");
+  users.SetDefaultRoutes (true);
+
+  m_topology.InstallNdn (routers, users);
+}
+
+void
+MobilityScenarioHelper::InstallApplications (const NodeContainer &servers, const NodeContainer &terminals,
+                                             double mbps, Time stop, Time retx, int32_t maxSeq)
+{
+  // Interests per second giving the data rate
+  double frequency = mbps * 1000000 / PAYLOAD_SIZE;
+  NS_LOG_INFO ("Consumer Interest/s frequency: " << frequency);
+
+  ndn::AppHelper producerHelper ("ns3::ndn::Producer");
+  producerHelper.SetPrefix ("/waseda/sato");
+  producerHelper.SetAttribute ("StopTime", TimeValue (stop - Seconds (1)));
+  producerHelper.SetAttribute ("PayloadSize", UintegerValue (PAYLOAD_SIZE));
+  producerHelper.Install (servers);
+
+  ndn::AppHelper consumerHelper ("ns3::ndn::ConsumerCbr");
+  consumerHelper.SetPrefix ("/waseda/sato");
+  consumerHelper.SetAttribute ("Frequency", DoubleValue (frequency));
+  consumerHelper.SetAttribute ("StartTime", TimeValue (Seconds (1)));
+  consumerHelper.SetAttribute ("StopTime", TimeValue (stop - Seconds (1)));
+  consumerHelper.SetAttribute ("RetxTimer", TimeValue (retx));
+  if (maxSeq > 0)
+    consumerHelper.SetAttribute ("MaxSeq", IntegerValue (maxSeq));
+  consumerHelper.Install (terminals);
+}
+
+std::string
+MobilityScenarioHelper::GetFileId (const std::string &strategy, const std::string &part) const
+{
+  char fileId[250];
+  snprintf (fileId, sizeof (fileId), "%s-%02u-%03u-%03u%s%s.txt", strategy.c_str (),
+            m_topology.GetMobileTerminals ().GetN (), m_topology.GetServerNodes ().GetN (),
+            m_topology.GetNAps (), part.empty () ? "" : "-", part.c_str ());
+  return fileId;
+}
+
+bool
+MobilityScenarioHelper::WriteNodeLists (const std::string &prefix, const std::string &fileId) const
+{
+  const char *names[] = { "clients", "servers" };
+  NodeContainer nodes[] = { m_topology.GetMobileTerminals (), m_topology.GetServerNodes () };
+
+  for (int i = 0; i < 2; i++)
+    {
+      std::ofstream file ((prefix + "-" + names[i] + "-" + fileId).c_str ());
+      for (NodeContainer::Iterator node = nodes[i].Begin (); node != nodes[i].End (); node++)
+        file << (*node)->GetId () << std::endl;
+      if (!file.good ())
+        return false;
+    }
+  return true;
+}
+
+void
+MobilityScenarioHelper::EnableSummary ()
+{
+  m_received = 0;
+  m_retransmitted = 0;
+  m_delay = 0;
+  Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::ndn::Consumer/FirstInterestDataDelay",
+                                 MakeCallback (&MobilityScenarioHelper::DataReceived, this));
+}
+
+bool
+MobilityScenarioHelper::WriteSummary (const std::string &path, double activeTime) const
+{
+  std::ofstream file (path.c_str ());
+  file << "goodput=" << m_received * PAYLOAD_SIZE * 8 / activeTime / 1e6 << std::endl;
+  file << "delay=" << (m_received ? m_delay / m_received * 1000 : 0) << std::endl;
+  file << "retxShare=" << (m_received ? (double) m_retransmitted / m_received : 0) << std::endl;
+  file << "handoffs=" << m_handoffs << std::endl;
+  return file.good ();
+}
+
+void
+MobilityScenarioHelper::DataReceived (Ptr<ndn::App> app, uint32_t seqno, Time delay, uint32_t retxCount, int32_t hopCount)
+{
+  m_received++;
+  m_delay += delay.GetSeconds ();
+  // The consumers count the first transmission in retxCount
+  if (retxCount > 1)
+    m_retransmitted++;
+}
+
+void
+MobilityScenarioHelper::SetBinaryTraces (bool enable)
+{
+  m_binaryTraces = enable;
+}
+
+void
+MobilityScenarioHelper::SetReducedTraces (bool enable, bool byClass)
+{
+  m_reducedTraces = enable;
+  m_byClass = byClass;
+}
+
+void
+MobilityScenarioHelper::SetAsyncTraces (bool enable)
+{
+  m_asyncTraces = enable;
+}
+
+void
+MobilityScenarioHelper::SetDelayHistograms (bool enable)
+{
+  m_delayHistograms = enable;
+}
+
+void
+MobilityScenarioHelper::SetFineTracePeriods (Time fine, Time window, Time coarse)
+{
+  m_finePeriod = fine;
+  m_fineWindow = window;
+  m_coarsePeriod = coarse;
+}
+
+void
+MobilityScenarioHelper::InstallTracers (const NodeContainer &traced, const std::string &prefix, const std::string &fileId)
+{
+  // Adaptive periods only apply to the columnar tracers
+  bool fine = m_finePeriod.IsStrictlyPositive ();
+  if (fine)
+    TraceSchedule::Enable (m_finePeriod, m_coarsePeriod);
+
+  if (m_reducedTraces || m_binaryTraces || m_asyncTraces || m_delayHistograms || fine)
+    {
+      // The columnar tracers write the traces below through a sink per
+      // file: reduced to the series the graphs use, in the columnar format
+      // (convert back with ndn-trace-convert) or in the text tables,
+      // optionally written by a thread of their own. The delay histograms
+      // replace the row per Data packet
+      const char *names[] = { "aggregate-trace", "rate-trace", m_delayHistograms ? "app-histograms" : "app-delays", "drop-trace", "cs-trace" };
+      double bins[] = { 1.0, 1.0, 1.0, 0.5, 1.0 };
+      boost::shared_ptr<TraceSink> sinks[5];
+
+      for (int i = 0; i < 5; i++)
+        {
+          if (m_reducedTraces)
+            {
+              std::string file = prefix + "-" + names[i] + "-reduced-" + fileId;
+              boost::shared_ptr<AggregatingTraceSink> sink = boost::make_shared<AggregatingTraceSink> (file, Seconds (bins[i]));
+              if (m_byClass)
+                {
+                  sink->SetNodeClass (m_topology.GetMobileTerminals (), "mobile");
+                  sink->SetNodeClass (m_topology.GetApNodes (), "ap");
+                  sink->SetNodeClass (m_topology.GetCentralNodes (), "core");
+                  sink->SetNodeClass (m_topology.GetFirstLevelNodes (), "core");
+                  sink->SetNodeClass (m_topology.GetServerNodes (), "server");
+                }
+              sinks[i] = sink;
+            }
+          else if (m_binaryTraces)
+            sinks[i] = boost::make_shared<ColumnarTraceWriter> (prefix + "-" + names[i] + "-" + fileId + ".ntc");
+          else
+            sinks[i] = boost::make_shared<TextTraceSink> (prefix + "-" + names[i] + "-" + fileId);
+
+          if (m_asyncTraces)
+            sinks[i] = boost::make_shared<AsyncTraceSink> (sinks[i]);
+        }
+
+      ColumnarL3Tracer::Install (traced, sinks[0], Seconds (1.0), ColumnarL3Tracer::AGGREGATE);
+      ColumnarL3Tracer::Install (traced, sinks[1], Seconds (1.0), ColumnarL3Tracer::RATE);
+      if (m_delayHistograms)
+        ColumnarAppHistogramTracer::Install (traced, sinks[2], Seconds (1.0));
+      else
+        ColumnarAppDelayTracer::Install (traced, sinks[2]);
+      ColumnarL2Tracer::Install (traced, sinks[3], Seconds (0.5));
+      ColumnarCsTracer::Install (traced, sinks[4], Seconds (1));
+      return;
+    }
+
+  ndn::L3AggregateTracer::Install (traced, prefix + "-aggregate-trace-" + fileId, Seconds (1.0));
+  ndn::L3RateTracer::Install (traced, prefix + "-rate-trace-" + fileId, Seconds (1.0));
+  ndn::AppDelayTracer::Install (traced, prefix + "-app-delays-" + fileId);
+
+  // The ndnSIM L2 tracer can only trace every node, the columnar one
+  // writes the same table for a selection. Partitioned and MPI runs only
+  // trace the nodes they run, so they never trace every node
+  std::string drops = prefix + "-drop-trace-" + fileId;
+  if (traced.GetN () == NodeContainer::GetGlobal ().GetN ())
+    L2RateTracer::InstallAll (drops, Seconds (0.5));
+  else
+    ColumnarL2Tracer::Install (traced, boost::make_shared<TextTraceSink> (drops), Seconds (0.5));
+
+  ndn::CsTracer::Install (traced, prefix + "-cs-trace-" + fileId, Seconds (1));
+}
+
+void
+MobilityScenarioHelper::InstallHandoffTrace (const NodeContainer &terminals, const std::string &prefix, const std::string &fileId)
+{
+  std::string file = prefix + "-handoffs-" + fileId + ".ntc";
+  if (m_asyncTraces)
+    HandoffRecorder::Install (terminals, boost::make_shared<AsyncTraceSink> (boost::make_shared<ColumnarTraceWriter> (file)));
+  else
+    HandoffRecorder::Install (terminals, file);
+}
+
+void
+MobilityScenarioHelper::DestroyTracers ()
+{
+  // The ndnSIM tracers would otherwise only flush their files at exit
+  ndn::L3AggregateTracer::Destroy ();
+  ndn::L3RateTracer::Destroy ();
+  ndn::AppDelayTracer::Destroy ();
+  L2RateTracer::Destroy ();
+  ndn::CsTracer::Destroy ();
+
+  // The columnar and reduced traces write their last rows when closed
+  ColumnarL3Tracer::Destroy ();
+  ColumnarAppDelayTracer::Destroy ();
+  ColumnarAppHistogramTracer::Destroy ();
+  ColumnarL2Tracer::Destroy ();
+  ColumnarCsTracer::Destroy ();
+  HandoffRecorder::Destroy ();
+}
+
+void
+MobilityScenarioHelper::ScheduleApSelection (const NodeContainer &terminals, double period, double end)
+{
+  NS_ASSERT_MSG (period > 0, "The AP selection period must be positive");
+
+  for (double t = 0; t < end; t += period)
+    {
+      for (NodeContainer::Iterator node = terminals.Begin (); node != terminals.End (); node++)
+        Simulator::ScheduleWithContext ((*node)->GetId (), Seconds (t), &MobilityScenarioHelper::SelectAp, this, *node);
+
+      // The movement traces are followed everywhere, so each worker and
+      // rank finds the SSID changes for the fine windows on its own
+      if (TraceSchedule::IsEnabled () && m_fineWindow.IsStrictlyPositive ())
+        Simulator::Schedule (Seconds (t), &MobilityScenarioHelper::OpenFineWindows, this);
+    }
+}
+
+uint64_t
+MobilityScenarioHelper::GetHandoffs () const
+{
+  return m_handoffs;
+}
+
+std::string
+MobilityScenarioHelper::GetNearestSsid (Ptr<MobilityModel> node, const std::map<std::string, Ptr<MobilityModel> > &aps,
+                                        double &distance)
+{
+  // Of equally distant APs, the last SSID in order wins, as it always did
+  std::string ssid;
+  for (std::map<std::string, Ptr<MobilityModel> >::const_iterator ap = aps.begin (); ap != aps.end (); ap++)
+    {
+      double d = node->GetDistanceFrom (ap->second);
+      if (ssid.empty () || d <= distance)
+        {
+          distance = d;
+          ssid = ap->first;
+        }
+    }
+  return ssid;
+}
+
+void
+MobilityScenarioHelper::SelectAp (Ptr<Node> node)
+{
+  double distance;
+  std::string ssid = GetNearestSsid (node->GetObject<MobilityModel> (), m_topology.GetApMobility (), distance);
+  NS_LOG_INFO ("Change to SSID " << ssid << " at distance of " << distance);
+
+  std::string &current = m_ssid[node->GetId ()];
+
+  // The recorder has to see the change before the card associates, which
+  // a FastWifiNetDevice does at once
+  if (current != ssid && !current.empty ())
+    HandoffRecorder::Trigger (node, current, ssid);
+
+  m_topology.Associate (node->GetDevice (0), ssid);
+
+  if (current != ssid)
+    {
+      if (!current.empty ())
+        m_handoffs++;
+      current = ssid;
+    }
+}
+
+void
+MobilityScenarioHelper::OpenFineWindows ()
+{
+  // Every terminal, including the ones other processes run
+  NodeContainer terminals = m_topology.GetMobileTerminals ();
+  for (NodeContainer::Iterator node = terminals.Begin (); node != terminals.End (); node++)
+    {
+      double distance;
+      std::string ssid = GetNearestSsid ((*node)->GetObject<MobilityModel> (), m_topology.GetApMobility (), distance);
+
+      std::string &current = m_windowSsid[(*node)->GetId ()];
+      if (current != ssid)
+        {
+          if (!current.empty ())
+            TraceSchedule::AddWindow (Simulator::Now (), Simulator::Now () + m_fineWindow);
+          current = ssid;
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,272 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  mobility-scenario-helper.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  mobility-scenario-helper.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with mobility-scenario-helper.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MOBILITY_SCENARIO_HELPER_H
+#define MOBILITY_SCENARIO_HELPER_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <ns3-dev/ns3/mobility-model.h>
+#include <ns3-dev/ns3/node-container.h>
+#include <ns3-dev/ns3/nstime.h>
+#include <ns3-dev/ns3/ndnSIM/apps/ndn-app.h>
+
+#include "sector-topology-helper.h"
+
+namespace ns3 {
+
+class ResultCache;
+
+/**
+ * @brief What the mobility scenarios run on a SectorTopologyHelper: the
+ * NDN stacks, the producers and consumers, the AP selection of the mobile
+ * terminals and the tracers
+ *
+ * ndn-mobility-random and ndn-mobility-sweep both set their runs up with
+ * it, so a sweep point runs what the scenario runs with the same options:
+ *
+ *   MobilityScenarioHelper run (topology);
+ *   run.InstallNdn ("flood", csSize);
+ *   run.InstallApplications (servers, terminals, mbps, Seconds (endTime), Seconds (retx));
+ *   std::string fileId = run.GetFileId ("flood");
+ *   run.WriteNodeLists ("results/NDNMobilityRandom", fileId);
+ *   run.InstallTracers (traced, "results/NDNMobilityRandom", fileId);
+ *   run.ScheduleApSelection (terminals, checkTime, endTime);
+ *   run.EnableSummary ();
+ *   Simulator::Run ();
+ *   Simulator::Destroy ();
+ *   MobilityScenarioHelper::DestroyTracers ();
+ *   run.WriteSummary ("results/summary.txt", endTime - 2);
+ *
+ * The helper has to live until the simulation ends, as the AP selection
+ * events call it.
+ */
+class MobilityScenarioHelper
+{
+public:
+  /**
+   * @brief Bytes of payload of every Data packet
+   */
+  static const uint32_t PAYLOAD_SIZE = 1024;
+
+  MobilityScenarioHelper (SectorTopologyHelper &topology);
+
+  /**
+   * @brief Whether a forwarding strategy is "flood", "smart" or "bestr"
+   */
+  static bool
+  IsStrategy (const std::string &strategy);
+
+  /**
+   * @brief Key the options choosing which trace files a run writes, so
+   * the cached results of a run without them are not taken for a run
+   * asking for them. Without trace they write nothing and are left out
+   *
+   * @param traced Roles of the traced nodes, "all" for every node
+   */
+  static void
+  AddTraceOptions (ResultCache &cache, bool trace, bool binary, bool reduced, bool byClass,
+                   bool delayHistograms, double finePeriod, double fineWindow, double coarsePeriod,
+                   bool handoffs, const std::string &traced);
+
+  /**
+   * @brief Install the NDN stacks: the given forwarding strategy and an
+   * LRU Content Store of csSize on the routers, BestRoute and no Content
+   * Store on the mobile terminals and servers
+   */
+  void
+  InstallNdn (const std::string &strategy, uint32_t csSize);
+
+  /**
+   * @brief Install the producers of /waseda/sato on the servers and the
+   * CBR consumers on the mobile terminals, active from 1 s to stop - 1 s
+   *
+   * @param mbps Data rate of each consumer in MB/s
+   * @param maxSeq Sequence numbers each consumer requests, -1 for no limit
+   */
+  void
+  InstallApplications (const NodeContainer &servers, const NodeContainer &terminals,
+                       double mbps, Time stop, Time retx, int32_t maxSeq = -1);
+
+  /**
+   * @brief Trace file identifier of the scenarios, like
+   * flood-01-001-054.txt: strategy, mobile terminals, servers and APs.
+   * ndn-trace-merge reads the configuration back from it
+   *
+   * @param part Worker or rank of a partitioned run, like "w01", or empty
+   */
+  std::string
+  GetFileId (const std::string &strategy, const std::string &part = "") const;
+
+  /**
+   * @brief Write the node IDs of the mobile terminals to
+   * prefix-clients-fileId and of the servers to prefix-servers-fileId
+   */
+  bool
+  WriteNodeLists (const std::string &prefix, const std::string &fileId) const;
+
+  /**
+   * @brief Count the Data the consumers of this process receive, for
+   * WriteSummary. Call once the applications are installed
+   */
+  void
+  EnableSummary ();
+
+  /**
+   * @brief Write the run summary as name=value lines: goodput (Mbps),
+   * delay (ms), retxShare and handoffs
+   *
+   * Goodput counts the payload of every sequence number once, over the
+   * time the consumers are active. retxShare is the share of the received
+   * sequence numbers whose Interest had to be retransmitted. It is only a
+   * proxy for the loss around handoffs: it also counts Interests that
+   * were late rather than lost, and sequence numbers never received are
+   * not in it at all.
+   *
+   * @param activeTime Seconds the consumers were active
+   */
+  bool
+  WriteSummary (const std::string &path, double activeTime) const;
+
+  /**
+   * @brief Write the traces in the columnar binary format
+   */
+  void
+  SetBinaryTraces (bool enable);
+
+  /**
+   * @brief Write only the traces reduced over nodes and faces by
+   * AggregatingTraceSink, the node classes kept apart with byClass
+   */
+  void
+  SetReducedTraces (bool enable, bool byClass = false);
+
+  /**
+   * @brief Format and write the traces from background threads
+   */
+  void
+  SetAsyncTraces (bool enable);
+
+  /**
+   * @brief Trace the delays as per second histograms instead of one row
+   * per Data packet
+   */
+  void
+  SetDelayHistograms (bool enable);
+
+  /**
+   * @brief Trace every fine period for window after each SSID change, and
+   * every coarse period (0 for the periods of each tracer) elsewhere
+   *
+   * Reduced traces sum the rows of a bin, so they cannot be sampled
+   * finely.
+   */
+  void
+  SetFineTracePeriods (Time fine, Time window, Time coarse);
+
+  /**
+   * @brief Install the L3 aggregate and rate, app delay, L2 drop and CS
+   * tracers on the given nodes, writing prefix-<trace>-fileId
+   *
+   * The ndnSIM text tracers are used unless an option above needs the
+   * columnar ones. The delay histograms only trace the consumers, so call
+   * after InstallApplications.
+   */
+  void
+  InstallTracers (const NodeContainer &traced, const std::string &prefix, const std::string &fileId);
+
+  /**
+   * @brief Write a binary row per handoff of the given terminals to
+   * prefix-handoffs-fileId.ntc
+   */
+  void
+  InstallHandoffTrace (const NodeContainer &terminals, const std::string &prefix, const std::string &fileId);
+
+  /**
+   * @brief Close every tracer, after Simulator::Destroy
+   */
+  static void
+  DestroyTracers ();
+
+  /**
+   * @brief Give each terminal the SSID of its nearest AP every period
+   * seconds until end
+   *
+   * The check times are summed in seconds, as the scenarios always did,
+   * so they fall on the same nanoseconds. The checks run on the given
+   * terminals, the ones of this process. With fine trace periods the
+   * windows are opened by a global event doing the same checks for every
+   * terminal of the topology, so every worker or MPI rank samples the
+   * same windows.
+   */
+  void
+  ScheduleApSelection (const NodeContainer &terminals, double period, double end);
+
+  /**
+   * @brief AP changes of the terminals run by this process
+   */
+  uint64_t
+  GetHandoffs () const;
+
+  /**
+   * @brief SSID of the AP nearest to a mobile terminal
+   *
+   * @param distance Set to the distance to that AP
+   */
+  static std::string
+  GetNearestSsid (Ptr<MobilityModel> node, const std::map<std::string, Ptr<MobilityModel> > &aps, double &distance);
+
+private:
+  void
+  SelectAp (Ptr<Node> node);
+
+  void
+  OpenFineWindows ();
+
+  void
+  DataReceived (Ptr<ndn::App> app, uint32_t seqno, Time delay, uint32_t retxCount, int32_t hopCount);
+
+  SectorTopologyHelper &m_topology;
+
+  bool m_binaryTraces;
+  bool m_reducedTraces;
+  bool m_byClass;
+  bool m_asyncTraces;
+  bool m_delayHistograms;
+  Time m_finePeriod;
+  Time m_fineWindow;
+  Time m_coarsePeriod;
+
+  // SSID of each terminal, by node ID, for the association and the windows
+  std::map<uint32_t, std::string> m_ssid;
+  std::map<uint32_t, std::string> m_windowSsid;
+  uint64_t m_handoffs;
+
+  // Data received, one per sequence number, the ones whose Interest was
+  // retransmitted and the sum of their delays
+  uint64_t m_received;
+  uint64_t m_retransmitted;
+  double m_delay;
+};
+
+} // namespace ns3
+
+#endif // MOBILITY_SCENARIO_HELPER_H
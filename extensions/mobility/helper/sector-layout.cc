@@ -0,0 +1,302 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  sector-layout.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  sector-layout.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with sector-layout.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "sector-layout.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <ns3-dev/ns3/assert.h>
+#include <ns3-dev/ns3/log.h>
+
+NS_LOG_COMPONENT_DEFINE ("SectorLayout");
+
+namespace ns3 {
+
+namespace {
+
+// Vectors that define a hexagon, as in hexagon-random.py
+const double g_hexVectors[3][2] = { { 0.0, -1.0 }, { -0.8660254037844386, 0.5 }, { 0.8660254037844386, 0.5 } };
+
+// frange from hexagon-random.py
+uint32_t
+CountSteps (double start, double end, double inc)
+{
+  uint32_t n = 0;
+  while (start + n * inc < end)
+    n++;
+  return n;
+}
+
+uint32_t
+CountSectors (double r, double side)
+{
+  double col = 2 * r * std::sqrt (3.0);
+  return CountSteps (2 * r, side, 6 * r) * CountSteps (r * std::sqrt (3.0), side, col)
+    + CountSteps (5 * r, side, 6 * r) * CountSteps (0, side, col);
+}
+
+} // anonymous namespace
+
+SectorLayout::SectorLayout ()
+  : m_xaxis (0)
+  , m_yaxis (0)
+  , m_apsPerSector (0)
+{
+}
+
+bool
+SectorLayout::Read (const std::string &file)
+{
+  std::ifstream is (file.c_str (), std::ios::in | std::ios::binary);
+
+  if (!is.is_open ())
+    {
+      NS_LOG_ERROR ("Cannot open position file " << file);
+      return false;
+    }
+
+  char magic[4] = { 0, 0, 0, 0 };
+  is.read (magic, sizeof (magic));
+  is.clear ();
+  is.seekg (0);
+
+  m_sectors.clear ();
+  m_aps.clear ();
+
+  if (std::memcmp (magic, "HEXB", sizeof (magic)) == 0)
+    return ReadBinary (is);
+  else
+    return ReadText (is);
+}
+
+bool
+SectorLayout::ReadText (std::istream &is)
+{
+  std::string line;
+  uint32_t sectors = 0;
+  uint32_t wnodes = 0;
+
+  NS_LOG_INFO ("Reading X and Y axis");
+  std::getline (is, line);
+  std::istringstream (line) >> m_xaxis;
+  std::getline (is, line);
+  std::istringstream (line) >> m_yaxis;
+
+  NS_LOG_INFO ("Reading number of sectors");
+  std::getline (is, line);
+  std::istringstream (line) >> sectors;
+
+  NS_LOG_INFO ("Reading sector positions");
+  m_sectors.reserve (sectors);
+  for (uint32_t i = 0; i < sectors; i++)
+    {
+      Vector pos;
+      std::getline (is, line, ',');
+      std::istringstream (line) >> pos.x;
+      std::getline (is, line);
+      std::istringstream (line) >> pos.y;
+      m_sectors.push_back (pos);
+    }
+
+  NS_LOG_INFO ("Reading number of wireless nodes per sector");
+  std::getline (is, line);
+  std::istringstream (line) >> m_apsPerSector;
+
+  NS_LOG_INFO ("Reading number of wireless nodes in the simulation");
+  std::getline (is, line);
+  std::istringstream (line) >> wnodes;
+
+  NS_LOG_INFO ("Reading wireless node positions");
+  m_aps.reserve (wnodes);
+  for (uint32_t i = 0; i < wnodes; i++)
+    {
+      Vector pos;
+      std::getline (is, line, ',');
+      std::istringstream (line) >> pos.x;
+      std::getline (is, line);
+      std::istringstream (line) >> pos.y;
+      m_aps.push_back (pos);
+    }
+
+  if (!is)
+    {
+      NS_LOG_ERROR ("Position file is truncated");
+      return false;
+    }
+
+  return true;
+}
+
+bool
+SectorLayout::ReadBinary (std::istream &is)
+{
+  char magic[4];
+  uint32_t version;
+  double axis[2];
+  uint32_t counts[3];
+
+  is.read (magic, sizeof (magic));
+  is.read (reinterpret_cast<char *> (&version), sizeof (version));
+  is.read (reinterpret_cast<char *> (axis), sizeof (axis));
+  is.read (reinterpret_cast<char *> (counts), sizeof (counts));
+
+  if (!is || version != 1)
+    {
+      NS_LOG_ERROR ("Unsupported binary position file");
+      return false;
+    }
+
+  m_xaxis = axis[0];
+  m_yaxis = axis[1];
+  m_apsPerSector = counts[1];
+
+  // Positions are stored as (x, y) pairs of doubles
+  std::vector<double> xy (2 * (counts[0] + counts[2]));
+  if (!xy.empty ())
+    is.read (reinterpret_cast<char *> (&xy[0]), xy.size () * sizeof (double));
+
+  if (!is)
+    {
+      NS_LOG_ERROR ("Position file is truncated");
+      return false;
+    }
+
+  m_sectors.reserve (counts[0]);
+  for (uint32_t i = 0; i < counts[0]; i++)
+    m_sectors.push_back (Vector (xy[2 * i], xy[2 * i + 1], 0.0));
+
+  m_aps.reserve (counts[2]);
+  for (uint32_t i = counts[0]; i < counts[0] + counts[2]; i++)
+    m_aps.push_back (Vector (xy[2 * i], xy[2 * i + 1], 0.0));
+
+  return true;
+}
+
+void
+SectorLayout::Generate (uint32_t sectors, uint32_t apsPerSector, double radius, uint64_t seed)
+{
+  NS_ASSERT_MSG (radius >= 2, "Radius must be at least 2 meters");
+
+  boost::random::mt19937_64 gen (seed);
+  boost::random::uniform_int_distribution<> xdist (0, static_cast<int> (radius) - 1);
+  boost::random::uniform_int_distribution<> ydist (1, static_cast<int> (radius) - 1);
+
+  double side = std::floor (std::sqrt (sectors * 6 * std::sqrt (3.0) * radius * radius));
+  while (CountSectors (radius, side) < sectors)
+    side += radius;
+
+  m_xaxis = side;
+  m_yaxis = side;
+  m_apsPerSector = apsPerSector;
+  m_sectors.clear ();
+  m_aps.clear ();
+  m_sectors.reserve (sectors);
+  m_aps.reserve (sectors * apsPerSector);
+
+  // The two interleaved rows of hexagons
+  const double start[2][2] = { { radius * std::sqrt (3.0), 2 * radius }, { 0, 5 * radius } };
+
+  for (uint32_t s = 0; s < 2; s++)
+    {
+      uint32_t rows = CountSteps (start[s][1], side, 6 * radius);
+      uint32_t cols = CountSteps (start[s][0], side, 2 * radius * std::sqrt (3.0));
+
+      for (uint32_t i = 0; i < rows && m_sectors.size () < sectors; i++)
+        {
+          for (uint32_t j = 0; j < cols && m_sectors.size () < sectors; j++)
+            {
+              Vector center (start[s][0] + j * 2 * radius * std::sqrt (3.0),
+                             start[s][1] + i * 6 * radius, 0.0);
+              m_sectors.push_back (center);
+
+              // Fill the three rhombuses of the hexagon in turn
+              for (uint32_t k = 0; k < apsPerSector; k++)
+                {
+                  uint32_t t = (k < apsPerSector - apsPerSector % 3) ? k % 3 : k - (apsPerSector - apsPerSector % 3);
+                  const double *v1 = g_hexVectors[t];
+                  const double *v2 = g_hexVectors[(t + 1) % 3];
+                  int x = xdist (gen);
+                  int y = ydist (gen);
+
+                  m_aps.push_back (Vector (x * v1[0] + y * v2[0] + center.x,
+                                           x * v1[1] + y * v2[1] + center.y, 0.0));
+                }
+            }
+        }
+    }
+}
+
+double
+SectorLayout::GetXAxis () const
+{
+  return m_xaxis;
+}
+
+double
+SectorLayout::GetYAxis () const
+{
+  return m_yaxis;
+}
+
+uint32_t
+SectorLayout::GetNSectors () const
+{
+  return m_sectors.size ();
+}
+
+uint32_t
+SectorLayout::GetApsPerSector () const
+{
+  return m_apsPerSector;
+}
+
+uint32_t
+SectorLayout::GetNAps () const
+{
+  return m_aps.size ();
+}
+
+const Vector &
+SectorLayout::GetSectorPosition (uint32_t sector) const
+{
+  NS_ASSERT (sector < m_sectors.size ());
+  return m_sectors[sector];
+}
+
+const Vector &
+SectorLayout::GetApPosition (uint32_t ap) const
+{
+  NS_ASSERT (ap < m_aps.size ());
+  return m_aps[ap];
+}
+
+uint32_t
+SectorLayout::GetSectorOfAp (uint32_t ap) const
+{
+  NS_ASSERT (ap < m_aps.size () && m_apsPerSector > 0);
+  return ap / m_apsPerSector;
+}
+
+} // namespace ns3
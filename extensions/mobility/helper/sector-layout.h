@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  sector-layout.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  sector-layout.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with sector-layout.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SECTOR_LAYOUT_H
+#define SECTOR_LAYOUT_H
+
+#include <string>
+#include <vector>
+
+#include <ns3-dev/ns3/vector.h>
+
+namespace ns3 {
+
+/**
+ * @brief Positions of the sector (central) nodes and wireless access points
+ *
+ * Holds the contents of a rand-hex.txt style position file, as written by
+ * random/hexagon-random.py, or of its binary equivalent written by
+ * random/hexagon-generator --binary.  APs are stored sector by sector, so
+ * AP i belongs to sector i / GetApsPerSector ().
+ */
+class SectorLayout
+{
+public:
+  /**
+   * @brief Create an empty layout
+   */
+  SectorLayout ();
+
+  /**
+   * @brief Read a position file, detecting text or binary format
+   *
+   * @param file Path to the position file
+   * @returns false if the file could not be opened or is truncated
+   */
+  bool
+  Read (const std::string &file);
+
+  /**
+   * @brief Fill the layout with the same hexagonal lattice hexagon-random.py
+   * uses, growing a square area until the requested number of sectors fits
+   *
+   * @param sectors Number of sectors to lay out
+   * @param apsPerSector Number of APs placed in each sector
+   * @param radius Radius of the range of a wireless station (meters)
+   * @param seed Seed for the AP placement
+   */
+  void
+  Generate (uint32_t sectors, uint32_t apsPerSector, double radius, uint64_t seed);
+
+  double
+  GetXAxis () const;
+
+  double
+  GetYAxis () const;
+
+  uint32_t
+  GetNSectors () const;
+
+  uint32_t
+  GetApsPerSector () const;
+
+  uint32_t
+  GetNAps () const;
+
+  const Vector &
+  GetSectorPosition (uint32_t sector) const;
+
+  const Vector &
+  GetApPosition (uint32_t ap) const;
+
+  /**
+   * @brief Sector the AP number ap belongs to
+   */
+  uint32_t
+  GetSectorOfAp (uint32_t ap) const;
+
+private:
+  bool
+  ReadText (std::istream &is);
+
+  bool
+  ReadBinary (std::istream &is);
+
+private:
+  double m_xaxis;
+  double m_yaxis;
+  uint32_t m_apsPerSector;
+  std::vector<Vector> m_sectors;
+  std::vector<Vector> m_aps;
+};
+
+} // namespace ns3
+
+#endif // SECTOR_LAYOUT_H
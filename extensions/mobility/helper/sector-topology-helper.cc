@@ -0,0 +1,869 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  sector-topology-helper.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  sector-topology-helper.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with sector-topology-helper.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "sector-topology-helper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sys/time.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <ns3-dev/ns3/boolean.h>
+#include <ns3-dev/ns3/constant-position-mobility-model.h>
+#include <ns3-dev/ns3/double.h>
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/mpi-interface.h>
+#include <ns3-dev/ns3/nqos-wifi-mac-helper.h>
+#include <ns3-dev/ns3/propagation-delay-model.h>
+#include <ns3-dev/ns3/propagation-loss-model.h>
+#include <ns3-dev/ns3/string.h>
+#include <ns3-dev/ns3/wifi-helper.h>
+#include <ns3-dev/ns3/wifi-mac.h>
+#include <ns3-dev/ns3/wifi-net-device.h>
+#include <ns3-dev/ns3/yans-wifi-channel.h>
+#include <ns3-dev/ns3/yans-wifi-helper.h>
+#include <ns3-dev/ns3/yans-wifi-phy.h>
+
+#include "../../point-to-point/model/ideal-link-net-device.h"
+#include "../../propagation/model/cached-propagation-loss-model.h"
+#include "../../propagation/model/fast-nakagami-propagation-loss-model.h"
+#include "../../wifi/helper/fast-wifi-helper.h"
+#include "../../wifi/helper/range-wifi-helper.h"
+#include "../../wifi/model/fast-wifi-net-device.h"
+
+NS_LOG_COMPONENT_DEFINE ("SectorTopologyHelper");
+
+namespace ns3 {
+
+namespace {
+
+double
+WallClock ()
+{
+  struct timeval t;
+  gettimeofday (&t, NULL);
+  return t.tv_sec + t.tv_usec * 1e-6;
+}
+
+Ptr<YansWifiPhy>
+GetYansPhy (Ptr<NetDevice> device)
+{
+  return DynamicCast<YansWifiPhy> (DynamicCast<WifiNetDevice> (device)->GetPhy ());
+}
+
+// Transmission powers of the Wi-Fi cards (dBm)
+const double TX_POWER_START = 16.0206;
+const double TX_POWER_END = 1;
+
+// Nakagami fading (dB) the range culling allows for above the mean loss.
+// The m = 0.75 fading past 200 m exceeds it with a probability of 3e-4
+const double RANGE_FADING_MARGIN = 10;
+
+// Non-overlapping 802.11g channels of the reuse clusters that fit in the
+// 2.4 GHz band
+const uint16_t REUSE_3_CHANNELS[] = { 1, 6, 11 };
+const uint16_t REUSE_4_CHANNELS[] = { 1, 5, 9, 13 };
+
+} // anonymous namespace
+
+SectorTopologyHelper::SectorTopologyHelper ()
+  : m_mobile (1)
+  , m_servers (1)
+  , m_sectors (0)
+  , m_apsPerSector (0)
+  , m_sectorRadius (0)
+  , m_channelPlan (SINGLE_CHANNEL)
+  , m_reuse (3)
+  , m_rangeCulling (false)
+  , m_maxRange (0)
+  , m_dormantBeacons (false)
+  , m_wakeRange (250)
+  , m_cachedLoss (false)
+  , m_fastFading (false)
+  , m_fastWifi (false)
+  , m_idealLinks (false)
+  , m_partitions (1)
+{
+  SetAccessLinkAttributes ("100Mbps", "5ms");
+  SetCoreLinkAttributes ("1Gbps", "2ms");
+}
+
+void
+SectorTopologyHelper::SetMobileTerminals (uint32_t mobile)
+{
+  m_mobile = mobile;
+}
+
+void
+SectorTopologyHelper::SetServers (uint32_t servers)
+{
+  m_servers = servers;
+}
+
+void
+SectorTopologyHelper::SetAccessLinkAttributes (const std::string &dataRate, const std::string &delay)
+{
+  m_accessLink.SetDeviceAttribute ("DataRate", StringValue (dataRate));
+  m_accessLink.SetChannelAttribute ("Delay", StringValue (delay));
+  m_idealAccessLink.SetDeviceAttribute ("DataRate", StringValue (dataRate));
+  m_idealAccessLink.SetChannelAttribute ("Delay", StringValue (delay));
+  m_partitionAccessLink.SetDeviceAttribute ("DataRate", StringValue (dataRate));
+  m_partitionAccessLink.SetChannelAttribute ("Delay", StringValue (delay));
+}
+
+void
+SectorTopologyHelper::SetCoreLinkAttributes (const std::string &dataRate, const std::string &delay)
+{
+  m_coreLink.SetDeviceAttribute ("DataRate", StringValue (dataRate));
+  m_coreLink.SetChannelAttribute ("Delay", StringValue (delay));
+  m_idealCoreLink.SetDeviceAttribute ("DataRate", StringValue (dataRate));
+  m_idealCoreLink.SetChannelAttribute ("Delay", StringValue (delay));
+  m_partitionCoreLink.SetDeviceAttribute ("DataRate", StringValue (dataRate));
+  m_partitionCoreLink.SetChannelAttribute ("Delay", StringValue (delay));
+}
+
+void
+SectorTopologyHelper::SetChannelPlan (ChannelPlan plan, uint32_t reuse)
+{
+  if (plan == REUSE_CHANNELS && reuse != 3 && reuse != 4 && reuse != 7)
+    {
+      NS_FATAL_ERROR ("Unsupported reuse cluster size " << reuse << ", use 3, 4 or 7");
+    }
+  m_channelPlan = plan;
+  m_reuse = reuse;
+}
+
+void
+SectorTopologyHelper::SetRangeCulling (bool enable, double maxRange)
+{
+  m_rangeCulling = enable;
+  m_maxRange = maxRange;
+}
+
+void
+SectorTopologyHelper::SetDormantBeacons (bool enable, double wakeRange)
+{
+  m_dormantBeacons = enable;
+  m_wakeRange = wakeRange;
+}
+
+void
+SectorTopologyHelper::SetCachedLoss (bool enable)
+{
+  m_cachedLoss = enable;
+}
+
+void
+SectorTopologyHelper::SetFastFading (bool enable)
+{
+  m_fastFading = enable;
+}
+
+void
+SectorTopologyHelper::SetIdealLinks (bool enable, bool accounting)
+{
+  m_idealLinks = enable;
+  m_idealAccessLink.SetDeviceAttribute ("Accounting", BooleanValue (accounting));
+  m_idealCoreLink.SetDeviceAttribute ("Accounting", BooleanValue (accounting));
+}
+
+void
+SectorTopologyHelper::SetPartitions (uint32_t partitions)
+{
+  NS_ASSERT (partitions > 0);
+  m_partitions = partitions;
+}
+
+void
+SectorTopologyHelper::SetFastWifi (bool enable)
+{
+  m_fastWifi = enable;
+}
+
+SectorTopologyHelper::ChannelPlan
+SectorTopologyHelper::ParseChannelPlan (const std::string &plan)
+{
+  if (plan == "single")
+    return SINGLE_CHANNEL;
+  else if (plan == "sector")
+    return SECTOR_CHANNELS;
+  else if (plan == "reuse")
+    return REUSE_CHANNELS;
+
+  NS_FATAL_ERROR ("Unknown channel plan \"" << plan << "\", use single, sector or reuse");
+  return SINGLE_CHANNEL;
+}
+
+void
+SectorTopologyHelper::Create (const SectorLayout &layout)
+{
+  double start = WallClock ();
+
+  m_sectors = layout.GetNSectors ();
+  m_apsPerSector = layout.GetApsPerSector ();
+
+  NS_LOG_INFO ("------Creating nodes------");
+  // Node creation order fixes the node IDs the trace files refer to. The
+  // wireless side is partition 0, the wired nodes are spread over the others
+  // with every central node on the partition of the first level node it
+  // connects to, so only the access links and the first level mesh are cut
+  uint32_t first = m_sectors / 3 + 1;
+  uint32_t branches = std::max (first - 1, 1u);
+  m_mobileNodes.Create (m_mobile);
+  for (uint32_t i = 0; i < m_sectors; i++)
+    {
+      m_centralNodes.Create (1, GetWiredPartition (i % branches, branches));
+    }
+  m_apNodes.Create (layout.GetNAps ());
+  for (uint32_t i = 0; i < first - 1; i++)
+    {
+      m_firstLevelNodes.Create (1, GetWiredPartition (i, branches));
+    }
+  // The node the servers are attached to relays every Data packet, so it
+  // goes with the servers on the last partition, which gets the fewest
+  // branches
+  m_firstLevelNodes.Create (1, GetServerPartition ());
+  m_serverNodes.Create (m_servers, GetServerPartition ());
+
+  NS_LOG_INFO ("------Placing Central nodes and wireless access nodes------");
+  // Aggregating the models directly avoids a MobilityHelper attribute pass
+  // per node
+  m_sectorPositions.clear ();
+  m_sectorPositions.reserve (m_sectors);
+  for (uint32_t i = 0; i < m_sectors; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> pos = CreateObject<ConstantPositionMobilityModel> ();
+      pos->SetPosition (layout.GetSectorPosition (i));
+      m_centralNodes.Get (i)->AggregateObject (pos);
+      m_sectorPositions.push_back (layout.GetSectorPosition (i));
+    }
+
+  // Neighbouring sector centres are 2*sqrt(3)*r apart, r being the hexagon
+  // radius. The closest centre to sector 0 recovers r for the reuse plan
+  double nearest = std::numeric_limits<double>::max ();
+  for (uint32_t i = 1; i < m_sectors; i++)
+    {
+      nearest = std::min (nearest, CalculateDistance (m_sectorPositions[0], m_sectorPositions[i]));
+    }
+  m_sectorRadius = (m_sectors > 1) ? nearest / (2 * std::sqrt (3.)) : 0;
+
+  for (uint32_t i = 0; i < layout.GetNAps (); i++)
+    {
+      Ptr<ConstantPositionMobilityModel> pos = CreateObject<ConstantPositionMobilityModel> ();
+      pos->SetPosition (layout.GetApPosition (i));
+      m_apNodes.Get (i)->AggregateObject (pos);
+    }
+
+  RecordTime ("create", start);
+}
+
+void
+SectorTopologyHelper::ConnectWired ()
+{
+  double start = WallClock ();
+  uint32_t first = m_firstLevelNodes.GetN ();
+
+  // Because the simulation is using Wifi, PtP connections are 100Mbps
+  // with 5ms delay
+  NS_LOG_INFO ("------Connecting Central nodes to wireless access nodes------");
+  for (uint32_t i = 0; i < m_apNodes.GetN (); i++)
+    {
+      InstallLink (false, m_centralNodes.Get (i / m_apsPerSector), m_apNodes.Get (i));
+    }
+
+  // Connect the servers to the lone core node
+  for (uint32_t i = 0; i < m_servers; i++)
+    {
+      InstallLink (false, m_serverNodes.Get (i), m_firstLevelNodes.Get (first - 1));
+    }
+
+  NS_LOG_INFO ("------Connecting Central nodes to first level nodes------");
+  for (uint32_t i = 0; i < first - 1; i++)
+    {
+      for (uint32_t j = i; j < m_sectors; j += (first - 1))
+        {
+          InstallLink (true, m_firstLevelNodes.Get (i), m_centralNodes.Get (j));
+        }
+    }
+
+  NS_LOG_INFO ("------Connecting First level nodes amongst themselves------");
+  for (uint32_t i = 0; i < first; i++)
+    {
+      for (uint32_t j = i + 1; j < first; j++)
+        {
+          InstallLink (true, m_firstLevelNodes.Get (i), m_firstLevelNodes.Get (j));
+        }
+    }
+
+  RecordTime ("wired", start);
+}
+
+NetDeviceContainer
+SectorTopologyHelper::AddCoreLink (Ptr<Node> a, Ptr<Node> b)
+{
+  return InstallLink (true, a, b);
+}
+
+uint32_t
+SectorTopologyHelper::GetWiredPartition (uint32_t i, uint32_t n) const
+{
+  if (m_partitions < 2)
+    return 0;
+
+  // Balanced contiguous runs, partition 1 taking the first
+  return 1 + (uint64_t) i * (m_partitions - 1) / n;
+}
+
+uint32_t
+SectorTopologyHelper::GetServerPartition () const
+{
+  return (m_partitions < 2) ? 0 : m_partitions - 1;
+}
+
+NetDeviceContainer
+SectorTopologyHelper::InstallLink (bool core, Ptr<Node> a, Ptr<Node> b)
+{
+  NetDeviceContainer devices;
+  if (a->GetSystemId () != b->GetSystemId () && !MpiInterface::IsEnabled ())
+    devices = core ? m_partitionCoreLink.Install (a, b) : m_partitionAccessLink.Install (a, b);
+  else if (a->GetSystemId () != b->GetSystemId ())
+    // PointToPointHelper sets up the MPI remote channel and receivers
+    devices = core ? m_coreLink.Install (a, b) : m_accessLink.Install (a, b);
+  else if (m_idealLinks)
+    devices = core ? m_idealCoreLink.Install (a, b) : m_idealAccessLink.Install (a, b);
+  else
+    devices = core ? m_coreLink.Install (a, b) : m_accessLink.Install (a, b);
+
+  m_wiredDevices.Add (devices);
+  return devices;
+}
+
+uint64_t
+SectorTopologyHelper::GetWiredTxBytes () const
+{
+  uint64_t bytes = 0;
+  for (uint32_t i = 0; i < m_wiredDevices.GetN (); i++)
+    {
+      Ptr<IdealLinkNetDevice> device = DynamicCast<IdealLinkNetDevice> (m_wiredDevices.Get (i));
+      if (device != 0)
+        bytes += device->GetTxBytes ();
+    }
+  return bytes;
+}
+
+NetDeviceContainer
+SectorTopologyHelper::GetWiredDevices () const
+{
+  return m_wiredDevices;
+}
+
+void
+SectorTopologyHelper::InstallWifi (uint32_t initialAp)
+{
+  double start = WallClock ();
+
+  NS_LOG_INFO ("------Creating ssids for wireless cards------");
+  m_ssids.clear ();
+  m_ssids.reserve (m_apNodes.GetN ());
+  m_apMobility.clear ();
+
+  for (uint32_t i = 0; i < m_apNodes.GetN (); i++)
+    {
+      std::string ssid ("ap-" + boost::lexical_cast<std::string> (i));
+      m_ssids.push_back (Ssid (ssid));
+      m_apMobility[ssid] = m_apNodes.Get (i)->GetObject<MobilityModel> ();
+    }
+
+  if (m_fastWifi)
+    {
+      InstallFastWifi (initialAp);
+      RecordTime ("wifi", start);
+      return;
+    }
+
+  NS_LOG_INFO ("------Creating Wireless cards------");
+
+  // Use the Wifi Helper to define the wireless interfaces for APs
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211g);
+  // The ConstantRateWifiManager only works with one rate, making issues
+  // and the MinstrelWifiManager isn't working on the current version of NS-3
+  wifi.SetRemoteStationManager ("ns3::ArfWifiManager");
+
+  // With SINGLE_CHANNEL all interfaces are placed on the same channel, which
+  // makes AP changes easy but has every frame evaluated by every card
+  YansWifiPhyHelper yansPhyHelper = YansWifiPhyHelper::Default ();
+  RangeWifiPhyHelper rangePhyHelper;
+  const WifiPhyHelper *wifiPhyHelper;
+  Ptr<YansWifiChannel> uplink;
+  Ptr<PropagationLossModel> uplinkLoss;
+
+  if (m_rangeCulling)
+    {
+      Ptr<RangeWifiChannel> channel = CreateObject<RangeWifiChannel> ();
+      channel->SetPropagationLossModel (CreateLossModel ());
+      channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+      channel->SetAttribute ("MaxRange", DoubleValue (GetMaxRange ()));
+      NS_LOG_INFO ("Delivering frames up to " << GetMaxRange () << " m");
+
+      // Nothing is culled when every AP is in range of every other, as
+      // with the derived range on the 1000 x 1000 m layouts
+      Vector low (std::numeric_limits<double>::max (), std::numeric_limits<double>::max (), 0);
+      Vector high (-low.x, -low.y, 0);
+      for (std::map<std::string, Ptr<MobilityModel> >::const_iterator ap = m_apMobility.begin (); ap != m_apMobility.end (); ap++)
+        {
+          Vector position = ap->second->GetPosition ();
+          low = Vector (std::min (low.x, position.x), std::min (low.y, position.y), 0);
+          high = Vector (std::max (high.x, position.x), std::max (high.y, position.y), 0);
+        }
+      if (!m_apMobility.empty () && CalculateDistance (low, high) <= GetMaxRange ())
+        NS_LOG_WARN ("The APs are all within " << GetMaxRange () << " m of each other, range culling skips no card");
+
+      rangePhyHelper.SetChannel (channel);
+      rangePhyHelper.Set ("TxPowerStart", DoubleValue (TX_POWER_START));
+      rangePhyHelper.Set ("TxPowerEnd", DoubleValue (TX_POWER_END));
+      wifiPhyHelper = &rangePhyHelper;
+    }
+  else
+    {
+      uplinkLoss = CreateLossModel ();
+      uplink = CreateYansChannel (uplinkLoss);
+      yansPhyHelper.SetChannel (uplink);
+      yansPhyHelper.Set ("TxPowerStart", DoubleValue (TX_POWER_START));
+      yansPhyHelper.Set ("TxPowerEnd", DoubleValue (TX_POWER_END));
+      wifiPhyHelper = &yansPhyHelper;
+    }
+
+  // Add a simple no QoS based card to the Wifi interfaces
+  NqosWifiMacHelper wifiMacHelper = NqosWifiMacHelper::Default ();
+
+  NS_LOG_INFO ("------Assigning AP wireless cards------");
+  // All APs share one MAC configuration and are installed in one pass. The
+  // SSID is then set on each MAC, rather than reconfiguring the helper per AP
+  wifiMacHelper.SetType ("ns3::ApWifiMac",
+                         "BeaconGeneration", BooleanValue (true),
+                         "BeaconInterval", TimeValue (Seconds (0.102)));
+
+  m_apWifiDevices = wifi.Install (*wifiPhyHelper, wifiMacHelper, m_apNodes);
+
+  for (uint32_t i = 0; i < m_apWifiDevices.GetN (); i++)
+    {
+      DynamicCast<WifiNetDevice> (m_apWifiDevices.Get (i))->GetMac ()->SetSsid (m_ssids[i]);
+    }
+
+  // Downlink channel per sector or reuse colour. The APs were added to the
+  // uplink channel by the install above, and SetChannel adds them to their
+  // downlink channel, which becomes the one they transmit on. The range
+  // culled channel already skips far away cards, so it only needs the
+  // channel numbers. The downlinks share the cached losses of the uplink
+  std::vector<Ptr<YansWifiChannel> > downlinks;
+  m_apChannelNumbers.clear ();
+
+  if (m_channelPlan != SINGLE_CHANNEL && !m_rangeCulling)
+    {
+      NS_LOG_INFO ("------Assigning sector channels------");
+      uint32_t groups = (m_channelPlan == REUSE_CHANNELS) ? m_reuse : m_sectors;
+      for (uint32_t g = 0; g < groups; g++)
+        {
+          downlinks.push_back (CreateYansChannel (CreateLossModel (uplinkLoss)));
+        }
+    }
+
+  for (uint32_t i = 0; i < m_apWifiDevices.GetN (); i++)
+    {
+      Ptr<YansWifiPhy> phy = GetYansPhy (m_apWifiDevices.Get (i));
+      if (m_channelPlan != SINGLE_CHANNEL)
+        {
+          uint32_t group = GetChannelGroup (i / m_apsPerSector);
+          if (!downlinks.empty ())
+            {
+              phy->SetChannel (downlinks[group]);
+            }
+          phy->SetChannelNumber (GetChannelNumber (group));
+        }
+      m_apChannelNumbers[m_ssids[i].PeekString ()] = phy->GetChannelNumber ();
+    }
+
+  NS_LOG_INFO ("------Assigning mobile terminal wireless cards------");
+  wifiMacHelper.SetType ("ns3::StaWifiMac",
+                         "Ssid", SsidValue (m_ssids[initialAp]),
+                         "ActiveProbing", BooleanValue (true));
+
+  if (!downlinks.empty ())
+    {
+      yansPhyHelper.SetChannel (downlinks[0]);
+    }
+
+  m_mobileWifiDevices = wifi.Install (*wifiPhyHelper, wifiMacHelper, m_mobileNodes);
+
+  if (m_channelPlan != SINGLE_CHANNEL)
+    {
+      // Terminals listen on every downlink channel and transmit on the uplink
+      // one, so the last SetChannel must be the uplink
+      for (uint32_t i = 0; i < m_mobileWifiDevices.GetN (); i++)
+        {
+          Ptr<YansWifiPhy> phy = GetYansPhy (m_mobileWifiDevices.Get (i));
+          if (!downlinks.empty ())
+            {
+              for (uint32_t g = 1; g < downlinks.size (); g++)
+                {
+                  phy->SetChannel (downlinks[g]);
+                }
+              phy->SetChannel (uplink);
+            }
+          phy->SetChannelNumber (m_apChannelNumbers[m_ssids[initialAp].PeekString ()]);
+        }
+    }
+
+  if (m_dormantBeacons)
+    {
+      NS_LOG_INFO ("------Suspending beacons of APs far from mobile terminals------");
+      m_beaconController = CreateObject<DormantBeaconController> ();
+      m_beaconController->SetAttribute ("WakeRange", DoubleValue (m_wakeRange));
+      m_beaconController->AddAps (m_apWifiDevices);
+      m_beaconController->AddStations (m_mobileWifiDevices);
+      m_beaconController->Start ();
+    }
+
+  RecordTime ("wifi", start);
+}
+
+void
+SectorTopologyHelper::InstallFastWifi (uint32_t initialAp)
+{
+  NS_LOG_INFO ("------Creating abstract wireless cards------");
+  Ptr<FastWifiChannel> channel = CreateObject<FastWifiChannel> ();
+  FastWifiHelper fastWifi;
+
+  // Every AP serves its own SSID, so the helper is configured per AP
+  m_apWifiDevices = NetDeviceContainer ();
+  fastWifi.SetDeviceAttribute ("AccessPoint", BooleanValue (true));
+  for (uint32_t i = 0; i < m_apNodes.GetN (); i++)
+    {
+      fastWifi.SetDeviceAttribute ("Ssid", SsidValue (m_ssids[i]));
+      m_apWifiDevices.Add (fastWifi.Install (channel, m_apNodes.Get (i)));
+    }
+
+  fastWifi.SetDeviceAttribute ("AccessPoint", BooleanValue (false));
+  fastWifi.SetDeviceAttribute ("Ssid", SsidValue (m_ssids[initialAp]));
+  m_mobileWifiDevices = fastWifi.Install (channel, m_mobileNodes);
+
+  m_apChannelNumbers.clear ();
+}
+
+Ptr<PropagationLossModel>
+SectorTopologyHelper::CreateLossModel (Ptr<PropagationLossModel> share) const
+{
+  Ptr<PropagationLossModel> loss = CreateObject<ThreeLogDistancePropagationLossModel> ();
+  if (m_cachedLoss)
+    {
+      Ptr<CachedPropagationLossModel> cached = CreateObject<CachedPropagationLossModel> ();
+      Ptr<CachedPropagationLossModel> other = DynamicCast<CachedPropagationLossModel> (share);
+      if (other != 0)
+        cached->ShareCache (other);
+      else
+        cached->SetModel (loss);
+      loss = cached;
+    }
+  if (m_fastFading)
+    {
+      loss->SetNext (CreateObject<FastNakagamiPropagationLossModel> ());
+    }
+  else
+    {
+      loss->SetNext (CreateObject<NakagamiPropagationLossModel> ());
+    }
+  return loss;
+}
+
+Ptr<YansWifiChannel>
+SectorTopologyHelper::CreateYansChannel (Ptr<PropagationLossModel> loss) const
+{
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationLossModel (loss);
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  return channel;
+}
+
+double
+SectorTopologyHelper::GetMaxRange () const
+{
+  if (m_maxRange > 0)
+    return m_maxRange;
+
+  // Strongest likely reception: highest TX power and both antenna gains,
+  // plus a fading margin Nakagami fading rarely exceeds
+  Ptr<YansWifiPhy> probe = CreateObject<YansWifiPhy> ();
+  double txPower = std::max (TX_POWER_START, TX_POWER_END) + probe->GetTxGain ()
+    + probe->GetRxGain () + RANGE_FADING_MARGIN;
+
+  // Weaker frames can neither be received nor make the medium busy, they
+  // only add to the interference of stronger ones
+  double sensitivity = std::min (probe->GetEdThreshold (), probe->GetCcaMode1Threshold ());
+
+  return RangeWifiChannel::FindMaxRange (CreateObject<ThreeLogDistancePropagationLossModel> (),
+                                         txPower, sensitivity);
+}
+
+void
+SectorTopologyHelper::Associate (Ptr<NetDevice> device, const std::string &ssid) const
+{
+  Ptr<FastWifiNetDevice> fast = DynamicCast<FastWifiNetDevice> (device);
+  if (fast != 0)
+    {
+      fast->SetSsid (Ssid (ssid));
+      return;
+    }
+
+  DynamicCast<WifiNetDevice> (device)->GetMac ()->SetSsid (Ssid (ssid));
+  SwitchChannel (device, ssid);
+}
+
+void
+SectorTopologyHelper::SwitchChannel (Ptr<NetDevice> device, const std::string &ssid) const
+{
+  std::map<std::string, uint16_t>::const_iterator i = m_apChannelNumbers.find (ssid);
+  if (i == m_apChannelNumbers.end ())
+    return;
+
+  // A channel switch costs the PHY its switching delay, so only retune when
+  // the new AP really is on another channel
+  Ptr<YansWifiPhy> phy = GetYansPhy (device);
+  if (phy->GetChannelNumber () != i->second)
+    {
+      NS_LOG_INFO ("Switching node " << device->GetNode ()->GetId () << " to channel " << i->second);
+      phy->SetChannelNumber (i->second);
+    }
+}
+
+uint32_t
+SectorTopologyHelper::GetChannelGroup (uint32_t sector) const
+{
+  if (m_channelPlan == SECTOR_CHANNELS)
+    return sector;
+
+  if (m_sectorPositions.size () < 2)
+    return 0;
+
+  const Vector &origin = m_sectorPositions[0];
+  double r = m_sectorRadius;
+
+  // Axial coordinates on the lattice: rows are 3r apart and every row is
+  // shifted by sqrt(3)*r, columns are 2*sqrt(3)*r apart
+  double dx = m_sectorPositions[sector].x - origin.x;
+  double dy = m_sectorPositions[sector].y - origin.y;
+  int row = (int) std::floor (dy / (3 * r) + 0.5);
+  int col = (int) std::floor ((dx - row * std::sqrt (3.) * r) / (2 * std::sqrt (3.) * r) + 0.5);
+
+  // Standard colourings of the hexagonal lattice in which no two adjacent
+  // cells share a colour
+  int colour;
+  switch (m_reuse)
+    {
+    case 3:
+      colour = col - row;
+      break;
+    case 4:
+      colour = col + 2 * row;
+      break;
+    default:
+      colour = col + 3 * row;
+      break;
+    }
+
+  int k = m_reuse;
+  return ((colour % k) + k) % k;
+}
+
+uint16_t
+SectorTopologyHelper::GetChannelNumber (uint32_t group) const
+{
+  if (m_channelPlan == REUSE_CHANNELS && m_reuse == 3)
+    return REUSE_3_CHANNELS[group];
+  if (m_channelPlan == REUSE_CHANNELS && m_reuse == 4)
+    return REUSE_4_CHANNELS[group];
+
+  // Virtual channels, see ChannelPlan
+  NS_ASSERT_MSG (group < std::numeric_limits<uint16_t>::max (), "Too many channel groups");
+  return group + 1;
+}
+
+void
+SectorTopologyHelper::InstallNdn (const ndn::StackHelper &routers, const ndn::StackHelper &users)
+{
+  double start = WallClock ();
+
+  NS_LOG_INFO ("------Installing NDN stack on routers------");
+  routers.Install (GetRouterNodes ());
+
+  NS_LOG_INFO ("------Installing NDN stack on mobile terminals and servers------");
+  users.Install (GetUserNodes ());
+
+  RecordTime ("ndn", start);
+}
+
+void
+SectorTopologyHelper::RecordTime (const std::string &phase, double start)
+{
+  m_times.push_back (std::make_pair (phase, WallClock () - start));
+}
+
+void
+SectorTopologyHelper::PrintTimes (std::ostream &os) const
+{
+  for (std::vector<std::pair<std::string, double> >::const_iterator i = m_times.begin ();
+       i != m_times.end (); i++)
+    {
+      os << std::setw (8) << i->first << " " << std::fixed << std::setprecision (3)
+         << i->second << " s" << std::endl;
+    }
+  os << std::setw (8) << "total" << " " << std::fixed << std::setprecision (3)
+     << GetTotalTime () << " s" << std::endl;
+}
+
+double
+SectorTopologyHelper::GetPhaseTime (const std::string &phase) const
+{
+  double total = 0;
+  for (std::vector<std::pair<std::string, double> >::const_iterator i = m_times.begin ();
+       i != m_times.end (); i++)
+    {
+      if (i->first == phase)
+        total += i->second;
+    }
+  return total;
+}
+
+double
+SectorTopologyHelper::GetTotalTime () const
+{
+  double total = 0;
+  for (std::vector<std::pair<std::string, double> >::const_iterator i = m_times.begin ();
+       i != m_times.end (); i++)
+    {
+      total += i->second;
+    }
+  return total;
+}
+
+uint32_t
+SectorTopologyHelper::GetNSectors () const
+{
+  return m_sectors;
+}
+
+uint32_t
+SectorTopologyHelper::GetNAps () const
+{
+  return m_apNodes.GetN ();
+}
+
+NodeContainer
+SectorTopologyHelper::GetMobileTerminals () const
+{
+  return m_mobileNodes;
+}
+
+NodeContainer
+SectorTopologyHelper::GetCentralNodes () const
+{
+  return m_centralNodes;
+}
+
+NodeContainer
+SectorTopologyHelper::GetApNodes () const
+{
+  return m_apNodes;
+}
+
+NodeContainer
+SectorTopologyHelper::GetSectorAps (uint32_t sector) const
+{
+  NodeContainer aps;
+  for (uint32_t j = sector * m_apsPerSector; j < (sector + 1) * m_apsPerSector; j++)
+    {
+      aps.Add (m_apNodes.Get (j));
+    }
+  return aps;
+}
+
+NodeContainer
+SectorTopologyHelper::GetFirstLevelNodes () const
+{
+  return m_firstLevelNodes;
+}
+
+NodeContainer
+SectorTopologyHelper::GetServerNodes () const
+{
+  return m_serverNodes;
+}
+
+NodeContainer
+SectorTopologyHelper::GetRouterNodes () const
+{
+  return NodeContainer (m_centralNodes, m_apNodes, m_firstLevelNodes);
+}
+
+NodeContainer
+SectorTopologyHelper::GetUserNodes () const
+{
+  return NodeContainer (m_mobileNodes, m_serverNodes);
+}
+
+NetDeviceContainer
+SectorTopologyHelper::GetApWifiDevices () const
+{
+  return m_apWifiDevices;
+}
+
+NetDeviceContainer
+SectorTopologyHelper::GetMobileWifiDevices () const
+{
+  return m_mobileWifiDevices;
+}
+
+const std::vector<Ssid> &
+SectorTopologyHelper::GetSsids () const
+{
+  return m_ssids;
+}
+
+Ptr<DormantBeaconController>
+SectorTopologyHelper::GetBeaconController () const
+{
+  return m_beaconController;
+}
+
+const std::map<std::string, uint16_t> &
+SectorTopologyHelper::GetApChannelNumbers () const
+{
+  return m_apChannelNumbers;
+}
+
+const std::map<std::string, Ptr<MobilityModel> > &
+SectorTopologyHelper::GetApMobility () const
+{
+  return m_apMobility;
+}
+
+} // namespace ns3
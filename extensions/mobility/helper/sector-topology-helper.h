@@ -0,0 +1,487 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  sector-topology-helper.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  sector-topology-helper.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with sector-topology-helper.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SECTOR_TOPOLOGY_HELPER_H
+#define SECTOR_TOPOLOGY_HELPER_H
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ns3-dev/ns3/mobility-model.h>
+#include <ns3-dev/ns3/net-device-container.h>
+#include <ns3-dev/ns3/node-container.h>
+#include <ns3-dev/ns3/point-to-point-helper.h>
+#include <ns3-dev/ns3/propagation-loss-model.h>
+#include <ns3-dev/ns3/ssid.h>
+#include <ns3-dev/ns3/yans-wifi-channel.h>
+#include <ns3-dev/ns3/ndnSIM/helper/ndn-stack-helper.h>
+
+#include "sector-layout.h"
+#include "../../parallel/helper/partition-link-helper.h"
+#include "../../point-to-point/helper/ideal-link-helper.h"
+#include "../../wifi/model/dormant-beacon-controller.h"
+
+namespace ns3 {
+
+/**
+ * @brief Builds the sector hierarchy used by the mobility scenarios
+ *
+ * The hierarchy is made of one central node per sector, the wireless access
+ * points (APs) of each sector attached to their central node, a first level
+ * of core nodes connected as a full mesh, and the servers attached to the
+ * last first level node. Mobile terminals reach the APs over Wi-Fi.
+ *
+ * Nodes are created in the order the scenarios have always used (mobile
+ * terminals, central nodes, APs, first level nodes, servers), so node IDs
+ * and trace files are unchanged by using the helper.
+ *
+ * Typical use:
+ *
+ *   SectorTopologyHelper topology;
+ *   topology.SetMobileTerminals (mobile);
+ *   topology.Create (layout);
+ *   topology.ConnectWired ();
+ *   // install the mobile terminal mobility models here
+ *   topology.InstallWifi ();
+ *   topology.InstallNdn (ndnHelperRouters, ndnHelperUsers);
+ */
+class SectorTopologyHelper
+{
+public:
+  /**
+   * @brief How the Wi-Fi cards are spread over channels
+   *
+   * SINGLE_CHANNEL puts every card on one channel, as the scenarios always
+   * did. SECTOR_CHANNELS gives every sector its own channel, and
+   * REUSE_CHANNELS colours the hexagonal lattice with a reuse cluster so
+   * that neighbouring sectors never share a channel.
+   *
+   * Reuse clusters of 3 and 4 use the non-overlapping 802.11g channels 1,
+   * 6 and 11, and 1, 5, 9 and 13. Neither a cluster of 7 nor a channel
+   * per sector fits in the 2.4 GHz band, so they number their groups 1,
+   * 2, 3... These are virtual channels: the Wi-Fi channels only deliver
+   * between cards on the same number and model no adjacent channel
+   * interference, so the numbers only tell the groups apart, and may be
+   * past channel 13.
+   */
+  enum ChannelPlan
+  {
+    SINGLE_CHANNEL,
+    SECTOR_CHANNELS,
+    REUSE_CHANNELS
+  };
+
+  SectorTopologyHelper ();
+
+  /**
+   * @brief Number of mobile terminals to create (default 1)
+   */
+  void
+  SetMobileTerminals (uint32_t mobile);
+
+  /**
+   * @brief Number of servers to create (default 1)
+   */
+  void
+  SetServers (uint32_t servers);
+
+  /**
+   * @brief Data rate and delay of the AP to central node and server links
+   * (default 100Mbps, 5ms)
+   */
+  void
+  SetAccessLinkAttributes (const std::string &dataRate, const std::string &delay);
+
+  /**
+   * @brief Data rate and delay of the central to first level links and of
+   * the first level mesh (default 1Gbps, 2ms)
+   */
+  void
+  SetCoreLinkAttributes (const std::string &dataRate, const std::string &delay);
+
+  /**
+   * @brief Select the Wi-Fi channel plan (default SINGLE_CHANNEL)
+   *
+   * @param plan Channel plan
+   * @param reuse Reuse cluster size for REUSE_CHANNELS: 3, 4 or 7
+   */
+  void
+  SetChannelPlan (ChannelPlan plan, uint32_t reuse = 3);
+
+  /**
+   * @brief Use a RangeWifiChannel that skips far away cards
+   *
+   * @param enable Enable range culling
+   * @param maxRange Delivery range in metres. 0 derives it from the
+   * transmission power, the deterministic path loss, a 10 dB fading margin
+   * and the receive sensitivity of the cards (their CCA threshold, -99 dBm):
+   * about 1.8 km with the ThreeLogDistance defaults the channels use,
+   * whose exponent of 3.8 past 500 m keeps frames above the sensitivity
+   * that far. That is longer than the diagonal of the 1000 x 1000 m
+   * layouts, so there the derived range culls nothing: it only pays off
+   * on larger areas. A shorter explicit range culls more, but drops
+   * frames the cards would still have sensed
+   */
+  void
+  SetRangeCulling (bool enable, double maxRange = 0);
+
+  /**
+   * @brief Suspend the beacons of APs that no mobile terminal is near
+   *
+   * The scenarios steer terminals to their nearest AP, which is never
+   * further away than the sector radius, so far away APs beacon for nobody.
+   *
+   * @param enable Enable dormant APs
+   * @param wakeRange APs within this distance (meters) of a terminal beacon
+   */
+  void
+  SetDormantBeacons (bool enable, double wakeRange = 250);
+
+  /**
+   * @brief Cache the ThreeLogDistance path loss with a
+   * CachedPropagationLossModel. Nakagami fading is still drawn per frame
+   */
+  void
+  SetCachedLoss (bool enable);
+
+  /**
+   * @brief Draw the Nakagami fading with FastNakagamiPropagationLossModel
+   */
+  void
+  SetFastFading (bool enable);
+
+  /**
+   * @brief Build the wired hierarchy from IdealLinkNetDevice instead of
+   * PointToPointNetDevice
+   *
+   * Each frame then costs a single receive event per hop, with the same
+   * serialization and propagation delays but no queue: only use it when the
+   * wired links are not the bottleneck.
+   *
+   * @param enable Use ideal links for the links created from now on
+   * @param accounting Count the packets and bytes crossing the ideal links
+   */
+  void
+  SetIdealLinks (bool enable, bool accounting = false);
+
+  /**
+   * @brief Spread the nodes over partitions for PartitionSimulatorImpl or
+   * over MPI ranks for DistributedSimulatorImpl
+   *
+   * Wi-Fi frames travel in a fraction of a microsecond, which leaves no
+   * lookahead, so the mobile terminals and all the APs stay together in
+   * partition 0 and handoffs never cross partitions. The first level
+   * nodes are spread in balanced runs over the other partitions, each
+   * central node following the first level node it connects to. The node
+   * the servers hang from and the servers take the last partition. Links
+   * between partitions use PartitionRemoteChannel, or the MPI remote
+   * channel once MpiInterface is enabled, the 2 ms core links setting the
+   * lookahead.
+   *
+   * @param partitions Number of partitions, 1 for none
+   */
+  void
+  SetPartitions (uint32_t partitions);
+
+  /**
+   * @brief Replace the 802.11g cards with FastWifiNetDevice
+   *
+   * There are no beacons, probes, retries or PHY reception events: frames
+   * cost one event each, at a rate and loss set by distance, and handoffs
+   * are instantaneous. Channel plans, range culling, dormant beacons and the
+   * loss model options have no effect in this mode
+   */
+  void
+  SetFastWifi (bool enable);
+
+  /**
+   * @brief Parse "single", "sector" or "reuse" into a ChannelPlan
+   */
+  static ChannelPlan
+  ParseChannelPlan (const std::string &plan);
+
+  /**
+   * @brief Create all nodes and place the central nodes and APs
+   *
+   * @param layout Parsed position file
+   */
+  void
+  Create (const SectorLayout &layout);
+
+  /**
+   * @brief Connect APs to their central node, central nodes to the first
+   * level, the first level amongst itself and the servers to the last first
+   * level node
+   */
+  void
+  ConnectWired ();
+
+  /**
+   * @brief Connect two nodes with a core link, for scenarios that add
+   * their own links on top of the hierarchy
+   */
+  NetDeviceContainer
+  AddCoreLink (Ptr<Node> a, Ptr<Node> b);
+
+  /**
+   * @brief Install 802.11g cards on the APs and the mobile terminals
+   *
+   * Every AP gets SSID "ap-<index>". The mobile terminals start associated
+   * to the SSID of AP initialAp.
+   *
+   * With a channel plan other than SINGLE_CHANNEL, each sector (or reuse
+   * colour) gets its own YansWifiChannel and channel number. APs transmit on
+   * their sector channel, which also holds every mobile terminal. The mobile
+   * terminals transmit on a shared uplink channel holding every AP, and are
+   * tuned to the number of their AP. Downlink frames only go through the
+   * cards of their group's channel. Uplink frames go through every AP, and
+   * the ones tuned to another number are skipped with a comparison, before
+   * any propagation loss is computed or receive event scheduled. So the
+   * costs of both directions follow the cell (or cluster) population. A
+   * handoff only needs to retune the terminal with SwitchChannel.
+   *
+   * The uplink cannot be split per group like the downlink: a terminal
+   * would have to move to the uplink of its new group at each handoff, and
+   * YansWifiPhy::SetChannel adds the card to the channel again every time,
+   * with no way to remove it.
+   */
+  void
+  InstallWifi (uint32_t initialAp = 0);
+
+  /**
+   * @brief Hand a mobile terminal card over to the AP with the given SSID,
+   * retuning it with SwitchChannel when needed
+   */
+  void
+  Associate (Ptr<NetDevice> device, const std::string &ssid) const;
+
+  /**
+   * @brief Retune a mobile terminal card to the channel of the AP with the
+   * given SSID. Does nothing if it is already on that channel
+   */
+  void
+  SwitchChannel (Ptr<NetDevice> device, const std::string &ssid) const;
+
+  /**
+   * @brief Install the NDN stacks
+   *
+   * @param routers Stack for the central, AP and first level nodes
+   * @param users Stack for the mobile terminals and servers
+   */
+  void
+  InstallNdn (const ndn::StackHelper &routers, const ndn::StackHelper &users);
+
+  /**
+   * @brief Print the wall clock time spent in each construction phase
+   */
+  void
+  PrintTimes (std::ostream &os) const;
+
+  /**
+   * @brief Wall clock time spent in one phase ("create", "wired", "wifi" or
+   * "ndn"), in seconds. Zero if the phase was not run
+   */
+  double
+  GetPhaseTime (const std::string &phase) const;
+
+  /**
+   * @brief Total wall clock time spent building, in seconds
+   */
+  double
+  GetTotalTime () const;
+
+  uint32_t
+  GetNSectors () const;
+
+  uint32_t
+  GetNAps () const;
+
+  NodeContainer
+  GetMobileTerminals () const;
+
+  NodeContainer
+  GetCentralNodes () const;
+
+  NodeContainer
+  GetApNodes () const;
+
+  NodeContainer
+  GetSectorAps (uint32_t sector) const;
+
+  NodeContainer
+  GetFirstLevelNodes () const;
+
+  NodeContainer
+  GetServerNodes () const;
+
+  /**
+   * @brief Central, AP and first level nodes
+   */
+  NodeContainer
+  GetRouterNodes () const;
+
+  /**
+   * @brief Mobile terminals and servers
+   */
+  NodeContainer
+  GetUserNodes () const;
+
+  /**
+   * @brief Devices of all wired links, including the ones added with
+   * AddCoreLink
+   */
+  NetDeviceContainer
+  GetWiredDevices () const;
+
+  /**
+   * @brief Bytes sent over the ideal links, zero unless SetIdealLinks was
+   * enabled with accounting
+   */
+  uint64_t
+  GetWiredTxBytes () const;
+
+  NetDeviceContainer
+  GetApWifiDevices () const;
+
+  NetDeviceContainer
+  GetMobileWifiDevices () const;
+
+  const std::vector<Ssid> &
+  GetSsids () const;
+
+  /**
+   * @brief Controller of the AP beacons, null unless SetDormantBeacons was
+   * enabled before InstallWifi
+   */
+  Ptr<DormantBeaconController>
+  GetBeaconController () const;
+
+  /**
+   * @brief Channel number of every AP, ordered by SSID string
+   */
+  const std::map<std::string, uint16_t> &
+  GetApChannelNumbers () const;
+
+  /**
+   * @brief AP mobility models ordered by SSID string
+   */
+  const std::map<std::string, Ptr<MobilityModel> > &
+  GetApMobility () const;
+
+private:
+  /**
+   * @brief Partition of the i-th of n wired nodes of a level
+   */
+  uint32_t
+  GetWiredPartition (uint32_t i, uint32_t n) const;
+
+  uint32_t
+  GetServerPartition () const;
+
+  NetDeviceContainer
+  InstallLink (bool core, Ptr<Node> a, Ptr<Node> b);
+
+  void
+  InstallFastWifi (uint32_t initialAp);
+
+  /**
+   * @param share Loss model of another channel, whose cached losses the
+   * new model uses
+   */
+  Ptr<PropagationLossModel>
+  CreateLossModel (Ptr<PropagationLossModel> share = 0) const;
+
+  Ptr<YansWifiChannel>
+  CreateYansChannel (Ptr<PropagationLossModel> loss) const;
+
+  /**
+   * @brief Delivery range of the range culled channel
+   */
+  double
+  GetMaxRange () const;
+
+  /**
+   * @brief Channel group (sector or reuse colour) a sector belongs to
+   */
+  uint32_t
+  GetChannelGroup (uint32_t sector) const;
+
+  /**
+   * @brief Channel number of a channel group
+   */
+  uint16_t
+  GetChannelNumber (uint32_t group) const;
+
+  void
+  RecordTime (const std::string &phase, double start);
+
+private:
+  uint32_t m_mobile;
+  uint32_t m_servers;
+  uint32_t m_sectors;
+  uint32_t m_apsPerSector;
+  std::vector<Vector> m_sectorPositions;
+  double m_sectorRadius;
+
+  ChannelPlan m_channelPlan;
+  uint32_t m_reuse;
+
+  bool m_rangeCulling;
+  double m_maxRange;
+
+  bool m_dormantBeacons;
+  double m_wakeRange;
+  Ptr<DormantBeaconController> m_beaconController;
+
+  bool m_cachedLoss;
+  bool m_fastFading;
+  bool m_fastWifi;
+  bool m_idealLinks;
+  uint32_t m_partitions;
+
+  PointToPointHelper m_accessLink;
+  PointToPointHelper m_coreLink;
+  IdealLinkHelper m_idealAccessLink;
+  IdealLinkHelper m_idealCoreLink;
+  PartitionLinkHelper m_partitionAccessLink;
+  PartitionLinkHelper m_partitionCoreLink;
+
+  NodeContainer m_mobileNodes;
+  NodeContainer m_centralNodes;
+  NodeContainer m_apNodes;
+  NodeContainer m_firstLevelNodes;
+  NodeContainer m_serverNodes;
+
+  NetDeviceContainer m_wiredDevices;
+  NetDeviceContainer m_apWifiDevices;
+  NetDeviceContainer m_mobileWifiDevices;
+
+  std::vector<Ssid> m_ssids;
+  std::map<std::string, Ptr<MobilityModel> > m_apMobility;
+  std::map<std::string, uint16_t> m_apChannelNumbers;
+
+  std::vector<std::pair<std::string, double> > m_times;
+};
+
+} // namespace ns3
+
+#endif // SECTOR_TOPOLOGY_HELPER_H
@@ -0,0 +1,71 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  partition-link-helper.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  partition-link-helper.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with partition-link-helper.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "partition-link-helper.h"
+#include "../model/partition-remote-channel.h"
+
+#include <ns3-dev/ns3/mac48-address.h>
+#include <ns3-dev/ns3/point-to-point-net-device.h>
+#include <ns3-dev/ns3/queue.h>
+
+namespace ns3 {
+
+PartitionLinkHelper::PartitionLinkHelper ()
+{
+  m_queue.SetTypeId ("ns3::DropTailQueue");
+  m_device.SetTypeId ("ns3::PointToPointNetDevice");
+  m_channel.SetTypeId ("ns3::PointToPointChannel");
+  m_remoteChannel.SetTypeId ("ns3::PartitionRemoteChannel");
+}
+
+void
+PartitionLinkHelper::SetDeviceAttribute (std::string name, const AttributeValue &v)
+{
+  m_device.Set (name, v);
+}
+
+void
+PartitionLinkHelper::SetChannelAttribute (std::string name, const AttributeValue &v)
+{
+  m_channel.Set (name, v);
+  m_remoteChannel.Set (name, v);
+}
+
+NetDeviceContainer
+PartitionLinkHelper::Install (Ptr<Node> a, Ptr<Node> b) const
+{
+  NetDeviceContainer devices;
+  Ptr<PointToPointChannel> channel = (a->GetSystemId () != b->GetSystemId ())
+    ? m_remoteChannel.Create<PointToPointChannel> ()
+    : m_channel.Create<PointToPointChannel> ();
+
+  Ptr<Node> nodes[2] = { a, b };
+  for (int i = 0; i < 2; i++)
+    {
+      Ptr<PointToPointNetDevice> device = m_device.Create<PointToPointNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      nodes[i]->AddDevice (device);
+      device->SetQueue (m_queue.Create<Queue> ());
+      device->Attach (channel);
+      devices.Add (device);
+    }
+  return devices;
+}
+
+} // namespace ns3
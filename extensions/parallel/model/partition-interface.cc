@@ -0,0 +1,579 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  partition-interface.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  partition-interface.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with partition-interface.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "partition-interface.h"
+#include "partition-simulator-impl.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/make-event.h>
+#include <ns3-dev/ns3/node-list.h>
+#include <ns3-dev/ns3/point-to-point-net-device.h>
+#include <ns3-dev/ns3/simulator.h>
+#include <ns3-dev/ns3/tag.h>
+#include <ns3-dev/ns3/tag-buffer.h>
+
+NS_LOG_COMPONENT_DEFINE ("PartitionInterface");
+
+namespace ns3 {
+
+namespace {
+
+// Shared memory layout: the barrier, two generations of window slots, the
+// partition results and the mailboxes, each block cache line aligned
+struct Header
+{
+  volatile uint32_t count;
+  volatile uint32_t sense;
+  volatile uint32_t failed;
+};
+
+struct Slot
+{
+  volatile int64_t next;
+  volatile int64_t nextGlobal;
+  volatile uint32_t stop;
+};
+
+struct Result
+{
+  volatile uint64_t events;
+  volatile uint64_t digest;
+  volatile uint64_t sum;
+};
+
+// Packet tag following a message, before its serialized bytes
+struct TagRecord
+{
+  uint32_t uid;
+  uint32_t size;
+};
+
+const size_t LINE = 64;
+
+size_t
+RoundUp (size_t size)
+{
+  return (size + LINE - 1) / LINE * LINE;
+}
+
+size_t
+SlotsOffset ()
+{
+  return RoundUp (sizeof (Header));
+}
+
+size_t
+ResultsOffset (uint32_t workers)
+{
+  return SlotsOffset () + RoundUp (2 * workers * sizeof (Slot));
+}
+
+size_t
+MailboxesOffset (uint32_t workers, uint32_t partitions)
+{
+  return ResultsOffset (workers) + RoundUp (partitions * sizeof (Result));
+}
+
+size_t
+MailboxStride (uint32_t mailboxSize)
+{
+  return LINE + RoundUp (mailboxSize);
+}
+
+uint32_t
+Pad (uint32_t size)
+{
+  return (size + 7) / 8 * 8;
+}
+
+// Copies of the packet tags of a packet, returning the bytes they take
+uint32_t
+GetTags (Ptr<const Packet> packet, std::vector<Tag *> &tags)
+{
+  uint32_t size = 0;
+  PacketTagIterator i = packet->GetPacketTagIterator ();
+  while (i.HasNext ())
+    {
+      PacketTagIterator::Item item = i.Next ();
+      TypeId tid = item.GetTypeId ();
+      if (!tid.HasConstructor ())
+        {
+          NS_FATAL_ERROR ("Packet tag " << tid.GetName () << " has no constructor and cannot cross partitions");
+        }
+      Tag *tag = dynamic_cast<Tag *> (tid.GetConstructor () ());
+      item.GetTag (*tag);
+      tags.push_back (tag);
+      size += sizeof (TagRecord) + tag->GetSerializedSize ();
+    }
+  return size;
+}
+
+pid_t g_parent = 0;
+
+} // anonymous namespace
+
+bool PartitionInterface::s_enabled = false;
+uint32_t PartitionInterface::s_worker = 0;
+uint32_t PartitionInterface::s_workers = 1;
+uint32_t PartitionInterface::s_partitions = 0;
+uint32_t PartitionInterface::s_mailboxSize = 0;
+uint8_t *PartitionInterface::s_shared = 0;
+size_t PartitionInterface::s_sharedSize = 0;
+uint32_t PartitionInterface::s_sense = 0;
+uint32_t PartitionInterface::s_parity = 0;
+std::vector<pid_t> PartitionInterface::s_children;
+std::vector<uint64_t> PartitionInterface::s_sequence;
+std::vector<uint8_t> PartitionInterface::s_localMailbox;
+std::vector<uint64_t> PartitionInterface::s_events;
+std::vector<uint64_t> PartitionInterface::s_digests;
+std::vector<uint64_t> PartitionInterface::s_sums;
+
+bool
+PartitionInterface::MessageOrder::operator () (const Message *a, const Message *b) const
+{
+  if (a->sent != b->sent)
+    return a->sent < b->sent;
+  return (a->src < b->src) || (a->src == b->src && a->seq < b->seq);
+}
+
+void
+PartitionInterface::Enable (uint32_t workers, uint32_t mailboxSize)
+{
+  NS_ASSERT_MSG (!s_enabled, "PartitionInterface already enabled");
+  NS_ASSERT (workers > 0);
+
+  s_partitions = GetNPartitions ();
+  s_workers = workers;
+  s_mailboxSize = mailboxSize;
+  if (s_workers > s_partitions)
+    {
+      NS_LOG_WARN (s_workers << " workers for " << s_partitions << " partitions, some will be idle");
+    }
+
+  // The mailboxes are only backed by memory as far as they are written
+  s_sharedSize = MailboxesOffset (s_workers, s_partitions)
+    + (size_t) s_workers * s_workers * MailboxStride (s_mailboxSize);
+  void *shared = mmap (0, s_sharedSize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (shared == MAP_FAILED)
+    {
+      NS_FATAL_ERROR ("Could not map " << s_sharedSize << " bytes of shared memory");
+    }
+
+  s_shared = (uint8_t *) shared;
+  s_enabled = true;
+  s_worker = 0;
+  s_sense = 0;
+  s_parity = 0;
+  s_children.clear ();
+  s_localMailbox.clear ();
+  g_parent = getpid ();
+
+  // Buffered output would otherwise be written once per worker
+  std::cout.flush ();
+  std::cerr.flush ();
+  fflush (0);
+
+  for (uint32_t w = 1; w < s_workers; w++)
+    {
+      pid_t pid = fork ();
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("Could not fork worker " << w);
+        }
+      if (pid == 0)
+        {
+          s_worker = w;
+          s_children.clear ();
+          break;
+        }
+      s_children.push_back (pid);
+    }
+
+  NS_LOG_INFO ("Worker " << s_worker << " of " << s_workers << " running "
+                         << s_partitions << " partitions");
+}
+
+void
+PartitionInterface::Disable ()
+{
+  if (!s_enabled)
+    return;
+
+  if (s_worker != 0)
+    {
+      // Static destructors flush this worker's trace files
+      exit (0);
+    }
+
+  for (std::vector<pid_t>::const_iterator i = s_children.begin (); i != s_children.end (); i++)
+    {
+      int status;
+      if (waitpid (*i, &status, 0) != *i || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          NS_FATAL_ERROR ("Worker process " << *i << " failed");
+        }
+    }
+
+  Result *results = (Result *) (s_shared + ResultsOffset (s_workers));
+  s_events.resize (s_partitions);
+  s_digests.resize (s_partitions);
+  s_sums.resize (s_partitions);
+  for (uint32_t p = 0; p < s_partitions; p++)
+    {
+      s_events[p] = results[p].events;
+      s_digests[p] = results[p].digest;
+      s_sums[p] = results[p].sum;
+    }
+
+  munmap (s_shared, s_sharedSize);
+  s_shared = 0;
+  s_enabled = false;
+  s_workers = 1;
+  s_children.clear ();
+}
+
+bool
+PartitionInterface::IsEnabled ()
+{
+  return s_enabled;
+}
+
+uint32_t
+PartitionInterface::GetWorker ()
+{
+  return s_worker;
+}
+
+uint32_t
+PartitionInterface::GetNWorkers ()
+{
+  return s_enabled ? s_workers : 1;
+}
+
+uint32_t
+PartitionInterface::GetNPartitions ()
+{
+  if (s_enabled)
+    return s_partitions;
+
+  uint32_t partitions = 1;
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); i++)
+    {
+      partitions = std::max (partitions, (*i)->GetSystemId () + 1);
+    }
+  return partitions;
+}
+
+bool
+PartitionInterface::IsLocal (uint32_t partition)
+{
+  return !s_enabled || partition % s_workers == s_worker;
+}
+
+NodeContainer
+PartitionInterface::GetLocalNodes ()
+{
+  NodeContainer nodes;
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); i++)
+    {
+      if (IsLocal ((*i)->GetSystemId ()))
+        nodes.Add (*i);
+    }
+  return nodes;
+}
+
+uint8_t *
+PartitionInterface::GetMailbox (uint32_t from, uint32_t to)
+{
+  return s_shared + MailboxesOffset (s_workers, s_partitions)
+    + (from * s_workers + to) * MailboxStride (s_mailboxSize) + LINE;
+}
+
+uint64_t *
+PartitionInterface::GetMailboxUsed (uint32_t from, uint32_t to)
+{
+  return (uint64_t *) (GetMailbox (from, to) - LINE);
+}
+
+void
+PartitionInterface::SendPacket (Ptr<Packet> packet, Time rxTime, uint32_t srcPartition, uint32_t node, uint32_t ifIndex)
+{
+  uint32_t dst = NodeList::GetNode (node)->GetSystemId ();
+  uint32_t size = packet->GetSerializedSize ();
+  std::vector<Tag *> tags;
+  uint32_t tagsSize = GetTags (packet, tags);
+  uint32_t record = sizeof (Message) + Pad (size) + Pad (tagsSize);
+
+  if (srcPartition >= s_sequence.size ())
+    {
+      s_sequence.resize (srcPartition + 1, 0);
+    }
+
+  uint8_t *buffer;
+  if (IsLocal (dst))
+    {
+      size_t used = s_localMailbox.size ();
+      s_localMailbox.resize (used + record);
+      buffer = &s_localMailbox[used];
+    }
+  else
+    {
+      uint64_t *used = GetMailboxUsed (s_worker, dst % s_workers);
+      if (*used + record > s_mailboxSize)
+        {
+          NS_FATAL_ERROR ("Mailbox to worker " << dst % s_workers << " full, raise its size above "
+                          << s_mailboxSize << " bytes");
+        }
+      buffer = GetMailbox (s_worker, dst % s_workers) + *used;
+      *used += record;
+    }
+
+  Message *message = (Message *) buffer;
+  message->ts = rxTime.GetTimeStep ();
+  message->sent = Simulator::Now ().GetTimeStep ();
+  message->src = srcPartition;
+  message->node = node;
+  message->seq = s_sequence[srcPartition]++;
+  message->ifIndex = ifIndex;
+  message->size = size;
+  message->tagsSize = tagsSize;
+  packet->Serialize (buffer + sizeof (Message), size);
+
+  uint8_t *tagData = buffer + sizeof (Message) + Pad (size);
+  for (std::vector<Tag *>::const_iterator i = tags.begin (); i != tags.end (); i++)
+    {
+      TagRecord header;
+      header.uid = (*i)->GetInstanceTypeId ().GetUid ();
+      header.size = (*i)->GetSerializedSize ();
+      memcpy (tagData, &header, sizeof (header));
+      tagData += sizeof (header);
+      (*i)->Serialize (TagBuffer (tagData, tagData + header.size));
+      tagData += header.size;
+      delete *i;
+    }
+}
+
+void
+PartitionInterface::ReceiveMessages (PartitionSimulatorImpl *simulator)
+{
+  Barrier ();
+
+  std::vector<const Message *> messages;
+  for (size_t offset = 0; offset < s_localMailbox.size (); )
+    {
+      const Message *message = (const Message *) &s_localMailbox[offset];
+      messages.push_back (message);
+      offset += sizeof (Message) + Pad (message->size) + Pad (message->tagsSize);
+    }
+
+  for (uint32_t w = 0; s_enabled && w < s_workers; w++)
+    {
+      const uint8_t *mailbox = GetMailbox (w, s_worker);
+      uint64_t used = *GetMailboxUsed (w, s_worker);
+      for (uint64_t offset = 0; offset < used; )
+        {
+          const Message *message = (const Message *) (mailbox + offset);
+          messages.push_back (message);
+          offset += sizeof (Message) + Pad (message->size) + Pad (message->tagsSize);
+        }
+    }
+
+  // The order packets are scheduled in must not depend on which worker
+  // ran the sender. Sorting by send time first gives the order the
+  // default simulator schedules them in
+  std::sort (messages.begin (), messages.end (), MessageOrder ());
+
+  for (std::vector<const Message *>::const_iterator i = messages.begin (); i != messages.end (); i++)
+    {
+      const Message *message = *i;
+      Ptr<Packet> packet = Create<Packet> ((const uint8_t *) message + sizeof (Message), message->size, true);
+
+      uint8_t *tagData = (uint8_t *) message + sizeof (Message) + Pad (message->size);
+      uint8_t *tagsEnd = tagData + message->tagsSize;
+      while (tagData < tagsEnd)
+        {
+          TagRecord header;
+          memcpy (&header, tagData, sizeof (header));
+          tagData += sizeof (header);
+
+          // Workers are forked after every type is registered, so they
+          // agree on the type uids
+          TypeId tid = TypeId::GetRegistered (header.uid - 1);
+          Tag *tag = dynamic_cast<Tag *> (tid.GetConstructor () ());
+          tag->Deserialize (TagBuffer (tagData, tagData + header.size));
+          packet->AddPacketTag (*tag);
+          delete tag;
+          tagData += header.size;
+        }
+
+      Ptr<PointToPointNetDevice> device =
+        DynamicCast<PointToPointNetDevice> (NodeList::GetNode (message->node)->GetDevice (message->ifIndex));
+      NS_ASSERT (device != 0);
+
+      simulator->InsertRemote (message->ts, message->node,
+                               MakeEvent (&PointToPointNetDevice::Receive, device, packet));
+    }
+
+  // The senders only write again after the next barrier
+  s_localMailbox.clear ();
+  for (uint32_t w = 0; s_enabled && w < s_workers; w++)
+    {
+      *GetMailboxUsed (w, s_worker) = 0;
+    }
+}
+
+void
+PartitionInterface::Reduce (int64_t &next, int64_t &nextGlobal, bool &stop)
+{
+  if (!s_enabled)
+    return;
+
+  // Slots alternate between two generations, so that a fast worker writing
+  // the next window never overwrites a slot still being read
+  Slot *slots = (Slot *) (s_shared + SlotsOffset ()) + s_parity * s_workers;
+  slots[s_worker].next = next;
+  slots[s_worker].nextGlobal = nextGlobal;
+  slots[s_worker].stop = stop;
+  Barrier ();
+
+  for (uint32_t w = 0; w < s_workers; w++)
+    {
+      next = std::min (next, (int64_t) slots[w].next);
+      nextGlobal = std::min (nextGlobal, (int64_t) slots[w].nextGlobal);
+      stop = stop || slots[w].stop;
+    }
+  s_parity ^= 1;
+}
+
+void
+PartitionInterface::Barrier ()
+{
+  if (!s_enabled || s_workers == 1)
+    return;
+
+  // Sense reversing barrier, spinning as windows are short
+  Header *header = (Header *) s_shared;
+  s_sense ^= 1;
+  __sync_synchronize ();
+  if (__sync_add_and_fetch (&header->count, 1) == s_workers)
+    {
+      header->count = 0;
+      __sync_synchronize ();
+      header->sense = s_sense;
+    }
+  else
+    {
+      for (uint64_t spins = 1; header->sense != s_sense; spins++)
+        {
+          if (spins % 1024 == 0)
+            sched_yield ();
+          if (spins % (1 << 20) == 0)
+            CheckWorkers ();
+        }
+    }
+  __sync_synchronize ();
+}
+
+void
+PartitionInterface::CheckWorkers ()
+{
+  // A worker that died leaves the others waiting at the barrier forever
+  Header *header = (Header *) s_shared;
+  if (s_worker != 0)
+    {
+      if (header->failed || getppid () != g_parent)
+        _exit (1);
+      return;
+    }
+
+  for (std::vector<pid_t>::const_iterator i = s_children.begin (); i != s_children.end (); i++)
+    {
+      int status;
+      if (waitpid (*i, &status, WNOHANG) == *i)
+        {
+          header->failed = 1;
+          NS_FATAL_ERROR ("Worker process " << *i << " ended during the run");
+        }
+    }
+}
+
+void
+PartitionInterface::Report (uint32_t partition, uint64_t events, uint64_t digest)
+{
+  if (partition >= s_events.size ())
+    {
+      s_events.resize (partition + 1, 0);
+      s_digests.resize (partition + 1, 0);
+    }
+  s_events[partition] = events;
+  s_digests[partition] = digest;
+  if (partition >= s_sums.size ())
+    {
+      s_sums.resize (partition + 1, 0);
+    }
+
+  if (s_enabled)
+    {
+      Result *results = (Result *) (s_shared + ResultsOffset (s_workers));
+      results[partition].events = events;
+      results[partition].digest = digest;
+      results[partition].sum = s_sums[partition];
+    }
+}
+
+void
+PartitionInterface::Accumulate (uint32_t partition, uint64_t value)
+{
+  if (partition >= s_sums.size ())
+    {
+      s_sums.resize (partition + 1, 0);
+    }
+  s_sums[partition] += value;
+}
+
+uint64_t
+PartitionInterface::GetAccumulated (uint32_t partition)
+{
+  return (partition < s_sums.size ()) ? s_sums[partition] : 0;
+}
+
+uint64_t
+PartitionInterface::GetEvents (uint32_t partition)
+{
+  return (partition < s_events.size ()) ? s_events[partition] : 0;
+}
+
+uint64_t
+PartitionInterface::GetDigest (uint32_t partition)
+{
+  return (partition < s_digests.size ()) ? s_digests[partition] : 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  partition-interface.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  partition-interface.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with partition-interface.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PARTITION_INTERFACE_H
+#define PARTITION_INTERFACE_H
+
+#include <sys/types.h>
+#include <vector>
+
+#include <ns3-dev/ns3/node-container.h>
+#include <ns3-dev/ns3/nstime.h>
+#include <ns3-dev/ns3/packet.h>
+
+namespace ns3 {
+
+class PartitionSimulatorImpl;
+
+/**
+ * @brief Worker processes and shared memory mailboxes for
+ * PartitionSimulatorImpl
+ *
+ * Partitions are given by the system ID of the nodes. Enable forks the
+ * process into workers once the topology is built, worker w running the
+ * partitions p with p % workers == w. Forking copies the whole simulation
+ * state, which ns-3 cannot share between threads (reference counts, packet
+ * buffer free lists and the packet UID counter are not thread safe).
+ *
+ * Packets crossing partitions are serialized into one mailbox per pair of
+ * workers, in a shared anonymous mapping, and read after the window
+ * barrier. Packet::Serialize leaves the packet tags out, so they travel
+ * next to the packet: ndnSIM keeps the hop count in one. Byte tags are
+ * not carried. Without Enable the simulator runs every partition in the
+ * calling process, through the same mailboxes and windows, which a
+ * parallel run reproduces exactly.
+ *
+ * Packets arriving at the same time are scheduled in the order they were
+ * sent, as the default simulator would. The one order the default
+ * simulator may differ in is between such a packet and an event of the
+ * receiving partition at the very same time step, scheduled in the
+ * previous window after the packet was sent: ndn-mobility-bench checks
+ * the traces against a DefaultSimulatorImpl run.
+ *
+ * Typical use:
+ *
+ *   GlobalValue::Bind ("SimulatorImplementationType",
+ *                      StringValue ("ns3::PartitionSimulatorImpl"));
+ *   // build the topology with nodes created on their partition
+ *   PartitionInterface::Enable (workers);
+ *   // install per worker traces
+ *   Simulator::Run ();
+ *   Simulator::Destroy ();
+ *   PartitionInterface::Disable ();
+ */
+class PartitionInterface
+{
+public:
+  /**
+   * @brief Fork into workers. Returns in every worker
+   *
+   * @param workers Number of worker processes, including the caller
+   * @param mailboxSize Bytes a worker can send another in one window
+   */
+  static void
+  Enable (uint32_t workers, uint32_t mailboxSize = 16 << 20);
+
+  /**
+   * @brief End the parallel run: workers other than the first exit, the
+   * first waits for them and collects their partition results
+   */
+  static void
+  Disable ();
+
+  static bool
+  IsEnabled ();
+
+  /**
+   * @brief Index of this worker, 0 in the process that called Enable
+   */
+  static uint32_t
+  GetWorker ();
+
+  static uint32_t
+  GetNWorkers ();
+
+  /**
+   * @brief Number of partitions, one more than the highest node system ID
+   */
+  static uint32_t
+  GetNPartitions ();
+
+  /**
+   * @brief Whether this worker runs the partition
+   */
+  static bool
+  IsLocal (uint32_t partition);
+
+  /**
+   * @brief Nodes of the partitions this worker runs
+   */
+  static NodeContainer
+  GetLocalNodes ();
+
+  /**
+   * @brief Hand a packet to the receiving device on another partition
+   *
+   * @param rxTime Time the packet arrives, at least one lookahead ahead
+   * @param srcPartition Partition of the sending node
+   * @param node Receiving node
+   * @param ifIndex Receiving PointToPointNetDevice
+   */
+  static void
+  SendPacket (Ptr<Packet> packet, Time rxTime, uint32_t srcPartition, uint32_t node, uint32_t ifIndex);
+
+  /**
+   * @brief Wait for every worker to end its window, then schedule the
+   * packets sent to this worker, in (send time, source partition, send
+   * order) order
+   */
+  static void
+  ReceiveMessages (PartitionSimulatorImpl *simulator);
+
+  /**
+   * @brief Agree on the next window with the other workers
+   *
+   * @param next Earliest partition event of this worker (time steps)
+   * @param nextGlobal Earliest global event of this worker (time steps)
+   * @param stop Whether this worker wants to stop
+   */
+  static void
+  Reduce (int64_t &next, int64_t &nextGlobal, bool &stop);
+
+  /**
+   * @brief Record the events a partition ran and their digest
+   */
+  static void
+  Report (uint32_t partition, uint64_t events, uint64_t digest);
+
+  /**
+   * @brief Add to a sum kept per partition and collected from the workers
+   * like the event counts, such as a digest of the traces summed over the
+   * rows, which does not depend on the order they are written in
+   */
+  static void
+  Accumulate (uint32_t partition, uint64_t value);
+
+  /**
+   * @brief Sum of the values accumulated for a partition. In the first
+   * worker, valid for every partition after Disable
+   */
+  static uint64_t
+  GetAccumulated (uint32_t partition);
+
+  /**
+   * @brief Events run by a partition in the last run. In the first worker,
+   * valid for every partition after Disable
+   */
+  static uint64_t
+  GetEvents (uint32_t partition);
+
+  /**
+   * @brief Digest of the time, context and order of the events a partition
+   * ran. Equal digests mean the partition ran the same events in the same
+   * order
+   */
+  static uint64_t
+  GetDigest (uint32_t partition);
+
+private:
+  struct Message
+  {
+    int64_t ts;
+    int64_t sent;
+    uint32_t src;
+    uint32_t node;
+    uint64_t seq;
+    uint32_t ifIndex;
+    uint32_t size;
+    uint32_t tagsSize;
+  };
+
+  struct MessageOrder
+  {
+    bool
+    operator () (const Message *a, const Message *b) const;
+  };
+
+  static uint8_t *
+  GetMailbox (uint32_t from, uint32_t to);
+
+  static uint64_t *
+  GetMailboxUsed (uint32_t from, uint32_t to);
+
+  static void
+  Barrier ();
+
+  static void
+  CheckWorkers ();
+
+  static bool s_enabled;
+  static uint32_t s_worker;
+  static uint32_t s_workers;
+  static uint32_t s_partitions;
+  static uint32_t s_mailboxSize;
+
+  static uint8_t *s_shared;
+  static size_t s_sharedSize;
+  static uint32_t s_sense;
+  static uint32_t s_parity;
+  static std::vector<pid_t> s_children;
+
+  // Send counters per source partition, and messages to local partitions
+  static std::vector<uint64_t> s_sequence;
+  static std::vector<uint8_t> s_localMailbox;
+
+  static std::vector<uint64_t> s_events;
+  static std::vector<uint64_t> s_digests;
+  static std::vector<uint64_t> s_sums;
+};
+
+} // namespace ns3
+
+#endif // PARTITION_INTERFACE_H
@@ -0,0 +1,78 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  partition-remote-channel.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  partition-remote-channel.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with partition-remote-channel.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "partition-remote-channel.h"
+#include "partition-interface.h"
+
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/node.h>
+#include <ns3-dev/ns3/point-to-point-net-device.h>
+#include <ns3-dev/ns3/simulator.h>
+
+NS_LOG_COMPONENT_DEFINE ("PartitionRemoteChannel");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (PartitionRemoteChannel);
+
+TypeId
+PartitionRemoteChannel::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::PartitionRemoteChannel")
+    .SetParent<PointToPointChannel> ()
+    .AddConstructor<PartitionRemoteChannel> ()
+  ;
+  return tid;
+}
+
+PartitionRemoteChannel::PartitionRemoteChannel ()
+{
+}
+
+PartitionRemoteChannel::~PartitionRemoteChannel ()
+{
+}
+
+bool
+PartitionRemoteChannel::TransmitStart (Ptr<Packet> p, Ptr<PointToPointNetDevice> src, Time txTime)
+{
+  NS_ASSERT (IsInitialized ());
+
+  uint32_t wire = (src == GetSource (0)) ? 0 : 1;
+  Ptr<PointToPointNetDevice> dst = GetDestination (wire);
+  uint32_t partition = src->GetNode ()->GetSystemId ();
+
+  // A global event driving a node of another worker must not send twice
+  if (!PartitionInterface::IsLocal (partition))
+    return true;
+
+  Time rxTime = Simulator::Now () + txTime + GetDelay ();
+  NS_LOG_LOGIC ("Frame from node " << src->GetNode ()->GetId () << " to node "
+                << dst->GetNode ()->GetId () << " arrives at " << rxTime);
+  PartitionInterface::SendPacket (p, rxTime, partition, dst->GetNode ()->GetId (), dst->GetIfIndex ());
+  return true;
+}
+
+Time
+PartitionRemoteChannel::GetLookahead () const
+{
+  return GetDelay ();
+}
+
+} // namespace ns3
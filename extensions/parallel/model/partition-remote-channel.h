@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  partition-remote-channel.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  partition-remote-channel.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with partition-remote-channel.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PARTITION_REMOTE_CHANNEL_H
+#define PARTITION_REMOTE_CHANNEL_H
+
+#include <ns3-dev/ns3/point-to-point-channel.h>
+
+namespace ns3 {
+
+/**
+ * @brief Point-to-point channel joining nodes of two partitions
+ *
+ * Frames are handed to PartitionInterface, serialized, instead of being
+ * scheduled at the destination device directly. They arrive at the same
+ * time as over a PointToPointChannel, but lose their packet tags, as with
+ * the MPI remote channel. The channel delay is the lookahead of the
+ * PartitionSimulatorImpl.
+ */
+class PartitionRemoteChannel : public PointToPointChannel
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  PartitionRemoteChannel ();
+
+  virtual
+  ~PartitionRemoteChannel ();
+
+  virtual bool
+  TransmitStart (Ptr<Packet> p, Ptr<PointToPointNetDevice> src, Time txTime);
+
+  /**
+   * @brief Shortest time a frame takes to cross the channel
+   */
+  Time
+  GetLookahead () const;
+};
+
+} // namespace ns3
+
+#endif // PARTITION_REMOTE_CHANNEL_H
@@ -0,0 +1,476 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  partition-simulator-impl.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  partition-simulator-impl.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with partition-simulator-impl.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "partition-simulator-impl.h"
+#include "partition-interface.h"
+#include "partition-remote-channel.h"
+
+#include <algorithm>
+
+#include <ns3-dev/ns3/channel-list.h>
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/node-list.h>
+#include <ns3-dev/ns3/node.h>
+#include <ns3-dev/ns3/simulator.h>
+
+NS_LOG_COMPONENT_DEFINE ("PartitionSimulatorImpl");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (PartitionSimulatorImpl);
+
+namespace {
+
+const int64_t NEVER = 0x7fffffffffffffffLL;
+
+uint64_t
+Mix (uint64_t digest, uint64_t value)
+{
+  // FNV-1a over 64 bit words
+  return (digest ^ value) * 0x100000001b3ULL;
+}
+
+} // anonymous namespace
+
+TypeId
+PartitionSimulatorImpl::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::PartitionSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .AddConstructor<PartitionSimulatorImpl> ()
+  ;
+  return tid;
+}
+
+PartitionSimulatorImpl::PartitionSimulatorImpl ()
+  : m_current (GLOBAL)
+  , m_currentContext (GLOBAL)
+  , m_stop (false)
+{
+  m_schedulerFactory.SetTypeId ("ns3::MapScheduler");
+  m_global.events = m_schedulerFactory.Create<Scheduler> ();
+  m_global.currentTs = 0;
+  m_global.currentUid = 0;
+  // uid 0 is "invalid" events, 1 "now" events and 2 "destroy" events
+  m_global.uid = 4;
+  m_global.executed = 0;
+  m_global.digest = 0xcbf29ce484222325ULL;
+}
+
+PartitionSimulatorImpl::~PartitionSimulatorImpl ()
+{
+}
+
+void
+PartitionSimulatorImpl::DoDispose ()
+{
+  m_queues.push_back (m_global);
+  for (std::vector<Queue>::iterator i = m_queues.begin (); i != m_queues.end (); i++)
+    {
+      while (!i->events->IsEmpty ())
+        {
+          Scheduler::Event next = i->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      i->events = 0;
+    }
+  m_queues.clear ();
+  m_global.events = 0;
+  SimulatorImpl::DoDispose ();
+}
+
+void
+PartitionSimulatorImpl::Destroy ()
+{
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+PartitionSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  m_schedulerFactory = schedulerFactory;
+
+  m_queues.push_back (m_global);
+  for (std::vector<Queue>::iterator i = m_queues.begin (); i != m_queues.end (); i++)
+    {
+      Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+      while (!i->events->IsEmpty ())
+        {
+          scheduler->Insert (i->events->RemoveNext ());
+        }
+      i->events = scheduler;
+    }
+  m_global = m_queues.back ();
+  m_queues.pop_back ();
+}
+
+PartitionSimulatorImpl::Queue &
+PartitionSimulatorImpl::GetQueue (uint32_t partition)
+{
+  if (partition == GLOBAL)
+    return m_global;
+
+  while (m_queues.size () <= partition)
+    {
+      Queue queue;
+      queue.events = m_schedulerFactory.Create<Scheduler> ();
+      queue.currentTs = 0;
+      queue.currentUid = 0;
+      queue.uid = 4;
+      queue.executed = 0;
+      queue.digest = 0xcbf29ce484222325ULL;
+      m_queues.push_back (queue);
+    }
+  return m_queues[partition];
+}
+
+const PartitionSimulatorImpl::Queue &
+PartitionSimulatorImpl::GetQueue (uint32_t partition) const
+{
+  return (partition == GLOBAL) ? m_global : m_queues[partition];
+}
+
+uint32_t
+PartitionSimulatorImpl::GetPartition (uint32_t context) const
+{
+  if (context == GLOBAL)
+    return GLOBAL;
+
+  // Nodes never change partition, so their system IDs are cached
+  while (m_partitionOf.size () <= context)
+    {
+      m_partitionOf.push_back (NodeList::GetNode (m_partitionOf.size ())->GetSystemId ());
+    }
+  return m_partitionOf[context];
+}
+
+void
+PartitionSimulatorImpl::Insert (Queue &queue, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = queue.uid++;
+  queue.events->Insert (ev);
+}
+
+bool
+PartitionSimulatorImpl::IsFinished () const
+{
+  if (!m_global.events->IsEmpty ())
+    return false;
+
+  for (uint32_t p = 0; p < m_queues.size (); p++)
+    {
+      if (PartitionInterface::IsLocal (p) && !m_queues[p].events->IsEmpty ())
+        return false;
+    }
+  return true;
+}
+
+void
+PartitionSimulatorImpl::Stop ()
+{
+  m_stop = true;
+}
+
+void
+PartitionSimulatorImpl::Stop (Time const &time)
+{
+  Simulator::Schedule (time, &Simulator::Stop);
+}
+
+EventId
+PartitionSimulatorImpl::Schedule (Time const &time, EventImpl *event)
+{
+  Queue &queue = GetQueue (m_current);
+  Time tAbsolute = time + TimeStep (queue.currentTs);
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (queue.currentTs));
+
+  uint64_t ts = (uint64_t) tAbsolute.GetTimeStep ();
+  uint32_t uid = queue.uid;
+  Insert (queue, ts, m_currentContext, event);
+  return EventId (event, ts, m_currentContext, uid);
+}
+
+void
+PartitionSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event)
+{
+  uint32_t partition = GetPartition (context);
+
+  // Without a node context the event stays where it was scheduled from
+  if (partition == GLOBAL)
+    {
+      Queue &queue = GetQueue (m_current);
+      Insert (queue, queue.currentTs + time.GetTimeStep (), m_currentContext, event);
+      return;
+    }
+
+  // Only the links give another partition time to see the event coming
+  if (m_current != GLOBAL && partition != m_current)
+    {
+      NS_FATAL_ERROR ("Event scheduled from partition " << m_current << " onto node " << context
+                      << " of partition " << partition << ", connect them with a PartitionRemoteChannel");
+    }
+
+  // Global events run in every worker, each keeping its own partitions
+  if (!PartitionInterface::IsLocal (partition))
+    {
+      event->Unref ();
+      return;
+    }
+
+  uint64_t now = GetQueue (m_current).currentTs;
+  Insert (GetQueue (partition), now + time.GetTimeStep (), context, event);
+}
+
+EventId
+PartitionSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+PartitionSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  EventId id (Ptr<EventImpl> (event, false), GetQueue (m_current).currentTs, GLOBAL, 2);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+void
+PartitionSimulatorImpl::InsertRemote (int64_t ts, uint32_t context, EventImpl *event)
+{
+  Insert (GetQueue (GetPartition (context)), ts, context, event);
+}
+
+void
+PartitionSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  GetQueue (GetPartition (id.GetContext ())).events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+}
+
+void
+PartitionSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+PartitionSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0 || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+
+  uint32_t partition = GetPartition (id.GetContext ());
+  if (partition != GLOBAL && partition >= m_queues.size ())
+    {
+      return true;
+    }
+
+  const Queue &queue = GetQueue (partition);
+  return id.PeekEventImpl () == 0
+         || id.GetTs () < queue.currentTs
+         || (id.GetTs () == queue.currentTs && id.GetUid () <= queue.currentUid)
+         || id.PeekEventImpl ()->IsCancelled ();
+}
+
+void
+PartitionSimulatorImpl::RunQueue (uint32_t partition, uint64_t until, bool inclusive)
+{
+  Queue &queue = GetQueue (partition);
+  m_current = partition;
+
+  while (!queue.events->IsEmpty ())
+    {
+      Scheduler::Event next = queue.events->PeekNext ();
+      if (next.key.m_ts > until || (!inclusive && next.key.m_ts == until))
+        break;
+
+      next = queue.events->RemoveNext ();
+      NS_ASSERT (next.key.m_ts >= queue.currentTs);
+      queue.currentTs = next.key.m_ts;
+      queue.currentUid = next.key.m_uid;
+      m_currentContext = next.key.m_context;
+
+      queue.executed++;
+      queue.digest = Mix (Mix (Mix (queue.digest, next.key.m_ts), next.key.m_context), next.key.m_uid);
+
+      next.impl->Invoke ();
+      next.impl->Unref ();
+    }
+}
+
+void
+PartitionSimulatorImpl::Run ()
+{
+  m_stop = false;
+
+  uint32_t partitions = PartitionInterface::GetNPartitions ();
+  GetQueue (partitions - 1);
+
+  int64_t lookahead = FindLookahead ().GetTimeStep ();
+  NS_ASSERT_MSG (lookahead > 0, "Partitions need links with a positive delay between them");
+  NS_LOG_INFO ("Running " << partitions << " partitions with a lookahead of " << TimeStep (lookahead));
+
+  while (true)
+    {
+      PartitionInterface::ReceiveMessages (this);
+
+      int64_t next = NEVER;
+      for (uint32_t p = 0; p < partitions; p++)
+        {
+          if (PartitionInterface::IsLocal (p) && !m_queues[p].events->IsEmpty ())
+            next = std::min (next, (int64_t) m_queues[p].events->PeekNext ().key.m_ts);
+        }
+      int64_t nextGlobal = m_global.events->IsEmpty () ? NEVER : (int64_t) m_global.events->PeekNext ().key.m_ts;
+      bool stop = m_stop;
+
+      PartitionInterface::Reduce (next, nextGlobal, stop);
+      if (stop || (next == NEVER && nextGlobal == NEVER))
+        break;
+
+      // No partition can reach another before the window ends. Global
+      // events close the window, so they see every partition up to them
+      int64_t grant = (next > NEVER - lookahead) ? NEVER : next + lookahead;
+      bool global = nextGlobal <= grant;
+      if (global)
+        grant = nextGlobal;
+
+      for (uint32_t p = 0; p < partitions; p++)
+        {
+          if (PartitionInterface::IsLocal (p))
+            RunQueue (p, grant, false);
+        }
+      if (global)
+        RunQueue (GLOBAL, grant, true);
+    }
+
+  m_current = GLOBAL;
+  m_currentContext = GLOBAL;
+
+  for (uint32_t p = 0; p < partitions; p++)
+    {
+      if (PartitionInterface::IsLocal (p))
+        PartitionInterface::Report (p, m_queues[p].executed, m_queues[p].digest);
+    }
+}
+
+Time
+PartitionSimulatorImpl::Now () const
+{
+  return TimeStep (GetQueue (m_current).currentTs);
+}
+
+Time
+PartitionSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  return TimeStep (id.GetTs () - GetQueue (m_current).currentTs);
+}
+
+Time
+PartitionSimulatorImpl::GetMaximumSimulationTime () const
+{
+  return TimeStep (NEVER);
+}
+
+uint32_t
+PartitionSimulatorImpl::GetSystemId () const
+{
+  return PartitionInterface::GetWorker ();
+}
+
+uint32_t
+PartitionSimulatorImpl::GetContext () const
+{
+  return m_currentContext;
+}
+
+Time
+PartitionSimulatorImpl::FindLookahead ()
+{
+  int64_t lookahead = NEVER;
+  for (uint32_t i = 0; i < ChannelList::GetNChannels (); i++)
+    {
+      Ptr<PartitionRemoteChannel> channel = DynamicCast<PartitionRemoteChannel> (ChannelList::GetChannel (i));
+      if (channel != 0)
+        lookahead = std::min (lookahead, channel->GetLookahead ().GetTimeStep ());
+    }
+  return TimeStep (lookahead);
+}
+
+} // namespace ns3
@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  partition-simulator-impl.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  partition-simulator-impl.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with partition-simulator-impl.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PARTITION_SIMULATOR_IMPL_H
+#define PARTITION_SIMULATOR_IMPL_H
+
+#include <list>
+#include <vector>
+
+#include <ns3-dev/ns3/event-id.h>
+#include <ns3-dev/ns3/event-impl.h>
+#include <ns3-dev/ns3/nstime.h>
+#include <ns3-dev/ns3/object-factory.h>
+#include <ns3-dev/ns3/scheduler.h>
+#include <ns3-dev/ns3/simulator-impl.h>
+
+namespace ns3 {
+
+/**
+ * @brief Conservative windowed simulator over node partitions
+ *
+ * The partition of a node is its system ID. Every partition has its own
+ * event list and clock, and partitions only meet through
+ * PartitionRemoteChannel links, whose smallest delay is the lookahead. The
+ * simulation advances in windows: all workers agree on the earliest
+ * pending event T, then every partition runs its events before
+ * T + lookahead on its own, as nothing another partition does in the
+ * window can reach it earlier. Packets sent over the remote links are
+ * scheduled at their destination between windows.
+ *
+ * Events without a node context scheduled from the main program (stop,
+ * periodic tracers, mobility traces) are global: every worker runs its
+ * copy of them between windows, after the partition events before their
+ * time and before the ones at their time. Events a partition schedules
+ * inherit its context and stay in it. An event scheduled directly onto a
+ * node of another partition breaks the partitioning and stops the run
+ * with a fatal error. Simulator::Stop takes effect at the end of the window.
+ *
+ * The order events run in within a partition depends neither on the
+ * number of workers nor on their speed, so running the partitions in one
+ * process or in PartitionInterface workers gives the same per node
+ * traces. What may differ is anything drawn from process wide counters at
+ * run time, such as packet UIDs.
+ */
+class PartitionSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  PartitionSimulatorImpl ();
+
+  virtual
+  ~PartitionSimulatorImpl ();
+
+  virtual void
+  Destroy ();
+
+  virtual bool
+  IsFinished () const;
+
+  virtual void
+  Stop ();
+
+  virtual void
+  Stop (Time const &time);
+
+  virtual EventId
+  Schedule (Time const &time, EventImpl *event);
+
+  virtual void
+  ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event);
+
+  virtual EventId
+  ScheduleNow (EventImpl *event);
+
+  virtual EventId
+  ScheduleDestroy (EventImpl *event);
+
+  virtual void
+  Remove (const EventId &id);
+
+  virtual void
+  Cancel (const EventId &id);
+
+  virtual bool
+  IsExpired (const EventId &id) const;
+
+  virtual void
+  Run ();
+
+  virtual Time
+  Now () const;
+
+  virtual Time
+  GetDelayLeft (const EventId &id) const;
+
+  virtual Time
+  GetMaximumSimulationTime () const;
+
+  virtual void
+  SetScheduler (ObjectFactory schedulerFactory);
+
+  virtual uint32_t
+  GetSystemId () const;
+
+  virtual uint32_t
+  GetContext () const;
+
+  /**
+   * @brief Schedule a packet arrival from another partition, called by
+   * PartitionInterface between windows
+   */
+  void
+  InsertRemote (int64_t ts, uint32_t context, EventImpl *event);
+
+  /**
+   * @brief Smallest delay of the PartitionRemoteChannel links
+   */
+  static Time
+  FindLookahead ();
+
+protected:
+  virtual void
+  DoDispose ();
+
+private:
+  /**
+   * @brief Event list and clock of a partition, or of the global events
+   */
+  struct Queue
+  {
+    Ptr<Scheduler> events;
+    uint64_t currentTs;
+    uint32_t currentUid;
+    uint32_t uid;
+    uint64_t executed;
+    uint64_t digest;
+  };
+
+  static const uint32_t GLOBAL = 0xffffffff;
+
+  Queue &
+  GetQueue (uint32_t partition);
+
+  const Queue &
+  GetQueue (uint32_t partition) const;
+
+  /**
+   * @brief Partition of an event context, GLOBAL for no context
+   */
+  uint32_t
+  GetPartition (uint32_t context) const;
+
+  void
+  Insert (Queue &queue, uint64_t ts, uint32_t context, EventImpl *event);
+
+  /**
+   * @brief Run the events of a queue up to (and including when inclusive)
+   * the given time
+   */
+  void
+  RunQueue (uint32_t partition, uint64_t until, bool inclusive);
+
+  ObjectFactory m_schedulerFactory;
+  std::vector<Queue> m_queues;
+  Queue m_global;
+
+  // Partition and context of the running event
+  uint32_t m_current;
+  uint32_t m_currentContext;
+
+  mutable std::vector<uint32_t> m_partitionOf;
+
+  typedef std::list<EventId> DestroyEvents;
+  DestroyEvents m_destroyEvents;
+
+  bool m_stop;
+};
+
+} // namespace ns3
+
+#endif // PARTITION_SIMULATOR_IMPL_H
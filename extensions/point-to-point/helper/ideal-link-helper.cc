@@ -0,0 +1,63 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  ideal-link-helper.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ideal-link-helper.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with ideal-link-helper.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ideal-link-helper.h"
+#include "../model/ideal-link-net-device.h"
+
+#include <ns3-dev/ns3/mac48-address.h>
+
+namespace ns3 {
+
+IdealLinkHelper::IdealLinkHelper ()
+{
+  m_device.SetTypeId ("ns3::IdealLinkNetDevice");
+  m_channel.SetTypeId ("ns3::IdealLinkChannel");
+}
+
+void
+IdealLinkHelper::SetDeviceAttribute (std::string name, const AttributeValue &v)
+{
+  m_device.Set (name, v);
+}
+
+void
+IdealLinkHelper::SetChannelAttribute (std::string name, const AttributeValue &v)
+{
+  m_channel.Set (name, v);
+}
+
+NetDeviceContainer
+IdealLinkHelper::Install (Ptr<Node> a, Ptr<Node> b) const
+{
+  NetDeviceContainer devices;
+  Ptr<IdealLinkChannel> channel = m_channel.Create<IdealLinkChannel> ();
+
+  Ptr<Node> nodes[2] = { a, b };
+  for (int i = 0; i < 2; i++)
+    {
+      Ptr<IdealLinkNetDevice> device = m_device.Create<IdealLinkNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      nodes[i]->AddDevice (device);
+      device->Attach (channel);
+      devices.Add (device);
+    }
+  return devices;
+}
+
+} // namespace ns3
@@ -0,0 +1,65 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  ideal-link-helper.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ideal-link-helper.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with ideal-link-helper.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef IDEAL_LINK_HELPER_H
+#define IDEAL_LINK_HELPER_H
+
+#include <string>
+
+#include <ns3-dev/ns3/net-device-container.h>
+#include <ns3-dev/ns3/node.h>
+#include <ns3-dev/ns3/object-factory.h>
+
+namespace ns3 {
+
+/**
+ * @brief Connects pairs of nodes with IdealLinkNetDevice, the way
+ * PointToPointHelper does with PointToPointNetDevice
+ */
+class IdealLinkHelper
+{
+public:
+  IdealLinkHelper ();
+
+  /**
+   * @brief Set an attribute of the created devices, e.g. DataRate
+   */
+  void
+  SetDeviceAttribute (std::string name, const AttributeValue &v);
+
+  /**
+   * @brief Set an attribute of the created channels, e.g. Delay
+   */
+  void
+  SetChannelAttribute (std::string name, const AttributeValue &v);
+
+  /**
+   * @brief Create a device on each node and link them
+   */
+  NetDeviceContainer
+  Install (Ptr<Node> a, Ptr<Node> b) const;
+
+private:
+  ObjectFactory m_device;
+  ObjectFactory m_channel;
+};
+
+} // namespace ns3
+
+#endif // IDEAL_LINK_HELPER_H
@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  ideal-link-channel.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ideal-link-channel.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with ideal-link-channel.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ideal-link-channel.h"
+#include "ideal-link-net-device.h"
+
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/simulator.h>
+
+NS_LOG_COMPONENT_DEFINE ("IdealLinkChannel");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (IdealLinkChannel);
+
+TypeId
+IdealLinkChannel::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::IdealLinkChannel")
+    .SetParent<Channel> ()
+    .AddConstructor<IdealLinkChannel> ()
+    .AddAttribute ("Delay",
+                   "Propagation delay through the link",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&IdealLinkChannel::m_delay),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+IdealLinkChannel::IdealLinkChannel ()
+  : m_nDevices (0)
+{
+}
+
+IdealLinkChannel::~IdealLinkChannel ()
+{
+}
+
+void
+IdealLinkChannel::Attach (Ptr<IdealLinkNetDevice> device)
+{
+  NS_ASSERT_MSG (m_nDevices < 2, "Only two devices permitted");
+  m_devices[m_nDevices++] = device;
+}
+
+uint32_t
+IdealLinkChannel::GetNDevices () const
+{
+  return m_nDevices;
+}
+
+Ptr<NetDevice>
+IdealLinkChannel::GetDevice (uint32_t i) const
+{
+  NS_ASSERT (i < m_nDevices);
+  return m_devices[i];
+}
+
+Time
+IdealLinkChannel::GetDelay () const
+{
+  return m_delay;
+}
+
+void
+IdealLinkChannel::Transmit (Ptr<IdealLinkNetDevice> sender, Ptr<Packet> packet, uint16_t protocol, Time txEnd)
+{
+  NS_ASSERT_MSG (m_nDevices == 2, "Link is not connected");
+
+  // The peer gets its own copy, as with a PointToPointChannel, so neither
+  // side sees the headers the other adds or removes
+  Ptr<IdealLinkNetDevice> peer = (m_devices[0] == sender) ? m_devices[1] : m_devices[0];
+  Simulator::ScheduleWithContext (peer->GetNode ()->GetId (), txEnd - Simulator::Now () + m_delay,
+                                  &IdealLinkNetDevice::Receive, peer, packet->Copy (), protocol,
+                                  Mac48Address::ConvertFrom (sender->GetAddress ()));
+}
+
+} // namespace ns3
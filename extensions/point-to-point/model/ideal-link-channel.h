@@ -0,0 +1,83 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  ideal-link-channel.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ideal-link-channel.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with ideal-link-channel.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef IDEAL_LINK_CHANNEL_H
+#define IDEAL_LINK_CHANNEL_H
+
+#include <ns3-dev/ns3/channel.h>
+#include <ns3-dev/ns3/nstime.h>
+#include <ns3-dev/ns3/packet.h>
+
+namespace ns3 {
+
+class IdealLinkNetDevice;
+
+/**
+ * @brief Lossless full duplex link between two IdealLinkNetDevice
+ *
+ * A frame reaches the peer device Delay after the sender has finished
+ * serializing it, in a single receive event.
+ */
+class IdealLinkChannel : public Channel
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  IdealLinkChannel ();
+
+  virtual
+  ~IdealLinkChannel ();
+
+  /**
+   * @brief Attach one of the two ends of the link
+   */
+  void
+  Attach (Ptr<IdealLinkNetDevice> device);
+
+  virtual uint32_t
+  GetNDevices () const;
+
+  virtual Ptr<NetDevice>
+  GetDevice (uint32_t i) const;
+
+  /**
+   * @brief Propagation delay of the link
+   */
+  Time
+  GetDelay () const;
+
+  /**
+   * @brief Deliver a frame to the other end of the link
+   *
+   * @param sender Device sending the frame
+   * @param txEnd Time at which the sender finishes serializing the frame
+   */
+  void
+  Transmit (Ptr<IdealLinkNetDevice> sender, Ptr<Packet> packet, uint16_t protocol, Time txEnd);
+
+private:
+  Time m_delay;
+  Ptr<IdealLinkNetDevice> m_devices[2];
+  uint32_t m_nDevices;
+};
+
+} // namespace ns3
+
+#endif // IDEAL_LINK_CHANNEL_H
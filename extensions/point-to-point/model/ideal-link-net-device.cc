@@ -0,0 +1,306 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  ideal-link-net-device.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ideal-link-net-device.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with ideal-link-net-device.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ideal-link-net-device.h"
+
+#include <algorithm>
+
+#include <ns3-dev/ns3/boolean.h>
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/simulator.h>
+#include <ns3-dev/ns3/trace-source-accessor.h>
+#include <ns3-dev/ns3/uinteger.h>
+
+NS_LOG_COMPONENT_DEFINE ("IdealLinkNetDevice");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (IdealLinkNetDevice);
+
+TypeId
+IdealLinkNetDevice::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::IdealLinkNetDevice")
+    .SetParent<NetDevice> ()
+    .AddConstructor<IdealLinkNetDevice> ()
+    .AddAttribute ("DataRate",
+                   "The rate frames are serialized at",
+                   DataRateValue (DataRate ("32768b/s")),
+                   MakeDataRateAccessor (&IdealLinkNetDevice::m_bps),
+                   MakeDataRateChecker ())
+    .AddAttribute ("Mtu",
+                   "The MAC-level Maximum Transmission Unit",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&IdealLinkNetDevice::SetMtu,
+                                         &IdealLinkNetDevice::GetMtu),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("Accounting",
+                   "Count the packets and bytes sent and received",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&IdealLinkNetDevice::m_accounting),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("MacTx",
+                     "A packet has been handed to the device for transmission",
+                     MakeTraceSourceAccessor (&IdealLinkNetDevice::m_txTrace))
+    .AddTraceSource ("MacRx",
+                     "A packet has been received by the device",
+                     MakeTraceSourceAccessor (&IdealLinkNetDevice::m_rxTrace))
+  ;
+  return tid;
+}
+
+IdealLinkNetDevice::IdealLinkNetDevice ()
+  : m_ifIndex (0)
+  , m_mtu (1500)
+  , m_txBusyUntil (Seconds (0))
+  , m_accounting (false)
+  , m_txPackets (0)
+  , m_txBytes (0)
+  , m_rxPackets (0)
+  , m_rxBytes (0)
+{
+}
+
+IdealLinkNetDevice::~IdealLinkNetDevice ()
+{
+}
+
+void
+IdealLinkNetDevice::DoDispose ()
+{
+  m_node = 0;
+  m_channel = 0;
+  m_rxCallback.Nullify ();
+  m_promiscCallback.Nullify ();
+  NetDevice::DoDispose ();
+}
+
+void
+IdealLinkNetDevice::Attach (Ptr<IdealLinkChannel> channel)
+{
+  m_channel = channel;
+  m_channel->Attach (this);
+  m_linkChanges ();
+}
+
+void
+IdealLinkNetDevice::Receive (Ptr<Packet> packet, uint16_t protocol, Mac48Address from)
+{
+  if (m_accounting)
+    {
+      m_rxPackets++;
+      m_rxBytes += packet->GetSize ();
+    }
+
+  m_rxTrace (packet);
+
+  if (!m_promiscCallback.IsNull ())
+    {
+      m_promiscCallback (this, packet, protocol, from, m_address, NetDevice::PACKET_HOST);
+    }
+
+  m_rxCallback (this, packet, protocol, from);
+}
+
+uint64_t
+IdealLinkNetDevice::GetTxPackets () const
+{
+  return m_txPackets;
+}
+
+uint64_t
+IdealLinkNetDevice::GetTxBytes () const
+{
+  return m_txBytes;
+}
+
+uint64_t
+IdealLinkNetDevice::GetRxPackets () const
+{
+  return m_rxPackets;
+}
+
+uint64_t
+IdealLinkNetDevice::GetRxBytes () const
+{
+  return m_rxBytes;
+}
+
+void
+IdealLinkNetDevice::SetIfIndex (const uint32_t index)
+{
+  m_ifIndex = index;
+}
+
+uint32_t
+IdealLinkNetDevice::GetIfIndex () const
+{
+  return m_ifIndex;
+}
+
+Ptr<Channel>
+IdealLinkNetDevice::GetChannel () const
+{
+  return m_channel;
+}
+
+void
+IdealLinkNetDevice::SetAddress (Address address)
+{
+  m_address = Mac48Address::ConvertFrom (address);
+}
+
+Address
+IdealLinkNetDevice::GetAddress () const
+{
+  return m_address;
+}
+
+bool
+IdealLinkNetDevice::SetMtu (const uint16_t mtu)
+{
+  m_mtu = mtu;
+  return true;
+}
+
+uint16_t
+IdealLinkNetDevice::GetMtu () const
+{
+  return m_mtu;
+}
+
+bool
+IdealLinkNetDevice::IsLinkUp () const
+{
+  return m_channel != 0;
+}
+
+void
+IdealLinkNetDevice::AddLinkChangeCallback (Callback<void> callback)
+{
+  m_linkChanges.ConnectWithoutContext (callback);
+}
+
+bool
+IdealLinkNetDevice::IsBroadcast () const
+{
+  return true;
+}
+
+Address
+IdealLinkNetDevice::GetBroadcast () const
+{
+  return Mac48Address::GetBroadcast ();
+}
+
+bool
+IdealLinkNetDevice::IsMulticast () const
+{
+  return true;
+}
+
+Address
+IdealLinkNetDevice::GetMulticast (Ipv4Address multicastGroup) const
+{
+  return Mac48Address::GetMulticast (multicastGroup);
+}
+
+Address
+IdealLinkNetDevice::GetMulticast (Ipv6Address addr) const
+{
+  return Mac48Address::GetMulticast (addr);
+}
+
+bool
+IdealLinkNetDevice::IsBridge () const
+{
+  return false;
+}
+
+bool
+IdealLinkNetDevice::IsPointToPoint () const
+{
+  return true;
+}
+
+bool
+IdealLinkNetDevice::Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber)
+{
+  if (m_channel == 0)
+    return false;
+
+  m_txTrace (packet);
+
+  if (m_accounting)
+    {
+      m_txPackets++;
+      m_txBytes += packet->GetSize ();
+    }
+
+  // Frames queue up behind the one being serialized
+  Time start = std::max (Simulator::Now (), m_txBusyUntil);
+  m_txBusyUntil = start + Seconds (m_bps.CalculateTxTime (packet->GetSize ()));
+  m_channel->Transmit (this, packet, protocolNumber, m_txBusyUntil);
+  return true;
+}
+
+bool
+IdealLinkNetDevice::SendFrom (Ptr<Packet> packet, const Address &source, const Address &dest, uint16_t protocolNumber)
+{
+  NS_FATAL_ERROR ("IdealLinkNetDevice does not support SendFrom");
+  return false;
+}
+
+Ptr<Node>
+IdealLinkNetDevice::GetNode () const
+{
+  return m_node;
+}
+
+void
+IdealLinkNetDevice::SetNode (Ptr<Node> node)
+{
+  m_node = node;
+}
+
+bool
+IdealLinkNetDevice::NeedsArp () const
+{
+  return false;
+}
+
+void
+IdealLinkNetDevice::SetReceiveCallback (NetDevice::ReceiveCallback cb)
+{
+  m_rxCallback = cb;
+}
+
+void
+IdealLinkNetDevice::SetPromiscReceiveCallback (NetDevice::PromiscReceiveCallback cb)
+{
+  m_promiscCallback = cb;
+}
+
+bool
+IdealLinkNetDevice::SupportsSendFrom () const
+{
+  return false;
+}
+
+} // namespace ns3
@@ -0,0 +1,183 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  ideal-link-net-device.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ideal-link-net-device.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with ideal-link-net-device.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef IDEAL_LINK_NET_DEVICE_H
+#define IDEAL_LINK_NET_DEVICE_H
+
+#include <ns3-dev/ns3/data-rate.h>
+#include <ns3-dev/ns3/mac48-address.h>
+#include <ns3-dev/ns3/net-device.h>
+#include <ns3-dev/ns3/node.h>
+#include <ns3-dev/ns3/nstime.h>
+#include <ns3-dev/ns3/traced-callback.h>
+
+#include "ideal-link-channel.h"
+
+namespace ns3 {
+
+/**
+ * @brief Point-to-point net device without a queue or transmit events
+ *
+ * Stands in for PointToPointNetDevice on links that are never the
+ * bottleneck. Frames are serialized one after the other at DataRate, and
+ * the only event per frame is its reception at the peer. Nothing is ever
+ * dropped, so a link that is in fact overloaded just delays frames more
+ * and more.
+ *
+ * With Accounting set, the device counts the packets and bytes it sends
+ * and receives.
+ */
+class IdealLinkNetDevice : public NetDevice
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  IdealLinkNetDevice ();
+
+  virtual
+  ~IdealLinkNetDevice ();
+
+  void
+  Attach (Ptr<IdealLinkChannel> channel);
+
+  /**
+   * @brief Called by the channel when a frame arrives
+   */
+  void
+  Receive (Ptr<Packet> packet, uint16_t protocol, Mac48Address from);
+
+  uint64_t
+  GetTxPackets () const;
+
+  uint64_t
+  GetTxBytes () const;
+
+  uint64_t
+  GetRxPackets () const;
+
+  uint64_t
+  GetRxBytes () const;
+
+  // NetDevice
+  virtual void
+  SetIfIndex (const uint32_t index);
+
+  virtual uint32_t
+  GetIfIndex () const;
+
+  virtual Ptr<Channel>
+  GetChannel () const;
+
+  virtual void
+  SetAddress (Address address);
+
+  virtual Address
+  GetAddress () const;
+
+  virtual bool
+  SetMtu (const uint16_t mtu);
+
+  virtual uint16_t
+  GetMtu () const;
+
+  virtual bool
+  IsLinkUp () const;
+
+  virtual void
+  AddLinkChangeCallback (Callback<void> callback);
+
+  virtual bool
+  IsBroadcast () const;
+
+  virtual Address
+  GetBroadcast () const;
+
+  virtual bool
+  IsMulticast () const;
+
+  virtual Address
+  GetMulticast (Ipv4Address multicastGroup) const;
+
+  virtual Address
+  GetMulticast (Ipv6Address addr) const;
+
+  virtual bool
+  IsBridge () const;
+
+  virtual bool
+  IsPointToPoint () const;
+
+  virtual bool
+  Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
+
+  virtual bool
+  SendFrom (Ptr<Packet> packet, const Address &source, const Address &dest, uint16_t protocolNumber);
+
+  virtual Ptr<Node>
+  GetNode () const;
+
+  virtual void
+  SetNode (Ptr<Node> node);
+
+  virtual bool
+  NeedsArp () const;
+
+  virtual void
+  SetReceiveCallback (NetDevice::ReceiveCallback cb);
+
+  virtual void
+  SetPromiscReceiveCallback (NetDevice::PromiscReceiveCallback cb);
+
+  virtual bool
+  SupportsSendFrom () const;
+
+protected:
+  virtual void
+  DoDispose ();
+
+private:
+  Ptr<Node> m_node;
+  Ptr<IdealLinkChannel> m_channel;
+  Mac48Address m_address;
+  uint32_t m_ifIndex;
+  uint16_t m_mtu;
+
+  DataRate m_bps;
+
+  // The device is busy sending until then
+  Time m_txBusyUntil;
+
+  bool m_accounting;
+  uint64_t m_txPackets;
+  uint64_t m_txBytes;
+  uint64_t m_rxPackets;
+  uint64_t m_rxBytes;
+
+  NetDevice::ReceiveCallback m_rxCallback;
+  NetDevice::PromiscReceiveCallback m_promiscCallback;
+  TracedCallback<> m_linkChanges;
+
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+  TracedCallback<Ptr<const Packet> > m_rxTrace;
+};
+
+} // namespace ns3
+
+#endif // IDEAL_LINK_NET_DEVICE_H
@@ -0,0 +1,307 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  cached-propagation-loss-model.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  cached-propagation-loss-model.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with cached-propagation-loss-model.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cached-propagation-loss-model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <ns3-dev/ns3/double.h>
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/pointer.h>
+#include <ns3-dev/ns3/simple-ref-count.h>
+#include <ns3-dev/ns3/uinteger.h>
+
+NS_LOG_COMPONENT_DEFINE ("CachedPropagationLossModel");
+
+namespace ns3 {
+
+/**
+ * @brief Losses of one wrapped model, kept by every model sharing them
+ */
+class CachedPropagationLossModel::Cache : public SimpleRefCount<CachedPropagationLossModel::Cache>
+{
+public:
+  Cache ();
+
+  void
+  GrowMatrix (uint32_t size, uint32_t maxStatic);
+
+  void
+  StaticMoved (Ptr<const MobilityModel> node);
+
+  // Gain (negative loss) in dB of each static pair, NaN until computed.
+  // m_capacity is the row length
+  std::vector<float> m_matrix;
+  uint32_t m_capacity;
+  uint32_t m_nStatic;
+  std::map<const MobilityModel *, int32_t> m_index;
+
+  // Gain every Resolution meters, and the reference distance of the
+  // wrapped model, under which it has no loss
+  std::vector<double> m_table;
+  double m_nearDistance;
+};
+
+CachedPropagationLossModel::Cache::Cache ()
+  : m_capacity (0)
+  , m_nStatic (0)
+  , m_nearDistance (0)
+{
+}
+
+void
+CachedPropagationLossModel::Cache::GrowMatrix (uint32_t size, uint32_t maxStatic)
+{
+  if (size <= m_capacity)
+    return;
+
+  uint32_t capacity = std::max<uint32_t> (m_capacity * 2, 64);
+  capacity = std::min (std::max (capacity, size), maxStatic);
+
+  std::vector<float> matrix (capacity * capacity, std::numeric_limits<float>::quiet_NaN ());
+  for (uint32_t i = 0; i < m_capacity; i++)
+    {
+      std::copy (m_matrix.begin () + i * m_capacity, m_matrix.begin () + (i + 1) * m_capacity,
+                 matrix.begin () + i * capacity);
+    }
+
+  m_matrix.swap (matrix);
+  m_capacity = capacity;
+}
+
+void
+CachedPropagationLossModel::Cache::StaticMoved (Ptr<const MobilityModel> node)
+{
+  std::map<const MobilityModel *, int32_t>::const_iterator i = m_index.find (PeekPointer (node));
+  if (i == m_index.end () || i->second < 0)
+    return;
+
+  uint32_t index = i->second;
+  for (uint32_t j = 0; j < m_capacity; j++)
+    {
+      m_matrix[index * m_capacity + j] = std::numeric_limits<float>::quiet_NaN ();
+      m_matrix[j * m_capacity + index] = std::numeric_limits<float>::quiet_NaN ();
+    }
+}
+
+NS_OBJECT_ENSURE_REGISTERED (CachedPropagationLossModel);
+
+TypeId
+CachedPropagationLossModel::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::CachedPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .AddConstructor<CachedPropagationLossModel> ()
+    .AddAttribute ("Model",
+                   "Deterministic propagation loss model whose loss is cached",
+                   PointerValue (),
+                   MakePointerAccessor (&CachedPropagationLossModel::SetModel,
+                                        &CachedPropagationLossModel::GetModel),
+                   MakePointerChecker<PropagationLossModel> ())
+    .AddAttribute ("MaxStaticNodes",
+                   "Largest number of static nodes kept in the loss matrix",
+                   UintegerValue (2048),
+                   MakeUintegerAccessor (&CachedPropagationLossModel::m_maxStatic),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Resolution",
+                   "Distance in meters between two entries of the lookup table",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&CachedPropagationLossModel::m_resolution),
+                   MakeDoubleChecker<double> (0.001))
+    .AddAttribute ("MaxDistance",
+                   "Distance in meters covered by the lookup table",
+                   DoubleValue (10000.0),
+                   MakeDoubleAccessor (&CachedPropagationLossModel::m_maxDistance),
+                   MakeDoubleChecker<double> (1.0))
+  ;
+  return tid;
+}
+
+CachedPropagationLossModel::CachedPropagationLossModel ()
+  : m_maxStatic (2048)
+  , m_resolution (0.1)
+  , m_maxDistance (10000.0)
+  , m_cache (Create<Cache> ())
+  , m_lastSender (0)
+  , m_lastSenderIndex (-1)
+  , m_staticHits (0)
+  , m_tableHits (0)
+{
+  m_origin = CreateObject<ConstantPositionMobilityModel> ();
+  m_probe = CreateObject<ConstantPositionMobilityModel> ();
+}
+
+CachedPropagationLossModel::~CachedPropagationLossModel ()
+{
+}
+
+void
+CachedPropagationLossModel::SetModel (Ptr<PropagationLossModel> model)
+{
+  m_model = model;
+
+  // Anything computed with the previous model is stale, and models
+  // sharing the cache keep theirs
+  m_cache = Create<Cache> ();
+  m_lastSender = 0;
+  m_lastSenderIndex = -1;
+}
+
+Ptr<PropagationLossModel>
+CachedPropagationLossModel::GetModel () const
+{
+  return m_model;
+}
+
+void
+CachedPropagationLossModel::ShareCache (Ptr<const CachedPropagationLossModel> other)
+{
+  m_model = other->m_model;
+  m_maxStatic = other->m_maxStatic;
+  m_resolution = other->m_resolution;
+  m_maxDistance = other->m_maxDistance;
+  m_cache = other->m_cache;
+  m_lastSender = 0;
+  m_lastSenderIndex = -1;
+}
+
+uint64_t
+CachedPropagationLossModel::GetStaticHits () const
+{
+  return m_staticHits;
+}
+
+uint64_t
+CachedPropagationLossModel::GetTableHits () const
+{
+  return m_tableHits;
+}
+
+int32_t
+CachedPropagationLossModel::GetStaticIndex (Ptr<MobilityModel> node) const
+{
+  Cache &cache = *m_cache;
+  std::map<const MobilityModel *, int32_t>::const_iterator i = cache.m_index.find (PeekPointer (node));
+  if (i != cache.m_index.end ())
+    return i->second;
+
+  // Moving nodes are remembered too, with no index. The cache is told of
+  // moves itself, as it may outlive this model
+  int32_t index = -1;
+  if (DynamicCast<ConstantPositionMobilityModel> (node) != 0 && cache.m_nStatic < m_maxStatic)
+    {
+      index = cache.m_nStatic++;
+      cache.GrowMatrix (cache.m_nStatic, m_maxStatic);
+      node->TraceConnectWithoutContext ("CourseChange", MakeCallback (&Cache::StaticMoved, m_cache));
+    }
+
+  cache.m_index[PeekPointer (node)] = index;
+  return index;
+}
+
+double
+CachedPropagationLossModel::CalcGain (double distance) const
+{
+  m_probe->SetPosition (Vector (distance, 0, 0));
+  return m_model->CalcRxPower (0, m_origin, m_probe);
+}
+
+void
+CachedPropagationLossModel::BuildTable () const
+{
+  uint32_t entries = (uint32_t) std::ceil (m_maxDistance / m_resolution) + 2;
+  m_cache->m_table.resize (entries);
+  for (uint32_t k = 0; k < entries; k++)
+    {
+      m_cache->m_table[k] = CalcGain (k * m_resolution);
+    }
+
+  DoubleValue nearDistance (0);
+  if (!m_model->GetAttributeFailSafe ("Distance0", nearDistance))
+    m_model->GetAttributeFailSafe ("ReferenceDistance", nearDistance);
+  m_cache->m_nearDistance = nearDistance.Get ();
+}
+
+double
+CachedPropagationLossModel::DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  NS_ASSERT_MSG (m_model != 0, "CachedPropagationLossModel needs a model to cache");
+
+  // The sender of a transmission asks for every receiver in turn
+  if (PeekPointer (a) != m_lastSender)
+    {
+      m_lastSender = PeekPointer (a);
+      m_lastSenderIndex = GetStaticIndex (a);
+    }
+
+  int32_t ia = m_lastSenderIndex;
+  int32_t ib = (ia >= 0) ? GetStaticIndex (b) : -1;
+
+  Cache &cache = *m_cache;
+  if (ib >= 0)
+    {
+      float &gain = cache.m_matrix[ia * cache.m_capacity + ib];
+      if (gain != gain)
+        {
+          gain = m_model->CalcRxPower (0, a, b);
+        }
+      m_staticHits++;
+      return txPowerDbm + gain;
+    }
+
+  double distance = a->GetDistanceFrom (b);
+  if (distance >= m_maxDistance)
+    {
+      return txPowerDbm + m_model->CalcRxPower (0, a, b);
+    }
+
+  if (cache.m_table.empty ())
+    {
+      BuildTable ();
+    }
+
+  // The loss jumps at the reference distance, so the entries on both
+  // sides of it are never blended: the interval holding it is computed,
+  // and closer nodes get the loss under it
+  double position = distance / m_resolution;
+  uint32_t k = (uint32_t) position;
+  if (distance >= cache.m_nearDistance && k * m_resolution <= cache.m_nearDistance)
+    {
+      return txPowerDbm + m_model->CalcRxPower (0, a, b);
+    }
+
+  m_tableHits++;
+  if (distance < cache.m_nearDistance)
+    {
+      return txPowerDbm + cache.m_table[0];
+    }
+
+  double fraction = position - k;
+  return txPowerDbm + cache.m_table[k] + fraction * (cache.m_table[k + 1] - cache.m_table[k]);
+}
+
+int64_t
+CachedPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  return (m_model != 0) ? m_model->AssignStreams (stream) : 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  cached-propagation-loss-model.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  cached-propagation-loss-model.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with cached-propagation-loss-model.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef CACHED_PROPAGATION_LOSS_MODEL_H
+#define CACHED_PROPAGATION_LOSS_MODEL_H
+
+#include <map>
+#include <vector>
+
+#include <ns3-dev/ns3/constant-position-mobility-model.h>
+#include <ns3-dev/ns3/propagation-loss-model.h>
+
+namespace ns3 {
+
+/**
+ * @brief Caches the loss of a deterministic propagation loss model
+ *
+ * The wrapped model must only depend on the distance between the nodes,
+ * like the LogDistance and ThreeLogDistance models, and must not be
+ * chained itself. Random fading goes in the models chained after this one
+ * with SetNext, which are evaluated on every call as usual.
+ *
+ * The loss between two ConstantPositionMobilityModel nodes is computed once
+ * and kept in a dense matrix, for up to MaxStaticNodes nodes. Moving a
+ * static node with SetPosition clears its entries. For any other pair the
+ * loss is interpolated from a table sampled every Resolution meters up to
+ * MaxDistance, beyond which the wrapped model is called directly. Below
+ * the reference distance of a LogDistance or ThreeLogDistance model, where
+ * its loss jumps, the table is not interpolated.
+ *
+ * The matrix and the table can take megabytes, so the models of the
+ * channels of one network should share them with ShareCache.
+ */
+class CachedPropagationLossModel : public PropagationLossModel
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  CachedPropagationLossModel ();
+
+  virtual
+  ~CachedPropagationLossModel ();
+
+  /**
+   * @brief Deterministic model whose loss is cached
+   */
+  void
+  SetModel (Ptr<PropagationLossModel> model);
+
+  Ptr<PropagationLossModel>
+  GetModel () const;
+
+  /**
+   * @brief Use the wrapped model, the attributes and the cached losses of
+   * another model, so several channels keep a single matrix and table.
+   * SetModel gives this model a cache of its own again
+   */
+  void
+  ShareCache (Ptr<const CachedPropagationLossModel> other);
+
+  /**
+   * @brief Loss lookups answered from the static matrix and from the table
+   */
+  uint64_t
+  GetStaticHits () const;
+
+  uint64_t
+  GetTableHits () const;
+
+private:
+  virtual double
+  DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+
+  virtual int64_t
+  DoAssignStreams (int64_t stream);
+
+  /**
+   * @brief Index of a static node in the matrix, or -1 if it has none
+   */
+  int32_t
+  GetStaticIndex (Ptr<MobilityModel> node) const;
+
+  void
+  BuildTable () const;
+
+  double
+  CalcGain (double distance) const;
+
+  class Cache;
+
+  Ptr<PropagationLossModel> m_model;
+
+  uint32_t m_maxStatic;
+  double m_resolution;
+  double m_maxDistance;
+
+  // Static matrix and table, possibly shared with other models
+  Ptr<Cache> m_cache;
+
+  mutable const MobilityModel *m_lastSender;
+  mutable int32_t m_lastSenderIndex;
+
+  // Positions used to evaluate the wrapped model at a given distance
+  Ptr<ConstantPositionMobilityModel> m_origin;
+  Ptr<ConstantPositionMobilityModel> m_probe;
+
+  mutable uint64_t m_staticHits;
+  mutable uint64_t m_tableHits;
+};
+
+} // namespace ns3
+
+#endif // CACHED_PROPAGATION_LOSS_MODEL_H
@@ -0,0 +1,233 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  fast-nakagami-propagation-loss-model.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  fast-nakagami-propagation-loss-model.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with fast-nakagami-propagation-loss-model.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "fast-nakagami-propagation-loss-model.h"
+
+#include <cmath>
+#include <limits>
+
+#include <ns3-dev/ns3/double.h>
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/mobility-model.h>
+#include <ns3-dev/ns3/uinteger.h>
+
+NS_LOG_COMPONENT_DEFINE ("FastNakagamiPropagationLossModel");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (FastNakagamiPropagationLossModel);
+
+TypeId
+FastNakagamiPropagationLossModel::GetTypeId ()
+{
+  // Same attributes and defaults as NakagamiPropagationLossModel
+  static TypeId tid = TypeId ("ns3::FastNakagamiPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .AddConstructor<FastNakagamiPropagationLossModel> ()
+    .AddAttribute ("Distance1",
+                   "Beginning of the second distance field. Default is 80m.",
+                   DoubleValue (80.0),
+                   MakeDoubleAccessor (&FastNakagamiPropagationLossModel::m_distance1),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("Distance2",
+                   "Beginning of the third distance field. Default is 200m.",
+                   DoubleValue (200.0),
+                   MakeDoubleAccessor (&FastNakagamiPropagationLossModel::m_distance2),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("m0",
+                   "m0 for distances smaller than Distance1. Default is 1.5.",
+                   DoubleValue (1.5),
+                   MakeDoubleAccessor (&FastNakagamiPropagationLossModel::m_m0),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("m1",
+                   "m1 for distances smaller than Distance2. Default is 0.75.",
+                   DoubleValue (0.75),
+                   MakeDoubleAccessor (&FastNakagamiPropagationLossModel::m_m1),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("m2",
+                   "m2 for distances greater than Distance2. Default is 0.75.",
+                   DoubleValue (0.75),
+                   MakeDoubleAccessor (&FastNakagamiPropagationLossModel::m_m2),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("BlockSize",
+                   "Number of gamma variates generated at once for each shape",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&FastNakagamiPropagationLossModel::m_blockSize),
+                   MakeUintegerChecker<uint32_t> (2))
+  ;
+  return tid;
+}
+
+FastNakagamiPropagationLossModel::FastNakagamiPropagationLossModel ()
+  : m_blockSize (1024)
+  , m_seeded (false)
+{
+  m_seedVariable = CreateObject<UniformRandomVariable> ();
+}
+
+FastNakagamiPropagationLossModel::~FastNakagamiPropagationLossModel ()
+{
+}
+
+void
+FastNakagamiPropagationLossModel::Seed () const
+{
+  m_engine.seed ((uint32_t) m_seedVariable->GetInteger (0, 0xffffffff));
+  m_seeded = true;
+}
+
+FastNakagamiPropagationLossModel::Ring &
+FastNakagamiPropagationLossModel::GetRing (double m) const
+{
+  for (std::vector<Ring>::iterator i = m_rings.begin (); i != m_rings.end (); i++)
+    {
+      if (i->shape == m)
+        return *i;
+    }
+
+  Ring ring;
+  ring.shape = m;
+  ring.samples.resize (m_blockSize);
+  ring.next = m_blockSize;
+  m_rings.push_back (ring);
+  return m_rings.back ();
+}
+
+void
+FastNakagamiPropagationLossModel::Refill (Ring &ring) const
+{
+  if (!m_seeded)
+    {
+      Seed ();
+    }
+
+  // Marsaglia and Tsang only work for shapes of at least 1. Smaller shapes
+  // draw Gamma(m + 1) and scale it by U^(1/m)
+  bool boost = ring.shape < 1;
+  double alpha = boost ? ring.shape + 1 : ring.shape;
+  double d = alpha - 1.0 / 3;
+  double c = 1 / std::sqrt (9 * d);
+
+  // Uniforms for the normals (an even number of them), the acceptance
+  // test and the boost
+  uint32_t n = m_blockSize;
+  uint32_t pairs = (n + 1) / 2;
+  uint32_t draws = 2 * pairs + (boost ? 2 * n : n);
+  m_normal.resize (2 * pairs);
+  m_uniform.resize (draws);
+  m_candidate.resize (n);
+
+  // The samples are kept in dB, normalized to a mean power of 1, so a
+  // lookup is a single addition. The logarithm of v is needed anyway
+  const double twoPi = 6.283185307179586;
+  const double dbPerNeper = 4.342944819032518;
+  const double offset = std::log (d) - std::log (ring.shape);
+  const double inverse = 1 / ring.shape;
+
+  uint32_t filled = 0;
+  while (filled < n)
+    {
+      for (uint32_t i = 0; i < draws; i++)
+        {
+          m_uniform[i] = (m_engine () + 0.5) * (1.0 / 4294967296.0);
+        }
+
+      // Box-Muller, two normals out of every pair of uniforms
+      for (uint32_t i = 0; i < 2 * pairs; i += 2)
+        {
+          double r = std::sqrt (-2 * std::log (m_uniform[i]));
+          double theta = twoPi * m_uniform[i + 1];
+          m_normal[i] = r * std::cos (theta);
+          m_normal[i + 1] = r * std::sin (theta);
+        }
+
+      // Candidates, NaN when rejected. The squeeze accepts most of them
+      // without the logarithm of u
+      const double *u = &m_uniform[2 * pairs];
+      const double *w = &m_uniform[2 * pairs + n];
+      for (uint32_t i = 0; i < n; i++)
+        {
+          double x = m_normal[i];
+          double x2 = x * x;
+          double t = 1 + c * x;
+          double logT = std::log (t);
+          double v = t * t * t;
+          bool accept = (t > 0) && (u[i] < 1 - 0.0331 * x2 * x2
+                                    || std::log (u[i]) < 0.5 * x2 + d - d * v + 3 * d * logT);
+          double db = dbPerNeper * (offset + 3 * logT + (boost ? std::log (w[i]) * inverse : 0));
+          m_candidate[i] = accept ? db : std::numeric_limits<double>::quiet_NaN ();
+        }
+
+      for (uint32_t i = 0; i < n && filled < n; i++)
+        {
+          if (!std::isnan (m_candidate[i]))
+            ring.samples[filled++] = m_candidate[i];
+        }
+    }
+
+  ring.next = 0;
+}
+
+double
+FastNakagamiPropagationLossModel::GetFadingDb (double m) const
+{
+  Ring &ring = GetRing (m);
+  if (ring.next == ring.samples.size ())
+    {
+      Refill (ring);
+    }
+  return ring.samples[ring.next++];
+}
+
+double
+FastNakagamiPropagationLossModel::DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  // select m parameter
+  double distance = b->GetDistanceFrom (a);
+  NS_ASSERT (distance >= 0);
+
+  double m;
+  if (distance < m_distance1)
+    {
+      m = m_m0;
+    }
+  else if (distance < m_distance2)
+    {
+      m = m_m1;
+    }
+  else
+    {
+      m = m_m2;
+    }
+
+  // The received power in Watt is Gamma(m, power / m), which in dBm is the
+  // transmitted power plus 10 log10 of a Gamma(m, 1 / m) variate
+  return txPowerDbm + GetFadingDb (m);
+}
+
+int64_t
+FastNakagamiPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  m_seedVariable->SetStream (stream);
+  m_seeded = false;
+  m_rings.clear ();
+  return 1;
+}
+
+} // namespace ns3
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  fast-nakagami-propagation-loss-model.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  fast-nakagami-propagation-loss-model.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with fast-nakagami-propagation-loss-model.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef FAST_NAKAGAMI_PROPAGATION_LOSS_MODEL_H
+#define FAST_NAKAGAMI_PROPAGATION_LOSS_MODEL_H
+
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+
+#include <ns3-dev/ns3/propagation-loss-model.h>
+#include <ns3-dev/ns3/random-variable-stream.h>
+
+namespace ns3 {
+
+/**
+ * @brief Nakagami-m fading drawn from pre-generated gamma samples
+ *
+ * Same distribution and attributes as NakagamiPropagationLossModel. The
+ * received power for shape m is the mean power times a Gamma(m, 1/m)
+ * variate. These variates are generated per shape in blocks of BlockSize
+ * with the Marsaglia-Tsang method and served in dB from a ring buffer.
+ * The speed-up comes from that batching, the loops over a block taking
+ * the place of a call to the ns-3 gamma variable per frame, and not from
+ * vector instructions: the logarithms and square roots are not
+ * vectorized without -ffast-math.
+ *
+ * The block generator is a Mersenne Twister seeded from an ns-3 uniform
+ * stream, so the draws follow the ns-3 seed, run number and AssignStreams.
+ * They are statistically equivalent to, but not the same numbers as, the
+ * ones of the stock model.
+ */
+class FastNakagamiPropagationLossModel : public PropagationLossModel
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  FastNakagamiPropagationLossModel ();
+
+  virtual
+  ~FastNakagamiPropagationLossModel ();
+
+  /**
+   * @brief Fading in dB for the given shape, 10 log10 of a Gamma(m, 1/m)
+   * variate. Exposed for the equivalence checks
+   */
+  double
+  GetFadingDb (double m) const;
+
+private:
+  /**
+   * @brief Ring buffer of unit gamma variates for one shape
+   */
+  struct Ring
+  {
+    double shape;
+    std::vector<double> samples;
+    uint32_t next;
+  };
+
+  virtual double
+  DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+
+  virtual int64_t
+  DoAssignStreams (int64_t stream);
+
+  Ring &
+  GetRing (double m) const;
+
+  void
+  Refill (Ring &ring) const;
+
+  void
+  Seed () const;
+
+  double m_distance1;
+  double m_distance2;
+  double m_m0;
+  double m_m1;
+  double m_m2;
+  uint32_t m_blockSize;
+
+  Ptr<UniformRandomVariable> m_seedVariable;
+  mutable bool m_seeded;
+  mutable boost::random::mt19937 m_engine;
+
+  // One ring of fading values in dB per shape in use, at most three
+  mutable std::vector<Ring> m_rings;
+
+  // Scratch arrays of the block generator
+  mutable std::vector<double> m_normal;
+  mutable std::vector<double> m_uniform;
+  mutable std::vector<double> m_candidate;
+};
+
+} // namespace ns3
+
+#endif // FAST_NAKAGAMI_PROPAGATION_LOSS_MODEL_H
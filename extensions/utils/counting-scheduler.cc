@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  counting-scheduler.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  counting-scheduler.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with counting-scheduler.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "counting-scheduler.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CountingScheduler);
+
+uint64_t CountingScheduler::s_inserted = 0;
+uint64_t CountingScheduler::s_executed = 0;
+uint64_t CountingScheduler::s_removed = 0;
+
+TypeId
+CountingScheduler::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::CountingScheduler")
+    .SetParent<MapScheduler> ()
+    .AddConstructor<CountingScheduler> ()
+  ;
+  return tid;
+}
+
+CountingScheduler::CountingScheduler ()
+{
+}
+
+CountingScheduler::~CountingScheduler ()
+{
+}
+
+void
+CountingScheduler::Insert (const Event &ev)
+{
+  s_inserted++;
+  MapScheduler::Insert (ev);
+}
+
+Scheduler::Event
+CountingScheduler::RemoveNext ()
+{
+  s_executed++;
+  return MapScheduler::RemoveNext ();
+}
+
+void
+CountingScheduler::Remove (const Event &ev)
+{
+  s_removed++;
+  MapScheduler::Remove (ev);
+}
+
+uint64_t
+CountingScheduler::GetInserted ()
+{
+  return s_inserted;
+}
+
+uint64_t
+CountingScheduler::GetExecuted ()
+{
+  return s_executed;
+}
+
+uint64_t
+CountingScheduler::GetRemoved ()
+{
+  return s_removed;
+}
+
+void
+CountingScheduler::Reset ()
+{
+  s_inserted = 0;
+  s_executed = 0;
+  s_removed = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,89 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  counting-scheduler.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  counting-scheduler.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with counting-scheduler.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COUNTING_SCHEDULER_H
+#define COUNTING_SCHEDULER_H
+
+#include <ns3-dev/ns3/map-scheduler.h>
+
+namespace ns3 {
+
+/**
+ * @brief MapScheduler that counts the events going through it
+ *
+ * Used by the benchmarks to report events per second. Install with
+ *
+ *   ObjectFactory factory;
+ *   factory.SetTypeId ("ns3::CountingScheduler");
+ *   Simulator::SetScheduler (factory);
+ *
+ * The counters are static because the simulator owns the scheduler, and
+ * survive Simulator::Destroy until Reset is called.
+ */
+class CountingScheduler : public MapScheduler
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  CountingScheduler ();
+
+  virtual
+  ~CountingScheduler ();
+
+  virtual void
+  Insert (const Event &ev);
+
+  virtual Event
+  RemoveNext ();
+
+  virtual void
+  Remove (const Event &ev);
+
+  /**
+   * @brief Events scheduled so far
+   */
+  static uint64_t
+  GetInserted ();
+
+  /**
+   * @brief Events taken off the queue to be run so far. Includes events
+   * that were cancelled, which the simulator skips
+   */
+  static uint64_t
+  GetExecuted ();
+
+  /**
+   * @brief Events removed before running (Simulator::Remove)
+   */
+  static uint64_t
+  GetRemoved ();
+
+  static void
+  Reset ();
+
+private:
+  static uint64_t s_inserted;
+  static uint64_t s_executed;
+  static uint64_t s_removed;
+};
+
+} // namespace ns3
+
+#endif // COUNTING_SCHEDULER_H
@@ -0,0 +1,233 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  result-cache.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  result-cache.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with result-cache.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "result-cache.h"
+#include "run-launcher.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sys/stat.h>
+
+#include <ns3-dev/ns3/global-value.h>
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/string.h>
+#include <ns3-dev/ns3/type-id.h>
+
+NS_LOG_COMPONENT_DEFINE ("ResultCache");
+
+namespace ns3 {
+
+ResultCache::ResultCache (const std::string &directory)
+  : m_directory (directory)
+{
+}
+
+void
+ResultCache::Add (const std::string &name, const std::string &value)
+{
+  NS_ASSERT_MSG (name.find_first_of ("=\n") == std::string::npos, "Bad cache parameter name " << name);
+  NS_ASSERT_MSG (value.find ('\n') == std::string::npos, "Bad value for cache parameter " << name);
+  m_config[name] = value;
+}
+
+void
+ResultCache::Add (const std::string &name, const char *value)
+{
+  Add (name, std::string (value));
+}
+
+void
+ResultCache::Add (const std::string &name, int64_t value)
+{
+  char buffer[32];
+  sprintf (buffer, "%lld", (long long) value);
+  Add (name, std::string (buffer));
+}
+
+void
+ResultCache::Add (const std::string &name, uint64_t value)
+{
+  char buffer[32];
+  sprintf (buffer, "%llu", (unsigned long long) value);
+  Add (name, std::string (buffer));
+}
+
+void
+ResultCache::Add (const std::string &name, int32_t value)
+{
+  Add (name, (int64_t) value);
+}
+
+void
+ResultCache::Add (const std::string &name, uint32_t value)
+{
+  Add (name, (uint64_t) value);
+}
+
+void
+ResultCache::Add (const std::string &name, double value)
+{
+  char buffer[32];
+  sprintf (buffer, "%.17g", value);
+  Add (name, std::string (buffer));
+}
+
+void
+ResultCache::Add (const std::string &name, bool value)
+{
+  Add (name, std::string (value ? "true" : "false"));
+}
+
+bool
+ResultCache::AddFile (const std::string &name, const std::string &path)
+{
+  std::ifstream file (path.c_str (), std::ios::binary);
+  if (!file)
+    return false;
+
+  uint64_t hash = Hash (0, 0);
+  char buffer[65536];
+  while (file)
+    {
+      file.read (buffer, sizeof (buffer));
+      hash = Hash (buffer, file.gcount (), hash);
+    }
+
+  char value[32];
+  sprintf (value, "%016llx", (unsigned long long) hash);
+  Add (name, std::string (value));
+  return true;
+}
+
+void
+ResultCache::AddAttributes ()
+{
+  uint64_t hash = Hash (0, 0);
+  for (uint32_t i = 0; i < TypeId::GetRegisteredN (); i++)
+    {
+      TypeId tid = TypeId::GetRegistered (i);
+      for (uint32_t j = 0; j < tid.GetAttributeN (); j++)
+        {
+          TypeId::AttributeInformation info = tid.GetAttribute (j);
+          std::string line = tid.GetName () + "::" + info.name + "="
+            + info.initialValue->SerializeToString (info.checker) + "\n";
+          hash = Hash (line.data (), line.size (), hash);
+        }
+    }
+
+  for (GlobalValue::Iterator i = GlobalValue::Begin (); i != GlobalValue::End (); i++)
+    {
+      // The partitioned and distributed simulators give the results of
+      // the default one
+      if ((*i)->GetName () == "SimulatorImplementationType")
+        continue;
+
+      StringValue value;
+      (*i)->GetValue (value);
+      std::string line = (*i)->GetName () + "=" + value.Get () + "\n";
+      hash = Hash (line.data (), line.size (), hash);
+    }
+
+  char value[32];
+  sprintf (value, "%016llx", (unsigned long long) hash);
+  Add ("attributes", std::string (value));
+}
+
+bool
+ResultCache::AddProgram ()
+{
+  // Linux only, as is the rest of the toolchain
+  return AddFile ("program", "/proc/self/exe");
+}
+
+uint64_t
+ResultCache::Hash (const void *data, size_t size, uint64_t hash)
+{
+  const uint8_t *bytes = (const uint8_t *) data;
+  for (size_t i = 0; i < size; i++)
+    {
+      hash ^= bytes[i];
+      hash *= 1099511628211ULL;
+    }
+  return hash;
+}
+
+std::string
+ResultCache::GetKey () const
+{
+  // The map keeps the parameters sorted by name
+  uint64_t hash = Hash (0, 0);
+  for (std::map<std::string, std::string>::const_iterator i = m_config.begin (); i != m_config.end (); i++)
+    {
+      hash = Hash (i->first.data (), i->first.size (), hash);
+      hash = Hash ("=", 1, hash);
+      hash = Hash (i->second.data (), i->second.size (), hash);
+      hash = Hash ("\n", 1, hash);
+    }
+
+  char key[32];
+  sprintf (key, "%016llx", (unsigned long long) hash);
+  return key;
+}
+
+std::string
+ResultCache::GetPath () const
+{
+  return m_directory + "/" + GetKey ();
+}
+
+bool
+ResultCache::IsComplete () const
+{
+  struct stat info;
+  return stat ((GetPath () + "/done").c_str (), &info) == 0;
+}
+
+bool
+ResultCache::Prepare () const
+{
+  std::string path = GetPath ();
+
+  if (!RunLauncher::CreateDirectories (path))
+    return false;
+
+  std::ofstream config ((path + "/config.txt").c_str ());
+  for (std::map<std::string, std::string>::const_iterator i = m_config.begin (); i != m_config.end (); i++)
+    {
+      config << i->first << "=" << i->second << std::endl;
+    }
+  return config.good ();
+}
+
+bool
+ResultCache::Complete () const
+{
+  // Written under another name first, so the marker never exists half
+  // written
+  std::string path = GetPath ();
+  {
+    std::ofstream marker ((path + "/done.tmp").c_str ());
+    marker << GetKey () << std::endl;
+    if (!marker.good ())
+      return false;
+  }
+  return rename ((path + "/done.tmp").c_str (), (path + "/done").c_str ()) == 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  result-cache.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  result-cache.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with result-cache.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <map>
+#include <stdint.h>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * @brief Directory of simulation results named by a hash of everything
+ * that determines them
+ *
+ * A run adds every parameter and input file, then either finds its
+ * results complete under GetPath or writes them there:
+ *
+ *   ResultCache cache ("results");
+ *   cache.Add ("scenario", "NDNMobilityRandom");
+ *   cache.Add ("mobile", mobile);
+ *   cache.AddFile ("posfile", posFile);
+ *   cache.AddAttributes ();
+ *   cache.AddProgram ();
+ *   if (cache.IsComplete ())
+ *     return 0;
+ *   cache.Prepare ();
+ *   // run, writing the traces under cache.GetPath ()
+ *   cache.Complete ();
+ *
+ * The key does not depend on the order of the Add calls. Options that
+ * only change how or where the results are written should be left out,
+ * so runs differing in them share their results. A run that is
+ * interrupted leaves no completion marker, so it is computed again.
+ */
+class ResultCache
+{
+public:
+  /**
+   * @param directory Directory holding one subdirectory per key
+   */
+  ResultCache (const std::string &directory);
+
+  void
+  Add (const std::string &name, const std::string &value);
+
+  void
+  Add (const std::string &name, const char *value);
+
+  void
+  Add (const std::string &name, int64_t value);
+
+  void
+  Add (const std::string &name, uint64_t value);
+
+  void
+  Add (const std::string &name, int32_t value);
+
+  void
+  Add (const std::string &name, uint32_t value);
+
+  /**
+   * @brief Doubles are keyed with all their digits, so 0.1 and 0.1000001
+   * are different runs
+   */
+  void
+  Add (const std::string &name, double value);
+
+  void
+  Add (const std::string &name, bool value);
+
+  /**
+   * @brief Key the contents of an input file
+   *
+   * @returns false if the file cannot be read
+   */
+  bool
+  AddFile (const std::string &name, const std::string &path);
+
+  /**
+   * @brief Key the current default of every attribute of every TypeId
+   * and the value of every GlobalValue
+   *
+   * Call after CommandLine::Parse, so the --ns3::Type::Attribute=value
+   * overrides and the NS_ATTRIBUTE_DEFAULT and NS_GLOBAL_VALUE settings
+   * are keyed. They all go in a single hash named attributes. The
+   * simulator implementation is left out, as it does not change the
+   * results.
+   */
+  void
+  AddAttributes ();
+
+  /**
+   * @brief Key the running executable, so a rebuilt program does not
+   * reuse the results of the old one
+   *
+   * @returns false if the executable cannot be read
+   */
+  bool
+  AddProgram ();
+
+  /**
+   * @brief Hash of the parameters and files, 16 hexadecimal digits
+   */
+  std::string
+  GetKey () const;
+
+  /**
+   * @brief Directory the results of this configuration go in
+   */
+  std::string
+  GetPath () const;
+
+  /**
+   * @brief Whether a run of this configuration finished
+   */
+  bool
+  IsComplete () const;
+
+  /**
+   * @brief Create the result directory and write the configuration to
+   * config.txt in it
+   *
+   * @returns false if the directory cannot be written
+   */
+  bool
+  Prepare () const;
+
+  /**
+   * @brief Mark the results as complete. Call once every result file is
+   * closed
+   */
+  bool
+  Complete () const;
+
+  /**
+   * @brief FNV-1a hash of a buffer, continuing from hash
+   */
+  static uint64_t
+  Hash (const void *data, size_t size, uint64_t hash = 14695981039346656037ULL);
+
+private:
+  std::string m_directory;
+  std::map<std::string, std::string> m_config;
+};
+
+} // namespace ns3
+
+#endif // RESULT_CACHE_H
@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  run-launcher.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  run-launcher.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with run-launcher.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "run-launcher.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <ns3-dev/ns3/log.h>
+
+NS_LOG_COMPONENT_DEFINE ("RunLauncher");
+
+namespace ns3 {
+
+bool
+RunLauncher::CreateDirectories (const std::string &path)
+{
+  for (size_t i = 1; i <= path.size (); i++)
+    {
+      if (i < path.size () && path[i] != '/')
+        continue;
+
+      if (mkdir (path.substr (0, i).c_str (), 0777) != 0 && errno != EEXIST)
+        {
+          NS_LOG_WARN ("Could not create " << path.substr (0, i));
+          return false;
+        }
+    }
+  return true;
+}
+
+bool
+RunLauncher::ReadMetric (const std::string &path, const std::string &metric, double &value)
+{
+  std::ifstream file (path.c_str ());
+  std::string line;
+
+  while (std::getline (file, line))
+    {
+      size_t eq = line.find ('=');
+      if (eq != std::string::npos && line.substr (0, eq) == metric)
+        {
+          value = std::atof (line.substr (eq + 1).c_str ());
+          return true;
+        }
+    }
+  return false;
+}
+
+pid_t
+RunLauncher::Start (const std::string &program, const std::vector<std::string> &args, const std::string &log)
+{
+  // Built before forking, the child only execs
+  std::vector<char *> argv;
+  argv.push_back (const_cast<char *> (program.c_str ()));
+  for (size_t i = 0; i < args.size (); i++)
+    argv.push_back (const_cast<char *> (args[i].c_str ()));
+  argv.push_back (0);
+
+  std::fflush (stdout);
+  pid_t pid = fork ();
+  if (pid != 0)
+    return pid;
+
+  int fd = open (log.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd >= 0)
+    {
+      dup2 (fd, 1);
+      dup2 (fd, 2);
+      close (fd);
+    }
+
+  execv (program.c_str (), &argv[0]);
+  _exit (127);
+}
+
+} // namespace ns3
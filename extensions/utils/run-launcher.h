@@ -0,0 +1,71 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  run-launcher.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  run-launcher.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with run-launcher.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RUN_LAUNCHER_H
+#define RUN_LAUNCHER_H
+
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief What the drivers running a scenario many times share: the work
+ * directory, starting a run and reading back its summary
+ *
+ * A run is the scenario program started with its own arguments and a
+ * --summary file, its output going to a log:
+ *
+ *   RunLauncher::CreateDirectories ("results/replicate");
+ *   pid_t pid = RunLauncher::Start (program, args, "results/replicate/run-001.log");
+ *   ...
+ *   waitpid (pid, &status, 0);
+ *   RunLauncher::ReadMetric ("results/replicate/run-001.summary", "goodput", value);
+ */
+class RunLauncher
+{
+public:
+  /**
+   * @brief Create a directory and its missing parents, like mkdir -p
+   */
+  static bool
+  CreateDirectories (const std::string &path);
+
+  /**
+   * @brief Read one metric from a summary file of name=value lines, as
+   * MobilityScenarioHelper::WriteSummary writes them
+   */
+  static bool
+  ReadMetric (const std::string &path, const std::string &metric, double &value);
+
+  /**
+   * @brief Start a program in a child process, its standard output and
+   * error going to log
+   *
+   * @param args Arguments after the program name
+   * @returns PID of the child, negative if it could not be started
+   */
+  static pid_t
+  Start (const std::string &program, const std::vector<std::string> &args, const std::string &log);
+};
+
+} // namespace ns3
+
+#endif // RUN_LAUNCHER_H
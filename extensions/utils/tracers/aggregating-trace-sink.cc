@@ -0,0 +1,269 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  aggregating-trace-sink.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  aggregating-trace-sink.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with aggregating-trace-sink.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "aggregating-trace-sink.h"
+
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+#include <boost/lexical_cast.hpp>
+
+#include <ns3-dev/ns3/assert.h>
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/names.h>
+#include <ns3-dev/ns3/node.h>
+
+NS_LOG_COMPONENT_DEFINE ("AggregatingTraceSink");
+
+namespace ns3 {
+
+AggregatingTraceSink::AggregatingTraceSink (const std::string &path, Time bin)
+  : m_file (path.c_str ())
+  , m_bin (bin.ToDouble (Time::S))
+  , m_hasMean (false)
+  , m_headerWritten (false)
+  , m_closed (false)
+  , m_time (0)
+  , m_key (1, 0)
+{
+  NS_ASSERT (m_bin > 0);
+  // Class 0 is used when no column names the node
+  Code (m_classes, "all");
+  if (!m_file)
+    NS_LOG_WARN ("Could not open " << path);
+}
+
+AggregatingTraceSink::~AggregatingTraceSink ()
+{
+  Close ();
+}
+
+void
+AggregatingTraceSink::SetNodeClass (const NodeContainer &nodes, const std::string &nodeClass)
+{
+  // The tracers name a node as ndnSIM does: its name if it has one,
+  // otherwise its id
+  for (NodeContainer::Iterator node = nodes.Begin (); node != nodes.End (); node++)
+    {
+      std::string name = Names::FindName (*node);
+      if (name.empty ())
+        name = boost::lexical_cast<std::string> ((*node)->GetId ());
+      m_nodeClass[name] = nodeClass;
+    }
+}
+
+uint32_t
+AggregatingTraceSink::AddColumn (const std::string &name, Type type, Role role)
+{
+  NS_ASSERT_MSG (!m_headerWritten, "Columns must be added before the first row");
+  NS_ASSERT_MSG (role == NODE ? type == STRING : type != STRING || role == KEY || role == DETAIL,
+                 "Column " << name << " cannot be reduced as declared");
+
+  Column column;
+  column.m_name = name;
+  column.m_type = type;
+  column.m_role = role;
+  column.m_slot = 0;
+  switch (role)
+    {
+    case KEY:
+      column.m_slot = m_key.size ();
+      m_key.push_back (0);
+      m_keyColumns.push_back (m_columns.size ());
+      break;
+
+    case MEAN:
+      m_hasMean = true;
+      // Fall through
+    case SUM:
+      column.m_slot = m_values.size ();
+      m_values.push_back (0);
+      m_valueColumns.push_back (m_columns.size ());
+      break;
+
+    default:
+      break;
+    }
+
+  m_columns.push_back (column);
+  return m_columns.size () - 1;
+}
+
+void
+AggregatingTraceSink::SetDouble (uint32_t column, double value)
+{
+  Column &c = m_columns[column];
+  if (c.m_role == KEY)
+    m_key[c.m_slot] = Code (c, value);
+  else if (c.m_role == TIME)
+    m_time = value;
+  else if (c.m_role == SUM || c.m_role == MEAN)
+    m_values[c.m_slot] = value;
+}
+
+void
+AggregatingTraceSink::SetInteger (uint32_t column, int64_t value)
+{
+  SetDouble (column, value);
+}
+
+void
+AggregatingTraceSink::SetString (uint32_t column, const std::string &value)
+{
+  Column &c = m_columns[column];
+  if (c.m_role == KEY)
+    {
+      m_key[c.m_slot] = Code (c, value);
+    }
+  else if (c.m_role == NODE)
+    {
+      // The node column codes straight to the class of the node
+      std::map<std::string, uint32_t>::iterator entry = c.m_dictionary.find (value);
+      if (entry == c.m_dictionary.end ())
+        {
+          std::string nodeClass = "all";
+          if (!m_nodeClass.empty ())
+            {
+              std::map<std::string, std::string>::const_iterator i = m_nodeClass.find (value);
+              nodeClass = (i == m_nodeClass.end ()) ? "other" : i->second;
+            }
+          entry = c.m_dictionary.insert (std::make_pair (value, Code (m_classes, nodeClass))).first;
+        }
+      m_key[0] = entry->second;
+    }
+}
+
+uint32_t
+AggregatingTraceSink::Code (Column &column, const std::string &value)
+{
+  std::map<std::string, uint32_t>::iterator entry = column.m_dictionary.find (value);
+  if (entry == column.m_dictionary.end ())
+    {
+      entry = column.m_dictionary.insert (std::make_pair (value, (uint32_t) column.m_names.size ())).first;
+      column.m_names.push_back (value);
+    }
+  return entry->second;
+}
+
+uint32_t
+AggregatingTraceSink::Code (Column &column, double value)
+{
+  // Numbers are formatted only the first time they are seen
+  std::map<double, uint32_t>::iterator entry = column.m_numbers.find (value);
+  if (entry == column.m_numbers.end ())
+    {
+      std::ostringstream text;
+      if (column.m_type == INTEGER)
+        text << (int64_t) value;
+      else
+        text << value;
+      entry = column.m_numbers.insert (std::make_pair (value, Code (column, text.str ()))).first;
+    }
+  return entry->second;
+}
+
+void
+AggregatingTraceSink::EndRow ()
+{
+  NS_ASSERT (!m_closed);
+  if (!m_headerWritten)
+    WriteHeader ();
+
+  // Rows come in time order, so earlier bins are complete
+  int64_t bin = (int64_t) std::ceil (m_time / m_bin - 1e-9);
+  if (!m_groups.empty () && m_groups.rbegin ()->first.first < bin)
+    WriteBins (bin);
+
+  Group &group = m_groups[GroupKey (bin, m_key)];
+  if (group.m_sums.empty ())
+    {
+      group.m_sums.resize (m_values.size (), 0);
+      group.m_rows = 0;
+    }
+  for (uint32_t i = 0; i < m_values.size (); i++)
+    group.m_sums[i] += m_values[i];
+  group.m_rows++;
+}
+
+void
+AggregatingTraceSink::Close ()
+{
+  if (m_closed)
+    return;
+
+  if (!m_headerWritten)
+    WriteHeader ();
+  WriteBins (std::numeric_limits<int64_t>::max ());
+
+  m_file.close ();
+  m_closed = true;
+}
+
+bool
+AggregatingTraceSink::IsGood () const
+{
+  return !m_file.fail ();
+}
+
+void
+AggregatingTraceSink::WriteHeader ()
+{
+  m_file << "Time" << "\t" << "Node";
+  for (uint32_t i = 0; i < m_keyColumns.size (); i++)
+    m_file << "\t" << m_columns[m_keyColumns[i]].m_name;
+  for (uint32_t i = 0; i < m_valueColumns.size (); i++)
+    m_file << "\t" << m_columns[m_valueColumns[i]].m_name;
+  if (m_hasMean)
+    m_file << "\t" << "Samples";
+  m_file << "\n";
+
+  m_headerWritten = true;
+}
+
+void
+AggregatingTraceSink::WriteBins (int64_t before)
+{
+  std::map<GroupKey, Group>::iterator group = m_groups.begin ();
+  for (; group != m_groups.end () && group->first.first < before; group++)
+    {
+      const std::vector<uint32_t> &key = group->first.second;
+      m_file << group->first.first * m_bin << "\t" << m_classes.m_names[key[0]];
+      for (uint32_t i = 0; i < m_keyColumns.size (); i++)
+        {
+          const Column &c = m_columns[m_keyColumns[i]];
+          m_file << "\t" << c.m_names[key[c.m_slot]];
+        }
+      for (uint32_t i = 0; i < m_valueColumns.size (); i++)
+        {
+          const Column &c = m_columns[m_valueColumns[i]];
+          double value = group->second.m_sums[c.m_slot];
+          if (c.m_role == MEAN)
+            value /= group->second.m_rows;
+          m_file << "\t" << value;
+        }
+      if (m_hasMean)
+        m_file << "\t" << group->second.m_rows;
+      m_file << "\n";
+    }
+
+  m_groups.erase (m_groups.begin (), group);
+}
+
+} // namespace ns3
@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  aggregating-trace-sink.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  aggregating-trace-sink.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with aggregating-trace-sink.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AGGREGATING_TRACE_SINK_H
+#define AGGREGATING_TRACE_SINK_H
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ns3-dev/ns3/node-container.h>
+#include <ns3-dev/ns3/nstime.h>
+
+#include "trace-sink.h"
+
+namespace ns3 {
+
+/**
+ * @brief Reduces the rows of the columnar tracers in memory and writes
+ * only the reduced series
+ *
+ * This does in the simulation what the R scripts in graphs/ do with
+ * summaryBy (. ~ Time + Type): rows are put in time bins and grouped by
+ * the KEY columns and the class of their node; SUM columns are summed
+ * and MEAN columns averaged, DETAIL columns are dropped. KEY columns may
+ * be strings or numbers, such as the bounds of histogram buckets. Time bins end
+ * at multiples of the bin width and a row falls in the bin its time
+ * rounds up to, like ceiling (Time) in the scripts.
+ *
+ * The output is a text table with the columns Time Node, the KEY
+ * columns and the SUM and MEAN columns, under their tracer names, and
+ * Samples (rows in the group) when there are MEAN columns. Node holds
+ * the node class, or "all" if no class was set, so the scripts read it
+ * unchanged:
+ *
+ *   boost::shared_ptr<AggregatingTraceSink> sink =
+ *     boost::make_shared<AggregatingTraceSink> ("rate-trace.txt", Seconds (1.0));
+ *   sink->SetNodeClass (topology.GetMobileTerminals (), "mobile");
+ *   sink->SetNodeClass (topology.GetApNodes (), "ap");
+ *   ColumnarL3Tracer::Install (nodes, sink, Seconds (1.0), ColumnarL3Tracer::RATE);
+ *
+ * Nodes without a class are counted as "other". A bin is written once a
+ * row of a later bin arrives, the last ones on Close. For periodic
+ * tracers the bin should be their period, or a multiple of it.
+ */
+class AggregatingTraceSink : public TraceSink
+{
+public:
+  /**
+   * @param path Text file to write, replaced if it exists
+   * @param bin Width of the time bins
+   */
+  AggregatingTraceSink (const std::string &path, Time bin);
+
+  /**
+   * @brief Writes the last bins
+   */
+  virtual
+  ~AggregatingTraceSink ();
+
+  /**
+   * @brief Group the rows of these nodes under a class. Call before the
+   * simulation starts
+   */
+  void
+  SetNodeClass (const NodeContainer &nodes, const std::string &nodeClass);
+
+  virtual uint32_t
+  AddColumn (const std::string &name, Type type, Role role);
+
+  virtual void
+  SetDouble (uint32_t column, double value);
+
+  virtual void
+  SetInteger (uint32_t column, int64_t value);
+
+  virtual void
+  SetString (uint32_t column, const std::string &value);
+
+  virtual void
+  EndRow ();
+
+  virtual void
+  Close ();
+
+  virtual bool
+  IsGood () const;
+
+private:
+  struct Column
+  {
+    std::string m_name;
+    Type m_type;
+    Role m_role;
+    uint32_t m_slot;
+    std::map<std::string, uint32_t> m_dictionary;
+    std::map<double, uint32_t> m_numbers;
+    std::vector<std::string> m_names;
+  };
+
+  struct Group
+  {
+    std::vector<double> m_sums;
+    uint64_t m_rows;
+  };
+
+  // Time bin, then the class and KEY codes
+  typedef std::pair<int64_t, std::vector<uint32_t> > GroupKey;
+
+  uint32_t
+  Code (Column &column, const std::string &value);
+
+  /**
+   * @brief Code of a number of an INTEGER or DOUBLE KEY column, the same
+   * as the code of the number as the tracers print it
+   */
+  uint32_t
+  Code (Column &column, double value);
+
+  void
+  WriteHeader ();
+
+  void
+  WriteBins (int64_t before);
+
+  std::ofstream m_file;
+  double m_bin;
+  std::vector<Column> m_columns;
+  std::vector<uint32_t> m_keyColumns;
+  std::vector<uint32_t> m_valueColumns;
+  bool m_hasMean;
+  bool m_headerWritten;
+  bool m_closed;
+
+  std::map<std::string, std::string> m_nodeClass;
+  Column m_classes;
+
+  double m_time;
+  std::vector<uint32_t> m_key;
+  std::vector<double> m_values;
+
+  std::map<GroupKey, Group> m_groups;
+};
+
+} // namespace ns3
+
+#endif // AGGREGATING_TRACE_SINK_H
@@ -0,0 +1,267 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  async-trace-sink.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  async-trace-sink.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with async-trace-sink.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "async-trace-sink.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <ns3-dev/ns3/assert.h>
+#include <ns3-dev/ns3/callback.h>
+#include <ns3-dev/ns3/log.h>
+
+NS_LOG_COMPONENT_DEFINE ("AsyncTraceSink");
+
+namespace ns3 {
+
+// How long either thread sleeps before looking at the ring again, in
+// case the other one's signal came before it started waiting
+static const uint64_t g_pollNs = 1000000;
+
+AsyncTraceSink::AsyncTraceSink (boost::shared_ptr<TraceSink> sink, uint32_t bufferSize)
+  : m_sink (sink)
+  , m_pending (0)
+  , m_head (0)
+  , m_stop (false)
+  , m_stalls (0)
+  , m_tail (0)
+  , m_good (true)
+  , m_closed (false)
+{
+  NS_ASSERT (m_sink);
+
+  uint64_t size = 64;
+  while (size < bufferSize)
+    size <<= 1;
+  m_buffer.resize (size);
+  m_mask = size - 1;
+
+  m_good = m_sink->IsGood ();
+  m_thread = Create<SystemThread> (MakeCallback (&AsyncTraceSink::Run, this));
+  m_thread->Start ();
+}
+
+AsyncTraceSink::~AsyncTraceSink ()
+{
+  Close ();
+}
+
+uint32_t
+AsyncTraceSink::AddColumn (const std::string &name, Type type, Role role)
+{
+  // The background thread does not touch the sink before the first row
+  NS_ASSERT_MSG (m_head == 0, "Columns must be added before the first row");
+  return m_sink->AddColumn (name, type, role);
+}
+
+void
+AsyncTraceSink::SetDouble (uint32_t column, double value)
+{
+  char record = DOUBLE_RECORD;
+  Put (&record, sizeof (record));
+  Put (&column, sizeof (column));
+  Put (&value, sizeof (value));
+}
+
+void
+AsyncTraceSink::SetInteger (uint32_t column, int64_t value)
+{
+  char record = INTEGER_RECORD;
+  Put (&record, sizeof (record));
+  Put (&column, sizeof (column));
+  Put (&value, sizeof (value));
+}
+
+void
+AsyncTraceSink::SetString (uint32_t column, const std::string &value)
+{
+  char record = STRING_RECORD;
+  uint32_t size = value.size ();
+  Put (&record, sizeof (record));
+  Put (&column, sizeof (column));
+  Put (&size, sizeof (size));
+  Put (value.data (), size);
+}
+
+void
+AsyncTraceSink::EndRow ()
+{
+  NS_ASSERT (!m_closed);
+  char record = END_ROW_RECORD;
+  Put (&record, sizeof (record));
+
+  // The records must be in the ring before the reader sees the new head
+  __sync_synchronize ();
+  m_head = m_pending;
+}
+
+void
+AsyncTraceSink::Close ()
+{
+  if (m_closed)
+    return;
+  m_closed = true;
+
+  // The reader leaves only once it has caught up with the last head
+  __sync_synchronize ();
+  m_stop = true;
+  m_rowsReady.SetCondition (true);
+  m_rowsReady.Signal ();
+  m_thread->Join ();
+
+  m_sink->Close ();
+  m_good = m_sink->IsGood ();
+  if (m_stalls > 0)
+    NS_LOG_INFO ("Waited " << m_stalls << " times for the trace writer");
+}
+
+bool
+AsyncTraceSink::IsGood () const
+{
+  return m_good;
+}
+
+uint64_t
+AsyncTraceSink::GetStalls () const
+{
+  return m_stalls;
+}
+
+void
+AsyncTraceSink::Put (const void *data, uint32_t size)
+{
+  NS_ASSERT_MSG (m_pending + size - m_head <= m_buffer.size (),
+                 "A trace row does not fit in " << m_buffer.size () << " bytes");
+
+  uint64_t tail = m_tail;
+  if (m_pending + size - tail > m_buffer.size ())
+    {
+      // Back-pressure: wait for the reader rather than lose rows
+      m_stalls++;
+      do
+        {
+          // TimedWait leaves the condition set, so it is cleared before
+          // the tail is read again: room freed meanwhile sets it back
+          m_roomReady.SetCondition (false);
+          m_rowsReady.SetCondition (true);
+          m_rowsReady.Signal ();
+          __sync_synchronize ();
+          tail = m_tail;
+          if (m_pending + size - tail <= m_buffer.size ())
+            break;
+          m_roomReady.TimedWait (g_pollNs);
+          tail = m_tail;
+        }
+      while (m_pending + size - tail > m_buffer.size ());
+    }
+  // The reader is done with the bytes before the tail
+  __sync_synchronize ();
+
+  uint64_t offset = m_pending & m_mask;
+  uint64_t first = std::min<uint64_t> (size, m_buffer.size () - offset);
+  std::memcpy (&m_buffer[offset], data, first);
+  std::memcpy (&m_buffer[0], (const char *) data + first, size - first);
+  m_pending += size;
+}
+
+void
+AsyncTraceSink::Get (uint64_t &position, void *data, uint32_t size) const
+{
+  uint64_t offset = position & m_mask;
+  uint64_t first = std::min<uint64_t> (size, m_buffer.size () - offset);
+  std::memcpy (data, &m_buffer[offset], first);
+  std::memcpy ((char *) data + first, &m_buffer[0], size - first);
+  position += size;
+}
+
+void
+AsyncTraceSink::Run ()
+{
+  std::string value;
+  for (;;)
+    {
+      bool stop = m_stop;
+      __sync_synchronize ();
+      uint64_t head = m_head;
+      uint64_t tail = m_tail;
+      if (tail == head)
+        {
+          if (stop)
+            break;
+
+          // As in Put, clear the condition before looking again
+          m_rowsReady.SetCondition (false);
+          __sync_synchronize ();
+          if (m_head == head && !m_stop)
+            m_rowsReady.TimedWait (g_pollNs);
+          continue;
+        }
+
+      // Rows before the head are complete
+      __sync_synchronize ();
+      while (tail != head)
+        {
+          char record;
+          uint32_t column;
+          Get (tail, &record, sizeof (record));
+          switch (record)
+            {
+            case DOUBLE_RECORD:
+              {
+                double d;
+                Get (tail, &column, sizeof (column));
+                Get (tail, &d, sizeof (d));
+                m_sink->SetDouble (column, d);
+                break;
+              }
+            case INTEGER_RECORD:
+              {
+                int64_t i;
+                Get (tail, &column, sizeof (column));
+                Get (tail, &i, sizeof (i));
+                m_sink->SetInteger (column, i);
+                break;
+              }
+            case STRING_RECORD:
+              {
+                uint32_t size;
+                Get (tail, &column, sizeof (column));
+                Get (tail, &size, sizeof (size));
+                value.resize (size);
+                if (size > 0)
+                  Get (tail, &value[0], size);
+                m_sink->SetString (column, value);
+                break;
+              }
+            default:
+              m_sink->EndRow ();
+              // Hand the row's bytes back as soon as it is written
+              __sync_synchronize ();
+              m_tail = tail;
+              break;
+            }
+        }
+
+      m_good = m_sink->IsGood ();
+      m_roomReady.SetCondition (true);
+      m_roomReady.Signal ();
+    }
+}
+
+} // namespace ns3
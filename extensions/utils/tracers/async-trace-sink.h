@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  async-trace-sink.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  async-trace-sink.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with async-trace-sink.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ASYNC_TRACE_SINK_H
+#define ASYNC_TRACE_SINK_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <ns3-dev/ns3/ptr.h>
+#include <ns3-dev/ns3/system-condition.h>
+#include <ns3-dev/ns3/system-thread.h>
+
+#include "trace-sink.h"
+
+namespace ns3 {
+
+/**
+ * @brief Moves the work of another sink to a background thread
+ *
+ * The Set and EndRow calls of the simulator thread are appended as
+ * binary records to a ring buffer; a thread of its own replays them on
+ * the wrapped sink, which does the formatting, compression and writing.
+ * The ring has one writer and one reader, so appending takes no lock:
+ * a row becomes visible to the reader when EndRow publishes it.
+ *
+ * The ring has a fixed size. When the writer thread falls behind and
+ * the ring is full, the simulator waits for room instead of growing it
+ * or dropping rows. Close, which the destructor calls, waits until every
+ * row is written and then closes the wrapped sink, so the tracers'
+ * Destroy after Simulator::Destroy loses nothing:
+ *
+ *   boost::shared_ptr<TraceSink> sink = boost::make_shared<AsyncTraceSink> (
+ *     boost::make_shared<ColumnarTraceWriter> ("rate-trace.ntc"));
+ *   ColumnarL3Tracer::Install (nodes, sink, Seconds (1.0), ColumnarL3Tracer::RATE);
+ */
+class AsyncTraceSink : public TraceSink
+{
+public:
+  /**
+   * @param sink Sink the rows are written to, only used by the background
+   * thread once rows arrive
+   * @param bufferSize Bytes of the ring, rounded up to a power of two. A
+   * row must fit in it
+   */
+  AsyncTraceSink (boost::shared_ptr<TraceSink> sink, uint32_t bufferSize = 1 << 22);
+
+  virtual
+  ~AsyncTraceSink ();
+
+  /**
+   * @brief Declared on the wrapped sink directly, before any row
+   */
+  virtual uint32_t
+  AddColumn (const std::string &name, Type type, Role role);
+
+  virtual void
+  SetDouble (uint32_t column, double value);
+
+  virtual void
+  SetInteger (uint32_t column, int64_t value);
+
+  virtual void
+  SetString (uint32_t column, const std::string &value);
+
+  virtual void
+  EndRow ();
+
+  /**
+   * @brief Wait for the background thread to write every row, then close
+   * the wrapped sink
+   */
+  virtual void
+  Close ();
+
+  /**
+   * @brief Whether the wrapped sink was good after the rows written so
+   * far
+   */
+  virtual bool
+  IsGood () const;
+
+  /**
+   * @brief Times the simulator thread had to wait for room in the ring
+   */
+  uint64_t
+  GetStalls () const;
+
+private:
+  enum Record
+  {
+    DOUBLE_RECORD,
+    INTEGER_RECORD,
+    STRING_RECORD,
+    END_ROW_RECORD
+  };
+
+  void
+  Put (const void *data, uint32_t size);
+
+  void
+  Get (uint64_t &position, void *data, uint32_t size) const;
+
+  void
+  Run ();
+
+  boost::shared_ptr<TraceSink> m_sink;
+  std::vector<char> m_buffer;
+  uint64_t m_mask;
+
+  // Written by the simulator thread
+  uint64_t m_pending;
+  volatile uint64_t m_head;
+  volatile bool m_stop;
+  uint64_t m_stalls;
+
+  // Written by the background thread
+  volatile uint64_t m_tail;
+  volatile bool m_good;
+
+  SystemCondition m_rowsReady;
+  SystemCondition m_roomReady;
+  Ptr<SystemThread> m_thread;
+  bool m_closed;
+};
+
+} // namespace ns3
+
+#endif // ASYNC_TRACE_SINK_H
@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  columnar-app-delay-tracer.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  columnar-app-delay-tracer.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with columnar-app-delay-tracer.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "columnar-app-delay-tracer.h"
+#include "columnar-trace-writer.h"
+
+#include <list>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+
+#include <ns3-dev/ns3/config.h>
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/names.h>
+#include <ns3-dev/ns3/node.h>
+#include <ns3-dev/ns3/node-list.h>
+#include <ns3-dev/ns3/simulator.h>
+
+NS_LOG_COMPONENT_DEFINE ("ColumnarAppDelayTracer");
+
+namespace ns3 {
+
+static std::list<Ptr<ColumnarAppDelayTracer> > g_tracers;
+
+enum
+{
+  TIME, NODE, APP_ID, SEQ_NO, TYPE, DELAY_S, DELAY_US, RETX_COUNT, HOP_COUNT
+};
+
+void
+ColumnarAppDelayTracer::InstallAll (const std::string &file)
+{
+  NodeContainer nodes;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    nodes.Add (*node);
+
+  Install (nodes, file);
+}
+
+void
+ColumnarAppDelayTracer::Install (const NodeContainer &nodes, const std::string &file)
+{
+  boost::shared_ptr<TraceSink> sink = boost::make_shared<ColumnarTraceWriter> (file);
+  if (!sink->IsGood ())
+    {
+      NS_LOG_ERROR ("Trace file " << file << " cannot be opened");
+      return;
+    }
+
+  Install (nodes, sink);
+}
+
+void
+ColumnarAppDelayTracer::Install (const NodeContainer &nodes, boost::shared_ptr<TraceSink> sink)
+{
+  AddColumns (*sink);
+
+  for (NodeContainer::Iterator node = nodes.Begin (); node != nodes.End (); node++)
+    g_tracers.push_back (Create<ColumnarAppDelayTracer> (sink, *node));
+}
+
+void
+ColumnarAppDelayTracer::Destroy ()
+{
+  g_tracers.clear ();
+}
+
+void
+ColumnarAppDelayTracer::AddColumns (TraceSink &sink)
+{
+  sink.AddColumn ("Time", TraceSink::DOUBLE, TraceSink::TIME);
+  sink.AddColumn ("Node", TraceSink::STRING, TraceSink::NODE);
+  sink.AddColumn ("AppId", TraceSink::INTEGER, TraceSink::DETAIL);
+  sink.AddColumn ("SeqNo", TraceSink::INTEGER, TraceSink::DETAIL);
+  sink.AddColumn ("Type", TraceSink::STRING, TraceSink::KEY);
+  sink.AddColumn ("DelayS", TraceSink::DOUBLE, TraceSink::MEAN);
+  sink.AddColumn ("DelayUS", TraceSink::DOUBLE, TraceSink::MEAN);
+  sink.AddColumn ("RetxCount", TraceSink::INTEGER, TraceSink::MEAN);
+  sink.AddColumn ("HopCount", TraceSink::INTEGER, TraceSink::MEAN);
+}
+
+ColumnarAppDelayTracer::ColumnarAppDelayTracer (boost::shared_ptr<TraceSink> sink, Ptr<Node> node)
+  : m_sink (sink)
+  , m_node (boost::lexical_cast<std::string> (node->GetId ()))
+{
+  std::string path = "/NodeList/" + m_node + "/ApplicationList/*/";
+  Config::ConnectWithoutContext (path + "LastRetransmittedInterestDataDelay",
+                                 MakeCallback (&ColumnarAppDelayTracer::LastRetransmittedInterestDataDelay, this));
+  Config::ConnectWithoutContext (path + "FirstInterestDataDelay",
+                                 MakeCallback (&ColumnarAppDelayTracer::FirstInterestDataDelay, this));
+
+  std::string name = Names::FindName (node);
+  if (!name.empty ())
+    m_node = name;
+}
+
+void
+ColumnarAppDelayTracer::LastRetransmittedInterestDataDelay (Ptr<ndn::App> app, uint32_t seqno, Time delay, int32_t hopCount)
+{
+  WriteRow (app, seqno, "LastDelay", delay, 1, hopCount);
+}
+
+void
+ColumnarAppDelayTracer::FirstInterestDataDelay (Ptr<ndn::App> app, uint32_t seqno, Time delay, uint32_t retxCount, int32_t hopCount)
+{
+  WriteRow (app, seqno, "FullDelay", delay, retxCount, hopCount);
+}
+
+void
+ColumnarAppDelayTracer::WriteRow (Ptr<ndn::App> app, uint32_t seqno, const char *type, Time delay,
+                                  uint32_t retxCount, int32_t hopCount)
+{
+  TraceSink &w = *m_sink;
+  w.SetDouble (TIME, Simulator::Now ().ToDouble (Time::S));
+  w.SetString (NODE, m_node);
+  w.SetInteger (APP_ID, app->GetId ());
+  w.SetInteger (SEQ_NO, seqno);
+  w.SetString (TYPE, type);
+  w.SetDouble (DELAY_S, delay.ToDouble (Time::S));
+  w.SetDouble (DELAY_US, delay.ToDouble (Time::US));
+  w.SetInteger (RETX_COUNT, retxCount);
+  w.SetInteger (HOP_COUNT, hopCount);
+  w.EndRow ();
+}
+
+} // namespace ns3
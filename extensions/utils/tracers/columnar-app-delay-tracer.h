@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  columnar-app-delay-tracer.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  columnar-app-delay-tracer.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with columnar-app-delay-tracer.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COLUMNAR_APP_DELAY_TRACER_H
+#define COLUMNAR_APP_DELAY_TRACER_H
+
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+#include <ns3-dev/ns3/node-container.h>
+#include <ns3-dev/ns3/nstime.h>
+#include <ns3-dev/ns3/ptr.h>
+#include <ns3-dev/ns3/simple-ref-count.h>
+#include <ns3-dev/ns3/ndnSIM/apps/ndn-app.h>
+
+#include "trace-sink.h"
+
+namespace ns3 {
+
+/**
+ * @brief ndn::AppDelayTracer writing to a TraceSink
+ *
+ * One row per Data packet a consumer receives, with the columns of the
+ * text tracer: Time Node AppId SeqNo Type DelayS DelayUS RetxCount
+ * HopCount. Type is LastDelay (from the last retransmission) or
+ * FullDelay (from the first Interest).
+ */
+class ColumnarAppDelayTracer : public SimpleRefCount<ColumnarAppDelayTracer>
+{
+public:
+  static void
+  InstallAll (const std::string &file);
+
+  static void
+  Install (const NodeContainer &nodes, const std::string &file);
+
+  /**
+   * @brief Trace the given nodes into a sink, such as an
+   * AggregatingTraceSink
+   */
+  static void
+  Install (const NodeContainer &nodes, boost::shared_ptr<TraceSink> sink);
+
+  static void
+  Destroy ();
+
+  ColumnarAppDelayTracer (boost::shared_ptr<TraceSink> sink, Ptr<Node> node);
+
+  static void
+  AddColumns (TraceSink &sink);
+
+private:
+  void
+  LastRetransmittedInterestDataDelay (Ptr<ndn::App> app, uint32_t seqno, Time delay, int32_t hopCount);
+
+  void
+  FirstInterestDataDelay (Ptr<ndn::App> app, uint32_t seqno, Time delay, uint32_t retxCount, int32_t hopCount);
+
+  void
+  WriteRow (Ptr<ndn::App> app, uint32_t seqno, const char *type, Time delay, uint32_t retxCount, int32_t hopCount);
+
+  boost::shared_ptr<TraceSink> m_sink;
+  std::string m_node;
+};
+
+} // namespace ns3
+
+#endif // COLUMNAR_APP_DELAY_TRACER_H
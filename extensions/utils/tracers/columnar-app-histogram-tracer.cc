@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  columnar-app-histogram-tracer.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  columnar-app-histogram-tracer.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with columnar-app-histogram-tracer.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "columnar-app-histogram-tracer.h"
+#include "columnar-trace-writer.h"
+#include "trace-schedule.h"
+
+#include <list>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+
+#include <ns3-dev/ns3/config.h>
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/names.h>
+#include <ns3-dev/ns3/node.h>
+#include <ns3-dev/ns3/node-list.h>
+#include <ns3-dev/ns3/simulator.h>
+#include <ns3-dev/ns3/ndnSIM/apps/ndn-consumer.h>
+
+NS_LOG_COMPONENT_DEFINE ("ColumnarAppHistogramTracer");
+
+namespace ns3 {
+
+static std::list<Ptr<ColumnarAppHistogramTracer> > g_tracers;
+
+enum
+{
+  TIME, NODE, APP_ID, TYPE, LOW, HIGH, COUNT
+};
+
+void
+ColumnarAppHistogramTracer::InstallAll (const std::string &file, Time period)
+{
+  NodeContainer nodes;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    nodes.Add (*node);
+
+  Install (nodes, file, period);
+}
+
+void
+ColumnarAppHistogramTracer::Install (const NodeContainer &nodes, const std::string &file, Time period)
+{
+  boost::shared_ptr<TraceSink> sink = boost::make_shared<ColumnarTraceWriter> (file);
+  if (!sink->IsGood ())
+    {
+      NS_LOG_ERROR ("Trace file " << file << " cannot be opened");
+      return;
+    }
+
+  Install (nodes, sink, period);
+}
+
+void
+ColumnarAppHistogramTracer::Install (const NodeContainer &nodes, boost::shared_ptr<TraceSink> sink, Time period)
+{
+  AddColumns (*sink);
+
+  // Only consumers have delays, so the other nodes would only add a
+  // periodic event each
+  for (NodeContainer::Iterator node = nodes.Begin (); node != nodes.End (); node++)
+    {
+      for (uint32_t i = 0; i < (*node)->GetNApplications (); i++)
+        {
+          if (DynamicCast<ndn::Consumer> ((*node)->GetApplication (i)))
+            {
+              g_tracers.push_back (Create<ColumnarAppHistogramTracer> (sink, *node, period));
+              break;
+            }
+        }
+    }
+}
+
+void
+ColumnarAppHistogramTracer::Destroy ()
+{
+  g_tracers.clear ();
+}
+
+void
+ColumnarAppHistogramTracer::AddColumns (TraceSink &sink)
+{
+  sink.AddColumn ("Time", TraceSink::DOUBLE, TraceSink::TIME);
+  sink.AddColumn ("Node", TraceSink::STRING, TraceSink::NODE);
+  sink.AddColumn ("AppId", TraceSink::INTEGER, TraceSink::DETAIL);
+  sink.AddColumn ("Type", TraceSink::STRING, TraceSink::KEY);
+  sink.AddColumn ("Low", TraceSink::INTEGER, TraceSink::KEY);
+  sink.AddColumn ("High", TraceSink::INTEGER, TraceSink::KEY);
+  sink.AddColumn ("Count", TraceSink::INTEGER, TraceSink::SUM);
+}
+
+ColumnarAppHistogramTracer::ColumnarAppHistogramTracer (boost::shared_ptr<TraceSink> sink, Ptr<Node> node, Time period)
+  : m_sink (sink)
+  , m_node (boost::lexical_cast<std::string> (node->GetId ()))
+  , m_period (period)
+{
+  std::string path = "/NodeList/" + m_node + "/ApplicationList/*/";
+  Config::ConnectWithoutContext (path + "LastRetransmittedInterestDataDelay",
+                                 MakeCallback (&ColumnarAppHistogramTracer::LastRetransmittedInterestDataDelay, this));
+  Config::ConnectWithoutContext (path + "FirstInterestDataDelay",
+                                 MakeCallback (&ColumnarAppHistogramTracer::FirstInterestDataDelay, this));
+
+  std::string name = Names::FindName (node);
+  if (!name.empty ())
+    m_node = name;
+
+  m_lastWrite = Simulator::Now ();
+  m_scheduleId = TraceSchedule::Register (MakeCallback (&ColumnarAppHistogramTracer::Wake, this));
+  m_writeEvent = Simulator::Schedule (TraceSchedule::GetDelay (m_period), &ColumnarAppHistogramTracer::PeriodicWrite, this);
+}
+
+ColumnarAppHistogramTracer::~ColumnarAppHistogramTracer ()
+{
+  m_writeEvent.Cancel ();
+  TraceSchedule::Unregister (m_scheduleId);
+}
+
+void
+ColumnarAppHistogramTracer::LastRetransmittedInterestDataDelay (Ptr<ndn::App> app, uint32_t seqno, Time delay, int32_t hopCount)
+{
+  m_apps[app->GetId ()].lastDelay.Add (delay.GetMicroSeconds ());
+}
+
+void
+ColumnarAppHistogramTracer::FirstInterestDataDelay (Ptr<ndn::App> app, uint32_t seqno, Time delay, uint32_t retxCount, int32_t hopCount)
+{
+  Histograms &histograms = m_apps[app->GetId ()];
+  histograms.fullDelay.Add (delay.GetMicroSeconds ());
+  histograms.retxCount.Add (retxCount);
+}
+
+void
+ColumnarAppHistogramTracer::PeriodicWrite ()
+{
+  double time = Simulator::Now ().ToDouble (Time::S);
+
+  // The consumers are kept once seen, so the map stops growing after
+  // the first Data of each
+  for (std::map<uint32_t, Histograms>::iterator app = m_apps.begin (); app != m_apps.end (); app++)
+    {
+      WriteHistogram (time, app->first, "FullDelay", app->second.fullDelay);
+      WriteHistogram (time, app->first, "LastDelay", app->second.lastDelay);
+      WriteHistogram (time, app->first, "RetxCount", app->second.retxCount);
+      app->second.fullDelay.Clear ();
+      app->second.lastDelay.Clear ();
+      app->second.retxCount.Clear ();
+    }
+
+  m_lastWrite = Simulator::Now ();
+  m_writeEvent = Simulator::Schedule (TraceSchedule::GetDelay (m_period), &ColumnarAppHistogramTracer::PeriodicWrite, this);
+}
+
+void
+ColumnarAppHistogramTracer::WriteHistogram (double time, uint32_t appId, const char *type, const LogHistogram &histogram)
+{
+  TraceSink &w = *m_sink;
+  const LogHistogram::Buckets &buckets = histogram.GetBuckets ();
+  for (LogHistogram::Buckets::const_iterator bucket = buckets.begin (); bucket != buckets.end (); bucket++)
+    {
+      w.SetDouble (TIME, time);
+      w.SetString (NODE, m_node);
+      w.SetInteger (APP_ID, appId);
+      w.SetString (TYPE, type);
+      w.SetInteger (LOW, histogram.GetLow (bucket->first));
+      w.SetInteger (HIGH, histogram.GetHigh (bucket->first));
+      w.SetInteger (COUNT, bucket->second);
+      w.EndRow ();
+    }
+}
+
+void
+ColumnarAppHistogramTracer::Wake ()
+{
+  // A window opened: close the coarse period now rather than at its end
+  if (Simulator::Now () > m_lastWrite && TraceSchedule::IsLate (Simulator::GetDelayLeft (m_writeEvent)))
+    {
+      m_writeEvent.Cancel ();
+      m_writeEvent = Simulator::ScheduleNow (&ColumnarAppHistogramTracer::PeriodicWrite, this);
+    }
+}
+
+} // namespace ns3
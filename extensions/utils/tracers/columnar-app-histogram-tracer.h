@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  columnar-app-histogram-tracer.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  columnar-app-histogram-tracer.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with columnar-app-histogram-tracer.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COLUMNAR_APP_HISTOGRAM_TRACER_H
+#define COLUMNAR_APP_HISTOGRAM_TRACER_H
+
+#include <map>
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+#include <ns3-dev/ns3/event-id.h>
+#include <ns3-dev/ns3/node-container.h>
+#include <ns3-dev/ns3/nstime.h>
+#include <ns3-dev/ns3/ptr.h>
+#include <ns3-dev/ns3/simple-ref-count.h>
+#include <ns3-dev/ns3/ndnSIM/apps/ndn-app.h>
+
+#include "log-histogram.h"
+#include "trace-sink.h"
+
+namespace ns3 {
+
+/**
+ * @brief Delays of the consumers as histograms, in place of a row per
+ * Data packet
+ *
+ * Every period, one row per non-empty bucket of the LogHistogram of each
+ * consumer and Type: Time Node AppId Type Low High Count. Type is
+ * FullDelay or LastDelay, as with ColumnarAppDelayTracer, with the
+ * bucket bounds in microseconds, or RetxCount, counting the
+ * retransmissions of each Data. High is included in the bucket.
+ *
+ * The percentiles of any set of rows are those of the LogHistogram
+ * holding their counts, within the 1.6% width of the buckets. Low and
+ * High are integer keys, so an AggregatingTraceSink adds the counts of a
+ * bucket over the consumers of a node.
+ *
+ * Only the nodes running an ndn::Consumer are traced, so the
+ * applications have to be installed first.
+ */
+class ColumnarAppHistogramTracer : public SimpleRefCount<ColumnarAppHistogramTracer>
+{
+public:
+  static void
+  InstallAll (const std::string &file, Time period);
+
+  static void
+  Install (const NodeContainer &nodes, const std::string &file, Time period);
+
+  /**
+   * @brief Trace the given nodes into a sink, such as an
+   * AggregatingTraceSink
+   */
+  static void
+  Install (const NodeContainer &nodes, boost::shared_ptr<TraceSink> sink, Time period);
+
+  static void
+  Destroy ();
+
+  ColumnarAppHistogramTracer (boost::shared_ptr<TraceSink> sink, Ptr<Node> node, Time period);
+
+  ~ColumnarAppHistogramTracer ();
+
+  static void
+  AddColumns (TraceSink &sink);
+
+private:
+  struct Histograms
+  {
+    LogHistogram fullDelay;
+    LogHistogram lastDelay;
+    LogHistogram retxCount;
+  };
+
+  void
+  LastRetransmittedInterestDataDelay (Ptr<ndn::App> app, uint32_t seqno, Time delay, int32_t hopCount);
+
+  void
+  FirstInterestDataDelay (Ptr<ndn::App> app, uint32_t seqno, Time delay, uint32_t retxCount, int32_t hopCount);
+
+  void
+  PeriodicWrite ();
+
+  void
+  WriteHistogram (double time, uint32_t appId, const char *type, const LogHistogram &histogram);
+
+  void
+  Wake ();
+
+  boost::shared_ptr<TraceSink> m_sink;
+  std::string m_node;
+  Time m_period;
+  EventId m_writeEvent;
+  Time m_lastWrite;
+  uint32_t m_scheduleId;
+  std::map<uint32_t, Histograms> m_apps;
+};
+
+} // namespace ns3
+
+#endif // COLUMNAR_APP_HISTOGRAM_TRACER_H
@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  columnar-cs-tracer.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  columnar-cs-tracer.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with columnar-cs-tracer.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "columnar-cs-tracer.h"
+#include "columnar-trace-writer.h"
+#include "trace-schedule.h"
+
+#include <list>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/names.h>
+#include <ns3-dev/ns3/node.h>
+#include <ns3-dev/ns3/node-list.h>
+#include <ns3-dev/ns3/simulator.h>
+#include <ns3-dev/ns3/ndnSIM/model/cs/ndn-content-store.h>
+
+NS_LOG_COMPONENT_DEFINE ("ColumnarCsTracer");
+
+namespace ns3 {
+
+static std::list<Ptr<ColumnarCsTracer> > g_tracers;
+
+enum
+{
+  TIME, NODE, TYPE, PACKETS
+};
+
+void
+ColumnarCsTracer::InstallAll (const std::string &file, Time period)
+{
+  NodeContainer nodes;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    nodes.Add (*node);
+
+  Install (nodes, file, period);
+}
+
+void
+ColumnarCsTracer::Install (const NodeContainer &nodes, const std::string &file, Time period)
+{
+  boost::shared_ptr<TraceSink> sink = boost::make_shared<ColumnarTraceWriter> (file);
+  if (!sink->IsGood ())
+    {
+      NS_LOG_ERROR ("Trace file " << file << " cannot be opened");
+      return;
+    }
+
+  Install (nodes, sink, period);
+}
+
+void
+ColumnarCsTracer::Install (const NodeContainer &nodes, boost::shared_ptr<TraceSink> sink, Time period)
+{
+  AddColumns (*sink);
+
+  for (NodeContainer::Iterator node = nodes.Begin (); node != nodes.End (); node++)
+    {
+      // Nodes without NDN have nothing to trace
+      if ((*node)->GetObject<ndn::ContentStore> () == 0)
+        continue;
+      g_tracers.push_back (Create<ColumnarCsTracer> (sink, *node, period));
+    }
+}
+
+void
+ColumnarCsTracer::Destroy ()
+{
+  g_tracers.clear ();
+}
+
+void
+ColumnarCsTracer::AddColumns (TraceSink &sink)
+{
+  sink.AddColumn ("Time", TraceSink::DOUBLE, TraceSink::TIME);
+  sink.AddColumn ("Node", TraceSink::STRING, TraceSink::NODE);
+  sink.AddColumn ("Type", TraceSink::STRING, TraceSink::KEY);
+  sink.AddColumn ("Packets", TraceSink::INTEGER, TraceSink::SUM);
+}
+
+ColumnarCsTracer::ColumnarCsTracer (boost::shared_ptr<TraceSink> sink, Ptr<Node> node, Time period)
+  : m_sink (sink)
+  , m_node (boost::lexical_cast<std::string> (node->GetId ()))
+  , m_period (period)
+  , m_cacheHits (0)
+  , m_cacheMisses (0)
+{
+  Ptr<ndn::ContentStore> cs = node->GetObject<ndn::ContentStore> ();
+  cs->TraceConnectWithoutContext ("CacheHits", MakeCallback (&ColumnarCsTracer::CacheHits, this));
+  cs->TraceConnectWithoutContext ("CacheMisses", MakeCallback (&ColumnarCsTracer::CacheMisses, this));
+
+  std::string name = Names::FindName (node);
+  if (!name.empty ())
+    m_node = name;
+
+  m_lastWrite = Simulator::Now ();
+  m_scheduleId = TraceSchedule::Register (MakeCallback (&ColumnarCsTracer::Wake, this));
+  m_writeEvent = Simulator::Schedule (TraceSchedule::GetDelay (m_period), &ColumnarCsTracer::PeriodicWrite, this);
+}
+
+ColumnarCsTracer::~ColumnarCsTracer ()
+{
+  m_writeEvent.Cancel ();
+  TraceSchedule::Unregister (m_scheduleId);
+}
+
+void
+ColumnarCsTracer::CacheHits (Ptr<const ndn::Interest>, Ptr<const ndn::Data>)
+{
+  m_cacheHits++;
+}
+
+void
+ColumnarCsTracer::CacheMisses (Ptr<const ndn::Interest>)
+{
+  m_cacheMisses++;
+}
+
+void
+ColumnarCsTracer::PeriodicWrite ()
+{
+  TraceSink &w = *m_sink;
+  double time = Simulator::Now ().ToDouble (Time::S);
+
+  w.SetDouble (TIME, time);
+  w.SetString (NODE, m_node);
+  w.SetString (TYPE, "CacheHits");
+  w.SetInteger (PACKETS, m_cacheHits);
+  w.EndRow ();
+
+  w.SetDouble (TIME, time);
+  w.SetString (NODE, m_node);
+  w.SetString (TYPE, "CacheMisses");
+  w.SetInteger (PACKETS, m_cacheMisses);
+  w.EndRow ();
+
+  m_cacheHits = 0;
+  m_cacheMisses = 0;
+  m_lastWrite = Simulator::Now ();
+  m_writeEvent = Simulator::Schedule (TraceSchedule::GetDelay (m_period), &ColumnarCsTracer::PeriodicWrite, this);
+}
+
+void
+ColumnarCsTracer::Wake ()
+{
+  // A window opened: close the coarse period now rather than at its end
+  if (Simulator::Now () > m_lastWrite && TraceSchedule::IsLate (Simulator::GetDelayLeft (m_writeEvent)))
+    {
+      m_writeEvent.Cancel ();
+      m_writeEvent = Simulator::ScheduleNow (&ColumnarCsTracer::PeriodicWrite, this);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  columnar-cs-tracer.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  columnar-cs-tracer.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with columnar-cs-tracer.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COLUMNAR_CS_TRACER_H
+#define COLUMNAR_CS_TRACER_H
+
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+#include <ns3-dev/ns3/event-id.h>
+#include <ns3-dev/ns3/node-container.h>
+#include <ns3-dev/ns3/nstime.h>
+#include <ns3-dev/ns3/ptr.h>
+#include <ns3-dev/ns3/simple-ref-count.h>
+#include <ns3-dev/ns3/ndnSIM/model/ndn-interest.h>
+#include <ns3-dev/ns3/ndnSIM/model/ndn-data.h>
+
+#include "trace-sink.h"
+
+namespace ns3 {
+
+/**
+ * @brief ndn::CsTracer writing to a TraceSink
+ *
+ * Every period, the Content Store hits and misses of the period as
+ * rows Time Node Type Packets, Type being CacheHits or CacheMisses.
+ * The periods are shortened around events when TraceSchedule is
+ * enabled.
+ */
+class ColumnarCsTracer : public SimpleRefCount<ColumnarCsTracer>
+{
+public:
+  static void
+  InstallAll (const std::string &file, Time period);
+
+  static void
+  Install (const NodeContainer &nodes, const std::string &file, Time period);
+
+  /**
+   * @brief Trace the given nodes into a sink, such as an
+   * AggregatingTraceSink
+   */
+  static void
+  Install (const NodeContainer &nodes, boost::shared_ptr<TraceSink> sink, Time period);
+
+  static void
+  Destroy ();
+
+  ColumnarCsTracer (boost::shared_ptr<TraceSink> sink, Ptr<Node> node, Time period);
+
+  ~ColumnarCsTracer ();
+
+  static void
+  AddColumns (TraceSink &sink);
+
+private:
+  void
+  CacheHits (Ptr<const ndn::Interest>, Ptr<const ndn::Data>);
+
+  void
+  CacheMisses (Ptr<const ndn::Interest>);
+
+  void
+  PeriodicWrite ();
+
+  void
+  Wake ();
+
+  boost::shared_ptr<TraceSink> m_sink;
+  std::string m_node;
+  Time m_period;
+  EventId m_writeEvent;
+  Time m_lastWrite;
+  uint32_t m_scheduleId;
+  uint64_t m_cacheHits;
+  uint64_t m_cacheMisses;
+};
+
+} // namespace ns3
+
+#endif // COLUMNAR_CS_TRACER_H
@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  columnar-l2-tracer.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  columnar-l2-tracer.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with columnar-l2-tracer.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "columnar-l2-tracer.h"
+#include "columnar-trace-writer.h"
+#include "trace-schedule.h"
+
+#include <list>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/names.h>
+#include <ns3-dev/ns3/node.h>
+#include <ns3-dev/ns3/node-list.h>
+#include <ns3-dev/ns3/point-to-point-net-device.h>
+#include <ns3-dev/ns3/queue.h>
+#include <ns3-dev/ns3/simulator.h>
+
+NS_LOG_COMPONENT_DEFINE ("ColumnarL2Tracer");
+
+namespace ns3 {
+
+static std::list<Ptr<ColumnarL2Tracer> > g_tracers;
+
+// Weight of the newest period in the smoothed rates, as in L2RateTracer
+static const double alpha = 0.8;
+
+enum
+{
+  TIME, NODE, INTERFACE, TYPE, PACKETS, KILOBYTES, PACKETS_RAW, KILOBYTES_RAW
+};
+
+void
+ColumnarL2Tracer::InstallAll (const std::string &file, Time period)
+{
+  NodeContainer nodes;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    nodes.Add (*node);
+
+  Install (nodes, file, period);
+}
+
+void
+ColumnarL2Tracer::Install (const NodeContainer &nodes, const std::string &file, Time period)
+{
+  boost::shared_ptr<TraceSink> sink = boost::make_shared<ColumnarTraceWriter> (file);
+  if (!sink->IsGood ())
+    {
+      NS_LOG_ERROR ("Trace file " << file << " cannot be opened");
+      return;
+    }
+
+  Install (nodes, sink, period);
+}
+
+void
+ColumnarL2Tracer::Install (const NodeContainer &nodes, boost::shared_ptr<TraceSink> sink, Time period)
+{
+  AddColumns (*sink);
+
+  for (NodeContainer::Iterator node = nodes.Begin (); node != nodes.End (); node++)
+    g_tracers.push_back (Create<ColumnarL2Tracer> (sink, *node, period));
+}
+
+void
+ColumnarL2Tracer::Destroy ()
+{
+  g_tracers.clear ();
+}
+
+void
+ColumnarL2Tracer::AddColumns (TraceSink &sink)
+{
+  sink.AddColumn ("Time", TraceSink::DOUBLE, TraceSink::TIME);
+  sink.AddColumn ("Node", TraceSink::STRING, TraceSink::NODE);
+  sink.AddColumn ("Interface", TraceSink::STRING, TraceSink::KEY);
+  sink.AddColumn ("Type", TraceSink::STRING, TraceSink::KEY);
+  sink.AddColumn ("Packets", TraceSink::DOUBLE, TraceSink::SUM);
+  sink.AddColumn ("Kilobytes", TraceSink::DOUBLE, TraceSink::SUM);
+  sink.AddColumn ("PacketsRaw", TraceSink::DOUBLE, TraceSink::SUM);
+  sink.AddColumn ("KilobytesRaw", TraceSink::DOUBLE, TraceSink::SUM);
+}
+
+ColumnarL2Tracer::ColumnarL2Tracer (boost::shared_ptr<TraceSink> sink, Ptr<Node> node, Time period)
+  : m_sink (sink)
+  , m_node (boost::lexical_cast<std::string> (node->GetId ()))
+  , m_period (period)
+  , m_packets (0)
+  , m_bytes (0)
+  , m_packetRate (0)
+  , m_kilobyteRate (0)
+{
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      Ptr<PointToPointNetDevice> device = DynamicCast<PointToPointNetDevice> (node->GetDevice (i));
+      if (device != 0)
+        device->GetQueue ()->TraceConnectWithoutContext ("Drop", MakeCallback (&ColumnarL2Tracer::Drop, this));
+    }
+
+  std::string name = Names::FindName (node);
+  if (!name.empty ())
+    m_node = name;
+
+  m_lastWrite = Simulator::Now ();
+  m_scheduleId = TraceSchedule::Register (MakeCallback (&ColumnarL2Tracer::Wake, this));
+  m_writeEvent = Simulator::Schedule (TraceSchedule::GetDelay (m_period), &ColumnarL2Tracer::PeriodicWrite, this);
+}
+
+ColumnarL2Tracer::~ColumnarL2Tracer ()
+{
+  m_writeEvent.Cancel ();
+  TraceSchedule::Unregister (m_scheduleId);
+}
+
+void
+ColumnarL2Tracer::Drop (Ptr<const Packet> packet)
+{
+  m_packets++;
+  m_bytes += packet->GetSize ();
+}
+
+void
+ColumnarL2Tracer::PeriodicWrite ()
+{
+  double seconds = (Simulator::Now () - m_lastWrite).ToDouble (Time::S);
+  m_packetRate = alpha * m_packets / seconds + (1 - alpha) * m_packetRate;
+  m_kilobyteRate = alpha * m_bytes / seconds / 1024.0 + (1 - alpha) * m_kilobyteRate;
+
+  TraceSink &w = *m_sink;
+  w.SetDouble (TIME, Simulator::Now ().ToDouble (Time::S));
+  w.SetString (NODE, m_node);
+  w.SetString (INTERFACE, "combined");
+  w.SetString (TYPE, "Drop");
+  w.SetDouble (PACKETS, m_packetRate);
+  w.SetDouble (KILOBYTES, m_kilobyteRate);
+  w.SetDouble (PACKETS_RAW, m_packets);
+  w.SetDouble (KILOBYTES_RAW, m_bytes / 1024.0);
+  w.EndRow ();
+
+  m_packets = 0;
+  m_bytes = 0;
+  m_lastWrite = Simulator::Now ();
+  m_writeEvent = Simulator::Schedule (TraceSchedule::GetDelay (m_period), &ColumnarL2Tracer::PeriodicWrite, this);
+}
+
+void
+ColumnarL2Tracer::Wake ()
+{
+  // A window opened: close the coarse period now rather than at its end
+  if (Simulator::Now () > m_lastWrite && TraceSchedule::IsLate (Simulator::GetDelayLeft (m_writeEvent)))
+    {
+      m_writeEvent.Cancel ();
+      m_writeEvent = Simulator::ScheduleNow (&ColumnarL2Tracer::PeriodicWrite, this);
+    }
+}
+
+} // namespace ns3
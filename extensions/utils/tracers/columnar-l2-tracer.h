@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  columnar-l2-tracer.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  columnar-l2-tracer.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with columnar-l2-tracer.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COLUMNAR_L2_TRACER_H
+#define COLUMNAR_L2_TRACER_H
+
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+#include <ns3-dev/ns3/event-id.h>
+#include <ns3-dev/ns3/node-container.h>
+#include <ns3-dev/ns3/nstime.h>
+#include <ns3-dev/ns3/packet.h>
+#include <ns3-dev/ns3/ptr.h>
+#include <ns3-dev/ns3/simple-ref-count.h>
+
+#include "trace-sink.h"
+
+namespace ns3 {
+
+/**
+ * @brief L2RateTracer writing to a TraceSink
+ *
+ * Counts the packets the point-to-point transmit queues of a node drop.
+ * Every period one row Time Node Interface Type Packets Kilobytes
+ * PacketsRaw KilobytesRaw, with Interface "combined" and Type "Drop":
+ * smoothed rates, then the counts of the period. The periods are
+ * shortened around events when TraceSchedule is enabled.
+ */
+class ColumnarL2Tracer : public SimpleRefCount<ColumnarL2Tracer>
+{
+public:
+  static void
+  InstallAll (const std::string &file, Time period);
+
+  static void
+  Install (const NodeContainer &nodes, const std::string &file, Time period);
+
+  /**
+   * @brief Trace the given nodes into a sink, such as an
+   * AggregatingTraceSink
+   */
+  static void
+  Install (const NodeContainer &nodes, boost::shared_ptr<TraceSink> sink, Time period);
+
+  static void
+  Destroy ();
+
+  ColumnarL2Tracer (boost::shared_ptr<TraceSink> sink, Ptr<Node> node, Time period);
+
+  ~ColumnarL2Tracer ();
+
+  static void
+  AddColumns (TraceSink &sink);
+
+private:
+  void
+  Drop (Ptr<const Packet> packet);
+
+  void
+  PeriodicWrite ();
+
+  void
+  Wake ();
+
+  boost::shared_ptr<TraceSink> m_sink;
+  std::string m_node;
+  Time m_period;
+  EventId m_writeEvent;
+  Time m_lastWrite;
+  uint32_t m_scheduleId;
+  double m_packets;
+  double m_bytes;
+  double m_packetRate;
+  double m_kilobyteRate;
+};
+
+} // namespace ns3
+
+#endif // COLUMNAR_L2_TRACER_H
@@ -0,0 +1,346 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  columnar-l3-tracer.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  columnar-l3-tracer.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with columnar-l3-tracer.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "columnar-l3-tracer.h"
+#include "columnar-trace-writer.h"
+#include "trace-schedule.h"
+
+#include <list>
+#include <sstream>
+
+#include <boost/make_shared.hpp>
+
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/node-list.h>
+#include <ns3-dev/ns3/packet.h>
+#include <ns3-dev/ns3/simulator.h>
+#include <ns3-dev/ns3/ndnSIM/model/ndn-face.h>
+#include <ns3-dev/ns3/ndnSIM/model/ndn-interest.h>
+#include <ns3-dev/ns3/ndnSIM/model/ndn-data.h>
+#include <ns3-dev/ns3/ndnSIM/model/pit/ndn-pit-entry.h>
+
+NS_LOG_COMPONENT_DEFINE ("ColumnarL3Tracer");
+
+namespace ns3 {
+
+static std::list<Ptr<ColumnarL3Tracer> > g_tracers;
+
+// Weight of the newest period in the smoothed rates, as in L3RateTracer
+static const double alpha = 0.8;
+
+static const char *counterNames[] = {
+  "InInterests", "OutInterests", "DropInterests",
+  "InNacks", "OutNacks", "DropNacks",
+  "InData", "OutData", "DropData",
+  "InSatisfiedInterests", "InTimedOutInterests",
+  "OutSatisfiedInterests", "OutTimedOutInterests"
+};
+
+// Column indices, in the order AddColumns declares them
+enum
+{
+  TIME, NODE, FACE_ID, FACE_DESCR, TYPE, PACKETS, KILOBYTES, PACKET_RAW, KILOBYTES_RAW
+};
+
+void
+ColumnarL3Tracer::InstallAll (const std::string &file, Time period, Mode mode)
+{
+  NodeContainer nodes;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    nodes.Add (*node);
+
+  Install (nodes, file, period, mode);
+}
+
+void
+ColumnarL3Tracer::Install (const NodeContainer &nodes, const std::string &file, Time period, Mode mode)
+{
+  boost::shared_ptr<TraceSink> sink = boost::make_shared<ColumnarTraceWriter> (file);
+  if (!sink->IsGood ())
+    {
+      NS_LOG_ERROR ("Trace file " << file << " cannot be opened");
+      return;
+    }
+
+  Install (nodes, sink, period, mode);
+}
+
+void
+ColumnarL3Tracer::Install (const NodeContainer &nodes, boost::shared_ptr<TraceSink> sink, Time period, Mode mode)
+{
+  AddColumns (*sink, mode);
+
+  for (NodeContainer::Iterator node = nodes.Begin (); node != nodes.End (); node++)
+    g_tracers.push_back (Create<ColumnarL3Tracer> (sink, *node, period, mode));
+}
+
+void
+ColumnarL3Tracer::Destroy ()
+{
+  g_tracers.clear ();
+}
+
+void
+ColumnarL3Tracer::AddColumns (TraceSink &sink, Mode mode)
+{
+  sink.AddColumn ("Time", TraceSink::DOUBLE, TraceSink::TIME);
+  sink.AddColumn ("Node", TraceSink::STRING, TraceSink::NODE);
+  sink.AddColumn ("FaceId", TraceSink::INTEGER, TraceSink::DETAIL);
+  sink.AddColumn ("FaceDescr", TraceSink::STRING, TraceSink::DETAIL);
+  sink.AddColumn ("Type", TraceSink::STRING, TraceSink::KEY);
+  sink.AddColumn ("Packets", TraceSink::DOUBLE, TraceSink::SUM);
+  sink.AddColumn ("Kilobytes", TraceSink::DOUBLE, TraceSink::SUM);
+  if (mode == RATE)
+    {
+      sink.AddColumn ("PacketRaw", TraceSink::DOUBLE, TraceSink::SUM);
+      sink.AddColumn ("KilobytesRaw", TraceSink::DOUBLE, TraceSink::SUM);
+    }
+}
+
+ColumnarL3Tracer::FaceStats::FaceStats ()
+{
+  for (int i = 0; i < COUNTERS; i++)
+    {
+      m_packets[i] = 0;
+      m_bytes[i] = 0;
+      m_packetRate[i] = 0;
+      m_kilobyteRate[i] = 0;
+    }
+}
+
+ColumnarL3Tracer::ColumnarL3Tracer (boost::shared_ptr<TraceSink> sink, Ptr<Node> node, Time period, Mode mode)
+  : ndn::L3Tracer (node)
+  , m_sink (sink)
+  , m_period (period)
+  , m_mode (mode)
+{
+  m_lastWrite = Simulator::Now ();
+  m_scheduleId = TraceSchedule::Register (MakeCallback (&ColumnarL3Tracer::Wake, this));
+  m_writeEvent = Simulator::Schedule (TraceSchedule::GetDelay (m_period), &ColumnarL3Tracer::PeriodicWrite, this);
+}
+
+ColumnarL3Tracer::~ColumnarL3Tracer ()
+{
+  m_writeEvent.Cancel ();
+  TraceSchedule::Unregister (m_scheduleId);
+}
+
+void
+ColumnarL3Tracer::PrintHeader (std::ostream &os) const
+{
+  os << "Time" << "\t" << "Node" << "\t" << "FaceId" << "\t" << "FaceDescr" << "\t"
+     << "Type" << "\t" << "Packets" << "\t" << "Kilobytes";
+  if (m_mode == RATE)
+    os << "\t" << "PacketRaw" << "\t" << "KilobytesRaw";
+}
+
+void
+ColumnarL3Tracer::Print (std::ostream &os) const
+{
+}
+
+void
+ColumnarL3Tracer::Count (Ptr<const ndn::Face> face, Counter counter, Ptr<const Packet> wire)
+{
+  FaceStats &stats = m_stats[face];
+  stats.m_packets[counter]++;
+  if (wire)
+    stats.m_bytes[counter] += wire->GetSize ();
+}
+
+void
+ColumnarL3Tracer::OutInterests (Ptr<const ndn::Interest> interest, Ptr<const ndn::Face> face)
+{
+  Count (face, OUT_INTERESTS, interest->GetWire ());
+}
+
+void
+ColumnarL3Tracer::InInterests (Ptr<const ndn::Interest> interest, Ptr<const ndn::Face> face)
+{
+  Count (face, IN_INTERESTS, interest->GetWire ());
+}
+
+void
+ColumnarL3Tracer::DropInterests (Ptr<const ndn::Interest> interest, Ptr<const ndn::Face> face)
+{
+  Count (face, DROP_INTERESTS, interest->GetWire ());
+}
+
+void
+ColumnarL3Tracer::OutNacks (Ptr<const ndn::Interest> nack, Ptr<const ndn::Face> face)
+{
+  Count (face, OUT_NACKS, nack->GetWire ());
+}
+
+void
+ColumnarL3Tracer::InNacks (Ptr<const ndn::Interest> nack, Ptr<const ndn::Face> face)
+{
+  Count (face, IN_NACKS, nack->GetWire ());
+}
+
+void
+ColumnarL3Tracer::DropNacks (Ptr<const ndn::Interest> nack, Ptr<const ndn::Face> face)
+{
+  Count (face, DROP_NACKS, nack->GetWire ());
+}
+
+void
+ColumnarL3Tracer::OutData (Ptr<const ndn::Data> data, bool fromCache, Ptr<const ndn::Face> face)
+{
+  Count (face, OUT_DATA, data->GetWire ());
+}
+
+void
+ColumnarL3Tracer::InData (Ptr<const ndn::Data> data, Ptr<const ndn::Face> face)
+{
+  Count (face, IN_DATA, data->GetWire ());
+}
+
+void
+ColumnarL3Tracer::DropData (Ptr<const ndn::Data> data, Ptr<const ndn::Face> face)
+{
+  Count (face, DROP_DATA, data->GetWire ());
+}
+
+void
+ColumnarL3Tracer::SatisfiedInterests (Ptr<const ndn::pit::Entry> entry)
+{
+  // The node wide count goes under the null face, as in the text tracers
+  Count (0, SATISFIED_INTERESTS, 0);
+
+  for (ndn::pit::Entry::in_container::const_iterator i = entry->GetIncoming ().begin ();
+       i != entry->GetIncoming ().end (); i++)
+    Count (i->m_face, SATISFIED_INTERESTS, 0);
+
+  for (ndn::pit::Entry::out_container::const_iterator i = entry->GetOutgoing ().begin ();
+       i != entry->GetOutgoing ().end (); i++)
+    Count (i->m_face, OUT_SATISFIED_INTERESTS, 0);
+}
+
+void
+ColumnarL3Tracer::TimedOutInterests (Ptr<const ndn::pit::Entry> entry)
+{
+  Count (0, TIMED_OUT_INTERESTS, 0);
+
+  for (ndn::pit::Entry::in_container::const_iterator i = entry->GetIncoming ().begin ();
+       i != entry->GetIncoming ().end (); i++)
+    Count (i->m_face, TIMED_OUT_INTERESTS, 0);
+
+  for (ndn::pit::Entry::out_container::const_iterator i = entry->GetOutgoing ().begin ();
+       i != entry->GetOutgoing ().end (); i++)
+    Count (i->m_face, OUT_TIMED_OUT_INTERESTS, 0);
+}
+
+void
+ColumnarL3Tracer::WriteRow (double time, Ptr<const ndn::Face> face, const std::string &faceDescr,
+                            Counter counter, FaceStats &stats)
+{
+  TraceSink &w = *m_sink;
+  w.SetDouble (TIME, time);
+  w.SetString (NODE, m_node);
+  w.SetInteger (FACE_ID, face ? (int64_t) face->GetId () : -1);
+  w.SetString (FACE_DESCR, faceDescr);
+
+  // The node wide entry has no In/Out prefix
+  if (!face && counter == SATISFIED_INTERESTS)
+    w.SetString (TYPE, "SatisfiedInterests");
+  else if (!face && counter == TIMED_OUT_INTERESTS)
+    w.SetString (TYPE, "TimedOutInterests");
+  else
+    w.SetString (TYPE, counterNames[counter]);
+
+  if (m_mode == RATE)
+    {
+      double seconds = (Simulator::Now () - m_lastWrite).ToDouble (Time::S);
+      stats.m_packetRate[counter] = alpha * stats.m_packets[counter] / seconds
+        + (1 - alpha) * stats.m_packetRate[counter];
+      stats.m_kilobyteRate[counter] = alpha * stats.m_bytes[counter] / seconds / 1024.0
+        + (1 - alpha) * stats.m_kilobyteRate[counter];
+
+      w.SetDouble (PACKETS, stats.m_packetRate[counter]);
+      w.SetDouble (KILOBYTES, stats.m_kilobyteRate[counter]);
+      w.SetDouble (PACKET_RAW, stats.m_packets[counter]);
+      w.SetDouble (KILOBYTES_RAW, stats.m_bytes[counter] / 1024.0);
+    }
+  else
+    {
+      w.SetDouble (PACKETS, stats.m_packets[counter]);
+      w.SetDouble (KILOBYTES, stats.m_bytes[counter] / 1024.0);
+    }
+  w.EndRow ();
+}
+
+void
+ColumnarL3Tracer::PeriodicWrite ()
+{
+  double time = Simulator::Now ().ToDouble (Time::S);
+  int last = (m_mode == RATE) ? OUT_TIMED_OUT_INTERESTS : DROP_DATA;
+
+  for (std::map<Ptr<const ndn::Face>, FaceStats>::iterator stats = m_stats.begin ();
+       stats != m_stats.end (); stats++)
+    {
+      if (!stats->first)
+        continue;
+
+      std::map<Ptr<const ndn::Face>, std::string>::iterator descr = m_faceDescr.find (stats->first);
+      if (descr == m_faceDescr.end ())
+        {
+          std::ostringstream os;
+          os << *stats->first;
+          descr = m_faceDescr.insert (std::make_pair (stats->first, os.str ())).first;
+        }
+
+      for (int counter = IN_INTERESTS; counter <= last; counter++)
+        WriteRow (time, stats->first, descr->second, (Counter) counter, stats->second);
+    }
+
+  std::map<Ptr<const ndn::Face>, FaceStats>::iterator all = m_stats.find (Ptr<const ndn::Face> (0));
+  if (all != m_stats.end ())
+    {
+      WriteRow (time, 0, "all", SATISFIED_INTERESTS, all->second);
+      WriteRow (time, 0, "all", TIMED_OUT_INTERESTS, all->second);
+    }
+
+  // Only the rates carry over to the next period
+  for (std::map<Ptr<const ndn::Face>, FaceStats>::iterator stats = m_stats.begin ();
+       stats != m_stats.end (); stats++)
+    {
+      for (int i = 0; i < COUNTERS; i++)
+        {
+          stats->second.m_packets[i] = 0;
+          stats->second.m_bytes[i] = 0;
+        }
+    }
+
+  m_lastWrite = Simulator::Now ();
+  m_writeEvent = Simulator::Schedule (TraceSchedule::GetDelay (m_period), &ColumnarL3Tracer::PeriodicWrite, this);
+}
+
+void
+ColumnarL3Tracer::Wake ()
+{
+  // A window opened: close the coarse period now rather than at its end
+  if (Simulator::Now () > m_lastWrite && TraceSchedule::IsLate (Simulator::GetDelayLeft (m_writeEvent)))
+    {
+      m_writeEvent.Cancel ();
+      m_writeEvent = Simulator::ScheduleNow (&ColumnarL3Tracer::PeriodicWrite, this);
+    }
+}
+
+} // namespace ns3
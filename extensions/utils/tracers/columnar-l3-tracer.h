@@ -0,0 +1,198 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  columnar-l3-tracer.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  columnar-l3-tracer.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with columnar-l3-tracer.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COLUMNAR_L3_TRACER_H
+#define COLUMNAR_L3_TRACER_H
+
+#include <map>
+#include <ostream>
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+#include <ns3-dev/ns3/event-id.h>
+#include <ns3-dev/ns3/node-container.h>
+#include <ns3-dev/ns3/nstime.h>
+#include <ns3-dev/ns3/ndnSIM/utils/tracers/ndn-l3-tracer.h>
+
+#include "trace-sink.h"
+
+namespace ns3 {
+
+/**
+ * @brief ndn::L3AggregateTracer and ndn::L3RateTracer writing to a
+ * TraceSink
+ *
+ * The columns are those of the text tracers, so ColumnarTraceReader
+ * prints the same table: Time Node FaceId FaceDescr Type Packets
+ * Kilobytes, and for RATE also PacketRaw KilobytesRaw. Packets and
+ * Kilobytes are the counts of the period for AGGREGATE, and rates
+ * smoothed over the periods for RATE. Node, FaceDescr and Type are
+ * dictionary encoded. The periods are shortened around events when
+ * TraceSchedule is enabled, the rates staying per second.
+ */
+class ColumnarL3Tracer : public ndn::L3Tracer
+{
+public:
+  enum Mode
+  {
+    AGGREGATE,
+    RATE
+  };
+
+  /**
+   * @brief Trace every node into one file
+   */
+  static void
+  InstallAll (const std::string &file, Time period, Mode mode);
+
+  /**
+   * @brief Trace the given nodes into one file
+   */
+  static void
+  Install (const NodeContainer &nodes, const std::string &file, Time period, Mode mode);
+
+  /**
+   * @brief Trace the given nodes into a sink, such as an
+   * AggregatingTraceSink
+   */
+  static void
+  Install (const NodeContainer &nodes, boost::shared_ptr<TraceSink> sink, Time period, Mode mode);
+
+  /**
+   * @brief Remove all the tracers and close their files
+   */
+  static void
+  Destroy ();
+
+  ColumnarL3Tracer (boost::shared_ptr<TraceSink> sink, Ptr<Node> node, Time period, Mode mode);
+
+  virtual
+  ~ColumnarL3Tracer ();
+
+  /**
+   * @brief Declare the columns. Called once per file
+   */
+  static void
+  AddColumns (TraceSink &sink, Mode mode);
+
+  /**
+   * @brief Print the header of the text tracer
+   */
+  virtual void
+  PrintHeader (std::ostream &os) const;
+
+  /**
+   * @brief The rows go to the sink, so this prints nothing
+   */
+  virtual void
+  Print (std::ostream &os) const;
+
+protected:
+  virtual void
+  OutInterests (Ptr<const ndn::Interest>, Ptr<const ndn::Face>);
+
+  virtual void
+  InInterests (Ptr<const ndn::Interest>, Ptr<const ndn::Face>);
+
+  virtual void
+  DropInterests (Ptr<const ndn::Interest>, Ptr<const ndn::Face>);
+
+  virtual void
+  OutNacks (Ptr<const ndn::Interest>, Ptr<const ndn::Face>);
+
+  virtual void
+  InNacks (Ptr<const ndn::Interest>, Ptr<const ndn::Face>);
+
+  virtual void
+  DropNacks (Ptr<const ndn::Interest>, Ptr<const ndn::Face>);
+
+  virtual void
+  OutData (Ptr<const ndn::Data>, bool fromCache, Ptr<const ndn::Face>);
+
+  virtual void
+  InData (Ptr<const ndn::Data>, Ptr<const ndn::Face>);
+
+  virtual void
+  DropData (Ptr<const ndn::Data>, Ptr<const ndn::Face>);
+
+  virtual void
+  SatisfiedInterests (Ptr<const ndn::pit::Entry>);
+
+  virtual void
+  TimedOutInterests (Ptr<const ndn::pit::Entry>);
+
+private:
+  enum Counter
+  {
+    IN_INTERESTS,
+    OUT_INTERESTS,
+    DROP_INTERESTS,
+    IN_NACKS,
+    OUT_NACKS,
+    DROP_NACKS,
+    IN_DATA,
+    OUT_DATA,
+    DROP_DATA,
+    SATISFIED_INTERESTS,
+    TIMED_OUT_INTERESTS,
+    OUT_SATISFIED_INTERESTS,
+    OUT_TIMED_OUT_INTERESTS,
+    COUNTERS
+  };
+
+  /**
+   * @brief Packets and bytes of one face in the current period, and the
+   * smoothed rates for RATE
+   */
+  struct FaceStats
+  {
+    FaceStats ();
+
+    double m_packets[COUNTERS];
+    double m_bytes[COUNTERS];
+    double m_packetRate[COUNTERS];
+    double m_kilobyteRate[COUNTERS];
+  };
+
+  void
+  Count (Ptr<const ndn::Face> face, Counter counter, Ptr<const Packet> wire);
+
+  void
+  PeriodicWrite ();
+
+  void
+  Wake ();
+
+  void
+  WriteRow (double time, Ptr<const ndn::Face> face, const std::string &faceDescr, Counter counter, FaceStats &stats);
+
+  boost::shared_ptr<TraceSink> m_sink;
+  Time m_period;
+  Mode m_mode;
+  EventId m_writeEvent;
+  Time m_lastWrite;
+  uint32_t m_scheduleId;
+  std::map<Ptr<const ndn::Face>, FaceStats> m_stats;
+  std::map<Ptr<const ndn::Face>, std::string> m_faceDescr;
+};
+
+} // namespace ns3
+
+#endif // COLUMNAR_L3_TRACER_H
@@ -0,0 +1,359 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  columnar-trace-reader.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  columnar-trace-reader.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with columnar-trace-reader.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "columnar-trace-reader.h"
+
+#include <cstring>
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <ns3-dev/ns3/assert.h>
+#include <ns3-dev/ns3/log.h>
+
+NS_LOG_COMPONENT_DEFINE ("ColumnarTraceReader");
+
+namespace ns3 {
+
+/**
+ * @brief Cursor over a decompressed block that fails instead of reading
+ * past the end
+ */
+class ColumnarBlockCursor
+{
+public:
+  ColumnarBlockCursor (const std::vector<char> &data)
+    : m_data (data)
+    , m_position (0)
+    , m_good (true)
+  {
+  }
+
+  uint64_t
+  GetVarint ()
+  {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+      {
+        if (m_position >= m_data.size ())
+          break;
+        uint8_t byte = m_data[m_position++];
+        value |= (uint64_t) (byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+          return value;
+      }
+    m_good = false;
+    return 0;
+  }
+
+  uint32_t
+  GetUint32 ()
+  {
+    if (m_position + 4 > m_data.size ())
+      {
+        m_good = false;
+        return 0;
+      }
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++)
+      value |= (uint32_t) (uint8_t) m_data[m_position++] << (8 * i);
+    return value;
+  }
+
+  std::string
+  GetString ()
+  {
+    uint64_t size = GetVarint ();
+    if (!m_good || m_position + size > m_data.size ())
+      {
+        m_good = false;
+        return "";
+      }
+    std::string value (&m_data[0] + m_position, size);
+    m_position += size;
+    return value;
+  }
+
+  bool
+  IsGood () const
+  {
+    return m_good;
+  }
+
+private:
+  const std::vector<char> &m_data;
+  size_t m_position;
+  bool m_good;
+};
+
+static bool
+ReadVarint (std::istream &is, uint64_t &value)
+{
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7)
+    {
+      int byte = is.get ();
+      if (byte == EOF)
+        return false;
+      value |= (uint64_t) (byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return true;
+    }
+  return false;
+}
+
+ColumnarTraceReader::ColumnarTraceReader (const std::string &path)
+  : m_file (path.c_str (), std::ios::in | std::ios::binary)
+  , m_rows (0)
+  , m_row (0)
+  , m_good (false)
+{
+  char magic[8];
+  if (!m_file.read (magic, sizeof (magic)) || std::memcmp (magic, "NDNCOL01", 8) != 0)
+    {
+      NS_LOG_WARN (path << " is not a columnar trace");
+      return;
+    }
+
+  uint64_t columns;
+  if (!ReadVarint (m_file, columns))
+    return;
+
+  for (uint64_t i = 0; i < columns; i++)
+    {
+      Column column;
+      int type = m_file.get ();
+      uint64_t size;
+      if (type < TraceSink::DOUBLE || type > TraceSink::STRING || !ReadVarint (m_file, size))
+        return;
+
+      column.m_type = (TraceSink::Type) type;
+      column.m_name.resize (size);
+      if (size > 0 && !m_file.read (&column.m_name[0], size))
+        return;
+      m_columns.push_back (column);
+    }
+
+  m_good = true;
+}
+
+bool
+ColumnarTraceReader::IsGood () const
+{
+  return m_good;
+}
+
+uint32_t
+ColumnarTraceReader::GetNColumns () const
+{
+  return m_columns.size ();
+}
+
+const std::string &
+ColumnarTraceReader::GetName (uint32_t column) const
+{
+  return m_columns[column].m_name;
+}
+
+TraceSink::Type
+ColumnarTraceReader::GetType (uint32_t column) const
+{
+  return m_columns[column].m_type;
+}
+
+bool
+ColumnarTraceReader::Next ()
+{
+  if (!m_good)
+    return false;
+
+  if (m_row + 1 < m_rows)
+    {
+      m_row++;
+      return true;
+    }
+
+  m_row = 0;
+  m_rows = 0;
+  return ReadBlock ();
+}
+
+double
+ColumnarTraceReader::GetDouble (uint32_t column) const
+{
+  NS_ASSERT (m_columns[column].m_type == TraceSink::DOUBLE);
+  return m_columns[column].m_doubles[m_row];
+}
+
+int64_t
+ColumnarTraceReader::GetInteger (uint32_t column) const
+{
+  NS_ASSERT (m_columns[column].m_type == TraceSink::INTEGER);
+  return m_columns[column].m_integers[m_row];
+}
+
+const std::string &
+ColumnarTraceReader::GetString (uint32_t column) const
+{
+  NS_ASSERT (m_columns[column].m_type == TraceSink::STRING);
+  const Column &c = m_columns[column];
+  return c.m_dictionary[c.m_codes[m_row]];
+}
+
+void
+ColumnarTraceReader::PrintHeader (std::ostream &os) const
+{
+  for (uint32_t i = 0; i < m_columns.size (); i++)
+    {
+      if (i > 0)
+        os << "\t";
+      os << m_columns[i].m_name;
+    }
+}
+
+void
+ColumnarTraceReader::PrintRow (std::ostream &os) const
+{
+  for (uint32_t i = 0; i < m_columns.size (); i++)
+    {
+      if (i > 0)
+        os << "\t";
+      switch (m_columns[i].m_type)
+        {
+        case TraceSink::DOUBLE:
+          os << GetDouble (i);
+          break;
+        case TraceSink::INTEGER:
+          os << GetInteger (i);
+          break;
+        case TraceSink::STRING:
+          os << GetString (i);
+          break;
+        }
+    }
+}
+
+bool
+ColumnarTraceReader::ReadBlock ()
+{
+  char header[12];
+  if (!m_file.read (header, sizeof (header)))
+    {
+      // A clean end of file falls exactly between blocks
+      m_good = m_file.gcount () == 0;
+      return false;
+    }
+
+  std::vector<char> sizes (header, header + sizeof (header));
+  ColumnarBlockCursor fields (sizes);
+  uint32_t rows = fields.GetUint32 ();
+  uint32_t rawSize = fields.GetUint32 ();
+  uint32_t compressedSize = fields.GetUint32 ();
+
+  std::vector<char> compressed (compressedSize);
+  if (compressedSize == 0 || !m_file.read (&compressed[0], compressedSize))
+    {
+      NS_LOG_WARN ("Truncated block");
+      m_good = false;
+      return false;
+    }
+
+  std::vector<char> raw;
+  raw.reserve (rawSize);
+  try
+    {
+      boost::iostreams::filtering_istream in;
+      in.push (boost::iostreams::zlib_decompressor ());
+      in.push (boost::iostreams::array_source (&compressed[0], compressed.size ()));
+      boost::iostreams::copy (in, boost::iostreams::back_inserter (raw));
+    }
+  catch (const boost::iostreams::zlib_error &)
+    {
+      NS_LOG_WARN ("Damaged block");
+      m_good = false;
+      return false;
+    }
+
+  ColumnarBlockCursor cursor (raw);
+  for (uint32_t i = 0; i < m_columns.size () && cursor.IsGood (); i++)
+    {
+      Column &c = m_columns[i];
+      switch (c.m_type)
+        {
+        case TraceSink::DOUBLE:
+          c.m_doubles.resize (rows);
+          for (uint32_t row = 0; row < rows; row++)
+            {
+              uint64_t bits = cursor.GetUint32 ();
+              bits |= (uint64_t) cursor.GetUint32 () << 32;
+              std::memcpy (&c.m_doubles[row], &bits, sizeof (bits));
+            }
+          break;
+
+        case TraceSink::INTEGER:
+          {
+            c.m_integers.resize (rows);
+            int64_t previous = 0;
+            for (uint32_t row = 0; row < rows; row++)
+              {
+                uint64_t zigzag = cursor.GetVarint ();
+                previous += (int64_t) (zigzag >> 1) ^ -(int64_t) (zigzag & 1);
+                c.m_integers[row] = previous;
+              }
+          }
+          break;
+
+        case TraceSink::STRING:
+          {
+            uint64_t entries = cursor.GetVarint ();
+            for (uint64_t entry = 0; entry < entries && cursor.IsGood (); entry++)
+              c.m_dictionary.push_back (cursor.GetString ());
+
+            c.m_codes.resize (rows);
+            for (uint32_t row = 0; row < rows; row++)
+              {
+                uint64_t code = cursor.GetVarint ();
+                if (code >= c.m_dictionary.size ())
+                  {
+                    m_good = false;
+                    return false;
+                  }
+                c.m_codes[row] = code;
+              }
+          }
+          break;
+        }
+    }
+
+  if (!cursor.IsGood () || raw.size () != rawSize || rows == 0)
+    {
+      NS_LOG_WARN ("Damaged block");
+      m_good = false;
+      return false;
+    }
+
+  m_rows = rows;
+  m_row = 0;
+  return true;
+}
+
+} // namespace ns3
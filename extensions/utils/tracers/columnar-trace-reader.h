@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  columnar-trace-reader.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  columnar-trace-reader.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with columnar-trace-reader.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COLUMNAR_TRACE_READER_H
+#define COLUMNAR_TRACE_READER_H
+
+#include <fstream>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "trace-sink.h"
+
+namespace ns3 {
+
+/**
+ * @brief Reads a trace written by ColumnarTraceWriter row by row
+ *
+ *   ColumnarTraceReader reader ("trace.ntc");
+ *   while (reader.Next ())
+ *     {
+ *       double time = reader.GetDouble (0);
+ *       ...
+ *     }
+ *
+ * Only one block is held in memory at a time.
+ */
+class ColumnarTraceReader
+{
+public:
+  ColumnarTraceReader (const std::string &path);
+
+  /**
+   * @brief Whether the file is a readable trace. After Next returned
+   * false, whether the whole file was read without errors
+   */
+  bool
+  IsGood () const;
+
+  uint32_t
+  GetNColumns () const;
+
+  const std::string &
+  GetName (uint32_t column) const;
+
+  TraceSink::Type
+  GetType (uint32_t column) const;
+
+  /**
+   * @brief Move to the next row
+   *
+   * @returns false at the end of the trace or on a damaged block
+   */
+  bool
+  Next ();
+
+  double
+  GetDouble (uint32_t column) const;
+
+  int64_t
+  GetInteger (uint32_t column) const;
+
+  const std::string &
+  GetString (uint32_t column) const;
+
+  /**
+   * @brief Print the column names separated by tabs, as the ndnSIM text
+   * tracers do
+   */
+  void
+  PrintHeader (std::ostream &os) const;
+
+  /**
+   * @brief Print the current row separated by tabs, with the default
+   * stream formatting the ndnSIM text tracers use
+   */
+  void
+  PrintRow (std::ostream &os) const;
+
+private:
+  struct Column
+  {
+    std::string m_name;
+    TraceSink::Type m_type;
+    std::vector<double> m_doubles;
+    std::vector<int64_t> m_integers;
+    std::vector<uint32_t> m_codes;
+    std::vector<std::string> m_dictionary;
+  };
+
+  bool
+  ReadBlock ();
+
+  std::ifstream m_file;
+  std::vector<Column> m_columns;
+  uint32_t m_rows;
+  uint32_t m_row;
+  bool m_good;
+};
+
+} // namespace ns3
+
+#endif // COLUMNAR_TRACE_READER_H
@@ -0,0 +1,232 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  columnar-trace-writer.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  columnar-trace-writer.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with columnar-trace-writer.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "columnar-trace-writer.h"
+
+#include <cstring>
+
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <ns3-dev/ns3/assert.h>
+#include <ns3-dev/ns3/log.h>
+
+NS_LOG_COMPONENT_DEFINE ("ColumnarTraceWriter");
+
+namespace ns3 {
+
+static void
+PutVarint (std::vector<char> &out, uint64_t value)
+{
+  while (value >= 0x80)
+    {
+      out.push_back ((char) (value | 0x80));
+      value >>= 7;
+    }
+  out.push_back ((char) value);
+}
+
+static void
+PutUint32 (std::vector<char> &out, uint32_t value)
+{
+  for (int i = 0; i < 4; i++)
+    out.push_back ((char) (value >> (8 * i)));
+}
+
+static void
+PutString (std::vector<char> &out, const std::string &value)
+{
+  PutVarint (out, value.size ());
+  out.insert (out.end (), value.begin (), value.end ());
+}
+
+ColumnarTraceWriter::ColumnarTraceWriter (const std::string &path, uint32_t blockRows)
+  : m_file (path.c_str (), std::ios::out | std::ios::binary | std::ios::trunc)
+  , m_blockRows (blockRows)
+  , m_rows (0)
+  , m_headerWritten (false)
+  , m_closed (false)
+{
+  NS_ASSERT (blockRows > 0);
+  if (!m_file)
+    NS_LOG_WARN ("Could not open " << path);
+}
+
+ColumnarTraceWriter::~ColumnarTraceWriter ()
+{
+  Close ();
+}
+
+uint32_t
+ColumnarTraceWriter::AddColumn (const std::string &name, Type type, Role)
+{
+  NS_ASSERT_MSG (!m_headerWritten, "Columns must be added before the first row");
+  Column column;
+  column.m_name = name;
+  column.m_type = type;
+  m_columns.push_back (column);
+  return m_columns.size () - 1;
+}
+
+void
+ColumnarTraceWriter::SetDouble (uint32_t column, double value)
+{
+  NS_ASSERT (m_columns[column].m_type == DOUBLE && m_columns[column].m_doubles.size () == m_rows);
+  m_columns[column].m_doubles.push_back (value);
+}
+
+void
+ColumnarTraceWriter::SetInteger (uint32_t column, int64_t value)
+{
+  NS_ASSERT (m_columns[column].m_type == INTEGER && m_columns[column].m_integers.size () == m_rows);
+  m_columns[column].m_integers.push_back (value);
+}
+
+void
+ColumnarTraceWriter::SetString (uint32_t column, const std::string &value)
+{
+  Column &c = m_columns[column];
+  NS_ASSERT (c.m_type == STRING && c.m_codes.size () == m_rows);
+
+  std::map<std::string, uint32_t>::iterator entry = c.m_dictionary.find (value);
+  if (entry == c.m_dictionary.end ())
+    {
+      entry = c.m_dictionary.insert (std::make_pair (value, (uint32_t) c.m_dictionary.size ())).first;
+      c.m_newEntries.push_back (value);
+    }
+  c.m_codes.push_back (entry->second);
+}
+
+void
+ColumnarTraceWriter::EndRow ()
+{
+  NS_ASSERT (!m_closed);
+  if (!m_headerWritten)
+    WriteHeader ();
+
+  m_rows++;
+  if (m_rows == m_blockRows)
+    WriteBlock ();
+}
+
+void
+ColumnarTraceWriter::Close ()
+{
+  if (m_closed)
+    return;
+
+  // A trace without rows still carries its schema
+  if (!m_headerWritten)
+    WriteHeader ();
+  if (m_rows > 0)
+    WriteBlock ();
+
+  m_file.close ();
+  m_closed = true;
+}
+
+bool
+ColumnarTraceWriter::IsGood () const
+{
+  return !m_file.fail ();
+}
+
+void
+ColumnarTraceWriter::WriteHeader ()
+{
+  std::vector<char> header;
+  header.insert (header.end (), "NDNCOL01", "NDNCOL01" + 8);
+  PutVarint (header, m_columns.size ());
+  for (uint32_t i = 0; i < m_columns.size (); i++)
+    {
+      header.push_back ((char) m_columns[i].m_type);
+      PutString (header, m_columns[i].m_name);
+    }
+
+  m_file.write (&header[0], header.size ());
+  m_headerWritten = true;
+}
+
+void
+ColumnarTraceWriter::WriteBlock ()
+{
+  std::vector<char> raw;
+  for (uint32_t i = 0; i < m_columns.size (); i++)
+    {
+      Column &c = m_columns[i];
+      NS_ASSERT_MSG (c.m_doubles.size () + c.m_integers.size () + c.m_codes.size () == m_rows,
+                     "Column " << c.m_name << " was not set on every row");
+      switch (c.m_type)
+        {
+        case DOUBLE:
+          for (uint32_t row = 0; row < m_rows; row++)
+            {
+              uint64_t bits;
+              std::memcpy (&bits, &c.m_doubles[row], sizeof (bits));
+              PutUint32 (raw, (uint32_t) bits);
+              PutUint32 (raw, (uint32_t) (bits >> 32));
+            }
+          c.m_doubles.clear ();
+          break;
+
+        case INTEGER:
+          {
+            int64_t previous = 0;
+            for (uint32_t row = 0; row < m_rows; row++)
+              {
+                int64_t delta = c.m_integers[row] - previous;
+                PutVarint (raw, ((uint64_t) delta << 1) ^ (uint64_t) (delta >> 63));
+                previous = c.m_integers[row];
+              }
+            c.m_integers.clear ();
+          }
+          break;
+
+        case STRING:
+          PutVarint (raw, c.m_newEntries.size ());
+          for (uint32_t entry = 0; entry < c.m_newEntries.size (); entry++)
+            PutString (raw, c.m_newEntries[entry]);
+          for (uint32_t row = 0; row < m_rows; row++)
+            PutVarint (raw, c.m_codes[row]);
+          c.m_newEntries.clear ();
+          c.m_codes.clear ();
+          break;
+        }
+    }
+
+  std::vector<char> compressed;
+  {
+    boost::iostreams::filtering_ostream out;
+    out.push (boost::iostreams::zlib_compressor ());
+    out.push (boost::iostreams::back_inserter (compressed));
+    out.write (&raw[0], raw.size ());
+  }
+
+  std::vector<char> header;
+  PutUint32 (header, m_rows);
+  PutUint32 (header, raw.size ());
+  PutUint32 (header, compressed.size ());
+  m_file.write (&header[0], header.size ());
+  m_file.write (&compressed[0], compressed.size ());
+
+  m_rows = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  columnar-trace-writer.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  columnar-trace-writer.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with columnar-trace-writer.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COLUMNAR_TRACE_WRITER_H
+#define COLUMNAR_TRACE_WRITER_H
+
+#include <fstream>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "trace-sink.h"
+
+namespace ns3 {
+
+/**
+ * @brief Writes a trace table as compressed blocks of typed columns
+ *
+ * The file starts with the magic "NDNCOL01" and the schema: the number
+ * of columns, then per column its type (one byte) and its name (a
+ * varint length and the bytes). Blocks follow, each a header of three
+ * little endian uint32 (rows, raw size, compressed size) and the zlib
+ * compressed column data. Inside a block every column is stored in
+ * turn:
+ *
+ *  - DOUBLE: 8 bytes per row, little endian IEEE 754
+ *  - INTEGER: zigzag varint of the difference to the previous row
+ *  - STRING: the dictionary entries new in this block (a varint count,
+ *    then varint length and bytes each), then a varint code per row.
+ *    Codes number the entries in order of first appearance in the file
+ *
+ * Node names, faces and record types repeat on every row, so the
+ * dictionaries stay small and the codes compress to next to nothing.
+ *
+ * Columns are declared before the first row, and their roles are not
+ * stored:
+ *
+ *   ColumnarTraceWriter writer ("trace.ntc");
+ *   uint32_t time = writer.AddColumn ("Time", TraceSink::DOUBLE, TraceSink::TIME);
+ *   uint32_t node = writer.AddColumn ("Node", TraceSink::STRING, TraceSink::NODE);
+ *   writer.SetDouble (time, 1.0);
+ *   writer.SetString (node, "1");
+ *   writer.EndRow ();
+ */
+class ColumnarTraceWriter : public TraceSink
+{
+public:
+  /**
+   * @param path File to write, replaced if it exists
+   * @param blockRows Rows gathered before a block is compressed
+   */
+  ColumnarTraceWriter (const std::string &path, uint32_t blockRows = 16384);
+
+  /**
+   * @brief Writes the last block
+   */
+  virtual
+  ~ColumnarTraceWriter ();
+
+  virtual uint32_t
+  AddColumn (const std::string &name, Type type, Role role);
+
+  virtual void
+  SetDouble (uint32_t column, double value);
+
+  virtual void
+  SetInteger (uint32_t column, int64_t value);
+
+  virtual void
+  SetString (uint32_t column, const std::string &value);
+
+  virtual void
+  EndRow ();
+
+  /**
+   * @brief Write the rows gathered so far and close the file
+   */
+  virtual void
+  Close ();
+
+  virtual bool
+  IsGood () const;
+
+private:
+  struct Column
+  {
+    std::string m_name;
+    Type m_type;
+    std::vector<double> m_doubles;
+    std::vector<int64_t> m_integers;
+    std::vector<uint32_t> m_codes;
+    std::map<std::string, uint32_t> m_dictionary;
+    std::vector<std::string> m_newEntries;
+  };
+
+  void
+  WriteHeader ();
+
+  void
+  WriteBlock ();
+
+  std::ofstream m_file;
+  std::vector<Column> m_columns;
+  uint32_t m_blockRows;
+  uint32_t m_rows;
+  bool m_headerWritten;
+  bool m_closed;
+};
+
+} // namespace ns3
+
+#endif // COLUMNAR_TRACE_WRITER_H
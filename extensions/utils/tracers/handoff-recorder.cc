@@ -0,0 +1,236 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  handoff-recorder.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  handoff-recorder.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with handoff-recorder.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "handoff-recorder.h"
+#include "columnar-trace-writer.h"
+
+#include <map>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+
+#include <ns3-dev/ns3/config.h>
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/mgt-headers.h>
+#include <ns3-dev/ns3/names.h>
+#include <ns3-dev/ns3/node.h>
+#include <ns3-dev/ns3/simulator.h>
+#include <ns3-dev/ns3/wifi-mac-header.h>
+
+NS_LOG_COMPONENT_DEFINE ("HandoffRecorder");
+
+namespace ns3 {
+
+// Recorders by node id, for Trigger
+static std::map<uint32_t, Ptr<HandoffRecorder> > g_recorders;
+
+enum
+{
+  TIME, NODE, OLD_AP, NEW_AP, DEASSOC_DELAY, ASSOC_DELAY, BEACON_DELAY, DATA_DELAY, INTERESTS, LOST, RETRANSMISSIONS
+};
+
+void
+HandoffRecorder::Install (const NodeContainer &nodes, const std::string &file)
+{
+  boost::shared_ptr<TraceSink> sink = boost::make_shared<ColumnarTraceWriter> (file);
+  if (!sink->IsGood ())
+    {
+      NS_LOG_ERROR ("Trace file " << file << " cannot be opened");
+      return;
+    }
+
+  Install (nodes, sink);
+}
+
+void
+HandoffRecorder::Install (const NodeContainer &nodes, boost::shared_ptr<TraceSink> sink)
+{
+  AddColumns (*sink);
+
+  for (NodeContainer::Iterator node = nodes.Begin (); node != nodes.End (); node++)
+    g_recorders[(*node)->GetId ()] = Create<HandoffRecorder> (sink, *node);
+}
+
+void
+HandoffRecorder::Destroy ()
+{
+  for (std::map<uint32_t, Ptr<HandoffRecorder> >::iterator recorder = g_recorders.begin ();
+       recorder != g_recorders.end (); recorder++)
+    {
+      if (recorder->second->m_open)
+        recorder->second->WriteRow ();
+    }
+  g_recorders.clear ();
+}
+
+void
+HandoffRecorder::Trigger (Ptr<Node> node, const std::string &oldAp, const std::string &newAp)
+{
+  std::map<uint32_t, Ptr<HandoffRecorder> >::iterator recorder = g_recorders.find (node->GetId ());
+  if (recorder != g_recorders.end ())
+    recorder->second->Start (oldAp, newAp);
+}
+
+void
+HandoffRecorder::AddColumns (TraceSink &sink)
+{
+  sink.AddColumn ("Time", TraceSink::DOUBLE, TraceSink::TIME);
+  sink.AddColumn ("Node", TraceSink::STRING, TraceSink::NODE);
+  sink.AddColumn ("OldAp", TraceSink::STRING, TraceSink::DETAIL);
+  sink.AddColumn ("NewAp", TraceSink::STRING, TraceSink::DETAIL);
+  sink.AddColumn ("DeassocDelay", TraceSink::DOUBLE, TraceSink::MEAN);
+  sink.AddColumn ("AssocDelay", TraceSink::DOUBLE, TraceSink::MEAN);
+  sink.AddColumn ("BeaconDelay", TraceSink::DOUBLE, TraceSink::MEAN);
+  sink.AddColumn ("DataDelay", TraceSink::DOUBLE, TraceSink::MEAN);
+  sink.AddColumn ("Interests", TraceSink::INTEGER, TraceSink::SUM);
+  sink.AddColumn ("Lost", TraceSink::INTEGER, TraceSink::SUM);
+  sink.AddColumn ("Retransmissions", TraceSink::INTEGER, TraceSink::SUM);
+}
+
+HandoffRecorder::HandoffRecorder (boost::shared_ptr<TraceSink> sink, Ptr<Node> node)
+  : m_sink (sink)
+  , m_node (boost::lexical_cast<std::string> (node->GetId ()))
+  , m_open (false)
+{
+  // Paths matching nothing are ignored, so both kinds of card are covered
+  std::string path = "/NodeList/" + m_node + "/";
+  Config::ConnectWithoutContext (path + "DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::StaWifiMac/Assoc",
+                                 MakeCallback (&HandoffRecorder::Assoc, this));
+  Config::ConnectWithoutContext (path + "DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::StaWifiMac/DeAssoc",
+                                 MakeCallback (&HandoffRecorder::DeAssoc, this));
+  Config::ConnectWithoutContext (path + "DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxEnd",
+                                 MakeCallback (&HandoffRecorder::PhyRxEnd, this));
+  Config::ConnectWithoutContext (path + "DeviceList/*/$ns3::FastWifiNetDevice/Assoc",
+                                 MakeCallback (&HandoffRecorder::Assoc, this));
+  Config::ConnectWithoutContext (path + "DeviceList/*/$ns3::FastWifiNetDevice/DeAssoc",
+                                 MakeCallback (&HandoffRecorder::DeAssoc, this));
+  Config::ConnectWithoutContext (path + "ApplicationList/*/TransmittedInterests",
+                                 MakeCallback (&HandoffRecorder::TransmittedInterests, this));
+  Config::ConnectWithoutContext (path + "ApplicationList/*/FirstInterestDataDelay",
+                                 MakeCallback (&HandoffRecorder::FirstInterestDataDelay, this));
+
+  std::string name = Names::FindName (node);
+  if (!name.empty ())
+    m_node = name;
+}
+
+void
+HandoffRecorder::Start (const std::string &oldAp, const std::string &newAp)
+{
+  // The previous handoff ends where the next one starts
+  if (m_open)
+    WriteRow ();
+
+  m_open = true;
+  m_trigger = Simulator::Now ();
+  m_oldAp = oldAp;
+  m_newAp = newAp;
+  m_deassoc = Seconds (-1);
+  m_assoc = Seconds (-1);
+  m_beacon = Seconds (-1);
+  m_firstData = Seconds (-1);
+  m_interests = 0;
+  m_lost = 0;
+  m_retransmissions = 0;
+}
+
+void
+HandoffRecorder::WriteRow ()
+{
+  TraceSink &w = *m_sink;
+  w.SetDouble (TIME, m_trigger.ToDouble (Time::S));
+  w.SetString (NODE, m_node);
+  w.SetString (OLD_AP, m_oldAp);
+  w.SetString (NEW_AP, m_newAp);
+  w.SetDouble (DEASSOC_DELAY, m_deassoc.IsNegative () ? -1 : (m_deassoc - m_trigger).ToDouble (Time::S));
+  w.SetDouble (ASSOC_DELAY, m_assoc.IsNegative () ? -1 : (m_assoc - m_trigger).ToDouble (Time::S));
+  w.SetDouble (BEACON_DELAY, m_beacon.IsNegative () ? -1 : (m_beacon - m_trigger).ToDouble (Time::S));
+  w.SetDouble (DATA_DELAY, m_firstData.IsNegative () ? -1 : (m_firstData - m_trigger).ToDouble (Time::S));
+  w.SetInteger (INTERESTS, m_interests);
+  w.SetInteger (LOST, m_lost);
+  w.SetInteger (RETRANSMISSIONS, m_retransmissions);
+  w.EndRow ();
+
+  m_open = false;
+}
+
+void
+HandoffRecorder::Assoc (Mac48Address ap)
+{
+  if (m_open && m_assoc.IsNegative ())
+    m_assoc = Simulator::Now ();
+
+  // A FastWifiNetDevice has no beacons, and with active probing the
+  // association may come before any beacon
+  if (m_open && m_beacon.IsNegative ())
+    m_beacon = Simulator::Now ();
+}
+
+void
+HandoffRecorder::DeAssoc (Mac48Address ap)
+{
+  if (m_open && m_deassoc.IsNegative ())
+    m_deassoc = Simulator::Now ();
+}
+
+void
+HandoffRecorder::PhyRxEnd (Ptr<const Packet> packet)
+{
+  if (!m_open || !m_beacon.IsNegative ())
+    return;
+
+  Ptr<Packet> copy = packet->Copy ();
+  WifiMacHeader header;
+  copy->RemoveHeader (header);
+  if (!header.IsBeacon ())
+    return;
+
+  MgtBeaconHeader beacon;
+  copy->RemoveHeader (beacon);
+  if (beacon.GetSsid ().PeekString () == m_newAp)
+    m_beacon = Simulator::Now ();
+}
+
+void
+HandoffRecorder::TransmittedInterests (Ptr<const ndn::Interest>, Ptr<ndn::App>, Ptr<ndn::Face>)
+{
+  if (m_open && m_firstData.IsNegative ())
+    m_interests++;
+}
+
+void
+HandoffRecorder::FirstInterestDataDelay (Ptr<ndn::App> app, uint32_t seqno, Time delay, uint32_t retxCount, int32_t hopCount)
+{
+  if (!m_open)
+    return;
+
+  Time now = Simulator::Now ();
+  if (m_firstData.IsNegative ())
+    m_firstData = now;
+
+  // Interests sent during the interruption whose first transmission
+  // got no Data. The consumers count the first transmission in retxCount
+  if (retxCount > 1 && now - delay < m_firstData)
+    {
+      m_lost++;
+      m_retransmissions += retxCount - 1;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  handoff-recorder.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  handoff-recorder.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with handoff-recorder.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef HANDOFF_RECORDER_H
+#define HANDOFF_RECORDER_H
+
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+#include <ns3-dev/ns3/mac48-address.h>
+#include <ns3-dev/ns3/node-container.h>
+#include <ns3-dev/ns3/nstime.h>
+#include <ns3-dev/ns3/packet.h>
+#include <ns3-dev/ns3/ptr.h>
+#include <ns3-dev/ns3/simple-ref-count.h>
+#include <ns3-dev/ns3/ndnSIM/apps/ndn-app.h>
+#include <ns3-dev/ns3/ndnSIM/model/ndn-face.h>
+#include <ns3-dev/ns3/ndnSIM/model/ndn-interest.h>
+
+#include "trace-sink.h"
+
+namespace ns3 {
+
+/**
+ * @brief How long each handoff of a mobile terminal interrupts its
+ * consumers
+ *
+ * The scenario calls Trigger when it gives a terminal a new SSID, before
+ * the card associates. From then on the recorder follows the Assoc and
+ * DeAssoc traces of the card (StaWifiMac or FastWifiNetDevice), the
+ * beacons its PHY receives and the Interests and Data of the consumers,
+ * and writes one row per handoff when the next one starts or on Destroy:
+ *
+ *   Time Node OldAp NewAp DeassocDelay AssocDelay BeaconDelay DataDelay Interests Lost Retransmissions
+ *
+ * Time is the trigger. The delays are the seconds from it to the first
+ * de-association, association, beacon of the new AP and Data, -1 if
+ * there was none. A StaWifiMac given a new SSID stays associated to the
+ * old AP until it has missed MaxMissedBeacons of its beacons, so with the
+ * Yans cards AssocDelay is at least that long, and -1 when the next
+ * handoff comes sooner. BeaconDelay is when the card could first have
+ * associated: the first beacon carrying the new SSID, or the association
+ * if that came first, as with a FastWifiNetDevice. Interests
+ * counts the Interests sent until the first Data. Lost counts the Data
+ * whose first Interest went out before the first Data after the trigger
+ * but had to be retransmitted, and Retransmissions the retransmissions
+ * they took.
+ *
+ * Rows go out in the order the handoffs end, so the sink should not need
+ * them by time: a ColumnarTraceWriter, possibly behind an AsyncTraceSink.
+ * Nothing is scheduled and a row is a few dozen bytes, so thousands of
+ * terminals cost little more than their traces.
+ */
+class HandoffRecorder : public SimpleRefCount<HandoffRecorder>
+{
+public:
+  static void
+  Install (const NodeContainer &nodes, const std::string &file);
+
+  static void
+  Install (const NodeContainer &nodes, boost::shared_ptr<TraceSink> sink);
+
+  /**
+   * @brief Write the handoffs still open and remove the recorders
+   */
+  static void
+  Destroy ();
+
+  /**
+   * @brief A node is given the SSID of another AP. Nodes without a
+   * recorder are ignored
+   */
+  static void
+  Trigger (Ptr<Node> node, const std::string &oldAp, const std::string &newAp);
+
+  HandoffRecorder (boost::shared_ptr<TraceSink> sink, Ptr<Node> node);
+
+  static void
+  AddColumns (TraceSink &sink);
+
+private:
+  void
+  Start (const std::string &oldAp, const std::string &newAp);
+
+  void
+  WriteRow ();
+
+  void
+  Assoc (Mac48Address ap);
+
+  void
+  DeAssoc (Mac48Address ap);
+
+  void
+  PhyRxEnd (Ptr<const Packet> packet);
+
+  void
+  TransmittedInterests (Ptr<const ndn::Interest>, Ptr<ndn::App>, Ptr<ndn::Face>);
+
+  void
+  FirstInterestDataDelay (Ptr<ndn::App> app, uint32_t seqno, Time delay, uint32_t retxCount, int32_t hopCount);
+
+  boost::shared_ptr<TraceSink> m_sink;
+  std::string m_node;
+
+  // Handoff being recorded, the times being negative until seen
+  bool m_open;
+  Time m_trigger;
+  std::string m_oldAp;
+  std::string m_newAp;
+  Time m_deassoc;
+  Time m_assoc;
+  Time m_beacon;
+  Time m_firstData;
+  uint32_t m_interests;
+  uint32_t m_lost;
+  uint32_t m_retransmissions;
+};
+
+} // namespace ns3
+
+#endif // HANDOFF_RECORDER_H
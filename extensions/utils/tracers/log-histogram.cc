@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  log-histogram.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  log-histogram.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with log-histogram.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "log-histogram.h"
+
+#include <cmath>
+
+#include <ns3-dev/ns3/assert.h>
+
+namespace ns3 {
+
+LogHistogram::LogHistogram (uint32_t precision)
+  : m_precision (precision)
+  , m_exact (1ULL << precision)
+  , m_half (1ULL << (precision - 1))
+  , m_count (0)
+{
+  NS_ASSERT_MSG (precision >= 1 && precision <= 16, "Precision must be from 1 to 16 bits");
+}
+
+uint32_t
+LogHistogram::GetBucket (uint64_t value) const
+{
+  if (value < m_exact)
+    return value;
+
+  // The highest precision bits of the value select the bucket within
+  // its power of two
+  uint32_t msb = 63 - __builtin_clzll (value);
+  uint32_t shift = msb - m_precision + 1;
+  uint64_t top = value >> shift;
+  return m_exact + (shift - 1) * m_half + (top - m_half);
+}
+
+uint64_t
+LogHistogram::GetLow (uint32_t bucket) const
+{
+  if (bucket < m_exact)
+    return bucket;
+
+  uint64_t k = bucket - m_exact;
+  uint32_t shift = k / m_half + 1;
+  uint64_t top = k % m_half + m_half;
+  return top << shift;
+}
+
+uint64_t
+LogHistogram::GetHigh (uint32_t bucket) const
+{
+  if (bucket < m_exact)
+    return bucket;
+
+  uint32_t shift = (bucket - m_exact) / m_half + 1;
+  return GetLow (bucket) + (1ULL << shift) - 1;
+}
+
+void
+LogHistogram::Add (uint64_t value, uint64_t count)
+{
+  m_buckets[GetBucket (value)] += count;
+  m_count += count;
+}
+
+void
+LogHistogram::Merge (const LogHistogram &other)
+{
+  NS_ASSERT (other.m_precision == m_precision);
+  for (Buckets::const_iterator bucket = other.m_buckets.begin (); bucket != other.m_buckets.end (); bucket++)
+    m_buckets[bucket->first] += bucket->second;
+  m_count += other.m_count;
+}
+
+void
+LogHistogram::Clear ()
+{
+  m_buckets.clear ();
+  m_count = 0;
+}
+
+uint64_t
+LogHistogram::GetCount () const
+{
+  return m_count;
+}
+
+const LogHistogram::Buckets &
+LogHistogram::GetBuckets () const
+{
+  return m_buckets;
+}
+
+uint64_t
+LogHistogram::GetPercentile (double percentile) const
+{
+  if (m_count == 0)
+    return 0;
+
+  // Rank of the value, counting from 1, as the nearest rank method
+  uint64_t rank = (uint64_t) std::ceil (percentile / 100.0 * m_count);
+  if (rank < 1)
+    rank = 1;
+
+  uint64_t seen = 0;
+  for (Buckets::const_iterator bucket = m_buckets.begin (); bucket != m_buckets.end (); bucket++)
+    {
+      seen += bucket->second;
+      if (seen >= rank)
+        return GetHigh (bucket->first);
+    }
+  return GetHigh (m_buckets.rbegin ()->first);
+}
+
+} // namespace ns3
@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  log-histogram.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  log-histogram.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with log-histogram.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LOG_HISTOGRAM_H
+#define LOG_HISTOGRAM_H
+
+#include <map>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * @brief Counts of integer values in buckets of bounded relative width,
+ * as HdrHistogram does
+ *
+ * Values below 2^precision have a bucket each. Above, every power of two
+ * is split in 2^(precision - 1) buckets, so a bucket is at most
+ * 1 / 2^(precision - 1) of its values wide: 1.6% with the default
+ * precision of 7. Only the buckets holding values are stored, so a
+ * histogram of delays up to 10 s in microseconds has at most 1216
+ * buckets, however many values it counts.
+ *
+ *   LogHistogram delays;
+ *   delays.Add (delay.GetMicroSeconds ());
+ *   uint64_t p99 = delays.GetPercentile (99);
+ *
+ * A percentile is the highest value of the bucket it falls in, so it is
+ * never below the exact one and above it by at most the bucket width.
+ */
+class LogHistogram
+{
+public:
+  typedef std::map<uint32_t, uint64_t> Buckets;
+
+  /**
+   * @param precision Bits of the values kept, from 1 to 16
+   */
+  LogHistogram (uint32_t precision = 7);
+
+  void
+  Add (uint64_t value, uint64_t count = 1);
+
+  /**
+   * @brief Add the counts of a histogram of the same precision
+   */
+  void
+  Merge (const LogHistogram &other);
+
+  void
+  Clear ();
+
+  /**
+   * @brief Number of values added
+   */
+  uint64_t
+  GetCount () const;
+
+  /**
+   * @brief Highest value of the bucket holding the given percentile, 0
+   * when the histogram is empty
+   *
+   * @param percentile From 0 to 100, as 99.9 for p999
+   */
+  uint64_t
+  GetPercentile (double percentile) const;
+
+  /**
+   * @brief Non-empty buckets and their counts, in increasing order
+   */
+  const Buckets &
+  GetBuckets () const;
+
+  uint32_t
+  GetBucket (uint64_t value) const;
+
+  /**
+   * @brief Lowest value of a bucket
+   */
+  uint64_t
+  GetLow (uint32_t bucket) const;
+
+  /**
+   * @brief Highest value of a bucket, included in it
+   */
+  uint64_t
+  GetHigh (uint32_t bucket) const;
+
+private:
+  uint32_t m_precision;
+  uint64_t m_exact;
+  uint64_t m_half;
+  Buckets m_buckets;
+  uint64_t m_count;
+};
+
+} // namespace ns3
+
+#endif // LOG_HISTOGRAM_H
@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  text-trace-sink.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  text-trace-sink.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with text-trace-sink.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "text-trace-sink.h"
+
+#include <ns3-dev/ns3/assert.h>
+#include <ns3-dev/ns3/log.h>
+
+NS_LOG_COMPONENT_DEFINE ("TextTraceSink");
+
+namespace ns3 {
+
+TextTraceSink::TextTraceSink (const std::string &path)
+  : m_file (path.c_str ())
+  , m_headerWritten (false)
+  , m_closed (false)
+{
+  if (!m_file)
+    NS_LOG_WARN ("Could not open " << path);
+}
+
+TextTraceSink::~TextTraceSink ()
+{
+  Close ();
+}
+
+uint32_t
+TextTraceSink::AddColumn (const std::string &name, Type, Role)
+{
+  NS_ASSERT_MSG (!m_headerWritten, "Columns must be added before the first row");
+  m_names.push_back (name);
+  m_row.push_back ("");
+  return m_names.size () - 1;
+}
+
+void
+TextTraceSink::SetDouble (uint32_t column, double value)
+{
+  // The default stream formatting, as the ndnSIM tracers print
+  m_format.str ("");
+  m_format << value;
+  m_row[column] = m_format.str ();
+}
+
+void
+TextTraceSink::SetInteger (uint32_t column, int64_t value)
+{
+  m_format.str ("");
+  m_format << value;
+  m_row[column] = m_format.str ();
+}
+
+void
+TextTraceSink::SetString (uint32_t column, const std::string &value)
+{
+  m_row[column] = value;
+}
+
+void
+TextTraceSink::EndRow ()
+{
+  NS_ASSERT (!m_closed);
+  if (!m_headerWritten)
+    WriteHeader ();
+
+  for (uint32_t i = 0; i < m_row.size (); i++)
+    {
+      if (i > 0)
+        m_file << "\t";
+      m_file << m_row[i];
+    }
+  m_file << "\n";
+}
+
+void
+TextTraceSink::Close ()
+{
+  if (m_closed)
+    return;
+
+  if (!m_headerWritten)
+    WriteHeader ();
+
+  m_file.close ();
+  m_closed = true;
+}
+
+bool
+TextTraceSink::IsGood () const
+{
+  return !m_file.fail ();
+}
+
+void
+TextTraceSink::WriteHeader ()
+{
+  for (uint32_t i = 0; i < m_names.size (); i++)
+    {
+      if (i > 0)
+        m_file << "\t";
+      m_file << m_names[i];
+    }
+  m_file << "\n";
+
+  m_headerWritten = true;
+}
+
+} // namespace ns3
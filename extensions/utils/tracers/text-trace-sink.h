@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  text-trace-sink.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  text-trace-sink.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with text-trace-sink.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TEXT_TRACE_SINK_H
+#define TEXT_TRACE_SINK_H
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "trace-sink.h"
+
+namespace ns3 {
+
+/**
+ * @brief Writes the rows of the columnar tracers as the tab separated
+ * text of the ndnSIM tracers
+ *
+ * For tracing a selection of nodes into the text layout where the ndnSIM
+ * tracer can only be installed on all of them.
+ */
+class TextTraceSink : public TraceSink
+{
+public:
+  /**
+   * @param path File to write, replaced if it exists
+   */
+  TextTraceSink (const std::string &path);
+
+  virtual
+  ~TextTraceSink ();
+
+  virtual uint32_t
+  AddColumn (const std::string &name, Type type, Role role);
+
+  virtual void
+  SetDouble (uint32_t column, double value);
+
+  virtual void
+  SetInteger (uint32_t column, int64_t value);
+
+  virtual void
+  SetString (uint32_t column, const std::string &value);
+
+  virtual void
+  EndRow ();
+
+  virtual void
+  Close ();
+
+  virtual bool
+  IsGood () const;
+
+private:
+  void
+  WriteHeader ();
+
+  std::ofstream m_file;
+  std::vector<std::string> m_names;
+  std::vector<std::string> m_row;
+  std::ostringstream m_format;
+  bool m_headerWritten;
+  bool m_closed;
+};
+
+} // namespace ns3
+
+#endif // TEXT_TRACE_SINK_H
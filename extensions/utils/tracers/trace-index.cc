@@ -0,0 +1,493 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  trace-index.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  trace-index.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with trace-index.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "trace-index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <ns3-dev/ns3/log.h>
+
+NS_LOG_COMPONENT_DEFINE ("TraceIndex");
+
+namespace ns3 {
+
+namespace {
+
+const char g_magic[8] = { 'N', 'D', 'N', 'I', 'D', 'X', '0', '1' };
+
+typedef std::pair<const char *, const char *> Field;
+
+inline bool
+IsBlank (char c)
+{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Split a line on runs of blanks, up to the field needed
+void
+Split (const char *begin, const char *end, uint32_t fields, std::vector<Field> &found)
+{
+  found.clear ();
+  const char *p = begin;
+  while (found.size () < fields)
+    {
+      while (p < end && IsBlank (*p))
+        p++;
+      if (p == end)
+        break;
+      const char *start = p;
+      while (p < end && !IsBlank (*p))
+        p++;
+      found.push_back (Field (start, p));
+    }
+}
+
+bool
+ParseTime (const Field &field, double &value)
+{
+  char buffer[64];
+  size_t size = field.second - field.first;
+  if (size == 0 || size >= sizeof (buffer))
+    return false;
+  std::memcpy (buffer, field.first, size);
+  buffer[size] = '\0';
+
+  char *end;
+  value = std::strtod (buffer, &end);
+  return end == buffer + size;
+}
+
+void
+WriteInteger (std::ostream &os, uint64_t value, int bytes)
+{
+  for (int i = 0; i < bytes; i++)
+    os.put ((char) ((value >> (8 * i)) & 0xff));
+}
+
+uint64_t
+ReadInteger (std::istream &is, int bytes)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; i++)
+    value |= (uint64_t) (unsigned char) is.get () << (8 * i);
+  return value;
+}
+
+} // namespace
+
+TraceIndex::TraceIndex ()
+  : m_bin (1)
+  , m_traceSize (0)
+  , m_traceModified (0)
+  , m_timeColumn (0)
+  , m_nodeColumn (-1)
+  , m_columns (0)
+  , m_dataBegin (0)
+  , m_bytesRead (0)
+{
+}
+
+std::string
+TraceIndex::GetPath (const std::string &trace)
+{
+  return trace + ".idx";
+}
+
+double
+TraceIndex::GetBin () const
+{
+  return m_bin;
+}
+
+uint64_t
+TraceIndex::GetBytesRead () const
+{
+  return m_bytesRead;
+}
+
+const std::string &
+TraceIndex::GetError () const
+{
+  return m_error;
+}
+
+bool
+TraceIndex::Stat (const std::string &trace, uint64_t &size, int64_t &modified) const
+{
+  struct stat status;
+  if (stat (trace.c_str (), &status) != 0)
+    {
+      m_error = "could not open " + trace;
+      return false;
+    }
+  size = status.st_size;
+  modified = status.st_mtime;
+  return true;
+}
+
+bool
+TraceIndex::Build (const std::string &trace, double bin)
+{
+  m_error.clear ();
+  m_nodes.clear ();
+  m_bins.clear ();
+  m_bin = bin;
+  if (bin <= 0)
+    {
+      m_error = "the bin must be positive";
+      return false;
+    }
+  if (!Stat (trace, m_traceSize, m_traceModified))
+    return false;
+  if (m_traceSize == 0)
+    {
+      m_error = trace + " is empty";
+      return false;
+    }
+
+  int fd = open (trace.c_str (), O_RDONLY);
+  void *mapped = (fd < 0) ? MAP_FAILED : mmap (0, m_traceSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (fd >= 0)
+    close (fd);
+  if (mapped == MAP_FAILED)
+    {
+      m_error = "could not map " + trace;
+      return false;
+    }
+  madvise (mapped, m_traceSize, MADV_SEQUENTIAL);
+
+  const char *begin = static_cast<const char *> (mapped);
+  const char *end = begin + m_traceSize;
+  const char *eol = static_cast<const char *> (std::memchr (begin, '\n', end - begin));
+  if (eol == 0)
+    eol = end;
+
+  std::vector<Field> fields;
+  Split (begin, eol, ~0u, fields);
+  m_columns = fields.size ();
+  m_timeColumn = m_columns;
+  m_nodeColumn = -1;
+  for (uint32_t i = 0; i < fields.size (); i++)
+    {
+      std::string name (fields[i].first, fields[i].second);
+      if (name == "Time")
+        m_timeColumn = i;
+      else if (name == "Node")
+        m_nodeColumn = i;
+    }
+  if (m_timeColumn == m_columns)
+    {
+      munmap (mapped, m_traceSize);
+      m_error = trace + " has no Time column";
+      return false;
+    }
+  uint32_t needed = std::max<int32_t> (m_timeColumn, m_nodeColumn) + 1;
+
+  std::map<std::string, uint32_t> codes;
+  if (m_nodeColumn < 0)
+    m_nodes.push_back ("");
+  std::string node;
+  uint32_t code = 0;
+
+  m_dataBegin = std::min (eol + 1, end) - begin;
+  const char *line = begin + m_dataBegin;
+  int64_t lastBin = 0;
+  Bin *current = 0;
+  while (line < end)
+    {
+      eol = static_cast<const char *> (std::memchr (line, '\n', end - line));
+      if (eol == 0)
+        eol = end;
+      Split (line, eol, needed, fields);
+      if (fields.empty ())
+        {
+          line = eol + 1;
+          continue;
+        }
+
+      double time;
+      if (fields.size () < needed || !ParseTime (fields[m_timeColumn], time))
+        {
+          munmap (mapped, m_traceSize);
+          m_error = trace + " has a row without a time";
+          return false;
+        }
+
+      if (m_nodeColumn >= 0)
+        {
+          const Field &field = fields[m_nodeColumn];
+          // Rows of a node often follow each other
+          if (node.size () != (size_t) (field.second - field.first)
+              || node.compare (0, node.size (), field.first, field.second - field.first) != 0)
+            {
+              node.assign (field.first, field.second);
+              std::map<std::string, uint32_t>::iterator entry = codes.find (node);
+              if (entry == codes.end ())
+                {
+                  entry = codes.insert (std::make_pair (node, (uint32_t) m_nodes.size ())).first;
+                  m_nodes.push_back (node);
+                }
+              code = entry->second;
+            }
+        }
+
+      int64_t bin = (int64_t) std::floor (time / m_bin);
+      if (current == 0 || bin != lastBin)
+        {
+          current = &m_bins[bin];
+          lastBin = bin;
+        }
+
+      uint64_t rowBegin = line - begin;
+      uint64_t rowEnd = std::min (eol + 1, end) - begin;
+      Bin::iterator range = current->find (code);
+      if (range == current->end ())
+        {
+          Range r;
+          r.m_begin = rowBegin;
+          r.m_end = rowEnd;
+          current->insert (std::make_pair (code, r));
+        }
+      else
+        {
+          range->second.m_begin = std::min (range->second.m_begin, rowBegin);
+          range->second.m_end = std::max (range->second.m_end, rowEnd);
+        }
+
+      line = eol + 1;
+    }
+
+  munmap (mapped, m_traceSize);
+  NS_LOG_INFO ("Indexed " << trace << ": " << m_bins.size () << " bins, " << m_nodes.size () << " nodes");
+  return true;
+}
+
+bool
+TraceIndex::Save (const std::string &trace) const
+{
+  std::string path = GetPath (trace);
+  std::ofstream file (path.c_str (), std::ios::binary);
+
+  uint64_t bits;
+  std::memcpy (&bits, &m_bin, sizeof (bits));
+
+  file.write (g_magic, sizeof (g_magic));
+  WriteInteger (file, bits, 8);
+  WriteInteger (file, m_traceSize, 8);
+  WriteInteger (file, m_traceModified, 8);
+  WriteInteger (file, m_columns, 4);
+  WriteInteger (file, m_timeColumn, 4);
+  WriteInteger (file, (uint32_t) m_nodeColumn, 4);
+  WriteInteger (file, m_dataBegin, 8);
+
+  WriteInteger (file, m_nodes.size (), 4);
+  for (uint32_t i = 0; i < m_nodes.size (); i++)
+    {
+      WriteInteger (file, m_nodes[i].size (), 4);
+      file.write (m_nodes[i].data (), m_nodes[i].size ());
+    }
+
+  WriteInteger (file, m_bins.size (), 8);
+  for (std::map<int64_t, Bin>::const_iterator bin = m_bins.begin (); bin != m_bins.end (); bin++)
+    {
+      WriteInteger (file, bin->first, 8);
+      WriteInteger (file, bin->second.size (), 4);
+      for (Bin::const_iterator range = bin->second.begin (); range != bin->second.end (); range++)
+        {
+          WriteInteger (file, range->first, 4);
+          WriteInteger (file, range->second.m_begin, 8);
+          WriteInteger (file, range->second.m_end, 8);
+        }
+    }
+
+  file.close ();
+  if (!file)
+    {
+      m_error = "could not write " + path;
+      return false;
+    }
+  return true;
+}
+
+bool
+TraceIndex::Load (const std::string &trace)
+{
+  m_error.clear ();
+  m_nodes.clear ();
+  m_bins.clear ();
+
+  std::string path = GetPath (trace);
+  std::ifstream file (path.c_str (), std::ios::binary);
+  char magic[sizeof (g_magic)];
+  if (!file.read (magic, sizeof (magic)) || std::memcmp (magic, g_magic, sizeof (magic)) != 0)
+    {
+      m_error = path + " is not a trace index";
+      return false;
+    }
+
+  uint64_t bits = ReadInteger (file, 8);
+  std::memcpy (&m_bin, &bits, sizeof (bits));
+  m_traceSize = ReadInteger (file, 8);
+  m_traceModified = ReadInteger (file, 8);
+  m_columns = ReadInteger (file, 4);
+  m_timeColumn = ReadInteger (file, 4);
+  m_nodeColumn = (int32_t) ReadInteger (file, 4);
+  m_dataBegin = ReadInteger (file, 8);
+
+  uint64_t size;
+  int64_t modified;
+  if (!Stat (trace, size, modified))
+    return false;
+  if (size != m_traceSize || modified != m_traceModified)
+    {
+      m_error = path + " is older than the trace";
+      return false;
+    }
+
+  uint32_t nodes = ReadInteger (file, 4);
+  for (uint32_t i = 0; i < nodes && file; i++)
+    {
+      std::string node (ReadInteger (file, 4), '\0');
+      file.read (&node[0], node.size ());
+      m_nodes.push_back (node);
+    }
+
+  uint64_t bins = ReadInteger (file, 8);
+  for (uint64_t i = 0; i < bins && file; i++)
+    {
+      Bin &bin = m_bins[(int64_t) ReadInteger (file, 8)];
+      uint32_t ranges = ReadInteger (file, 4);
+      for (uint32_t r = 0; r < ranges && file; r++)
+        {
+          uint32_t code = ReadInteger (file, 4);
+          Range &range = bin[code];
+          range.m_begin = ReadInteger (file, 8);
+          range.m_end = ReadInteger (file, 8);
+        }
+    }
+
+  if (!file)
+    {
+      m_error = path + " is truncated";
+      m_bins.clear ();
+      return false;
+    }
+  return true;
+}
+
+bool
+TraceIndex::Extract (const std::string &trace, double from, double to,
+                     const std::vector<std::string> &nodes, std::ostream &os) const
+{
+  m_error.clear ();
+  m_bytesRead = 0;
+  if (!nodes.empty () && m_nodeColumn < 0)
+    {
+      m_error = trace + " has no Node column";
+      return false;
+    }
+
+  std::vector<bool> wanted (m_nodes.size (), nodes.empty ());
+  for (uint32_t i = 0; i < m_nodes.size (); i++)
+    if (std::find (nodes.begin (), nodes.end (), m_nodes[i]) != nodes.end ())
+      wanted[i] = true;
+
+  // Ranges of the selected nodes in the bins of the window, in file
+  // order and joined where they touch
+  std::vector<std::pair<uint64_t, uint64_t> > ranges;
+  std::map<int64_t, Bin>::const_iterator bin = m_bins.lower_bound ((int64_t) std::floor (from / m_bin));
+  std::map<int64_t, Bin>::const_iterator last = m_bins.upper_bound ((int64_t) std::floor (to / m_bin));
+  if (to < from)
+    last = bin;
+  for (; bin != last; bin++)
+    for (Bin::const_iterator range = bin->second.begin (); range != bin->second.end (); range++)
+      if (wanted[range->first])
+        ranges.push_back (std::make_pair (range->second.m_begin, range->second.m_end));
+  std::sort (ranges.begin (), ranges.end ());
+
+  std::vector<std::pair<uint64_t, uint64_t> > joined;
+  for (uint32_t i = 0; i < ranges.size (); i++)
+    {
+      if (!joined.empty () && ranges[i].first <= joined.back ().second)
+        joined.back ().second = std::max (joined.back ().second, ranges[i].second);
+      else
+        joined.push_back (ranges[i]);
+    }
+
+  std::ifstream file (trace.c_str (), std::ios::binary);
+  std::vector<char> buffer (m_dataBegin);
+  if (!file.read (buffer.empty () ? 0 : &buffer[0], buffer.size ()))
+    {
+      m_error = "could not read " + trace;
+      return false;
+    }
+  os.write (buffer.empty () ? 0 : &buffer[0], buffer.size ());
+  m_bytesRead = m_dataBegin;
+
+  uint32_t needed = std::max<int32_t> (m_timeColumn, m_nodeColumn) + 1;
+  std::vector<Field> fields;
+  std::string node;
+  for (uint32_t i = 0; i < joined.size (); i++)
+    {
+      buffer.resize (joined[i].second - joined[i].first);
+      file.seekg (joined[i].first);
+      if (!file.read (&buffer[0], buffer.size ()))
+        {
+          m_error = "could not read " + trace;
+          return false;
+        }
+      m_bytesRead += buffer.size ();
+
+      // Other nodes and times share the ranges, so each row is checked
+      const char *line = &buffer[0];
+      const char *end = line + buffer.size ();
+      while (line < end)
+        {
+          const char *eol = static_cast<const char *> (std::memchr (line, '\n', end - line));
+          if (eol == 0)
+            eol = end;
+          Split (line, eol, needed, fields);
+          eol = std::min (eol + 1, end);
+
+          double time;
+          bool keep = fields.size () == needed && ParseTime (fields[m_timeColumn], time)
+            && time >= from && time <= to;
+          if (keep && !nodes.empty ())
+            {
+              node.assign (fields[m_nodeColumn].first, fields[m_nodeColumn].second);
+              keep = std::find (nodes.begin (), nodes.end (), node) != nodes.end ();
+            }
+          if (keep)
+            os.write (line, eol - line);
+          line = eol;
+        }
+    }
+
+  return os.good ();
+}
+
+} // namespace ns3
@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  trace-index.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  trace-index.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with trace-index.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TRACE_INDEX_H
+#define TRACE_INDEX_H
+
+#include <map>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Where the rows of each time bin and node are in a text trace
+ *
+ * For every bin of the Time column and every value of the Node column,
+ * the index holds the offsets of the first row and of the end of the
+ * last one, so a window of a few seconds is read without going through
+ * the rest of the trace:
+ *
+ *   TraceIndex index;
+ *   if (!index.Load ("rate-trace.txt"))
+ *     {
+ *       index.Build ("rate-trace.txt", 1.0);
+ *       index.Save ("rate-trace.txt");
+ *     }
+ *   index.Extract ("rate-trace.txt", 100, 110, nodes, std::cout);
+ *
+ * The index is kept next to the trace, in a file named after it with
+ * .idx added. It records the size and time of the trace and is not
+ * loaded once the trace changed. Rows need not be in time order: then
+ * the ranges of bins overlap and Extract only reads more.
+ */
+class TraceIndex
+{
+public:
+  TraceIndex ();
+
+  /**
+   * @brief Index a trace with a header line and Time and Node columns
+   *
+   * @param bin Width of the time bins, in seconds
+   */
+  bool
+  Build (const std::string &trace, double bin);
+
+  /**
+   * @brief Write the index next to the trace
+   */
+  bool
+  Save (const std::string &trace) const;
+
+  /**
+   * @brief Read the index of the trace, if there is one up to date
+   */
+  bool
+  Load (const std::string &trace);
+
+  /**
+   * @brief Copy the header and the rows with Time in [from, to] to os
+   *
+   * @param nodes Values of the Node column to copy, all if empty
+   */
+  bool
+  Extract (const std::string &trace, double from, double to,
+           const std::vector<std::string> &nodes, std::ostream &os) const;
+
+  double
+  GetBin () const;
+
+  /**
+   * @brief Bytes of the trace Extract read in the last call
+   */
+  uint64_t
+  GetBytesRead () const;
+
+  const std::string &
+  GetError () const;
+
+  static std::string
+  GetPath (const std::string &trace);
+
+private:
+  struct Range
+  {
+    uint64_t m_begin;
+    uint64_t m_end;
+  };
+
+  // Ranges of a time bin, by node code
+  typedef std::map<uint32_t, Range> Bin;
+
+  bool
+  Stat (const std::string &trace, uint64_t &size, int64_t &modified) const;
+
+  double m_bin;
+  uint64_t m_traceSize;
+  int64_t m_traceModified;
+  uint32_t m_timeColumn;
+  int32_t m_nodeColumn;
+  uint32_t m_columns;
+  uint64_t m_dataBegin;
+  std::vector<std::string> m_nodes;
+  std::map<int64_t, Bin> m_bins;
+
+  mutable uint64_t m_bytesRead;
+  mutable std::string m_error;
+};
+
+} // namespace ns3
+
+#endif // TRACE_INDEX_H
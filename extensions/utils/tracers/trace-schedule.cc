@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  trace-schedule.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  trace-schedule.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with trace-schedule.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "trace-schedule.h"
+
+#include <map>
+
+#include <ns3-dev/ns3/assert.h>
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/simulator.h>
+
+NS_LOG_COMPONENT_DEFINE ("TraceSchedule");
+
+namespace ns3 {
+
+namespace {
+
+bool g_enabled = false;
+Time g_fine;
+Time g_coarse;
+
+// Start and end of the windows, which do not overlap
+std::map<Time, Time> g_windows;
+
+std::map<uint32_t, Callback<void> > g_clients;
+uint32_t g_nextClient = 0;
+
+// Drop the windows that ended
+void
+Prune (Time now)
+{
+  while (!g_windows.empty () && g_windows.begin ()->second <= now)
+    g_windows.erase (g_windows.begin ());
+}
+
+bool
+InWindow (Time now)
+{
+  std::map<Time, Time>::const_iterator window = g_windows.upper_bound (now);
+  if (window == g_windows.begin ())
+    return false;
+  window--;
+  return now < window->second;
+}
+
+} // namespace
+
+void
+TraceSchedule::Enable (Time fine, Time coarse)
+{
+  NS_ASSERT_MSG (fine.IsStrictlyPositive (), "The fine period must be positive");
+  g_enabled = true;
+  g_fine = fine;
+  g_coarse = coarse;
+}
+
+bool
+TraceSchedule::IsEnabled ()
+{
+  return g_enabled;
+}
+
+void
+TraceSchedule::AddWindow (Time start, Time end)
+{
+  if (!g_enabled)
+    return;
+
+  Time now = Simulator::Now ();
+  if (start < now)
+    start = now;
+  if (end <= start)
+    return;
+  Prune (now);
+
+  // Join the windows it overlaps or touches
+  std::map<Time, Time>::iterator window = g_windows.upper_bound (start);
+  if (window != g_windows.begin ())
+    {
+      std::map<Time, Time>::iterator before = window;
+      before--;
+      if (before->second >= start)
+        window = before;
+    }
+  while (window != g_windows.end () && window->first <= end)
+    {
+      if (window->first < start)
+        start = window->first;
+      if (window->second > end)
+        end = window->second;
+      g_windows.erase (window++);
+    }
+  g_windows[start] = end;
+
+  // Tracers already at the fine period ignore the call
+  NS_LOG_DEBUG ("Fine tracing from " << start.GetSeconds () << " to " << end.GetSeconds ());
+  Simulator::Schedule (start - now, &TraceSchedule::Open);
+}
+
+Time
+TraceSchedule::GetDelay (Time period)
+{
+  if (!g_enabled)
+    return period;
+
+  Time now = Simulator::Now ();
+  if (InWindow (now))
+    return g_fine;
+
+  // Outside the windows the rows fall on the multiples of the period
+  int64_t step = (g_coarse.IsZero () ? period : g_coarse).GetTimeStep ();
+  int64_t next = (now.GetTimeStep () / step + 1) * step;
+  return TimeStep (next - now.GetTimeStep ());
+}
+
+bool
+TraceSchedule::IsLate (Time delayLeft)
+{
+  return g_enabled && delayLeft > g_fine;
+}
+
+uint32_t
+TraceSchedule::Register (Callback<void> wake)
+{
+  g_clients[g_nextClient] = wake;
+  return g_nextClient++;
+}
+
+void
+TraceSchedule::Unregister (uint32_t id)
+{
+  g_clients.erase (id);
+}
+
+void
+TraceSchedule::Open ()
+{
+  Prune (Simulator::Now ());
+  std::map<uint32_t, Callback<void> > clients = g_clients;
+  for (std::map<uint32_t, Callback<void> >::iterator client = clients.begin (); client != clients.end (); client++)
+    client->second ();
+}
+
+} // namespace ns3
@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  trace-schedule.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  trace-schedule.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with trace-schedule.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TRACE_SCHEDULE_H
+#define TRACE_SCHEDULE_H
+
+#include <stdint.h>
+
+#include <ns3-dev/ns3/callback.h>
+#include <ns3-dev/ns3/nstime.h>
+
+namespace ns3 {
+
+/**
+ * @brief When the periodic columnar tracers write their rows
+ *
+ * By default a tracer writes every period it was installed with. Once
+ * Enable is called, tracers write every fine period inside the windows
+ * added with AddWindow, and on the multiples of a coarse period outside
+ * them, so the rows go to the moments worth looking at:
+ *
+ *   TraceSchedule::Enable (MilliSeconds (10), Seconds (5));
+ *   // install the tracers
+ *   ...
+ *   // on every SSID change
+ *   TraceSchedule::AddWindow (Simulator::Now (), Simulator::Now () + Seconds (2));
+ *
+ * Every row covers the time since the row before, so the rates are per
+ * second whatever the interval and the counts add up over any time
+ * range. Tracers waiting for their coarse write when a window opens
+ * write a row at once and go on at the fine period.
+ *
+ * The windows are shared by all the tracers of the process. With
+ * PartitionInterface workers or MPI ranks, each process only sees the
+ * windows it added, so AddWindow should be called from a global event
+ * every process runs rather than from an event of a node. A sink
+ * summing the rows of a time bin, as AggregatingTraceSink does, adds
+ * up the rates of every fine row; only the counts stay exact.
+ */
+class TraceSchedule
+{
+public:
+  /**
+   * @param fine Period inside the windows
+   * @param coarse Period outside them, zero to keep the period of each
+   * tracer
+   */
+  static void
+  Enable (Time fine, Time coarse = Seconds (0));
+
+  static bool
+  IsEnabled ();
+
+  /**
+   * @brief Sample at the fine period from start to end. Windows may
+   * overlap; the part before the current time is ignored
+   */
+  static void
+  AddWindow (Time start, Time end);
+
+  /**
+   * @brief Delay until the next row of a tracer installed with period
+   */
+  static Time
+  GetDelay (Time period);
+
+  /**
+   * @brief Whether a tracer whose next row is delayLeft away should
+   * write now, a window having opened
+   */
+  static bool
+  IsLate (Time delayLeft);
+
+  /**
+   * @brief Have wake called when a window opens
+   *
+   * @returns Identifier for Unregister
+   */
+  static uint32_t
+  Register (Callback<void> wake);
+
+  static void
+  Unregister (uint32_t id);
+
+private:
+  static void
+  Open ();
+};
+
+} // namespace ns3
+
+#endif // TRACE_SCHEDULE_H
@@ -0,0 +1,94 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  trace-sink.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  trace-sink.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with trace-sink.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TRACE_SINK_H
+#define TRACE_SINK_H
+
+#include <stdint.h>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * @brief Where the columnar tracers send their rows
+ *
+ * A tracer declares its columns once, then fills a row with one Set
+ * call per column and finishes it with EndRow. The role of a column
+ * tells a sink that reduces the rows what to do with it; sinks that
+ * store every row ignore it.
+ */
+class TraceSink
+{
+public:
+  enum Type
+  {
+    DOUBLE = 0,
+    INTEGER = 1,
+    STRING = 2
+  };
+
+  enum Role
+  {
+    TIME,    ///< Simulation time of the row, in seconds
+    NODE,    ///< Name of the node the row is about
+    KEY,     ///< Kind of record, kept apart when reducing (Type, Interface)
+    SUM,     ///< Count or rate, summed when reducing
+    MEAN,    ///< Measurement, averaged when reducing
+    DETAIL   ///< Identifies a face or packet, dropped when reducing
+  };
+
+  virtual
+  ~TraceSink ()
+  {
+  }
+
+  /**
+   * @returns Index of the column for the Set calls
+   */
+  virtual uint32_t
+  AddColumn (const std::string &name, Type type, Role role) = 0;
+
+  virtual void
+  SetDouble (uint32_t column, double value) = 0;
+
+  virtual void
+  SetInteger (uint32_t column, int64_t value) = 0;
+
+  virtual void
+  SetString (uint32_t column, const std::string &value) = 0;
+
+  virtual void
+  EndRow () = 0;
+
+  /**
+   * @brief Write out what is left and close the file
+   */
+  virtual void
+  Close () = 0;
+
+  /**
+   * @brief Whether everything so far was written
+   */
+  virtual bool
+  IsGood () const = 0;
+};
+
+} // namespace ns3
+
+#endif // TRACE_SINK_H
@@ -0,0 +1,683 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  trace-summary.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  trace-summary.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with trace-summary.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "trace-summary.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <ns3-dev/ns3/callback.h>
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/ptr.h>
+#include <ns3-dev/ns3/system-thread.h>
+
+NS_LOG_COMPONENT_DEFINE ("TraceSummary");
+
+namespace ns3 {
+
+namespace {
+
+typedef std::pair<const char *, const char *> Field;
+
+inline bool
+IsBlank (char c)
+{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Split a line on runs of blanks, as read.table does
+void
+Split (const char *begin, const char *end, std::vector<Field> &fields)
+{
+  fields.clear ();
+  const char *p = begin;
+  while (true)
+    {
+      while (p < end && IsBlank (*p))
+        p++;
+      if (p == end)
+        break;
+      const char *start = p;
+      while (p < end && !IsBlank (*p))
+        p++;
+      fields.push_back (Field (start, p));
+    }
+}
+
+// The mapped file is not terminated, so the field is copied for strtod
+bool
+ParseNumber (const Field &field, double &value)
+{
+  char buffer[64];
+  size_t size = field.second - field.first;
+  if (size == 0 || size >= sizeof (buffer))
+    return false;
+  std::memcpy (buffer, field.first, size);
+  buffer[size] = '\0';
+
+  char *end;
+  value = std::strtod (buffer, &end);
+  return end == buffer + size;
+}
+
+bool
+ParseNumber (const std::string &text, double &value)
+{
+  return ParseNumber (Field (text.data (), text.data () + text.size ()), value);
+}
+
+std::string
+FormatNumber (double value)
+{
+  char buffer[32];
+  std::sprintf (buffer, "%.15g", value);
+  return buffer;
+}
+
+} // namespace
+
+/**
+ * @brief The lines between two line ends, grouped by one thread
+ */
+class TraceSummary::Chunk
+{
+public:
+  Chunk (const TraceSummary *summary, const char *begin, const char *end)
+    : m_summary (summary)
+    , m_begin (begin)
+    , m_end (end)
+    , m_numeric (summary->m_numeric.size (), true)
+  {
+  }
+
+  void
+  Run ();
+
+  const TraceSummary *m_summary;
+  const char *m_begin;
+  const char *m_end;
+  Groups m_groups;
+  std::vector<bool> m_numeric;
+  std::string m_error;
+};
+
+void
+TraceSummary::Chunk::Run ()
+{
+  const TraceSummary &s = *m_summary;
+  uint32_t columns = s.m_header.size ();
+
+  std::vector<Field> fields;
+  std::vector<double> values (s.m_numeric.size (), 0);
+  std::vector<bool> numeric (s.m_numeric.size (), true);
+  std::vector<std::string> key (s.m_groupColumns.size ());
+
+  const char *line = m_begin;
+  while (line < m_end)
+    {
+      const char *eol = static_cast<const char *> (std::memchr (line, '\n', m_end - line));
+      if (eol == 0)
+        eol = m_end;
+      Split (line, eol, fields);
+      line = eol + 1;
+
+      if (fields.empty ())
+        continue;
+      if (fields.size () != columns)
+        {
+          m_error = "a line has " + boost::lexical_cast<std::string> (fields.size ())
+            + " fields, the header " + boost::lexical_cast<std::string> (columns);
+          return;
+        }
+
+      // A column is summarized only if all of it is numbers, the rows
+      // left out by Keep included
+      for (uint32_t i = 0; i < columns; i++)
+        if (s.m_parse[i])
+          {
+            numeric[i] = ParseNumber (fields[i], values[i]);
+            if (!numeric[i])
+              m_numeric[i] = false;
+          }
+      for (uint32_t i = 0; i < s.m_derived.size (); i++)
+        {
+          const Derived &d = s.m_derived[i];
+          uint32_t column = columns + i;
+          if (d.m_derivation == LABEL)
+            continue;
+          numeric[column] = numeric[d.m_source];
+          if (!numeric[column])
+            m_numeric[column] = false;
+          values[column] = (d.m_derivation == CEILING) ? std::ceil (values[d.m_source]) : values[d.m_source] * d.m_factor;
+        }
+
+      bool kept = true;
+      for (uint32_t i = 0; i < s.m_keep.size () && kept; i++)
+        {
+          const Field &field = fields[s.m_keep[i].first];
+          kept = s.m_keep[i].second->count (std::string (field.first, field.second)) > 0;
+        }
+      if (!kept)
+        continue;
+
+      for (uint32_t i = 0; i < key.size (); i++)
+        {
+          uint32_t column = s.m_groupColumns[i];
+          if (column < columns)
+            key[i].assign (fields[column].first, fields[column].second);
+          else if (s.m_derived[column - columns].m_derivation == LABEL)
+            key[i] = s.m_derived[column - columns].m_label;
+          else
+            key[i] = numeric[column] ? FormatNumber (values[column]) : "NA";
+        }
+
+      Groups::iterator group = m_groups.find (key);
+      if (group == m_groups.end ())
+        {
+          group = m_groups.insert (std::make_pair (key, Group ())).first;
+          group->second.m_sums.resize (s.m_valueColumns.size (), 0);
+          group->second.m_rows = 0;
+        }
+      for (uint32_t i = 0; i < s.m_valueColumns.size (); i++)
+        group->second.m_sums[i] += values[s.m_valueColumns[i]];
+      group->second.m_rows++;
+    }
+}
+
+TraceSummary::TraceSummary ()
+  : m_function (SUM)
+{
+}
+
+bool
+TraceSummary::SetTable (const std::string &table, const std::vector<std::string> &nodes)
+{
+  // What each script does to the data before calling summaryBy
+  std::vector<std::string> types;
+  std::vector<std::string> groups;
+
+  if (table == "rate" || table == "int")
+    {
+      if (table == "rate")
+        {
+          types.push_back ("OutInterests");
+          types.push_back ("InData");
+        }
+      else
+        {
+          types.push_back ("SatisfiedInterests");
+          types.push_back ("TimedOutInterests");
+        }
+      Scale ("Kilobytes", "Kilobits", 8);
+      SetFunction (SUM);
+
+      groups.push_back ("Time");
+      if (!nodes.empty ())
+        groups.push_back ("Node");
+      groups.push_back ("Type");
+    }
+  else if (table == "app")
+    {
+      types.push_back ("FullDelay");
+      Ceiling ("Time", "TimeSec");
+      SetFunction (MEAN);
+
+      groups.push_back ("TimeSec");
+      groups.push_back ("Type");
+    }
+  else
+    return false;
+
+  SetFactor ("Node");
+  if (!nodes.empty ())
+    Keep ("Node", nodes);
+  Keep ("Type", types);
+  SetGroups (groups);
+  return true;
+}
+
+void
+TraceSummary::SetGroups (const std::vector<std::string> &columns)
+{
+  m_groupNames = columns;
+}
+
+void
+TraceSummary::AddGroup (const std::string &column)
+{
+  m_groupNames.push_back (column);
+}
+
+void
+TraceSummary::SetFunction (Function function)
+{
+  m_function = function;
+}
+
+void
+TraceSummary::Average (const std::string &column, const std::string &count)
+{
+  m_averaged = column;
+  m_averageCount = count;
+}
+
+void
+TraceSummary::SetFactor (const std::string &column)
+{
+  m_factors.insert (column);
+}
+
+void
+TraceSummary::Keep (const std::string &column, const std::vector<std::string> &values)
+{
+  m_keepNames[column].insert (values.begin (), values.end ());
+}
+
+void
+TraceSummary::Ceiling (const std::string &column, const std::string &name)
+{
+  Derived d;
+  d.m_derivation = CEILING;
+  d.m_sourceName = column;
+  d.m_source = 0;
+  d.m_name = name;
+  d.m_factor = 1;
+  m_derived.push_back (d);
+}
+
+void
+TraceSummary::Scale (const std::string &column, const std::string &name, double factor)
+{
+  Derived d;
+  d.m_derivation = SCALE;
+  d.m_sourceName = column;
+  d.m_source = 0;
+  d.m_name = name;
+  d.m_factor = factor;
+  m_derived.push_back (d);
+}
+
+void
+TraceSummary::SetLabel (const std::string &name, const std::string &value)
+{
+  for (uint32_t i = 0; i < m_derived.size (); i++)
+    if (m_derived[i].m_derivation == LABEL && m_derived[i].m_name == name)
+      {
+        m_derived[i].m_label = value;
+        return;
+      }
+
+  Derived d;
+  d.m_derivation = LABEL;
+  d.m_source = 0;
+  d.m_name = name;
+  d.m_factor = 1;
+  d.m_label = value;
+  m_derived.push_back (d);
+}
+
+const std::string &
+TraceSummary::GetError () const
+{
+  return m_error;
+}
+
+bool
+TraceSummary::ReadHeader (const char *begin, const char *end)
+{
+  std::vector<Field> fields;
+  Split (begin, end, fields);
+  if (fields.empty ())
+    {
+      m_error = "the header line is empty";
+      return false;
+    }
+
+  std::vector<std::string> header;
+  std::map<std::string, uint32_t> index;
+  for (uint32_t i = 0; i < fields.size (); i++)
+    {
+      header.push_back (std::string (fields[i].first, fields[i].second));
+      index[header.back ()] = i;
+    }
+  if (!m_header.empty () && header != m_header)
+    {
+      m_error = "the header differs from the traces read before";
+      return false;
+    }
+  m_header = header;
+
+  for (uint32_t i = 0; i < m_derived.size (); i++)
+    {
+      if (m_derived[i].m_derivation == LABEL)
+        {
+          index[m_derived[i].m_name] = m_header.size () + i;
+          continue;
+        }
+      std::map<std::string, uint32_t>::const_iterator source = index.find (m_derived[i].m_sourceName);
+      if (source == index.end ())
+        {
+          m_error = "there is no column " + m_derived[i].m_sourceName;
+          return false;
+        }
+      m_derived[i].m_source = source->second;
+      index[m_derived[i].m_name] = m_header.size () + i;
+    }
+  uint32_t columns = m_header.size () + m_derived.size ();
+
+  std::vector<bool> grouped (columns, false);
+  m_groupColumns.clear ();
+  for (uint32_t i = 0; i < m_groupNames.size (); i++)
+    {
+      std::map<std::string, uint32_t>::const_iterator column = index.find (m_groupNames[i]);
+      if (column == index.end ())
+        {
+          m_error = "there is no column " + m_groupNames[i];
+          return false;
+        }
+      m_groupColumns.push_back (column->second);
+      grouped[column->second] = true;
+    }
+
+  m_keep.clear ();
+  std::map<std::string, std::set<std::string> >::const_iterator keep = m_keepNames.begin ();
+  for (; keep != m_keepNames.end (); keep++)
+    {
+      std::map<std::string, uint32_t>::const_iterator column = index.find (keep->first);
+      if (column == index.end () || column->second >= m_header.size ())
+        {
+          m_error = "there is no column " + keep->first;
+          return false;
+        }
+      m_keep.push_back (std::make_pair (column->second, &keep->second));
+    }
+
+  // Derived columns are computed from numbers, so their sources are
+  // parsed even when they are factors themselves
+  m_parse.assign (m_header.size (), false);
+  m_valueColumns.clear ();
+  for (uint32_t i = 0; i < columns; i++)
+    {
+      const std::string &name = (i < m_header.size ()) ? m_header[i] : m_derived[i - m_header.size ()].m_name;
+      if (grouped[i] || m_factors.count (name) > 0)
+        continue;
+      if (i >= m_header.size () && m_derived[i - m_header.size ()].m_derivation == LABEL)
+        continue;
+      m_valueColumns.push_back (i);
+      if (i < m_header.size ())
+        m_parse[i] = true;
+    }
+  for (uint32_t i = 0; i < m_derived.size (); i++)
+    if (m_derived[i].m_derivation != LABEL)
+      m_parse[m_derived[i].m_source] = true;
+  // Pooled traces are numeric only if all of them are
+  if (m_numeric.size () != columns)
+    m_numeric.assign (columns, true);
+
+  return true;
+}
+
+bool
+TraceSummary::Read (const std::string &path, uint32_t threads)
+{
+  m_error.clear ();
+
+  int fd = open (path.c_str (), O_RDONLY);
+  struct stat status;
+  if (fd < 0 || fstat (fd, &status) != 0)
+    {
+      if (fd >= 0)
+        close (fd);
+      m_error = "could not open " + path;
+      return false;
+    }
+  size_t size = status.st_size;
+  if (size == 0)
+    {
+      close (fd);
+      m_error = path + " is empty";
+      return false;
+    }
+
+  void *mapped = mmap (0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (mapped == MAP_FAILED)
+    {
+      m_error = "could not map " + path;
+      return false;
+    }
+  madvise (mapped, size, MADV_SEQUENTIAL);
+
+  const char *begin = static_cast<const char *> (mapped);
+  const char *end = begin + size;
+  const char *eol = static_cast<const char *> (std::memchr (begin, '\n', size));
+  if (eol == 0)
+    eol = end;
+  if (!ReadHeader (begin, eol))
+    {
+      munmap (mapped, size);
+      return false;
+    }
+
+  // Cut the lines in chunks of about the same size at line ends
+  const char *data = std::min (eol + 1, end);
+  if (threads == 0)
+    threads = 1;
+  std::vector<Chunk *> chunks;
+  const char *start = data;
+  for (uint32_t i = 1; i <= threads && start < end; i++)
+    {
+      const char *stop = end;
+      if (i < threads)
+        {
+          stop = data + (end - data) / threads * i;
+          if (stop < start)
+            stop = start;
+          const char *next = static_cast<const char *> (std::memchr (stop, '\n', end - stop));
+          stop = next ? next + 1 : end;
+        }
+      chunks.push_back (new Chunk (this, start, stop));
+      start = stop;
+    }
+  NS_LOG_INFO ("Reading " << path << " in " << chunks.size () << " chunks");
+
+  if (chunks.size () == 1)
+    chunks[0]->Run ();
+  else
+    {
+      std::vector<Ptr<SystemThread> > workers;
+      for (uint32_t i = 0; i < chunks.size (); i++)
+        {
+          workers.push_back (Create<SystemThread> (MakeCallback (&Chunk::Run, chunks[i])));
+          workers.back ()->Start ();
+        }
+      for (uint32_t i = 0; i < workers.size (); i++)
+        workers[i]->Join ();
+    }
+
+  // Merge in file order
+  for (uint32_t i = 0; i < chunks.size (); i++)
+    {
+      Chunk *chunk = chunks[i];
+      if (m_error.empty () && !chunk->m_error.empty ())
+        m_error = path + ": " + chunk->m_error;
+      MergeGroups (chunk->m_groups, chunk->m_numeric);
+      delete chunk;
+    }
+
+  munmap (mapped, size);
+  return m_error.empty ();
+}
+
+bool
+TraceSummary::Merge (const TraceSummary &other)
+{
+  if (other.m_header.empty ())
+    return true;
+  if (m_header.empty ())
+    {
+      m_header = other.m_header;
+      m_groupColumns = other.m_groupColumns;
+      m_valueColumns = other.m_valueColumns;
+      m_numeric = other.m_numeric;
+    }
+  else if (m_header != other.m_header || m_valueColumns != other.m_valueColumns)
+    {
+      m_error = "the summaries read traces with different headers";
+      return false;
+    }
+
+  MergeGroups (other.m_groups, other.m_numeric);
+  return true;
+}
+
+void
+TraceSummary::Clear ()
+{
+  m_header.clear ();
+  m_numeric.clear ();
+  m_groups.clear ();
+  m_error.clear ();
+}
+
+void
+TraceSummary::MergeGroups (const Groups &groups, const std::vector<bool> &numeric)
+{
+  for (uint32_t c = 0; c < m_numeric.size (); c++)
+    if (!numeric[c])
+      m_numeric[c] = false;
+
+  for (Groups::const_iterator group = groups.begin (); group != groups.end (); group++)
+    {
+      Groups::iterator merged = m_groups.find (group->first);
+      if (merged == m_groups.end ())
+        {
+          m_groups.insert (*group);
+          continue;
+        }
+      for (uint32_t v = 0; v < group->second.m_sums.size (); v++)
+        merged->second.m_sums[v] += group->second.m_sums[v];
+      merged->second.m_rows += group->second.m_rows;
+    }
+}
+
+bool
+TraceSummary::GroupOrder::operator() (const Groups::value_type *a, const Groups::value_type *b) const
+{
+  const std::vector<std::string> &x = a->first;
+  const std::vector<std::string> &y = b->first;
+  for (uint32_t i = 0; i < x.size (); i++)
+    {
+      if (x[i] == y[i])
+        continue;
+      double u, v;
+      if (ParseNumber (x[i], u) && ParseNumber (y[i], v) && u != v)
+        return u < v;
+      return x[i] < y[i];
+    }
+  return false;
+}
+
+void
+TraceSummary::Print (std::ostream &os) const
+{
+  const char *suffix = (m_function == SUM) ? ".sum" : ".mean";
+
+  // Index of the averaged group, past the groups if there is none
+  uint32_t averaged = std::find (m_groupNames.begin (), m_groupNames.end (), m_averaged) - m_groupNames.begin ();
+
+  std::vector<std::string> names;
+  for (uint32_t i = 0; i < m_groupNames.size (); i++)
+    if (i != averaged)
+      names.push_back (m_groupNames[i]);
+  if (averaged < m_groupNames.size ())
+    names.push_back (m_averageCount);
+  for (uint32_t i = 0; i < names.size (); i++)
+    os << (i ? "\t" : "") << names[i];
+  for (uint32_t i = 0; i < m_valueColumns.size (); i++)
+    {
+      uint32_t column = m_valueColumns[i];
+      if (!m_numeric[column])
+        continue;
+      const std::string &name = (column < m_header.size ()) ? m_header[column] : m_derived[column - m_header.size ()].m_name;
+      os << "\t" << name << suffix;
+    }
+  os << "\n";
+
+  // Summaries of the groups, summed over the values of the averaged
+  // group. m_rows counts those values, one without an averaged group
+  Groups printed;
+  for (Groups::const_iterator group = m_groups.begin (); group != m_groups.end (); group++)
+    {
+      std::vector<std::string> key = group->first;
+      if (averaged < key.size ())
+        key.erase (key.begin () + averaged);
+
+      Groups::iterator sum = printed.find (key);
+      if (sum == printed.end ())
+        {
+          sum = printed.insert (std::make_pair (key, Group ())).first;
+          sum->second.m_sums.resize (group->second.m_sums.size (), 0);
+          sum->second.m_rows = 0;
+        }
+      for (uint32_t v = 0; v < group->second.m_sums.size (); v++)
+        {
+          long double value = group->second.m_sums[v];
+          if (m_function == MEAN)
+            value /= group->second.m_rows;
+          sum->second.m_sums[v] += value;
+        }
+      sum->second.m_rows++;
+    }
+
+  std::vector<const Groups::value_type *> order;
+  for (Groups::const_iterator group = printed.begin (); group != printed.end (); group++)
+    order.push_back (&*group);
+  std::sort (order.begin (), order.end (), GroupOrder ());
+
+  std::streamsize precision = os.precision (15);
+  for (uint32_t g = 0; g < order.size (); g++)
+    {
+      const std::vector<std::string> &key = order[g]->first;
+      const Group &group = order[g]->second;
+      for (uint32_t i = 0; i < key.size (); i++)
+        os << (i ? "\t" : "") << key[i];
+      if (averaged < m_groupNames.size ())
+        os << (key.empty () ? "" : "\t") << group.m_rows;
+      for (uint32_t i = 0; i < m_valueColumns.size (); i++)
+        {
+          if (!m_numeric[m_valueColumns[i]])
+            continue;
+          os << "\t" << (double) (group.m_sums[i] / group.m_rows);
+        }
+      os << "\n";
+    }
+  os.precision (precision);
+}
+
+} // namespace ns3
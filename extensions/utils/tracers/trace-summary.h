@@ -0,0 +1,237 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  trace-summary.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  trace-summary.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with trace-summary.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TRACE_SUMMARY_H
+#define TRACE_SUMMARY_H
+
+#include <map>
+#include <ostream>
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Summarizes a text trace as summaryBy of the doBy R package does
+ *
+ * The scripts in graphs/ read a whole trace with read.table and reduce
+ * it with summaryBy (. ~ Time + Type, FUN=sum). This computes the same
+ * table without holding the trace in memory: the file is mapped, cut at
+ * line ends into one chunk per thread, and each thread groups its lines
+ * on its own before the groups are merged.
+ *
+ *   TraceSummary summary;
+ *   summary.SetFactor ("Node");
+ *   summary.Keep ("Type", types);
+ *   summary.Scale ("Kilobytes", "Kilobits", 8);
+ *   summary.SetGroups (groups);
+ *   if (summary.Read ("rate-trace.txt", 4))
+ *     summary.Print (std::cout);
+ *
+ * As in R, every column that is not a group, not a factor and holds only
+ * numbers is summarized, in file order, followed by the derived columns,
+ * and named after the column and the function (Packets.sum). Groups are
+ * printed in increasing order, comparing as numbers when both values
+ * are numbers.
+ *
+ * Reading several traces with the same header pools their rows, as
+ * rbind would before summaryBy. SetLabel adds a column naming the trace
+ * the rows came from, so a group can keep runs apart, and Average then
+ * prints the mean over the runs.
+ */
+class TraceSummary
+{
+public:
+  enum Function
+  {
+    SUM,
+    MEAN
+  };
+
+  TraceSummary ();
+
+  /**
+   * @brief Prepare the table one of the scripts in graphs/ computes
+   *
+   * @param table rate (rate-tr-j.R), int (int-tr-j.R) or app
+   * (app-data-j.R)
+   * @param nodes Nodes to keep, all if empty, as --node of the scripts
+   * @returns false for an unknown table
+   */
+  bool
+  SetTable (const std::string &table, const std::vector<std::string> &nodes);
+
+  /**
+   * @brief Columns the rows are grouped by, the right hand side of the
+   * summaryBy formula
+   */
+  void
+  SetGroups (const std::vector<std::string> &columns);
+
+  void
+  AddGroup (const std::string &column);
+
+  void
+  SetFunction (Function function);
+
+  /**
+   * @brief Print, for each value of the other groups, the mean of the
+   * summaries of the values of a group column, like summaryBy with
+   * FUN=mean on the summary of each run. The column is printed as one
+   * named count, holding how many values were averaged
+   */
+  void
+  Average (const std::string &column, const std::string &count);
+
+  /**
+   * @brief Never summarize this column, like factor () in the scripts
+   */
+  void
+  SetFactor (const std::string &column);
+
+  /**
+   * @brief Only read the rows whose column holds one of the values, like
+   * subset (data, column %in% values)
+   */
+  void
+  Keep (const std::string &column, const std::vector<std::string> &values);
+
+  /**
+   * @brief Add a column holding ceiling (column), like data$TimeSec
+   */
+  void
+  Ceiling (const std::string &column, const std::string &name);
+
+  /**
+   * @brief Add a column holding column * factor, like data$Kilobits
+   */
+  void
+  Scale (const std::string &column, const std::string &name, double factor);
+
+  /**
+   * @brief Add a column holding value in the rows of the traces read
+   * next. It is never summarized
+   */
+  void
+  SetLabel (const std::string &name, const std::string &value);
+
+  /**
+   * @brief Read and summarize a trace with a header line, adding its
+   * rows to those read before
+   *
+   * @param threads Chunks read in parallel
+   * @returns false if the file could not be read, its header differs
+   * from the traces read before or a line does not have as many fields
+   * as the header
+   */
+  bool
+  Read (const std::string &path, uint32_t threads);
+
+  /**
+   * @brief Add the rows another summary read, as if read here. Both must
+   * be set up the same way
+   *
+   * @returns false if they read traces with different headers
+   */
+  bool
+  Merge (const TraceSummary &other);
+
+  /**
+   * @brief Forget the rows read so far
+   */
+  void
+  Clear ();
+
+  /**
+   * @brief Print the summary as a tab separated table with a header
+   */
+  void
+  Print (std::ostream &os) const;
+
+  /**
+   * @brief Why the last Read failed
+   */
+  const std::string &
+  GetError () const;
+
+private:
+  struct Group
+  {
+    std::vector<long double> m_sums;
+    uint64_t m_rows;
+  };
+
+  enum Derivation
+  {
+    CEILING,
+    SCALE,
+    LABEL
+  };
+
+  struct Derived
+  {
+    Derivation m_derivation;
+    std::string m_sourceName;
+    uint32_t m_source;
+    std::string m_name;
+    double m_factor;
+    std::string m_label;
+  };
+
+  typedef std::map<std::vector<std::string>, Group> Groups;
+
+  class Chunk;
+
+  struct GroupOrder
+  {
+    bool
+    operator() (const Groups::value_type *a, const Groups::value_type *b) const;
+  };
+
+  bool
+  ReadHeader (const char *begin, const char *end);
+
+  void
+  MergeGroups (const Groups &groups, const std::vector<bool> &numeric);
+
+  std::vector<std::string> m_groupNames;
+  std::set<std::string> m_factors;
+  std::map<std::string, std::set<std::string> > m_keepNames;
+  std::vector<Derived> m_derived;
+  Function m_function;
+  std::string m_averaged;
+  std::string m_averageCount;
+
+  // Resolved against the header by Read
+  std::vector<std::string> m_header;
+  std::vector<uint32_t> m_groupColumns;
+  std::vector<bool> m_parse;
+  std::vector<std::pair<uint32_t, const std::set<std::string> *> > m_keep;
+  std::vector<uint32_t> m_valueColumns;
+  std::vector<bool> m_numeric;
+
+  Groups m_groups;
+  std::string m_error;
+};
+
+} // namespace ns3
+
+#endif // TRACE_SUMMARY_H
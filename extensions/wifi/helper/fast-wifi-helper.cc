@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  fast-wifi-helper.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  fast-wifi-helper.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with fast-wifi-helper.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "fast-wifi-helper.h"
+#include "../model/fast-wifi-net-device.h"
+
+#include <ns3-dev/ns3/mac48-address.h>
+
+namespace ns3 {
+
+FastWifiHelper::FastWifiHelper ()
+{
+  m_device.SetTypeId ("ns3::FastWifiNetDevice");
+}
+
+void
+FastWifiHelper::SetDeviceAttribute (std::string name, const AttributeValue &v)
+{
+  m_device.Set (name, v);
+}
+
+NetDeviceContainer
+FastWifiHelper::Install (Ptr<FastWifiChannel> channel, const NodeContainer &nodes) const
+{
+  NetDeviceContainer devices;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); i++)
+    {
+      devices.Add (Install (channel, *i));
+    }
+  return devices;
+}
+
+NetDeviceContainer
+FastWifiHelper::Install (Ptr<FastWifiChannel> channel, Ptr<Node> node) const
+{
+  Ptr<FastWifiNetDevice> device = m_device.Create<FastWifiNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  node->AddDevice (device);
+  device->SetChannel (channel);
+  return NetDeviceContainer (device);
+}
+
+} // namespace ns3
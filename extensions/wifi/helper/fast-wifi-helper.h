@@ -0,0 +1,65 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  fast-wifi-helper.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  fast-wifi-helper.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with fast-wifi-helper.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef FAST_WIFI_HELPER_H
+#define FAST_WIFI_HELPER_H
+
+#include <string>
+
+#include <ns3-dev/ns3/net-device-container.h>
+#include <ns3-dev/ns3/node-container.h>
+#include <ns3-dev/ns3/object-factory.h>
+
+#include "../model/fast-wifi-channel.h"
+
+namespace ns3 {
+
+/**
+ * @brief Creates FastWifiNetDevice objects attached to one FastWifiChannel
+ *
+ * Nodes need their mobility model before they transmit, not before they
+ * are installed.
+ */
+class FastWifiHelper
+{
+public:
+  FastWifiHelper ();
+
+  /**
+   * @brief Set an attribute of the created devices, e.g. AccessPoint or Ssid
+   */
+  void
+  SetDeviceAttribute (std::string name, const AttributeValue &v);
+
+  /**
+   * @brief Create one device per node and attach it to the channel
+   */
+  NetDeviceContainer
+  Install (Ptr<FastWifiChannel> channel, const NodeContainer &nodes) const;
+
+  NetDeviceContainer
+  Install (Ptr<FastWifiChannel> channel, Ptr<Node> node) const;
+
+private:
+  ObjectFactory m_device;
+};
+
+} // namespace ns3
+
+#endif // FAST_WIFI_HELPER_H
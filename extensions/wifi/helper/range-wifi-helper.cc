@@ -0,0 +1,69 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  range-wifi-helper.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  range-wifi-helper.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with range-wifi-helper.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "range-wifi-helper.h"
+#include "../model/range-wifi-phy.h"
+
+#include <ns3-dev/ns3/error-rate-model.h>
+
+namespace ns3 {
+
+RangeWifiPhyHelper::RangeWifiPhyHelper ()
+{
+  m_phy.SetTypeId ("ns3::RangeWifiPhy");
+  SetErrorRateModel ("ns3::NistErrorRateModel");
+}
+
+RangeWifiPhyHelper::~RangeWifiPhyHelper ()
+{
+}
+
+void
+RangeWifiPhyHelper::SetChannel (Ptr<RangeWifiChannel> channel)
+{
+  m_channel = channel;
+}
+
+void
+RangeWifiPhyHelper::Set (std::string name, const AttributeValue &v)
+{
+  m_phy.Set (name, v);
+}
+
+void
+RangeWifiPhyHelper::SetErrorRateModel (std::string name)
+{
+  m_errorRateModel = ObjectFactory ();
+  m_errorRateModel.SetTypeId (name);
+}
+
+Ptr<WifiPhy>
+RangeWifiPhyHelper::Create (Ptr<Node> node, Ptr<NetDevice> device) const
+{
+  // Same order as YansWifiPhyHelper, with the mobility set before the
+  // channel so that the channel can place the PHY in its grid
+  Ptr<RangeWifiPhy> phy = m_phy.Create<RangeWifiPhy> ();
+  phy->SetErrorRateModel (m_errorRateModel.Create<ErrorRateModel> ());
+  phy->SetMobility (node);
+  phy->SetDevice (device);
+  phy->SetChannel (m_channel);
+  return phy;
+}
+
+} // namespace ns3
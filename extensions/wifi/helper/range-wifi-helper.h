@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  range-wifi-helper.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  range-wifi-helper.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with range-wifi-helper.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RANGE_WIFI_HELPER_H
+#define RANGE_WIFI_HELPER_H
+
+#include <string>
+
+#include <ns3-dev/ns3/object-factory.h>
+#include <ns3-dev/ns3/wifi-helper.h>
+
+#include "../model/range-wifi-channel.h"
+
+namespace ns3 {
+
+/**
+ * @brief Creates RangeWifiPhy objects attached to one RangeWifiChannel
+ *
+ * Drop in replacement for YansWifiPhyHelper when used with
+ * WifiHelper::Install. Pcap and ASCII tracing are not supported.
+ */
+class RangeWifiPhyHelper : public WifiPhyHelper
+{
+public:
+  RangeWifiPhyHelper ();
+
+  virtual
+  ~RangeWifiPhyHelper ();
+
+  /**
+   * @brief Channel every created PHY is attached to
+   */
+  void
+  SetChannel (Ptr<RangeWifiChannel> channel);
+
+  /**
+   * @brief Set an attribute of the created PHYs
+   */
+  void
+  Set (std::string name, const AttributeValue &v);
+
+  /**
+   * @brief Select the error rate model (default ns3::NistErrorRateModel)
+   */
+  void
+  SetErrorRateModel (std::string name);
+
+  virtual Ptr<WifiPhy>
+  Create (Ptr<Node> node, Ptr<NetDevice> device) const;
+
+private:
+  ObjectFactory m_phy;
+  ObjectFactory m_errorRateModel;
+  Ptr<RangeWifiChannel> m_channel;
+};
+
+} // namespace ns3
+
+#endif // RANGE_WIFI_HELPER_H
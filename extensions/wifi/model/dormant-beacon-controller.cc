@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  dormant-beacon-controller.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  dormant-beacon-controller.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with dormant-beacon-controller.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "dormant-beacon-controller.h"
+
+#include <cmath>
+
+#include <ns3-dev/ns3/double.h>
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/node.h>
+#include <ns3-dev/ns3/simulator.h>
+#include <ns3-dev/ns3/wifi-net-device.h>
+
+NS_LOG_COMPONENT_DEFINE ("DormantBeaconController");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (DormantBeaconController);
+
+TypeId
+DormantBeaconController::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::DormantBeaconController")
+    .SetParent<Object> ()
+    .AddConstructor<DormantBeaconController> ()
+    .AddAttribute ("WakeRange",
+                   "APs within this distance (meters) of a station keep beaconing",
+                   DoubleValue (250.0),
+                   MakeDoubleAccessor (&DormantBeaconController::m_wakeRange),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("CheckInterval",
+                   "Time between two checks of the station positions",
+                   TimeValue (Seconds (1.0)),
+                   MakeTimeAccessor (&DormantBeaconController::m_checkInterval),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+DormantBeaconController::DormantBeaconController ()
+  : m_wakeRange (250.0)
+  , m_checkInterval (Seconds (1.0))
+  , m_checks (0)
+  , m_wakeUps (0)
+  , m_started (false)
+{
+}
+
+DormantBeaconController::~DormantBeaconController ()
+{
+}
+
+void
+DormantBeaconController::DoDispose ()
+{
+  m_checkEvent.Cancel ();
+  m_aps.clear ();
+  m_stations.clear ();
+  Object::DoDispose ();
+}
+
+void
+DormantBeaconController::AddAps (const NetDeviceContainer &aps)
+{
+  NS_ASSERT_MSG (!m_started, "APs must be added before Start");
+
+  for (uint32_t i = 0; i < aps.GetN (); i++)
+    {
+      Ptr<ApWifiMac> mac = DynamicCast<ApWifiMac> (DynamicCast<WifiNetDevice> (aps.Get (i))->GetMac ());
+      NS_ASSERT_MSG (mac != 0, "Device " << i << " is not a Wi-Fi AP");
+
+      m_aps.push_back (mac);
+      m_apPositions.push_back (aps.Get (i)->GetNode ()->GetObject<MobilityModel> ()->GetPosition ());
+      m_awake.push_back (true);
+      m_awakeList.push_back (m_aps.size () - 1);
+      m_seen.push_back (0);
+    }
+}
+
+void
+DormantBeaconController::AddStations (const NetDeviceContainer &stations)
+{
+  for (uint32_t i = 0; i < stations.GetN (); i++)
+    {
+      Ptr<MobilityModel> mobility = stations.Get (i)->GetNode ()->GetObject<MobilityModel> ();
+      NS_ASSERT_MSG (mobility != 0, "Station " << i << " has no mobility model");
+
+      m_stations.push_back (mobility);
+      mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&DormantBeaconController::CourseChanged, this));
+    }
+}
+
+void
+DormantBeaconController::Start (Time start)
+{
+  // The APs never move, so they are only placed in the grid once
+  m_grid.clear ();
+  for (uint32_t i = 0; i < m_apPositions.size (); i++)
+    {
+      m_grid[GetCell (m_apPositions[i])].push_back (i);
+    }
+
+  m_checkEvent.Cancel ();
+  m_checkEvent = Simulator::Schedule (start, &DormantBeaconController::Check, this);
+}
+
+DormantBeaconController::Cell
+DormantBeaconController::GetCell (const Vector &position) const
+{
+  return Cell ((int32_t) std::floor (position.x / m_wakeRange),
+               (int32_t) std::floor (position.y / m_wakeRange));
+}
+
+void
+DormantBeaconController::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  // A new course may bring the station near dormant APs before the next check
+  if (m_started)
+    {
+      Check ();
+    }
+}
+
+void
+DormantBeaconController::Check ()
+{
+  m_started = true;
+  m_checks++;
+
+  for (std::vector<Ptr<MobilityModel> >::const_iterator s = m_stations.begin ();
+       s != m_stations.end (); s++)
+    {
+      Vector position = (*s)->GetPosition ();
+      Cell centre = GetCell (position);
+
+      for (int32_t dx = -1; dx <= 1; dx++)
+        {
+          for (int32_t dy = -1; dy <= 1; dy++)
+            {
+              std::map<Cell, std::vector<uint32_t> >::const_iterator cell =
+                m_grid.find (Cell (centre.first + dx, centre.second + dy));
+              if (cell == m_grid.end ())
+                continue;
+
+              for (std::vector<uint32_t>::const_iterator i = cell->second.begin ();
+                   i != cell->second.end (); i++)
+                {
+                  if (CalculateDistance (position, m_apPositions[*i]) > m_wakeRange)
+                    continue;
+
+                  m_seen[*i] = m_checks;
+                  if (!m_awake[*i])
+                    {
+                      NS_LOG_INFO ("Waking beacons of AP " << *i);
+                      m_aps[*i]->SetBeaconGeneration (true);
+                      m_awake[*i] = true;
+                      m_awakeList.push_back (*i);
+                      m_wakeUps++;
+                    }
+                }
+            }
+        }
+    }
+
+  // Only APs that were awake may need suspending
+  std::vector<uint32_t>::iterator last = m_awakeList.begin ();
+  for (std::vector<uint32_t>::iterator i = m_awakeList.begin (); i != m_awakeList.end (); i++)
+    {
+      if (m_seen[*i] == m_checks)
+        {
+          *last++ = *i;
+          continue;
+        }
+
+      NS_LOG_INFO ("Suspending beacons of AP " << *i);
+      m_aps[*i]->SetBeaconGeneration (false);
+      m_awake[*i] = false;
+    }
+  m_awakeList.erase (last, m_awakeList.end ());
+
+  m_checkEvent.Cancel ();
+  m_checkEvent = Simulator::Schedule (m_checkInterval, &DormantBeaconController::Check, this);
+}
+
+uint32_t
+DormantBeaconController::GetNAwake () const
+{
+  return m_awakeList.size ();
+}
+
+uint64_t
+DormantBeaconController::GetWakeUps () const
+{
+  return m_wakeUps;
+}
+
+} // namespace ns3
@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  dormant-beacon-controller.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  dormant-beacon-controller.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with dormant-beacon-controller.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef DORMANT_BEACON_CONTROLLER_H
+#define DORMANT_BEACON_CONTROLLER_H
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <ns3-dev/ns3/ap-wifi-mac.h>
+#include <ns3-dev/ns3/event-id.h>
+#include <ns3-dev/ns3/mobility-model.h>
+#include <ns3-dev/ns3/net-device-container.h>
+#include <ns3-dev/ns3/nstime.h>
+#include <ns3-dev/ns3/object.h>
+
+namespace ns3 {
+
+/**
+ * @brief Turns AP beacons off while no station is near
+ *
+ * Every CheckInterval, and whenever a station changes course, the APs
+ * within WakeRange of a station are made to beacon and all other APs are
+ * made dormant. Dormant APs keep answering probe requests and carrying
+ * traffic, they only stop sending beacons.
+ *
+ * WakeRange must cover the distance at which a station may want to hear an
+ * AP, plus the distance a station travels in one CheckInterval.
+ */
+class DormantBeaconController : public Object
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  DormantBeaconController ();
+
+  virtual
+  ~DormantBeaconController ();
+
+  /**
+   * @brief Control the beacons of these AP devices
+   */
+  void
+  AddAps (const NetDeviceContainer &aps);
+
+  /**
+   * @brief Keep the APs near these station devices awake
+   */
+  void
+  AddStations (const NetDeviceContainer &stations);
+
+  /**
+   * @brief Start controlling the beacons at the given time
+   */
+  void
+  Start (Time start = Seconds (0));
+
+  /**
+   * @brief Number of APs currently beaconing
+   */
+  uint32_t
+  GetNAwake () const;
+
+  /**
+   * @brief Number of times an AP was woken up
+   */
+  uint64_t
+  GetWakeUps () const;
+
+protected:
+  virtual void
+  DoDispose ();
+
+private:
+  typedef std::pair<int32_t, int32_t> Cell;
+
+  Cell
+  GetCell (const Vector &position) const;
+
+  void
+  Check ();
+
+  void
+  CourseChanged (Ptr<const MobilityModel> mobility);
+
+  double m_wakeRange;
+  Time m_checkInterval;
+
+  std::vector<Ptr<ApWifiMac> > m_aps;
+  std::vector<Vector> m_apPositions;
+  std::vector<bool> m_awake;
+  std::vector<uint32_t> m_awakeList;
+  std::map<Cell, std::vector<uint32_t> > m_grid;
+
+  std::vector<Ptr<MobilityModel> > m_stations;
+
+  // Stamp of the last check each AP was found near a station in
+  std::vector<uint64_t> m_seen;
+  uint64_t m_checks;
+
+  uint64_t m_wakeUps;
+
+  bool m_started;
+  EventId m_checkEvent;
+};
+
+} // namespace ns3
+
+#endif // DORMANT_BEACON_CONTROLLER_H
@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  fast-wifi-channel.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  fast-wifi-channel.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with fast-wifi-channel.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "fast-wifi-channel.h"
+#include "fast-wifi-net-device.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/mobility-model.h>
+#include <ns3-dev/ns3/simulator.h>
+#include <ns3-dev/ns3/string.h>
+
+NS_LOG_COMPONENT_DEFINE ("FastWifiChannel");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (FastWifiChannel);
+
+TypeId
+FastWifiChannel::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::FastWifiChannel")
+    .SetParent<Channel> ()
+    .AddConstructor<FastWifiChannel> ()
+    .AddAttribute ("RateTable",
+                   "Comma separated distance:rate:loss entries, sorted by distance",
+                   StringValue ("50:24Mbps:0,100:16Mbps:0,150:8Mbps:0.01,200:4Mbps:0.02,250:1Mbps:0.05"),
+                   MakeStringAccessor (&FastWifiChannel::SetRateTable,
+                                       &FastWifiChannel::GetRateTable),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+FastWifiChannel::FastWifiChannel ()
+{
+  m_lossVariable = CreateObject<UniformRandomVariable> ();
+}
+
+FastWifiChannel::~FastWifiChannel ()
+{
+}
+
+uint32_t
+FastWifiChannel::GetNDevices () const
+{
+  return m_devices.size ();
+}
+
+Ptr<NetDevice>
+FastWifiChannel::GetDevice (uint32_t i) const
+{
+  return m_devices[i];
+}
+
+void
+FastWifiChannel::Add (Ptr<FastWifiNetDevice> device)
+{
+  m_devices.push_back (device);
+  Associate (device, device->GetSsid ().PeekString ());
+}
+
+void
+FastWifiChannel::Associate (Ptr<FastWifiNetDevice> device, const std::string &ssid)
+{
+  if (device->IsAccessPoint ())
+    {
+      // An AP serves a single SSID
+      for (std::map<std::string, Ptr<FastWifiNetDevice> >::iterator i = m_aps.begin ();
+           i != m_aps.end (); i++)
+        {
+          if (i->second == device)
+            {
+              m_aps.erase (i);
+              break;
+            }
+        }
+      m_aps[ssid] = device;
+      return;
+    }
+
+  std::map<Ptr<const FastWifiNetDevice>, Ptr<FastWifiNetDevice> >::iterator old = m_association.find (device);
+  if (old != m_association.end ())
+    {
+      std::vector<Ptr<FastWifiNetDevice> > &stations = m_stations[old->second];
+      stations.erase (std::find (stations.begin (), stations.end (), device));
+      m_association.erase (old);
+    }
+
+  std::map<std::string, Ptr<FastWifiNetDevice> >::const_iterator ap = m_aps.find (ssid);
+  if (ap == m_aps.end ())
+    {
+      NS_LOG_INFO ("Node " << device->GetNode ()->GetId () << " has no AP with SSID " << ssid);
+      return;
+    }
+
+  NS_LOG_INFO ("Node " << device->GetNode ()->GetId () << " associated to " << ssid);
+  m_association[device] = ap->second;
+  m_stations[ap->second].push_back (device);
+}
+
+Ptr<FastWifiNetDevice>
+FastWifiChannel::GetAp (Ptr<const FastWifiNetDevice> station) const
+{
+  std::map<Ptr<const FastWifiNetDevice>, Ptr<FastWifiNetDevice> >::const_iterator i = m_association.find (station);
+  return (i != m_association.end ()) ? i->second : 0;
+}
+
+void
+FastWifiChannel::SetRateTable (const std::string &table)
+{
+  std::vector<Entry> entries;
+  std::istringstream is (table);
+  std::string item;
+
+  while (std::getline (is, item, ','))
+    {
+      std::istringstream fields (item);
+      std::string distance, rate, loss;
+      if (!std::getline (fields, distance, ':') || !std::getline (fields, rate, ':')
+          || !std::getline (fields, loss, ':'))
+        {
+          NS_FATAL_ERROR ("Malformed rate table entry \"" << item << "\"");
+        }
+
+      Entry entry;
+      entry.distance = std::atof (distance.c_str ());
+      entry.rate = DataRate (rate);
+      entry.loss = std::atof (loss.c_str ());
+
+      if (!entries.empty () && entry.distance <= entries.back ().distance)
+        {
+          NS_FATAL_ERROR ("Rate table entries must be sorted by distance");
+        }
+      entries.push_back (entry);
+    }
+
+  m_rateTable = table;
+  m_entries.swap (entries);
+}
+
+std::string
+FastWifiChannel::GetRateTable () const
+{
+  return m_rateTable;
+}
+
+const FastWifiChannel::Entry *
+FastWifiChannel::Lookup (double distance) const
+{
+  for (std::vector<Entry>::const_iterator i = m_entries.begin (); i != m_entries.end (); i++)
+    {
+      if (distance <= i->distance)
+        return &(*i);
+    }
+  return 0;
+}
+
+Time
+FastWifiChannel::Send (Ptr<FastWifiNetDevice> sender, Ptr<const Packet> packet, uint16_t protocol,
+                       Mac48Address to, Time start)
+{
+  if (!sender->IsAccessPoint ())
+    {
+      Ptr<FastWifiNetDevice> ap = GetAp (sender);
+      return (ap != 0) ? Deliver (sender, ap, packet, protocol, to, start) : start;
+    }
+
+  // An AP reaches its own stations only, broadcasts at the pace of the
+  // slowest of them
+  Time busy = start;
+  std::map<Ptr<FastWifiNetDevice>, std::vector<Ptr<FastWifiNetDevice> > >::const_iterator stations = m_stations.find (sender);
+  if (stations == m_stations.end ())
+    return busy;
+
+  for (std::vector<Ptr<FastWifiNetDevice> >::const_iterator i = stations->second.begin ();
+       i != stations->second.end (); i++)
+    {
+      if (to.IsBroadcast () || to.IsGroup () || to == Mac48Address::ConvertFrom ((*i)->GetAddress ()))
+        {
+          busy = std::max (busy, Deliver (sender, *i, packet, protocol, to, start));
+        }
+    }
+  return busy;
+}
+
+Time
+FastWifiChannel::Deliver (Ptr<FastWifiNetDevice> sender, Ptr<FastWifiNetDevice> receiver,
+                          Ptr<const Packet> packet, uint16_t protocol, Mac48Address to, Time start)
+{
+  Ptr<MobilityModel> a = sender->GetNode ()->GetObject<MobilityModel> ();
+  Ptr<MobilityModel> b = receiver->GetNode ()->GetObject<MobilityModel> ();
+  double distance = a->GetDistanceFrom (b);
+
+  const Entry *entry = Lookup (distance);
+  if (entry == 0)
+    {
+      NS_LOG_DEBUG ("Node " << receiver->GetNode ()->GetId () << " out of range at " << distance << "m");
+      return start;
+    }
+
+  Time end = start + Seconds (entry->rate.CalculateTxTime (packet->GetSize ()));
+
+  // A lost frame still occupies the sender
+  if (entry->loss > 0 && m_lossVariable->GetValue () < entry->loss)
+    {
+      NS_LOG_DEBUG ("Frame to node " << receiver->GetNode ()->GetId () << " lost at " << distance << "m");
+      return end;
+    }
+
+  Time arrival = end + Seconds (distance / 299792458.0);
+  Simulator::ScheduleWithContext (receiver->GetNode ()->GetId (), arrival - Simulator::Now (),
+                                  &FastWifiNetDevice::Receive, receiver, packet->Copy (), protocol,
+                                  Mac48Address::ConvertFrom (sender->GetAddress ()), to);
+  return end;
+}
+
+int64_t
+FastWifiChannel::AssignStreams (int64_t stream)
+{
+  m_lossVariable->SetStream (stream);
+  return 1;
+}
+
+} // namespace ns3
@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  fast-wifi-channel.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  fast-wifi-channel.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with fast-wifi-channel.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef FAST_WIFI_CHANNEL_H
+#define FAST_WIFI_CHANNEL_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <ns3-dev/ns3/channel.h>
+#include <ns3-dev/ns3/data-rate.h>
+#include <ns3-dev/ns3/mac48-address.h>
+#include <ns3-dev/ns3/nstime.h>
+#include <ns3-dev/ns3/packet.h>
+#include <ns3-dev/ns3/random-variable-stream.h>
+
+namespace ns3 {
+
+class FastWifiNetDevice;
+
+/**
+ * @brief Range based wireless channel for FastWifiNetDevice
+ *
+ * There is no PHY or MAC: a station is associated to the AP whose SSID it
+ * is given as soon as it is given it, and frames only travel between a
+ * station and its AP. The rate a frame is sent at and the probability of
+ * losing it depend on the distance between the two, through RateTable:
+ * a comma separated list of "distance:rate:loss" entries sorted by
+ * distance, each applying up to its distance. Rates are meant as the
+ * throughput seen above the MAC, not PHY rates. Frames to stations further
+ * than the last entry are lost.
+ */
+class FastWifiChannel : public Channel
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  FastWifiChannel ();
+
+  virtual
+  ~FastWifiChannel ();
+
+  virtual uint32_t
+  GetNDevices () const;
+
+  virtual Ptr<NetDevice>
+  GetDevice (uint32_t i) const;
+
+  void
+  Add (Ptr<FastWifiNetDevice> device);
+
+  /**
+   * @brief Move a station to the AP with the given SSID, an unknown SSID
+   * leaves it unassociated. For an AP, serve the given SSID
+   */
+  void
+  Associate (Ptr<FastWifiNetDevice> device, const std::string &ssid);
+
+  /**
+   * @brief AP a station is associated to, null if none
+   */
+  Ptr<FastWifiNetDevice>
+  GetAp (Ptr<const FastWifiNetDevice> station) const;
+
+  /**
+   * @brief Send a frame from a device, starting no earlier than start
+   *
+   * @returns time at which the sender is free again
+   */
+  Time
+  Send (Ptr<FastWifiNetDevice> sender, Ptr<const Packet> packet, uint16_t protocol,
+        Mac48Address to, Time start);
+
+  void
+  SetRateTable (const std::string &table);
+
+  std::string
+  GetRateTable () const;
+
+  int64_t
+  AssignStreams (int64_t stream);
+
+private:
+  struct Entry
+  {
+    double distance;
+    DataRate rate;
+    double loss;
+  };
+
+  /**
+   * @brief Table entry for a distance, null when out of range
+   */
+  const Entry *
+  Lookup (double distance) const;
+
+  /**
+   * @brief Schedule the delivery of a frame to one receiver
+   *
+   * @returns time at which the sender is done with the frame, start if it
+   * was not sent
+   */
+  Time
+  Deliver (Ptr<FastWifiNetDevice> sender, Ptr<FastWifiNetDevice> receiver,
+           Ptr<const Packet> packet, uint16_t protocol, Mac48Address to, Time start);
+
+  std::vector<Ptr<FastWifiNetDevice> > m_devices;
+  std::map<std::string, Ptr<FastWifiNetDevice> > m_aps;
+
+  // Stations of each AP in association order, and AP of each station
+  std::map<Ptr<FastWifiNetDevice>, std::vector<Ptr<FastWifiNetDevice> > > m_stations;
+  std::map<Ptr<const FastWifiNetDevice>, Ptr<FastWifiNetDevice> > m_association;
+
+  std::string m_rateTable;
+  std::vector<Entry> m_entries;
+
+  Ptr<UniformRandomVariable> m_lossVariable;
+};
+
+} // namespace ns3
+
+#endif // FAST_WIFI_CHANNEL_H
@@ -0,0 +1,390 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  fast-wifi-net-device.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  fast-wifi-net-device.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with fast-wifi-net-device.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "fast-wifi-net-device.h"
+
+#include <algorithm>
+
+#include <ns3-dev/ns3/boolean.h>
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/simulator.h>
+#include <ns3-dev/ns3/trace-source-accessor.h>
+#include <ns3-dev/ns3/uinteger.h>
+
+NS_LOG_COMPONENT_DEFINE ("FastWifiNetDevice");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (FastWifiNetDevice);
+
+TypeId
+FastWifiNetDevice::GetTypeId ()
+{
+  // AccessPoint goes before Ssid, so that the SSID is set knowing the role
+  static TypeId tid = TypeId ("ns3::FastWifiNetDevice")
+    .SetParent<NetDevice> ()
+    .AddConstructor<FastWifiNetDevice> ()
+    .AddAttribute ("AccessPoint",
+                   "Whether the device is an AP rather than a station",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&FastWifiNetDevice::m_accessPoint),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Ssid",
+                   "SSID served by an AP, or SSID a station is associated to",
+                   SsidValue (Ssid ("default")),
+                   MakeSsidAccessor (&FastWifiNetDevice::SetSsid,
+                                     &FastWifiNetDevice::GetSsid),
+                   MakeSsidChecker ())
+    .AddAttribute ("Mtu",
+                   "The MAC-level Maximum Transmission Unit",
+                   UintegerValue (2296),
+                   MakeUintegerAccessor (&FastWifiNetDevice::SetMtu,
+                                         &FastWifiNetDevice::GetMtu),
+                   MakeUintegerChecker<uint16_t> (1, 2296))
+    .AddAttribute ("MaxPacketNumber",
+                   "Frames that can wait for the device, as in WifiMacQueue",
+                   UintegerValue (400),
+                   MakeUintegerAccessor (&FastWifiNetDevice::m_maxPackets),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxDelay",
+                   "Time a frame can wait for the device before it is dropped, as in WifiMacQueue",
+                   TimeValue (MilliSeconds (500.0)),
+                   MakeTimeAccessor (&FastWifiNetDevice::m_maxDelay),
+                   MakeTimeChecker ())
+    .AddTraceSource ("MacTx",
+                     "A packet has been handed to the device for transmission",
+                     MakeTraceSourceAccessor (&FastWifiNetDevice::m_txTrace))
+    .AddTraceSource ("MacTxDrop",
+                     "A packet has been dropped, the queue being full or the packet too old",
+                     MakeTraceSourceAccessor (&FastWifiNetDevice::m_txDropTrace))
+    .AddTraceSource ("MacRx",
+                     "A packet has been received by the device",
+                     MakeTraceSourceAccessor (&FastWifiNetDevice::m_rxTrace))
+    .AddTraceSource ("Assoc",
+                     "A station has been associated to the AP with the given address",
+                     MakeTraceSourceAccessor (&FastWifiNetDevice::m_assocTrace))
+    .AddTraceSource ("DeAssoc",
+                     "A station has left the AP with the given address",
+                     MakeTraceSourceAccessor (&FastWifiNetDevice::m_deAssocTrace))
+  ;
+  return tid;
+}
+
+FastWifiNetDevice::FastWifiNetDevice ()
+  : m_ifIndex (0)
+  , m_mtu (2296)
+  , m_accessPoint (false)
+  , m_txBusyUntil (Seconds (0))
+  , m_maxPackets (400)
+  , m_maxDelay (MilliSeconds (500.0))
+{
+}
+
+FastWifiNetDevice::~FastWifiNetDevice ()
+{
+}
+
+void
+FastWifiNetDevice::DoDispose ()
+{
+  m_txEvent.Cancel ();
+  m_queue.clear ();
+  m_node = 0;
+  m_channel = 0;
+  m_rxCallback.Nullify ();
+  m_promiscCallback.Nullify ();
+  NetDevice::DoDispose ();
+}
+
+void
+FastWifiNetDevice::SetChannel (Ptr<FastWifiChannel> channel)
+{
+  m_channel = channel;
+  m_channel->Add (this);
+  m_linkChanges ();
+}
+
+void
+FastWifiNetDevice::SetSsid (Ssid ssid)
+{
+  m_ssid = ssid;
+  if (m_channel == 0)
+    return;
+
+  if (m_accessPoint)
+    {
+      m_channel->Associate (this, ssid.PeekString ());
+      return;
+    }
+
+  // Same traces as StaWifiMac, both at once as the handoff takes no time
+  Ptr<FastWifiNetDevice> old = m_channel->GetAp (this);
+  m_channel->Associate (this, ssid.PeekString ());
+  Ptr<FastWifiNetDevice> ap = m_channel->GetAp (this);
+  if (ap == old)
+    return;
+
+  if (old != 0)
+    m_deAssocTrace (old->m_address);
+  if (ap != 0)
+    m_assocTrace (ap->m_address);
+}
+
+Ssid
+FastWifiNetDevice::GetSsid () const
+{
+  return m_ssid;
+}
+
+bool
+FastWifiNetDevice::IsAccessPoint () const
+{
+  return m_accessPoint;
+}
+
+void
+FastWifiNetDevice::Receive (Ptr<Packet> packet, uint16_t protocol, Mac48Address from, Mac48Address to)
+{
+  NetDevice::PacketType type;
+  if (to.IsBroadcast ())
+    {
+      type = NetDevice::PACKET_BROADCAST;
+    }
+  else if (to.IsGroup ())
+    {
+      type = NetDevice::PACKET_MULTICAST;
+    }
+  else if (to == m_address)
+    {
+      type = NetDevice::PACKET_HOST;
+    }
+  else
+    {
+      type = NetDevice::PACKET_OTHERHOST;
+    }
+
+  m_rxTrace (packet);
+
+  if (!m_promiscCallback.IsNull ())
+    {
+      m_promiscCallback (this, packet, protocol, from, to, type);
+    }
+
+  if (type != NetDevice::PACKET_OTHERHOST)
+    {
+      m_rxCallback (this, packet, protocol, from);
+    }
+}
+
+void
+FastWifiNetDevice::SetIfIndex (const uint32_t index)
+{
+  m_ifIndex = index;
+}
+
+uint32_t
+FastWifiNetDevice::GetIfIndex () const
+{
+  return m_ifIndex;
+}
+
+Ptr<Channel>
+FastWifiNetDevice::GetChannel () const
+{
+  return m_channel;
+}
+
+void
+FastWifiNetDevice::SetAddress (Address address)
+{
+  m_address = Mac48Address::ConvertFrom (address);
+}
+
+Address
+FastWifiNetDevice::GetAddress () const
+{
+  return m_address;
+}
+
+bool
+FastWifiNetDevice::SetMtu (const uint16_t mtu)
+{
+  m_mtu = mtu;
+  return true;
+}
+
+uint16_t
+FastWifiNetDevice::GetMtu () const
+{
+  return m_mtu;
+}
+
+bool
+FastWifiNetDevice::IsLinkUp () const
+{
+  return m_channel != 0;
+}
+
+void
+FastWifiNetDevice::AddLinkChangeCallback (Callback<void> callback)
+{
+  m_linkChanges.ConnectWithoutContext (callback);
+}
+
+bool
+FastWifiNetDevice::IsBroadcast () const
+{
+  return true;
+}
+
+Address
+FastWifiNetDevice::GetBroadcast () const
+{
+  return Mac48Address::GetBroadcast ();
+}
+
+bool
+FastWifiNetDevice::IsMulticast () const
+{
+  return true;
+}
+
+Address
+FastWifiNetDevice::GetMulticast (Ipv4Address multicastGroup) const
+{
+  return Mac48Address::GetMulticast (multicastGroup);
+}
+
+Address
+FastWifiNetDevice::GetMulticast (Ipv6Address addr) const
+{
+  return Mac48Address::GetMulticast (addr);
+}
+
+bool
+FastWifiNetDevice::IsBridge () const
+{
+  return false;
+}
+
+bool
+FastWifiNetDevice::IsPointToPoint () const
+{
+  return false;
+}
+
+bool
+FastWifiNetDevice::Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber)
+{
+  if (m_channel == 0)
+    return false;
+
+  m_txTrace (packet);
+
+  Frame frame;
+  frame.packet = packet;
+  frame.to = Mac48Address::ConvertFrom (dest);
+  frame.protocol = protocolNumber;
+  frame.queued = Simulator::Now ();
+
+  // Frames queue up behind the one being sent
+  if (m_queue.size () >= m_maxPackets)
+    {
+      NS_LOG_DEBUG ("Queue full, dropping frame");
+      m_txDropTrace (packet);
+      return false;
+    }
+  m_queue.push_back (frame);
+
+  if (!m_txEvent.IsRunning ())
+    {
+      if (Simulator::Now () >= m_txBusyUntil)
+        TransmitNext ();
+      else
+        m_txEvent = Simulator::Schedule (m_txBusyUntil - Simulator::Now (), &FastWifiNetDevice::TransmitNext, this);
+    }
+  return true;
+}
+
+void
+FastWifiNetDevice::TransmitNext ()
+{
+  Time now = Simulator::Now ();
+  while (!m_queue.empty () && now - m_queue.front ().queued > m_maxDelay)
+    {
+      NS_LOG_DEBUG ("Frame waited longer than " << m_maxDelay.GetSeconds () << "s, dropping it");
+      m_txDropTrace (m_queue.front ().packet);
+      m_queue.pop_front ();
+    }
+  if (m_queue.empty ())
+    return;
+
+  // The channel looks the distance up now, as the frame starts
+  Frame frame = m_queue.front ();
+  m_queue.pop_front ();
+  m_txBusyUntil = m_channel->Send (this, frame.packet, frame.protocol, frame.to, now);
+
+  if (!m_queue.empty ())
+    m_txEvent = Simulator::Schedule (std::max (m_txBusyUntil - now, Seconds (0)), &FastWifiNetDevice::TransmitNext, this);
+}
+
+bool
+FastWifiNetDevice::SendFrom (Ptr<Packet> packet, const Address &source, const Address &dest, uint16_t protocolNumber)
+{
+  NS_FATAL_ERROR ("FastWifiNetDevice does not support SendFrom");
+  return false;
+}
+
+Ptr<Node>
+FastWifiNetDevice::GetNode () const
+{
+  return m_node;
+}
+
+void
+FastWifiNetDevice::SetNode (Ptr<Node> node)
+{
+  m_node = node;
+}
+
+bool
+FastWifiNetDevice::NeedsArp () const
+{
+  return false;
+}
+
+void
+FastWifiNetDevice::SetReceiveCallback (NetDevice::ReceiveCallback cb)
+{
+  m_rxCallback = cb;
+}
+
+void
+FastWifiNetDevice::SetPromiscReceiveCallback (NetDevice::PromiscReceiveCallback cb)
+{
+  m_promiscCallback = cb;
+}
+
+bool
+FastWifiNetDevice::SupportsSendFrom () const
+{
+  return false;
+}
+
+} // namespace ns3
@@ -0,0 +1,205 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  fast-wifi-net-device.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  fast-wifi-net-device.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with fast-wifi-net-device.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef FAST_WIFI_NET_DEVICE_H
+#define FAST_WIFI_NET_DEVICE_H
+
+#include <deque>
+
+#include <ns3-dev/ns3/event-id.h>
+#include <ns3-dev/ns3/mac48-address.h>
+#include <ns3-dev/ns3/net-device.h>
+#include <ns3-dev/ns3/node.h>
+#include <ns3-dev/ns3/nstime.h>
+#include <ns3-dev/ns3/ssid.h>
+#include <ns3-dev/ns3/traced-callback.h>
+
+#include "fast-wifi-channel.h"
+
+namespace ns3 {
+
+/**
+ * @brief Wireless net device without PHY or MAC, for large sweeps
+ *
+ * An AP device serves the SSID it is given. A station device is associated
+ * to the AP with its SSID the moment the SSID is set, so handoffs are
+ * instantaneous, and fires the Assoc and DeAssoc traces of StaWifiMac
+ * right away. Frames are sent one after the other at the rate the
+ * FastWifiChannel gives for the distance when they start, and each costs
+ * a single event at the receiver. Frames waiting for the device to be
+ * free are queued like in WifiMacQueue: beyond MaxPacketNumber frames they
+ * are dropped, and so are frames that waited longer than MaxDelay.
+ */
+class FastWifiNetDevice : public NetDevice
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  FastWifiNetDevice ();
+
+  virtual
+  ~FastWifiNetDevice ();
+
+  void
+  SetChannel (Ptr<FastWifiChannel> channel);
+
+  /**
+   * @brief For an AP the SSID it serves, for a station the SSID of the AP
+   * to associate to
+   */
+  void
+  SetSsid (Ssid ssid);
+
+  Ssid
+  GetSsid () const;
+
+  bool
+  IsAccessPoint () const;
+
+  /**
+   * @brief Called by the channel when a frame arrives
+   */
+  void
+  Receive (Ptr<Packet> packet, uint16_t protocol, Mac48Address from, Mac48Address to);
+
+  // NetDevice
+  virtual void
+  SetIfIndex (const uint32_t index);
+
+  virtual uint32_t
+  GetIfIndex () const;
+
+  virtual Ptr<Channel>
+  GetChannel () const;
+
+  virtual void
+  SetAddress (Address address);
+
+  virtual Address
+  GetAddress () const;
+
+  virtual bool
+  SetMtu (const uint16_t mtu);
+
+  virtual uint16_t
+  GetMtu () const;
+
+  virtual bool
+  IsLinkUp () const;
+
+  virtual void
+  AddLinkChangeCallback (Callback<void> callback);
+
+  virtual bool
+  IsBroadcast () const;
+
+  virtual Address
+  GetBroadcast () const;
+
+  virtual bool
+  IsMulticast () const;
+
+  virtual Address
+  GetMulticast (Ipv4Address multicastGroup) const;
+
+  virtual Address
+  GetMulticast (Ipv6Address addr) const;
+
+  virtual bool
+  IsBridge () const;
+
+  virtual bool
+  IsPointToPoint () const;
+
+  virtual bool
+  Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
+
+  virtual bool
+  SendFrom (Ptr<Packet> packet, const Address &source, const Address &dest, uint16_t protocolNumber);
+
+  virtual Ptr<Node>
+  GetNode () const;
+
+  virtual void
+  SetNode (Ptr<Node> node);
+
+  virtual bool
+  NeedsArp () const;
+
+  virtual void
+  SetReceiveCallback (NetDevice::ReceiveCallback cb);
+
+  virtual void
+  SetPromiscReceiveCallback (NetDevice::PromiscReceiveCallback cb);
+
+  virtual bool
+  SupportsSendFrom () const;
+
+protected:
+  virtual void
+  DoDispose ();
+
+private:
+  struct Frame
+  {
+    Ptr<Packet> packet;
+    Mac48Address to;
+    uint16_t protocol;
+    Time queued;
+  };
+
+  /**
+   * @brief Send the oldest queued frame that has not expired, from where
+   * the nodes are now
+   */
+  void
+  TransmitNext ();
+
+  Ptr<Node> m_node;
+  Ptr<FastWifiChannel> m_channel;
+  Mac48Address m_address;
+  uint32_t m_ifIndex;
+  uint16_t m_mtu;
+
+  bool m_accessPoint;
+  Ssid m_ssid;
+
+  // The device is busy sending until then, TransmitNext is scheduled
+  // then while frames wait
+  Time m_txBusyUntil;
+  EventId m_txEvent;
+  std::deque<Frame> m_queue;
+  uint32_t m_maxPackets;
+  Time m_maxDelay;
+
+  NetDevice::ReceiveCallback m_rxCallback;
+  NetDevice::PromiscReceiveCallback m_promiscCallback;
+  TracedCallback<> m_linkChanges;
+
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+  TracedCallback<Ptr<const Packet> > m_txDropTrace;
+  TracedCallback<Ptr<const Packet> > m_rxTrace;
+  TracedCallback<Mac48Address> m_assocTrace;
+  TracedCallback<Mac48Address> m_deAssocTrace;
+};
+
+} // namespace ns3
+
+#endif // FAST_WIFI_NET_DEVICE_H
@@ -0,0 +1,285 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  range-wifi-channel.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  range-wifi-channel.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with range-wifi-channel.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "range-wifi-channel.h"
+#include "range-wifi-phy.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <ns3-dev/ns3/constant-position-mobility-model.h>
+#include <ns3-dev/ns3/double.h>
+#include <ns3-dev/ns3/log.h>
+#include <ns3-dev/ns3/net-device.h>
+#include <ns3-dev/ns3/node.h>
+#include <ns3-dev/ns3/pointer.h>
+#include <ns3-dev/ns3/simulator.h>
+
+NS_LOG_COMPONENT_DEFINE ("RangeWifiChannel");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (RangeWifiChannel);
+
+TypeId
+RangeWifiChannel::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::RangeWifiChannel")
+    .SetParent<WifiChannel> ()
+    .AddConstructor<RangeWifiChannel> ()
+    .AddAttribute ("MaxRange",
+                   "Distance in metres beyond which frames are not delivered",
+                   DoubleValue (1000.0),
+                   MakeDoubleAccessor (&RangeWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("PropagationLossModel", "A pointer to the propagation loss model attached to this channel.",
+                   PointerValue (),
+                   MakePointerAccessor (&RangeWifiChannel::m_loss),
+                   MakePointerChecker<PropagationLossModel> ())
+    .AddAttribute ("PropagationDelayModel", "A pointer to the propagation delay model attached to this channel.",
+                   PointerValue (),
+                   MakePointerAccessor (&RangeWifiChannel::m_delay),
+                   MakePointerChecker<PropagationDelayModel> ())
+  ;
+  return tid;
+}
+
+RangeWifiChannel::RangeWifiChannel ()
+  : m_maxRange (1000.0)
+  , m_culled (0)
+{
+}
+
+RangeWifiChannel::~RangeWifiChannel ()
+{
+  m_phyList.clear ();
+  m_mobility.clear ();
+}
+
+uint32_t
+RangeWifiChannel::GetNDevices () const
+{
+  return m_phyList.size ();
+}
+
+Ptr<NetDevice>
+RangeWifiChannel::GetDevice (uint32_t i) const
+{
+  return m_phyList[i]->GetDevice ()->GetObject<NetDevice> ();
+}
+
+void
+RangeWifiChannel::SetPropagationLossModel (Ptr<PropagationLossModel> loss)
+{
+  m_loss = loss;
+}
+
+void
+RangeWifiChannel::SetPropagationDelayModel (Ptr<PropagationDelayModel> delay)
+{
+  m_delay = delay;
+}
+
+void
+RangeWifiChannel::Add (Ptr<RangeWifiPhy> phy)
+{
+  uint32_t i = m_phyList.size ();
+  Ptr<MobilityModel> mobility = phy->GetMobility ()->GetObject<MobilityModel> ();
+  NS_ASSERT_MSG (mobility != 0, "RangeWifiChannel needs the mobility model installed before the Wi-Fi card");
+
+  m_phyList.push_back (phy);
+  m_mobility.push_back (mobility);
+  m_cellOf.push_back (Cell (0, 0));
+  m_moving.push_back (false);
+
+  std::vector<uint32_t> &same = m_byMobility[PeekPointer (mobility)];
+  if (same.empty ())
+    {
+      mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&RangeWifiChannel::CourseChanged, this));
+    }
+  same.push_back (i);
+
+  Place (i);
+}
+
+RangeWifiChannel::Cell
+RangeWifiChannel::GetCell (const Vector &position) const
+{
+  return Cell ((int32_t) std::floor (position.x / m_maxRange),
+               (int32_t) std::floor (position.y / m_maxRange));
+}
+
+void
+RangeWifiChannel::Place (uint32_t i)
+{
+  Vector velocity = m_mobility[i]->GetVelocity ();
+  if (velocity.x != 0 || velocity.y != 0 || velocity.z != 0)
+    {
+      m_moving[i] = true;
+      m_movingList.push_back (i);
+    }
+  else
+    {
+      m_moving[i] = false;
+      m_cellOf[i] = GetCell (m_mobility[i]->GetPosition ());
+      m_grid[m_cellOf[i]].push_back (i);
+    }
+}
+
+void
+RangeWifiChannel::Unplace (uint32_t i)
+{
+  std::vector<uint32_t> &list = m_moving[i] ? m_movingList : m_grid[m_cellOf[i]];
+  list.erase (std::find (list.begin (), list.end (), i));
+}
+
+void
+RangeWifiChannel::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  // Nodes that stop go back to the grid, nodes that start moving leave it
+  const std::vector<uint32_t> &phys = m_byMobility[PeekPointer (mobility)];
+  for (std::vector<uint32_t>::const_iterator i = phys.begin (); i != phys.end (); i++)
+    {
+      Unplace (*i);
+      Place (*i);
+    }
+}
+
+void
+RangeWifiChannel::Send (Ptr<RangeWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm,
+                        WifiTxVector txVector, WifiPreamble preamble)
+{
+  Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
+  NS_ASSERT (senderMobility != 0);
+
+  Cell centre = GetCell (senderMobility->GetPosition ());
+  for (int32_t dx = -1; dx <= 1; dx++)
+    {
+      for (int32_t dy = -1; dy <= 1; dy++)
+        {
+          std::map<Cell, std::vector<uint32_t> >::const_iterator cell =
+            m_grid.find (Cell (centre.first + dx, centre.second + dy));
+          if (cell == m_grid.end ())
+            continue;
+
+          for (std::vector<uint32_t>::const_iterator i = cell->second.begin ();
+               i != cell->second.end (); i++)
+            {
+              Deliver (sender, senderMobility, *i, packet, txPowerDbm, txVector, preamble);
+            }
+        }
+    }
+
+  for (std::vector<uint32_t>::const_iterator i = m_movingList.begin ();
+       i != m_movingList.end (); i++)
+    {
+      Deliver (sender, senderMobility, *i, packet, txPowerDbm, txVector, preamble);
+    }
+}
+
+void
+RangeWifiChannel::Deliver (Ptr<RangeWifiPhy> sender, Ptr<MobilityModel> senderMobility, uint32_t i,
+                           Ptr<const Packet> packet, double txPowerDbm, WifiTxVector txVector,
+                           WifiPreamble preamble)
+{
+  Ptr<RangeWifiPhy> receiver = m_phyList[i];
+
+  // For now don't account for inter channel interference
+  if (receiver == sender || receiver->GetChannelNumber () != sender->GetChannelNumber ())
+    return;
+
+  Ptr<MobilityModel> receiverMobility = m_mobility[i];
+  double distance = senderMobility->GetDistanceFrom (receiverMobility);
+  if (distance > m_maxRange)
+    {
+      m_culled++;
+      return;
+    }
+
+  Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+  NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << distance << "m, delay=" << delay);
+
+  Ptr<Packet> copy = packet->Copy ();
+  Ptr<Object> dstNetDevice = receiver->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+    }
+
+  Simulator::ScheduleWithContext (dstNode, delay, &RangeWifiChannel::Receive, this,
+                                  i, copy, rxPowerDbm, txVector, preamble);
+}
+
+void
+RangeWifiChannel::Receive (uint32_t i, Ptr<Packet> packet, double rxPowerDbm,
+                           WifiTxVector txVector, WifiPreamble preamble) const
+{
+  m_phyList[i]->StartReceivePacket (packet, rxPowerDbm, txVector, preamble);
+}
+
+double
+RangeWifiChannel::FindMaxRange (Ptr<PropagationLossModel> loss, double txPowerDbm,
+                                double thresholdDbm, double maxDistance)
+{
+  Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0, 0, 0));
+
+  b->SetPosition (Vector (maxDistance, 0, 0));
+  if (loss->CalcRxPower (txPowerDbm, a, b) >= thresholdDbm)
+    return maxDistance;
+
+  // Bisect for the distance at which the power falls under the threshold
+  double low = 0;
+  double high = maxDistance;
+  while (high - low > 1)
+    {
+      double mid = (low + high) / 2;
+      b->SetPosition (Vector (mid, 0, 0));
+      if (loss->CalcRxPower (txPowerDbm, a, b) >= thresholdDbm)
+        low = mid;
+      else
+        high = mid;
+    }
+
+  return high;
+}
+
+uint64_t
+RangeWifiChannel::GetCulledCount () const
+{
+  return m_culled;
+}
+
+int64_t
+RangeWifiChannel::AssignStreams (int64_t stream)
+{
+  int64_t currentStream = stream;
+  currentStream += m_loss->AssignStreams (stream);
+  return (currentStream - stream);
+}
+
+} // namespace ns3
@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  range-wifi-channel.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  range-wifi-channel.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with range-wifi-channel.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RANGE_WIFI_CHANNEL_H
+#define RANGE_WIFI_CHANNEL_H
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <ns3-dev/ns3/mobility-model.h>
+#include <ns3-dev/ns3/packet.h>
+#include <ns3-dev/ns3/propagation-delay-model.h>
+#include <ns3-dev/ns3/propagation-loss-model.h>
+#include <ns3-dev/ns3/wifi-channel.h>
+#include <ns3-dev/ns3/wifi-mode.h>
+#include <ns3-dev/ns3/wifi-preamble.h>
+#include <ns3-dev/ns3/wifi-tx-vector.h>
+
+namespace ns3 {
+
+class RangeWifiPhy;
+
+/**
+ * @brief Wi-Fi channel that only delivers frames to PHYs within range
+ *
+ * Behaves like YansWifiChannel, with the same loss and delay models, except
+ * that receivers further away than MaxRange from the sender are skipped
+ * before any propagation loss is computed or receive event scheduled.
+ *
+ * Static PHYs are kept in a square grid with cells of MaxRange metres, so a
+ * transmission only looks at the 3x3 cells around the sender. PHYs whose
+ * node is moving are kept in a separate list that is checked on every
+ * transmission. The mobility CourseChange trace moves PHYs between the two.
+ *
+ * MaxRange must be conservative: frames beyond it are never delivered, not
+ * even as interference. FindMaxRange computes one from a deterministic loss
+ * model.
+ */
+class RangeWifiChannel : public WifiChannel
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  RangeWifiChannel ();
+
+  virtual
+  ~RangeWifiChannel ();
+
+  virtual uint32_t
+  GetNDevices () const;
+
+  virtual Ptr<NetDevice>
+  GetDevice (uint32_t i) const;
+
+  /**
+   * @brief Attach a PHY to the channel
+   */
+  void
+  Add (Ptr<RangeWifiPhy> phy);
+
+  void
+  SetPropagationLossModel (Ptr<PropagationLossModel> loss);
+
+  void
+  SetPropagationDelayModel (Ptr<PropagationDelayModel> delay);
+
+  /**
+   * @brief Deliver a frame to every PHY within range on the sender's channel
+   * number. Same signature as YansWifiChannel::Send
+   */
+  void
+  Send (Ptr<RangeWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm,
+        WifiTxVector txVector, WifiPreamble preamble);
+
+  /**
+   * @brief Distance beyond which the received power is below thresholdDbm
+   *
+   * @param loss Deterministic loss model, non increasing with distance
+   * @param txPowerDbm Highest transmission power, including antenna gains
+   * @param thresholdDbm Weakest received power that still matters
+   * @param maxDistance Upper bound of the search
+   */
+  static double
+  FindMaxRange (Ptr<PropagationLossModel> loss, double txPowerDbm,
+                double thresholdDbm, double maxDistance = 100000);
+
+  /**
+   * @brief Number of receptions skipped because the receiver was out of range
+   */
+  uint64_t
+  GetCulledCount () const;
+
+  int64_t
+  AssignStreams (int64_t stream);
+
+private:
+  typedef std::pair<int32_t, int32_t> Cell;
+
+  Cell
+  GetCell (const Vector &position) const;
+
+  void
+  Place (uint32_t i);
+
+  void
+  Unplace (uint32_t i);
+
+  void
+  CourseChanged (Ptr<const MobilityModel> mobility);
+
+  void
+  Deliver (Ptr<RangeWifiPhy> sender, Ptr<MobilityModel> senderMobility, uint32_t i,
+           Ptr<const Packet> packet, double txPowerDbm, WifiTxVector txVector,
+           WifiPreamble preamble);
+
+  void
+  Receive (uint32_t i, Ptr<Packet> packet, double rxPowerDbm,
+           WifiTxVector txVector, WifiPreamble preamble) const;
+
+  double m_maxRange;
+
+  std::vector<Ptr<RangeWifiPhy> > m_phyList;
+  std::vector<Ptr<MobilityModel> > m_mobility;
+
+  // Grid cell of each static PHY, and whether it is on the moving list
+  std::vector<Cell> m_cellOf;
+  std::vector<bool> m_moving;
+
+  std::map<Cell, std::vector<uint32_t> > m_grid;
+  std::vector<uint32_t> m_movingList;
+
+  // PHYs per mobility model, for the CourseChange trace
+  std::map<const MobilityModel *, std::vector<uint32_t> > m_byMobility;
+
+  Ptr<PropagationLossModel> m_loss;
+  Ptr<PropagationDelayModel> m_delay;
+
+  uint64_t m_culled;
+};
+
+} // namespace ns3
+
+#endif // RANGE_WIFI_CHANNEL_H
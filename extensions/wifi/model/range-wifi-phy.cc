@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  range-wifi-phy.cc is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  range-wifi-phy.cc is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with range-wifi-phy.cc.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "range-wifi-phy.h"
+
+#include <ns3-dev/ns3/log.h>
+
+NS_LOG_COMPONENT_DEFINE ("RangeWifiPhy");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (RangeWifiPhy);
+
+TypeId
+RangeWifiPhy::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::RangeWifiPhy")
+    .SetParent<YansWifiPhy> ()
+    .AddConstructor<RangeWifiPhy> ()
+  ;
+  return tid;
+}
+
+RangeWifiPhy::RangeWifiPhy ()
+{
+}
+
+RangeWifiPhy::~RangeWifiPhy ()
+{
+}
+
+void
+RangeWifiPhy::DoDispose ()
+{
+  m_rangeChannel = 0;
+  YansWifiPhy::DoDispose ();
+}
+
+void
+RangeWifiPhy::SetChannel (Ptr<RangeWifiChannel> channel)
+{
+  // The private channel only ever holds this PHY, so its loss and delay
+  // models are never consulted
+  YansWifiPhy::SetChannel (CreateObject<YansWifiChannel> ());
+
+  m_rangeChannel = channel;
+  m_rangeChannel->Add (this);
+}
+
+Ptr<WifiChannel>
+RangeWifiPhy::GetChannel () const
+{
+  return m_rangeChannel;
+}
+
+double
+RangeWifiPhy::GetTxPowerDbm (uint8_t level) const
+{
+  // Same computation as YansWifiPhy::GetPowerDbm, which is private
+  double dbm = GetTxPowerStart ();
+  if (GetNTxPower () > 1)
+    {
+      dbm += level * (GetTxPowerEnd () - GetTxPowerStart ()) / (GetNTxPower () - 1);
+    }
+  return dbm + GetTxGain ();
+}
+
+void
+RangeWifiPhy::SendPacket (Ptr<const Packet> packet, WifiMode mode, enum WifiPreamble preamble,
+                          WifiTxVector txVector)
+{
+  YansWifiPhy::SendPacket (packet, mode, preamble, txVector);
+
+  // The base only moves to TX when it really transmitted the frame
+  if (IsStateTx ())
+    {
+      m_rangeChannel->Send (this, packet, GetTxPowerDbm (txVector.GetTxPowerLevel ()),
+                            txVector, preamble);
+    }
+}
+
+} // namespace ns3
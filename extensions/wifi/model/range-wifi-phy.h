@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu" -*- */
+/*
+ * Copyright 2014 Waseda University, Sato Laboratory
+ *
+ *  range-wifi-phy.h is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  range-wifi-phy.h is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with range-wifi-phy.h.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RANGE_WIFI_PHY_H
+#define RANGE_WIFI_PHY_H
+
+#include <ns3-dev/ns3/yans-wifi-channel.h>
+#include <ns3-dev/ns3/yans-wifi-phy.h>
+
+#include "range-wifi-channel.h"
+
+namespace ns3 {
+
+/**
+ * @brief YansWifiPhy attached to a RangeWifiChannel
+ *
+ * YansWifiChannel::Send is not virtual, so the PHY cannot simply be given
+ * another channel. Instead the YansWifiPhy base is attached to a private
+ * channel holding only this PHY, which keeps all of its transmission state
+ * handling while delivering to nobody. Once the base has started the
+ * transmission, the frame is handed to the RangeWifiChannel with the same
+ * power the base would have used.
+ */
+class RangeWifiPhy : public YansWifiPhy
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  RangeWifiPhy ();
+
+  virtual
+  ~RangeWifiPhy ();
+
+  /**
+   * @brief Attach the PHY to the channel it really transmits on
+   */
+  void
+  SetChannel (Ptr<RangeWifiChannel> channel);
+
+  virtual Ptr<WifiChannel>
+  GetChannel () const;
+
+  virtual void
+  SendPacket (Ptr<const Packet> packet, WifiMode mode, enum WifiPreamble preamble,
+              WifiTxVector txVector);
+
+protected:
+  virtual void
+  DoDispose ();
+
+private:
+  double
+  GetTxPowerDbm (uint8_t level) const;
+
+  Ptr<RangeWifiChannel> m_rangeChannel;
+};
+
+} // namespace ns3
+
+#endif // RANGE_WIFI_PHY_H
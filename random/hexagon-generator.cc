@@ -0,0 +1,319 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Copyright (c) 2014 Waseda University
+ * hexagon-generator.cc
+ *
+ *  Native replacement for hexagon-random.py. Lays out hexagonal sectors
+ *  over an area and places a number of wireless access points inside each
+ *  sector using the same rhombus sampling as randinunithex. The output is
+ *  the rand-hex.txt text format read by the scenarios, or an equivalent
+ *  binary file when --binary is given.
+ *
+ *  Binary layout (native byte order):
+ *    char[4]  "HEXB"
+ *    uint32   version (1)
+ *    double   X axis, Y axis
+ *    uint32   sectors, APs per sector, total APs
+ *    double   sectors * (x, y) sector centres
+ *    double   total APs * (x, y) AP positions
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/time.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/program_options.hpp>
+
+using namespace std;
+namespace br = boost::random;
+namespace po = boost::program_options;
+
+br::mt19937_64 gen;
+
+// Vectors that define a hexagon
+const double vectors[3][2] = { { 0.0, -1.0 }, { -0.8660254037844386, 0.5 }, { 0.8660254037844386, 0.5 } };
+
+struct Point
+{
+	double x;
+	double y;
+};
+
+// Puts a point within the hexagon, exactly as randinunithex does.
+// center gives the center of the hexagon
+// size tells us the length of the side of the hexagon
+// side tells us in which rhombus to put the wireless station
+Point randinunithex(const Point &center, int size, int side)
+{
+	const double *v1 = vectors[side];
+	const double *v2 = vectors[(side+1)%3];
+
+	br::uniform_int_distribution<> xdist(0, size-1);
+	br::uniform_int_distribution<> ydist(1, size-1);
+
+	int x = xdist(gen);
+	int y = ydist(gen);
+
+	Point res;
+	res.x = x*v1[0] + y*v2[0] + center.x;
+	res.y = x*v1[1] + y*v2[1] + center.y;
+	return res;
+}
+
+// Same semantics as frange in hexagon-random.py: the values are computed
+// as start + n*inc and stop before reaching end
+void frange(double start, double end, double inc, vector<double> &res)
+{
+	res.clear();
+	for (;;)
+	{
+		double next = start + res.size() * inc;
+		if (next >= end)
+			break;
+		res.push_back(next);
+	}
+}
+
+// Number of sector centres the python lattice produces for an area
+size_t countSectors(double r, double xaxis, double yaxis)
+{
+	vector<double> rows, cols;
+	size_t total = 0;
+
+	frange(2*r, yaxis, 6*r, rows);
+	frange(r*sqrt(3.), xaxis, 2*r*sqrt(3.), cols);
+	total += rows.size() * cols.size();
+
+	frange(5*r, yaxis, 6*r, rows);
+	frange(0, xaxis, 2*r*sqrt(3.), cols);
+	total += rows.size() * cols.size();
+
+	return total;
+}
+
+// Writes a double the way python writes repr(float): shortest digits that
+// read back to the same value, with a trailing .0 for integral values
+int formatDouble(char *buf, size_t len, double val)
+{
+	int n = 0;
+	for (int prec = 15; prec <= 17; prec++)
+	{
+		n = snprintf(buf, len, "%.*g", prec, val);
+		if (strtod(buf, NULL) == val)
+			break;
+	}
+
+	if (strpbrk(buf, ".eEn") == NULL)
+	{
+		buf[n++] = '.';
+		buf[n++] = '0';
+		buf[n] = '\0';
+	}
+	return n;
+}
+
+void writePoint(FILE *out, const Point &p)
+{
+	char buf[64];
+	formatDouble(buf, sizeof(buf), p.x);
+	fputs(buf, out);
+	fputc(',', out);
+	formatDouble(buf, sizeof(buf), p.y);
+	fputs(buf, out);
+	fputc('\n', out);
+}
+
+void writeText(FILE *out, double xaxis, double yaxis, uint32_t w,
+		const vector<Point> &resGW, const vector<Point> &resN)
+{
+	char buf[64];
+
+	// Print size of the area covered
+	formatDouble(buf, sizeof(buf), xaxis);
+	fprintf(out, "%s\n", buf);
+	formatDouble(buf, sizeof(buf), yaxis);
+	fprintf(out, "%s\n", buf);
+	// Number of GWs
+	fprintf(out, "%lu\n", (unsigned long)resGW.size());
+	// Positions of the GWs
+	for (size_t i = 0; i < resGW.size(); i++)
+		writePoint(out, resGW[i]);
+	// Number of wireless nodes per GW
+	fprintf(out, "%u\n", w);
+	// Total number of wireless nodes
+	fprintf(out, "%lu\n", (unsigned long)resN.size());
+	// Positions of the wireless capable nodes
+	for (size_t i = 0; i < resN.size(); i++)
+		writePoint(out, resN[i]);
+}
+
+void writeBinary(FILE *out, double xaxis, double yaxis, uint32_t w,
+		const vector<Point> &resGW, const vector<Point> &resN)
+{
+	uint32_t version = 1;
+	uint32_t counts[3] = { (uint32_t)resGW.size(), w, (uint32_t)resN.size() };
+	double axis[2] = { xaxis, yaxis };
+
+	fwrite("HEXB", 1, 4, out);
+	fwrite(&version, sizeof(version), 1, out);
+	fwrite(axis, sizeof(double), 2, out);
+	fwrite(counts, sizeof(uint32_t), 3, out);
+	if (!resGW.empty())
+		fwrite(&resGW[0], sizeof(Point), resGW.size(), out);
+	if (!resN.empty())
+		fwrite(&resN[0], sizeof(Point), resN.size(), out);
+}
+
+int main(int ac, char* av[])
+{
+	po::variables_map vm;
+
+	try {
+
+		po::options_description desc("Allowed options");
+		desc.add_options()
+	            		("help", "Produce this help message")
+	            		("radius,r", po::value<double>()->default_value(100.0), "Radius of the range of the Wireless station (meters)")
+	            		("xaxis,x", po::value<double>()->default_value(1000.0), "Size of the X axis for the area to use (meters)")
+	            		("yaxis,y", po::value<double>()->default_value(1000.0), "Size of the Y axis for the area to use (meters)")
+	            		("wireless,w", po::value<uint32_t>()->default_value(6), "Number of wireless stations to put in one hexagon area")
+	            		("sectors,n", po::value<uint32_t>(), "Number of sectors to lay out. Grows a square area to fit them, ignoring --xaxis and --yaxis")
+	            		("output,o", po::value<string>()->default_value("rand-hex"), "Specifies the output name for the resulting file")
+	            		("binary,b", "Write the binary layout (.bin) instead of text (.txt)")
+	            		("seed,s", po::value<uint64_t>(), "Seed for the random number generator")
+	            		;
+
+		po::store(po::parse_command_line(ac, av, desc), vm);
+		po::notify(vm);
+
+		if (vm.count("help")) {
+			cout << desc << "\n";
+			return 0;
+		}
+	}
+	catch(std::exception& e) {
+		cerr << "error: " << e.what() << "\n";
+		return 1;
+	}
+	catch(...) {
+		cerr << "Exception of unknown type!\n";
+	}
+
+	if (vm.count("seed"))
+		gen.seed(vm["seed"].as<uint64_t>());
+	else
+		gen.seed((uint64_t)std::time(0) ^ ((uint64_t)getpid() << 32));
+
+	double r = vm["radius"].as<double>();
+	double x = vm["xaxis"].as<double>();
+	double y = vm["yaxis"].as<double>();
+	uint32_t w = vm["wireless"].as<uint32_t>();
+	size_t limit = 0;
+
+	// randrange only accepts whole sizes
+	if (r < 2 || r != floor(r)) {
+		cerr << "Radius must be a whole number of meters greater than 1!" << endl;
+		return 1;
+	}
+
+	if (vm.count("sectors")) {
+		limit = vm["sectors"].as<uint32_t>();
+
+		// Each pair of interleaved lattice cells covers 12*sqrt(3)*r^2
+		x = floor(sqrt(limit * 6 * sqrt(3.) * r * r));
+		while (countSectors(r, x, x) < limit)
+			x += r;
+		y = x;
+	}
+
+	struct timeval start, end;
+	gettimeofday(&start, NULL);
+
+	// Specify the initial points to use in the algorithm
+	Point spoints[2] = { { r*sqrt(3.), 2*r }, { 0, 5*r } };
+
+	// Always divided in 3 zones which correspond to 3 rhombus of regular hexagon
+	vector<int> sides;
+	for (uint32_t i = 0; i < w / 3; i++)
+		for (int j = 0; j < 3; j++)
+			sides.push_back(j);
+
+	for (uint32_t i = 0; i < w % 3; i++)
+		sides.push_back(i);
+
+	size_t total = (limit > 0) ? limit : countSectors(r, x, y);
+
+	vector<Point> resGW;
+	vector<Point> resN;
+	resGW.reserve(total);
+	resN.reserve(total * w);
+
+	vector<double> rows, cols;
+
+	// Create all the points
+	for (int s = 0; s < 2; s++)
+	{
+		frange(spoints[s].y, y, 6*r, rows);
+		frange(spoints[s].x, x, 2*r*sqrt(3.), cols);
+
+		for (size_t i = 0; i < rows.size() && resGW.size() < total; i++)
+		{
+			for (size_t j = 0; j < cols.size() && resGW.size() < total; j++)
+			{
+				Point center = { cols[j], rows[i] };
+				resGW.push_back(center);
+
+				for (size_t k = 0; k < sides.size(); k++)
+					resN.push_back(randinunithex(center, (int)r, sides[k]));
+			}
+		}
+	}
+
+	string filename = vm["output"].as<string>();
+	filename += vm.count("binary") ? ".bin" : ".txt";
+
+	FILE *out = fopen(filename.c_str(), "wb");
+	if (out == NULL) {
+		cerr << "Could not open " << filename << " for writing!" << endl;
+		return 1;
+	}
+
+	static char iobuf[1 << 20];
+	setvbuf(out, iobuf, _IOFBF, sizeof(iobuf));
+
+	if (vm.count("binary"))
+		writeBinary(out, x, y, w, resGW, resN);
+	else
+		writeText(out, x, y, w, resGW, resN);
+
+	fclose(out);
+
+	gettimeofday(&end, NULL);
+
+	cerr << "Wrote " << resGW.size() << " sectors, " << resN.size() << " APs to "
+	     << filename << " in "
+	     << (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) * 1e-6
+	     << " s" << endl;
+
+	return 0;
+}
@@ -29,6 +29,7 @@
 #include <iterator>
 #include <iostream>
 #include <map>
+#include <sstream>
 #include <string>
 #include <sys/time.h>
 #include <vector>
@@ -59,6 +60,7 @@
 
 // Extension files
 // #include "minstrel-wifi-manager.h"
+#include "mobility/helper/sector-topology-helper.h"
 
 using namespace ns3;
 using namespace boost;
@@ -94,15 +96,12 @@ double obtain_Num(double min, double max)
 	return dist(gen);
 }
 
-// Function to change the SSID of a Node, depending on distance
-void SetSSIDviaDistance(uint32_t mtId, Ptr<MobilityModel> node, std::map<std::string, Ptr<MobilityModel> > aps)
+// Function to change the SSID of a Node, depending on distance. With a
+// channel plan the card is also retuned to the channel of the new AP
+void SetSSIDviaDistance(uint32_t mtId, Ptr<MobilityModel> node, std::map<std::string, Ptr<MobilityModel> > aps, const SectorTopologyHelper *topology)
 {
-	char configbuf[250];
 	char buffer[250];
 
-	// This causes the device in mtId to change the SSID, forcing AP change
-	sprintf(configbuf, "/NodeList/%d/DeviceList/0/$ns3::WifiNetDevice/Mac/Ssid", mtId);
-
 	std::map<double, std::string> SsidDistance;
 
 	// Iterate through the map of seen Ssids
@@ -119,8 +118,9 @@ void SetSSIDviaDistance(uint32_t mtId, Ptr<MobilityModel> node, std::map<std::st
 
 	NS_LOG_INFO(buffer);
 
-	// Because the map sorts by std:less, the first position has the lowest distance
-	Config::Set(configbuf, SsidValue(ssid));
+	// Because the map sorts by std:less, the first position has the lowest distance.
+	// This causes the device in mtId to change the SSID, forcing AP change
+	topology->Associate(NodeList::GetNode(mtId)->GetDevice(0), ssid);
 
 	// Empty the maps
 	SsidDistance.clear();
@@ -150,6 +150,18 @@ int main (int argc, char *argv[])
 	int maxSeq = -1;                              // Maximum number of Data packets to request
 	double retxtime = 0.05;                       // How frequent Interest retransmission timeouts should be checked (seconds)
 	int csSize = 10000000;                        // How big the Content Store should be
+	std::string chPlan = "single";                // Wifi channel plan (single, sector, reuse)
+	uint32_t reuse = 3;                           // Reuse cluster size for the reuse channel plan
+	bool rangeCull = false;                       // Only deliver Wifi frames to cards within range
+	double maxRange = 0;                          // Wifi delivery range in meters (0 derives it)
+	bool dormant = false;                         // Suspend beacons of APs far from mobile terminals
+	double wakeRange = 250;                       // Distance in meters at which APs resume beacons
+	bool cachedLoss = false;                      // Cache the deterministic Wifi path loss
+	bool fastFading = false;                      // Draw Nakagami fading from pre-generated blocks
+	bool fastWifi = false;                        // Use the abstract range based wireless link
+	bool idealLinks = false;                      // Use queueless links for the wired hierarchy
+	uint32_t seed = 1;                            // Seed of the random number generators
+	uint32_t run = 1;                             // Run number, the independent replication to simulate
 
 	// Variable for buffer
 	char buffer[250];
@@ -170,8 +182,24 @@ int main (int argc, char *argv[])
 	cmd.AddValue ("mbps", "Data transmission rate for NDN App in MBps", MBps);
 	cmd.AddValue ("size", "Content size in MB", contentSize);
 	cmd.AddValue ("retx", "How frequent Interest retransmission timeouts should be checked in seconds", retxtime);
+	cmd.AddValue ("chplan", "Wifi channel plan: single, sector or reuse", chPlan);
+	cmd.AddValue ("reuse", "Reuse cluster size for the reuse channel plan (3, 4 or 7)", reuse);
+	cmd.AddValue ("rangeCull", "Only deliver Wifi frames to cards within range", rangeCull);
+	cmd.AddValue ("maxRange", "Wifi delivery range in meters for rangeCull (0 derives it from the card sensitivity, about 1.8 km)", maxRange);
+	cmd.AddValue ("dormant", "Suspend beacons of APs with no mobile terminal near", dormant);
+	cmd.AddValue ("wakeRange", "Distance in meters at which dormant APs resume beacons", wakeRange);
+	cmd.AddValue ("cachedLoss", "Cache the deterministic Wifi path loss", cachedLoss);
+	cmd.AddValue ("fastFading", "Draw Nakagami fading from pre-generated gamma blocks", fastFading);
+	cmd.AddValue ("fastwifi", "Use an abstract range based wireless link instead of 802.11g", fastWifi);
+	cmd.AddValue ("idealLinks", "Use queueless single event links for the wired hierarchy", idealLinks);
+	cmd.AddValue ("seed", "Seed of the random number generators", seed);
+	cmd.AddValue ("run", "Run number of the random number generators", run);
 	cmd.Parse (argc,argv);
 
+	// Random variables take their streams from these when created
+	RngSeedManager::SetSeed (seed);
+	RngSeedManager::SetRun (run);
+
 	 // What the NDN Data packet payload size is fixed to 1024 bytes
 	uint32_t payLoadsize = 1024;
 
@@ -184,100 +212,39 @@ int main (int argc, char *argv[])
 	// How many Interests/second a producer creates
 	double intFreq = (MBps * 1000000) / payLoadsize;
 
-	vector<double> centralXpos;
-	vector<double> centralYpos;
-
-	vector<double> wirelessXpos;
-	vector<double> wirelessYpos;
-
 	NS_LOG_INFO ("------Attempting to read positions file------");
 
 	// Attempt to read the file with the position data
-	ifstream file;
-
-	file.open (posFile);
+	SectorLayout layout;
 
-	if (!file.is_open ()) {
+	if (!layout.Read (posFile)) {
 		cerr << "ERROR: Error opening file -> " << posFile << endl;
 		cerr << "ERROR: Please check position file before running simulation!" << endl;
 		return 1;
 	}
-	else {
-		// Attempt to read everything
-
-		string line;
-
-		// Get the size of the area to simulate
-		NS_LOG_INFO ("Reading X and Y axis");
-
-		getline(file, line);
-		istringstream xss(line);
-		xss >> xaxis;
-
-		getline(file, line);
-		istringstream yss(line);
-		yss >> yaxis;
-
-		// Get the number of central nodes
-		NS_LOG_INFO ("Reading number of sectors");
-
-		getline(file, line);
-		istringstream sss(line);
-		sss >> sectors;
-
-		double tmpX;
-		double tmpY;
 
-		NS_LOG_INFO ("Reading sector positions");
-
-		// Read the position for each sector, save into vector
-		for (int i = 0; i < sectors; i++) {
-			getline(file, line, ',');
-			istringstream dxs(line);
-			dxs >> tmpX;
-
-			centralXpos.push_back(tmpX);
-
-			getline(file, line);
-			istringstream dys(line);
-			dys >> tmpY;
-
-			centralYpos.push_back(tmpY);
-		}
-
-		// Get the number of wireless nodes per sector
-		NS_LOG_INFO ("Reading number of wireless nodes per sector");
-		getline(file, line);
-		istringstream apss(line);
-		apss >> aps;
-
-		// Get the total number of wireless nodes in simulation
-		NS_LOG_INFO ("Reading number of wireless nodes in the simulation");
-		getline(file, line);
-		istringstream wnss(line);
-		wnss >> wnodes;
-
-		// Read the position for each wireless node, save into vectors
-		NS_LOG_INFO ("Reading wireless node positions");
-		for (int i = 0; i < wnodes; i++) {
-			getline(file, line, ',');
-			istringstream dxs(line);
-			dxs >> tmpX;
-
-			wirelessXpos.push_back(tmpX);
-
-			getline(file, line);
-			istringstream dys(line);
-			dys >> tmpY;
-
-			wirelessYpos.push_back(tmpY);
-		}
-	}
+	xaxis = layout.GetXAxis ();
+	yaxis = layout.GetYAxis ();
+	sectors = layout.GetNSectors ();
+	aps = layout.GetApsPerSector ();
+	wnodes = layout.GetNAps ();
+
+	// Create the mobile terminals, central nodes, wireless access nodes,
+	// first level nodes and servers, and place the fixed nodes
+	SectorTopologyHelper topology;
+	topology.SetMobileTerminals (mobile);
+	topology.SetServers (servers);
+	topology.SetChannelPlan (SectorTopologyHelper::ParseChannelPlan (chPlan), reuse);
+	topology.SetRangeCulling (rangeCull, maxRange);
+	topology.SetDormantBeacons (dormant, wakeRange);
+	topology.SetCachedLoss (cachedLoss);
+	topology.SetFastFading (fastFading);
+	topology.SetFastWifi (fastWifi);
+	topology.SetIdealLinks (idealLinks);
+	topology.Create (layout);
 
-	NS_LOG_INFO ("------Creating nodes------");
 	// Node definitions for mobile terminals (consumers)
-	NodeContainer mobileTerminalContainer;
-	mobileTerminalContainer.Create(mobile);
+	NodeContainer mobileTerminalContainer = topology.GetMobileTerminals ();
 
 	std::vector<uint32_t> mobileNodeIds;
 
@@ -288,94 +255,21 @@ int main (int argc, char *argv[])
 	}
 
 	// Central Nodes
-	NodeContainer centralContainer;
-	centralContainer.Create (sectors);
-
-	// Wireless access Nodes
-	NodeContainer wirelessContainer;
-	wirelessContainer.Create (wnodes);
-
-	// Separate the wireless nodes into sector specific containers
-	std::vector<NodeContainer> sectorNodes;
-
-	for (int i = 0; i < sectors; i++)
-	{
-		NodeContainer wireless;
-		for (int j = i*aps; j < aps + i*aps; j++)
-		{
-			wireless.Add(wirelessContainer.Get (j));
-		}
-		sectorNodes.push_back(wireless);
-	}
-
-	// Find out how many first level nodes we will have
-	// The +1 is for the server which will be attached to the first level nodes
-	int first = (sectors / 3) + 1;
-
-	// First level Nodes
-	NodeContainer firstLevel;
-	firstLevel.Create (first);
-
-	// Container for all NDN capable nodes
-	NodeContainer allNdnNodes;
-	allNdnNodes.Add (centralContainer);
-	allNdnNodes.Add (wirelessContainer);
-	allNdnNodes.Add (firstLevel);
-
-	// Container for all NDN capable nodes not in first level
-	NodeContainer lowerNdnNodes;
-	lowerNdnNodes.Add (centralContainer);
-	lowerNdnNodes.Add (wirelessContainer);
+	NodeContainer centralContainer = topology.GetCentralNodes ();
 
 	// Container for server (producer) nodes
-	NodeContainer serverNodes;
-	serverNodes.Create (servers);
+	NodeContainer serverNodes = topology.GetServerNodes ();
 
 	std::vector<uint32_t> serverNodeIds;
 
-	// Save all the mobile Node IDs
+	// Save all the server Node IDs
 	for (int i = 0; i < servers; i++)
 	{
 		serverNodeIds.push_back(serverNodes.Get (i)->GetId ());
 	}
 
-	// Container for all nodes without NDN specific capabilities
-	NodeContainer allUserNodes;
-	allUserNodes.Add (mobileTerminalContainer);
-	allUserNodes.Add (serverNodes);
-
 	// Make sure to seed our random
-	gen.seed (std::time (0) + (long long)getpid () << 32);
-
-	NS_LOG_INFO ("------Placing Central nodes-------");
-	MobilityHelper centralStations;
-
-	Ptr<ListPositionAllocator> initialCenter = CreateObject<ListPositionAllocator> ();
-
-	for (int i = 0; i < sectors; i++)
-	{
-		Vector pos (centralXpos[i], centralYpos[i], 0.0);
-		initialCenter->Add (pos);
-	}
-
-	centralStations.SetPositionAllocator(initialCenter);
-	centralStations.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
-	centralStations.Install(centralContainer);
-
-	NS_LOG_INFO ("------Placing wireless access nodes------");
-	MobilityHelper wirelessStations;
-
-	Ptr<ListPositionAllocator> initialWireless = CreateObject<ListPositionAllocator> ();
-
-	for (int i = 0; i < wnodes; i++)
-	{
-		Vector pos (wirelessXpos[i], wirelessYpos[i], 0.0);
-		initialWireless->Add (pos);
-	}
-
-	wirelessStations.SetPositionAllocator(initialWireless);
-	wirelessStations.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-	wirelessStations.Install(wirelessContainer);
+	gen.seed (((uint64_t) seed << 32) | run);
 
 	NS_LOG_INFO ("------Placing mobile node and determining direction and speed------");
 	MobilityHelper mobileStations;
@@ -444,65 +338,9 @@ int main (int argc, char *argv[])
 
 	mobileStations.Install(mobileTerminalContainer);
 
-
-	// Connect Wireless Nodes to central nodes
-	// Because the simulation is using Wifi, PtP connections are 100Mbps
-	// with 5ms delay
-	NS_LOG_INFO("------Connecting Central nodes to wireless access nodes------");
-
-	vector <NetDeviceContainer> ptpWLANCenterDevices;
-
-	PointToPointHelper p2p_100mbps5ms;
-	p2p_100mbps5ms.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
-	p2p_100mbps5ms.SetChannelAttribute ("Delay", StringValue ("5ms"));
-
-	for (int i = 0; i < sectors; i++)
-	{
-		NetDeviceContainer ptpWirelessCenterDevices;
-
-		for (int j = 0; j < aps; j++)
-		{
-			ptpWirelessCenterDevices.Add (p2p_100mbps5ms.Install (centralContainer.Get (i), sectorNodes[i].Get (j) ));
-		}
-
-		ptpWLANCenterDevices.push_back (ptpWirelessCenterDevices);
-	}
-
-	// Connect the server to the lone core node
-	NetDeviceContainer ptpServerlowerNdnDevices;
-	ptpServerlowerNdnDevices.Add (p2p_100mbps5ms.Install (serverNodes.Get (0), firstLevel.Get (first-1)));
-
-	// Connect the center nodes to first level nodes
-	NS_LOG_INFO("Connecting Central Nodes amongst themselves");
-	vector <NetDeviceContainer> ptpCenterFirstDevices;
-
-	PointToPointHelper p2p_1Gbps2ms;
-	p2p_1Gbps2ms.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
-	p2p_1Gbps2ms.SetChannelAttribute ("Delay", StringValue ("2ms"));
-
-	for (int i = 0; i < first-1; i++)
-	{
-		NetDeviceContainer ptpCenterDevices;
-
-		for (int j = i; j < sectors; j+=(first-1))
-		{
-			ptpCenterDevices.Add (p2p_1Gbps2ms.Install (firstLevel.Get (i), centralContainer.Get (j)));
-		}
-
-		ptpCenterFirstDevices.push_back (ptpCenterDevices);
-	}
-
-	// Connect the first level nodes amongst themselves
-	NS_LOG_INFO("------Connecting First level nodes amongst themselves------");
-	NetDeviceContainer ptpFirstFirstDevices;
-
-	for (int i = 0; i < first; i++)
-	{
-		for (int j = i+1; j < first; j++)
-		{
-			ptpFirstFirstDevices.Add (p2p_1Gbps2ms.Install (firstLevel.Get (i), firstLevel.Get (j)));
-		}
-	}
+	// Connect the wireless access nodes, central nodes, first level nodes
+	// and servers
+	topology.ConnectWired ();
 
 	// Connect the central nodes amongst themselves
 	NS_LOG_INFO("------Connecting Central nodes amongst themselves------");
@@ -512,93 +350,21 @@ int main (int argc, char *argv[])
 	{
 		for (int j = i+1; j%3 !=0; i++, j++)
 		{
-			ptpCentralCentralDevices.Add (p2p_1Gbps2ms.Install (centralContainer.Get (i), centralContainer.Get (j)));
+			ptpCentralCentralDevices.Add (topology.AddCoreLink (centralContainer.Get (i), centralContainer.Get (j)));
 			if(i < 6)
 				{
-				ptpCentralCentralDevices.Add (p2p_1Gbps2ms.Install (centralContainer.Get (i), centralContainer.Get (k+i%3)));
-				ptpCentralCentralDevices.Add (p2p_1Gbps2ms.Install (centralContainer.Get (i), centralContainer.Get (k+i%3+1)));
+				ptpCentralCentralDevices.Add (topology.AddCoreLink (centralContainer.Get (i), centralContainer.Get (k+i%3)));
+				ptpCentralCentralDevices.Add (topology.AddCoreLink (centralContainer.Get (i), centralContainer.Get (k+i%3+1)));
 				}
 		}
-		if(i < 8)	ptpCentralCentralDevices.Add (p2p_1Gbps2ms.Install (centralContainer.Get (i), centralContainer.Get (k+i%3)));
-	}
-
-	NS_LOG_INFO ("------Creating Wireless cards------");
-
-	// Use the Wifi Helper to define the wireless interfaces for APs
-	WifiHelper wifi;
-	wifi.SetStandard(WIFI_PHY_STANDARD_80211g);
-	// The N standard is apparently not completely supported in NS-3
-	//wifi.setStandard(WIFI_PHY_STANDARD_80211n_2_4GHZ);
-	// The ConstantRateWifiManager only works with one rate, making issues
-	//wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager");
-	// The MinstrelWifiManager isn't working on the current version of NS-3
-	//wifi.SetRemoteStationManager ("ns3::MinstrelWifiManager");
-	wifi.SetRemoteStationManager ("ns3::ArfWifiManager");
-
-
-	YansWifiChannelHelper wifiChannel;
-	wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
-	wifiChannel.AddPropagationLoss ("ns3::ThreeLogDistancePropagationLossModel");
-	wifiChannel.AddPropagationLoss("ns3::NakagamiPropagationLossModel");
-
-	// All interfaces are placed on the same channel. Makes AP changes easy. Might
-	// have to be reconsidered for multiple mobile nodes
-	YansWifiPhyHelper wifiPhyHelper = YansWifiPhyHelper::Default ();
-	wifiPhyHelper.SetChannel (wifiChannel.Create ());
-	wifiPhyHelper.Set("TxPowerStart", DoubleValue(16.0206));
-	wifiPhyHelper.Set("TxPowerEnd", DoubleValue(1));
-
-	// Add a simple no QoS based card to the Wifi interfaces
-	NqosWifiMacHelper wifiMacHelper = NqosWifiMacHelper::Default ();
-
-	// Create SSIDs for all the APs
-	std::vector<Ssid> ssidV;
-
-	NS_LOG_INFO ("------Creating ssids for wireless cards------");
-
-	// We store the Wifi AP mobility models in a map, ordered by the ssid string. Will be easier to manage when
-	// calling the modified StaMApWifiMac
-	std::map<std::string, Ptr<MobilityModel> > apTerminalMobility;
-
-	for (int i = 0; i < wnodes; i++)
-	{
-		// Temporary string containing our SSID
-		std::string ssidtmp("ap-" + boost::lexical_cast<std::string>(i));
-
-		// Push the newly created SSID into a vector
-		ssidV.push_back (Ssid (ssidtmp));
-
-		// Get the mobility model for wnode i
-		Ptr<MobilityModel> tmp = (wirelessContainer.Get (i))->GetObject<MobilityModel> ();
-
-		// Store the information into our map
-		apTerminalMobility[ssidtmp] = tmp;
+		if(i < 8)	ptpCentralCentralDevices.Add (topology.AddCoreLink (centralContainer.Get (i), centralContainer.Get (k+i%3)));
 	}
 
-	NS_LOG_INFO ("------Assigning mobile terminal wireless cards------");
+	// Give the access nodes and mobile terminals their Wifi cards
+	topology.InstallWifi ();
 
-	NS_LOG_INFO ("Assigning AP wireless cards");
-	std::vector<NetDeviceContainer> wifiAPNetDevices;
-	for (int i = 0; i < wnodes; i++)
-	{
-		wifiMacHelper.SetType ("ns3::ApWifiMac",
-						   "Ssid", SsidValue (ssidV[i]),
-						   "BeaconGeneration", BooleanValue (true),
-						   "BeaconInterval", TimeValue (Seconds (0.102)));
-
-		wifiAPNetDevices.push_back (wifi.Install (wifiPhyHelper, wifiMacHelper, wirelessContainer.Get (i)));
-	}
-
-	// Create a Wifi station with a modified Station MAC.
-	wifiMacHelper.SetType("ns3::StaWifiMac",
-			"Ssid", SsidValue (ssidV[0]),
-			"ActiveProbing", BooleanValue (true));
-
-	NetDeviceContainer wifiMTNetDevices = wifi.Install (wifiPhyHelper, wifiMacHelper, mobileTerminalContainer);
-
-	// Using the same calculation from the Yans-wifi-Channel, we obtain the Mobility Models for the
-	// mobile node as well as all the Wifi capable nodes
-	Ptr<MobilityModel> mobileTerminalMobility = (mobileTerminalContainer.Get (0))->GetObject<MobilityModel> ();
+	// We store the Wifi AP mobility models in a map, ordered by the ssid string
+	std::map<std::string, Ptr<MobilityModel> > apTerminalMobility = topology.GetApMobility ();
 
 	std::vector<Ptr<MobilityModel> > mobileTerminalsMobility;
 
@@ -608,6 +374,7 @@ int main (int argc, char *argv[])
 		mobileTerminalsMobility.push_back((mobileTerminalContainer.Get (i))->GetObject<MobilityModel> ());
 	}
 
+
 	char routeType[250];
 
 	// Now install content stores and the rest on the middle node. Leave
@@ -636,8 +403,6 @@ int main (int argc, char *argv[])
 
 	ndnHelperRouters.SetContentStore ("ns3::ndn::cs::Freshness::Lru", "MaxSize", buffer);
 	ndnHelperRouters.SetDefaultRoutes (true);
-	// Install on ICN capable routers
-	ndnHelperRouters.Install (allNdnNodes);
 
 	// Create a NDN stack for the clients and mobile node
 	ndn::StackHelper ndnHelperUsers;
@@ -646,7 +411,13 @@ int main (int argc, char *argv[])
 	// No Content Stores are installed on these machines
 	ndnHelperUsers.SetContentStore ("ns3::ndn::cs::Nocache");
 	ndnHelperUsers.SetDefaultRoutes (true);
-	ndnHelperUsers.Install (allUserNodes);
+
+	// Install on ICN capable routers, clients and the mobile node
+	topology.InstallNdn (ndnHelperRouters, ndnHelperUsers);
+
+	std::ostringstream times;
+	topology.PrintTimes (times);
+	NS_LOG_INFO ("Topology construction times:\n" << times.str ());
 
 	NS_LOG_INFO ("------Installing Producer Application------");
 
@@ -754,7 +525,7 @@ int main (int argc, char *argv[])
 
 		for (int i = 0; i < mobile; i++)
 		{
-			Simulator::Schedule (Seconds(j), &SetSSIDviaDistance, mobileNodeIds[i], mobileTerminalsMobility[i], apTerminalMobility);
+			Simulator::Schedule (Seconds(j), &SetSSIDviaDistance, mobileNodeIds[i], mobileTerminalsMobility[i], apTerminalMobility, &topology);
 		}
 
 		j += checkTime;
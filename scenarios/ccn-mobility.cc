@@ -197,6 +197,8 @@ int main (int argc, char *argv[])
 	bool smart = false;					// Tells to run the simulation with SmartFlooding
 	bool bestr = false;					// Tells to run the simulation with BestRoute
 	char results[250] = "results";      // Directory to place results
+	uint32_t seed = 1;					// Seed of the random number generators
+	uint32_t run = 1;					// Run number, the independent replication to simulate
 
 	// Variable for buffer
 	char buffer[250];
@@ -214,8 +216,14 @@ int main (int argc, char *argv[])
 	cmd.AddValue ("trace", "Enable trace files", traceFiles);
 	cmd.AddValue ("smart", "Enable SmartFlooding forwarding", smart);
 	cmd.AddValue ("bestr", "Enable BestRoute forwarding", bestr);
+	cmd.AddValue ("seed", "Seed of the random number generators", seed);
+	cmd.AddValue ("run", "Run number of the random number generators", run);
 	cmd.Parse (argc,argv);
 
+	// Random variables take their streams from these when created
+	RngSeedManager::SetSeed (seed);
+	RngSeedManager::SetRun (run);
+
 	// Node definitions for mobile terminals
 	NodeContainer mobileTerminalContainer;
 	mobileTerminalContainer.Create(mobile);
@@ -249,7 +257,7 @@ int main (int argc, char *argv[])
 	allUserNodes.Add (networkNodes);
 
 	// Make sure to seed our random
-	gen.seed(std::time(0) + (long long)getpid() << 32);
+	gen.seed(((uint64_t) seed << 32) | run);
 
 	// With the network assigned, time to randomly obtain clients and servers
 	NS_LOG_INFO ("Obtaining the clients and servers");
@@ -0,0 +1,948 @@
+/* -*- Mode:C++; c-file-style:"gnu"; -*- */
+/*
+ * ndn-mobility-bench.cc
+ *  Benchmarks for the building blocks of the mobility scenarios
+ *
+ * Copyright (c) 2014 Waseda University, Sato Laboratory
+ *
+ *  ndn-mobility-bench is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  ndn-mobility-bench is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with ndn-mobility-bench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Standard C++ modules
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// boost modules
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+
+// MPI, for the reductions of the mpi benchmark
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+
+// ns3 modules
+#include <ns3-dev/ns3/core-module.h>
+#include <ns3-dev/ns3/mobility-module.h>
+#include <ns3-dev/ns3/mpi-interface.h>
+#include <ns3-dev/ns3/network-module.h>
+#include <ns3-dev/ns3/propagation-module.h>
+
+// ndnSIM modules
+#include <ns3-dev/ns3/ndnSIM-module.h>
+
+// Extension files
+#include "mobility/helper/sector-topology-helper.h"
+#include "parallel/model/partition-interface.h"
+#include "propagation/model/cached-propagation-loss-model.h"
+#include "propagation/model/fast-nakagami-propagation-loss-model.h"
+#include "utils/counting-scheduler.h"
+#include "utils/tracers/handoff-recorder.h"
+
+using namespace ns3;
+using namespace std;
+
+char scenario[250] = "NDNMobilityBench";
+
+NS_LOG_COMPONENT_DEFINE (scenario);
+
+// Splits a comma separated list of numbers
+vector<uint32_t> parseList(const string &list)
+{
+	vector<uint32_t> res;
+	istringstream is(list);
+	string item;
+
+	while (getline(is, item, ','))
+	{
+		res.push_back(atoi(item.c_str()));
+	}
+
+	return res;
+}
+
+double wallClock()
+{
+	struct timeval t;
+	gettimeofday(&t, NULL);
+	return t.tv_sec + t.tv_usec * 1e-6;
+}
+
+// Splits a comma separated list of words
+vector<string> parseWords(const string &list)
+{
+	vector<string> res;
+	istringstream is(list);
+	string item;
+
+	while (getline(is, item, ','))
+	{
+		res.push_back(item);
+	}
+
+	return res;
+}
+
+// Creates the nodes of a layout, with the mobile terminals walking randomly
+// over the area
+void createNodes(SectorTopologyHelper &topology, const SectorLayout &layout, uint32_t mobile)
+{
+	char buffer[250];
+
+	topology.SetMobileTerminals(mobile);
+	topology.Create(layout);
+
+	sprintf(buffer, "0|%f|0|%f", layout.GetXAxis(), layout.GetYAxis());
+
+	MobilityHelper mobileStations;
+	mobileStations.SetPositionAllocator ("ns3::RandomRectanglePositionAllocator",
+			"X", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=" + boost::lexical_cast<string>(layout.GetXAxis()) + "]"),
+			"Y", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=" + boost::lexical_cast<string>(layout.GetYAxis()) + "]"));
+	mobileStations.SetMobilityModel ("ns3::RandomWalk2dMobilityModel",
+			"Bounds", StringValue (buffer),
+			"Speed", StringValue ("ns3::ConstantRandomVariable[Constant=1.4]"),
+			"Distance", DoubleValue (20));
+	mobileStations.Install (topology.GetMobileTerminals());
+}
+
+// Runs the Wifi part of a layout under each configuration and reports the
+// events and wall time
+int channelBench(const string &posFile, const vector<string> &channels, uint32_t mobile, double simTime)
+{
+	SectorLayout layout;
+	if (!layout.Read(posFile))
+	{
+		cerr << "ERROR: Could not read " << posFile << endl;
+		return 1;
+	}
+
+	GlobalValue::Bind ("SchedulerType", StringValue ("ns3::CountingScheduler"));
+
+	printf("%16s %8s %12s %10s %12s\n", "Config", "APs", "Events", "Wall (s)", "Events/s");
+
+	for (int i = 0; i < channels.size(); i++)
+	{
+		// A configuration is a channel followed by + separated options
+		vector<string> config;
+		istringstream is(channels[i]);
+		string item;
+		while (getline(is, item, '+'))
+			config.push_back(item);
+
+		// Same random streams for every configuration, set before any
+		// object that draws from them is created
+		RngSeedManager::SetSeed (1);
+		RngSeedManager::SetRun (1);
+
+		SectorTopologyHelper topology;
+		if (config[0] == "range")
+			topology.SetRangeCulling(true);
+		else if (config[0] == "fast")
+			topology.SetFastWifi(true);
+		else if (config[0] != "yans")
+		{
+			cerr << "ERROR: Unknown channel " << config[0] << endl;
+			return 1;
+		}
+
+		for (int j = 1; j < config.size(); j++)
+		{
+			if (config[j] == "dormant")
+				topology.SetDormantBeacons(true);
+			else if (config[j] == "cached")
+				topology.SetCachedLoss(true);
+			else if (config[j] == "fastfading")
+				topology.SetFastFading(true);
+			else
+			{
+				cerr << "ERROR: Unknown option " << config[j] << endl;
+				return 1;
+			}
+		}
+
+		createNodes(topology, layout, mobile);
+		topology.InstallWifi();
+
+		CountingScheduler::Reset();
+		Simulator::Stop (Seconds (simTime));
+
+		double start = wallClock();
+		Simulator::Run ();
+		double wall = wallClock() - start;
+
+		uint64_t events = CountingScheduler::GetExecuted();
+		printf("%16s %8u %12lu %10.3f %12.0f\n", channels[i].c_str(), topology.GetNAps(),
+				(unsigned long)events, wall, events / wall);
+		fflush(stdout);
+
+		Simulator::Destroy ();
+	}
+
+	return 0;
+}
+
+// Wifi loss chain of the scenarios, optionally with the cached path loss
+Ptr<PropagationLossModel> createLoss(bool cached)
+{
+	Ptr<PropagationLossModel> loss = CreateObject<ThreeLogDistancePropagationLossModel> ();
+	if (cached)
+	{
+		Ptr<CachedPropagationLossModel> cache = CreateObject<CachedPropagationLossModel> ();
+		cache->SetModel (loss);
+		loss = cache;
+	}
+	loss->SetNext (CreateObject<NakagamiPropagationLossModel> ());
+	loss->AssignStreams (0);
+	return loss;
+}
+
+// Evaluates the loss between every pair of nodes a number of times
+double lossRounds(Ptr<PropagationLossModel> loss, const vector<Ptr<MobilityModel> > &nodes, uint32_t rounds, vector<double> &res)
+{
+	res.clear();
+	double start = wallClock();
+
+	for (uint32_t r = 0; r < rounds; r++)
+		for (int i = 0; i < nodes.size(); i++)
+			for (int j = 0; j < nodes.size(); j++)
+				if (i != j)
+					res.push_back(loss->CalcRxPower(16.0206, nodes[i], nodes[j]));
+
+	return wallClock() - start;
+}
+
+// Compares the cached loss model against the reference models, for the
+// static APs of a layout and a number of moving terminals
+int lossBench(const string &posFile, uint32_t mobile, uint32_t rounds, double tolerance)
+{
+	SectorLayout layout;
+	if (!layout.Read(posFile))
+	{
+		cerr << "ERROR: Could not read " << posFile << endl;
+		return 1;
+	}
+
+	vector<Ptr<MobilityModel> > nodes;
+	for (uint32_t i = 0; i < layout.GetNAps(); i++)
+	{
+		Ptr<ConstantPositionMobilityModel> ap = CreateObject<ConstantPositionMobilityModel> ();
+		ap->SetPosition(layout.GetApPosition(i));
+		nodes.push_back(ap);
+	}
+
+	// Any model other than ConstantPosition is treated as moving
+	Ptr<UniformRandomVariable> coord = CreateObject<UniformRandomVariable> ();
+	coord->SetStream (1000);
+	for (uint32_t i = 0; i < mobile; i++)
+	{
+		Ptr<ConstantVelocityMobilityModel> terminal = CreateObject<ConstantVelocityMobilityModel> ();
+		terminal->SetPosition(Vector(coord->GetValue(0, layout.GetXAxis()), coord->GetValue(0, layout.GetYAxis()), 0));
+		nodes.push_back(terminal);
+	}
+
+	printf("%10s %12s %10s %10s %12s\n", "Chain", "Calls", "Wall (s)", "ns/call", "Max diff dB");
+
+	// Both chains draw the same fading with the same streams, so the
+	// outputs can be compared call by call
+	const char *names[2] = { "path", "fading" };
+	int worst = 0;
+	for (int fading = 0; fading < 2; fading++)
+	{
+		vector<double> ref, res;
+		Ptr<PropagationLossModel> refLoss = createLoss(false);
+		Ptr<PropagationLossModel> cachedLoss = createLoss(true);
+		if (!fading)
+		{
+			refLoss->SetNext(0);
+			cachedLoss->SetNext(0);
+		}
+
+		double refWall = lossRounds(refLoss, nodes, rounds, ref);
+		double cachedWall = lossRounds(cachedLoss, nodes, rounds, res);
+
+		double diff = 0;
+		for (int i = 0; i < ref.size(); i++)
+			diff = max(diff, fabs(ref[i] - res[i]));
+
+		printf("%10s %12lu %10.3f %10.1f %12s\n", (string("ref-") + names[fading]).c_str(),
+				(unsigned long)ref.size(), refWall, refWall * 1e9 / ref.size(), "-");
+		printf("%10s %12lu %10.3f %10.1f %12.6f\n", (string("cached-") + names[fading]).c_str(),
+				(unsigned long)res.size(), cachedWall, cachedWall * 1e9 / res.size(), diff);
+
+		if (diff > tolerance)
+		{
+			cerr << "ERROR: Cached loss differs from the reference by " << diff << " dB" << endl;
+			worst = 1;
+		}
+	}
+
+	return worst;
+}
+
+// Draws fading samples in dB at a distance, timing the draws
+double fadingSamples(Ptr<PropagationLossModel> fading, double distance, uint32_t samples, vector<double> &res)
+{
+	Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+	Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+	b->SetPosition(Vector(distance, 0, 0));
+
+	res.resize(samples);
+	double start = wallClock();
+	for (uint32_t i = 0; i < samples; i++)
+		res[i] = fading->CalcRxPower(0, a, b);
+
+	return wallClock() - start;
+}
+
+// Checks that the fast Nakagami model draws the same distribution as the
+// stock one, at a distance in each of the three m fields
+int fadingBench(uint32_t samples)
+{
+	Ptr<PropagationLossModel> stock = CreateObject<NakagamiPropagationLossModel> ();
+	Ptr<PropagationLossModel> fast = CreateObject<FastNakagamiPropagationLossModel> ();
+	stock->AssignStreams (0);
+	fast->AssignStreams (10);
+
+	// Two sample Kolmogorov-Smirnov critical value at the 0.001 level
+	double critical = 1.95 * sqrt(2.0 / samples);
+
+	printf("%8s %10s %10s %10s %10s %10s %10s %10s\n", "Distance", "Stock ns", "Fast ns",
+			"Stock mean", "Fast mean", "Stock var", "Fast var", "KS D");
+
+	double distances[3] = { 50, 100, 300 };
+	int worst = 0;
+	for (int d = 0; d < 3; d++)
+	{
+		vector<double> ref, res;
+		double stockWall = fadingSamples(stock, distances[d], samples, ref);
+		double fastWall = fadingSamples(fast, distances[d], samples, res);
+
+		// Moments of the linear power, which has a mean of 1
+		double moments[2][2] = { { 0, 0 }, { 0, 0 } };
+		for (uint32_t i = 0; i < samples; i++)
+		{
+			double p = pow(10, ref[i] / 10);
+			double q = pow(10, res[i] / 10);
+			moments[0][0] += p;
+			moments[0][1] += p * p;
+			moments[1][0] += q;
+			moments[1][1] += q * q;
+		}
+		for (int k = 0; k < 2; k++)
+		{
+			moments[k][0] /= samples;
+			moments[k][1] = moments[k][1] / samples - moments[k][0] * moments[k][0];
+		}
+
+		sort(ref.begin(), ref.end());
+		sort(res.begin(), res.end());
+		uint32_t i = 0, j = 0;
+		double ks = 0;
+		while (i < samples && j < samples)
+		{
+			if (ref[i] < res[j])
+				i++;
+			else
+				j++;
+			ks = max(ks, fabs((double)i / samples - (double)j / samples));
+		}
+
+		printf("%8.0f %10.1f %10.1f %10.4f %10.4f %10.4f %10.4f %10.5f\n", distances[d],
+				stockWall * 1e9 / samples, fastWall * 1e9 / samples,
+				moments[0][0], moments[1][0], moments[0][1], moments[1][1], ks);
+
+		if (ks > critical)
+		{
+			cerr << "ERROR: Fading distributions differ at " << distances[d] << " m (D = "
+			     << ks << ", critical " << critical << ")" << endl;
+			worst = 1;
+		}
+	}
+
+	return worst;
+}
+
+// Installs the NDN stacks of the scenarios
+void installNdn(SectorTopologyHelper &topology)
+{
+	ndn::StackHelper ndnHelperRouters;
+	ndnHelperRouters.SetForwardingStrategy ("ns3::ndn::fw::Flooding::PerOutFaceLimits", "Limit", "ns3::ndn::Limits::Window");
+	ndnHelperRouters.SetContentStore ("ns3::ndn::cs::Freshness::Lru", "MaxSize", "10000000");
+	ndnHelperRouters.SetDefaultRoutes (true);
+
+	ndn::StackHelper ndnHelperUsers;
+	ndnHelperUsers.SetForwardingStrategy ("ns3::ndn::fw::BestRoute");
+	ndnHelperUsers.SetContentStore ("ns3::ndn::cs::Nocache");
+	ndnHelperUsers.SetDefaultRoutes (true);
+
+	topology.InstallNdn(ndnHelperRouters, ndnHelperUsers);
+}
+
+// Times the construction of the sector hierarchy for several numbers of APs
+int topologyBench(const vector<uint32_t> &apCounts, uint32_t apsPerSector, uint32_t mobile, bool wifi, bool ndn)
+{
+	printf("%8s %8s %8s %8s %8s %8s %8s\n", "APs", "Sectors", "Create", "Wired", "Wifi", "NDN", "Total");
+
+	for (int i = 0; i < apCounts.size(); i++)
+	{
+		uint32_t sectors = (apCounts[i] + apsPerSector - 1) / apsPerSector;
+
+		SectorLayout layout;
+		layout.Generate(sectors, apsPerSector, 100, 1);
+
+		SectorTopologyHelper topology;
+		topology.SetMobileTerminals(mobile);
+		topology.Create(layout);
+		topology.ConnectWired();
+
+		if (wifi)
+			topology.InstallWifi();
+
+		if (ndn)
+			installNdn(topology);
+
+		printf("%8u %8u %8.3f %8.3f %8.3f %8.3f %8.3f\n", topology.GetNAps(), topology.GetNSectors(),
+				topology.GetPhaseTime("create"), topology.GetPhaseTime("wired"),
+				topology.GetPhaseTime("wifi"), topology.GetPhaseTime("ndn"), topology.GetTotalTime());
+		fflush(stdout);
+
+		// Release all nodes before building the next size
+		Simulator::Destroy ();
+	}
+
+	return 0;
+}
+
+// Runs NDN traffic from every AP to the servers over the wired hierarchy
+// alone, with point-to-point and with ideal links, and reports the events
+// and wall time
+int wiredBench(uint32_t sectors, uint32_t apsPerSector, double intFreq, double simTime)
+{
+	GlobalValue::Bind ("SchedulerType", StringValue ("ns3::CountingScheduler"));
+
+	printf("%8s %8s %12s %10s %12s %10s\n", "Links", "APs", "Events", "Wall (s)", "Events/s", "Wired MB");
+
+	const char *links[2] = { "p2p", "ideal" };
+	for (int i = 0; i < 2; i++)
+	{
+		// Same random streams for both link models, set before the network
+		// and its applications are built
+		RngSeedManager::SetSeed (1);
+		RngSeedManager::SetRun (1);
+
+		SectorLayout layout;
+		layout.Generate(sectors, apsPerSector, 100, 1);
+
+		SectorTopologyHelper topology;
+		topology.SetIdealLinks(i == 1, true);
+		topology.Create(layout);
+		topology.ConnectWired();
+		installNdn(topology);
+
+		ndn::AppHelper producerHelper ("ns3::ndn::Producer");
+		producerHelper.SetPrefix ("/waseda/sato");
+		producerHelper.SetAttribute ("PayloadSize", StringValue ("1024"));
+		producerHelper.Install (topology.GetServerNodes());
+
+		ndn::AppHelper consumerHelper ("ns3::ndn::ConsumerCbr");
+		consumerHelper.SetPrefix ("/waseda/sato");
+		consumerHelper.SetAttribute ("Frequency", DoubleValue (intFreq));
+		consumerHelper.Install (topology.GetApNodes());
+
+		CountingScheduler::Reset();
+		Simulator::Stop (Seconds (simTime));
+
+		double start = wallClock();
+		Simulator::Run ();
+		double wall = wallClock() - start;
+
+		uint64_t events = CountingScheduler::GetExecuted();
+		printf("%8s %8u %12lu %10.3f %12.0f ", links[i], topology.GetNAps(),
+				(unsigned long)events, wall, events / wall);
+		if (i == 1)
+			printf("%10.3f\n", topology.GetWiredTxBytes() / 1e6);
+		else
+			printf("%10s\n", "-");
+		fflush(stdout);
+
+		Simulator::Destroy ();
+	}
+
+	return 0;
+}
+
+// Adds every Data a consumer receives to the digest of its partition. The
+// digests are sums, so they do not depend on the order of the receptions
+// within a time step, and the hop count shows whether the packet tags
+// crossed the partitions
+void dataDigest(Ptr<ndn::App> app, uint32_t seqno, Time delay, uint32_t retxCount, int32_t hopCount)
+{
+	uint64_t values[6] = { (uint64_t)Simulator::Now().GetTimeStep(), app->GetNode()->GetId(), seqno,
+			(uint64_t)delay.GetTimeStep(), retxCount, (uint64_t)hopCount };
+	uint64_t digest = 14695981039346656037ULL;
+	for (int i = 0; i < 6; i++)
+		digest = (digest ^ values[i]) * 1099511628211ULL;
+
+	PartitionInterface::Accumulate(app->GetNode()->GetSystemId(), digest);
+}
+
+// Runs one partitioned wired simulation and writes the wall time, events,
+// combined event digest of all partitions and digest of the Data received
+// to fd. Without workers, runs the same network unpartitioned on the
+// default simulator, the reference for the Data digest
+void parallelRun(uint32_t sectors, uint32_t apsPerSector, double intFreq, double simTime,
+		uint32_t partitions, uint32_t workers, int fd)
+{
+	if (workers == 0)
+	{
+		GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+		GlobalValue::Bind ("SchedulerType", StringValue ("ns3::CountingScheduler"));
+		partitions = 1;
+	}
+	else
+		GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::PartitionSimulatorImpl"));
+
+	// Same random streams for every run
+	RngSeedManager::SetSeed (1);
+	RngSeedManager::SetRun (1);
+
+	SectorLayout layout;
+	layout.Generate(sectors, apsPerSector, 100, 1);
+
+	SectorTopologyHelper topology;
+	topology.SetPartitions(partitions);
+	topology.Create(layout);
+	topology.ConnectWired();
+	installNdn(topology);
+
+	ndn::AppHelper producerHelper ("ns3::ndn::Producer");
+	producerHelper.SetPrefix ("/waseda/sato");
+	producerHelper.SetAttribute ("PayloadSize", StringValue ("1024"));
+	producerHelper.Install (topology.GetServerNodes());
+
+	ndn::AppHelper consumerHelper ("ns3::ndn::ConsumerCbr");
+	consumerHelper.SetPrefix ("/waseda/sato");
+	consumerHelper.SetAttribute ("Frequency", DoubleValue (intFreq));
+	consumerHelper.Install (topology.GetApNodes());
+
+	Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::ndn::Consumer/FirstInterestDataDelay",
+			MakeCallback (&dataDigest));
+
+	if (workers > 1)
+		PartitionInterface::Enable (workers);
+
+	CountingScheduler::Reset();
+	Simulator::Stop (Seconds (simTime));
+
+	double start = wallClock();
+	Simulator::Run ();
+	double wall = wallClock() - start;
+
+	Simulator::Destroy ();
+	PartitionInterface::Disable ();
+
+	// The event digest depends on the event uids of the simulator, so only
+	// runs on PartitionSimulatorImpl can be compared by it
+	uint64_t events = 0;
+	uint64_t digest = 0;
+	uint64_t data = 0;
+	if (workers == 0)
+		events = CountingScheduler::GetExecuted();
+	else
+		digest = 14695981039346656037ULL;
+	for (uint32_t p = 0; p < partitions; p++)
+	{
+		if (workers > 0)
+		{
+			events += PartitionInterface::GetEvents(p);
+			digest = (digest ^ PartitionInterface::GetDigest(p)) * 1099511628211ULL;
+		}
+		data += PartitionInterface::GetAccumulated(p);
+	}
+
+	char line[128];
+	int len = sprintf(line, "%f %llu %llx %llx\n", wall, (unsigned long long)events,
+			(unsigned long long)digest, (unsigned long long)data);
+	if (write(fd, line, len) != len)
+		exit(1);
+}
+
+// Runs the wired hierarchy unpartitioned on the default simulator, then
+// split into partitions with several numbers of workers. Every run happens
+// in a fresh process so the random streams start from the same state. The
+// partitioned runs must run the same events as the first of them, and every
+// run must receive the same Data as the default simulator
+int parallelBench(uint32_t sectors, uint32_t apsPerSector, double intFreq, double simTime,
+		uint32_t partitions, const vector<uint32_t> &workerList)
+{
+	printf("%10s %8s %12s %10s %8s %18s %18s\n", "Partitions", "Workers", "Events", "Wall (s)", "Speedup", "Digest", "Data");
+
+	// No workers stands for the default simulator
+	vector<uint32_t> workers(1, 0);
+	workers.insert(workers.end(), workerList.begin(), workerList.end());
+
+	double base = 0;
+	string reference;
+	string referenceData;
+	bool identical = true;
+	for (int i = 0; i < workers.size(); i++)
+	{
+		int fds[2];
+		if (pipe(fds) != 0)
+		{
+			cerr << "ERROR: Could not create a pipe" << endl;
+			return 1;
+		}
+
+		pid_t pid = fork();
+		if (pid == 0)
+		{
+			close(fds[0]);
+			parallelRun(sectors, apsPerSector, intFreq, simTime, partitions, workers[i], fds[1]);
+			exit(0);
+		}
+		close(fds[1]);
+
+		char line[128];
+		ssize_t len = read(fds[0], line, sizeof(line) - 1);
+		close(fds[0]);
+
+		int status;
+		double wall;
+		unsigned long long events;
+		char digest[32];
+		char data[32];
+		if (pid < 0 || len <= 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+		{
+			cerr << "ERROR: Run with " << workers[i] << " workers failed" << endl;
+			return 1;
+		}
+		line[len] = '\0';
+		if (sscanf(line, "%lf %llu %31s %31s", &wall, &events, digest, data) != 4)
+		{
+			cerr << "ERROR: Run with " << workers[i] << " workers returned no result" << endl;
+			return 1;
+		}
+
+		if (i == 0)
+		{
+			base = wall;
+			referenceData = data;
+			printf("%10u %8s %12llu %10.3f %8.2f %18s %18s\n", 1, "default", events, wall, 1.0, "-", data);
+			fflush(stdout);
+			continue;
+		}
+
+		if (i == 1)
+			reference = digest;
+		else if (reference != digest)
+			identical = false;
+		if (referenceData != data)
+			identical = false;
+
+		printf("%10u %8u %12llu %10.3f %8.2f %18s %18s\n", partitions, workers[i], events, wall, base / wall, digest, data);
+		fflush(stdout);
+	}
+
+	printf("Runs %s\n", identical ? "identical" : "DIFFER");
+	return identical ? 0 : 1;
+}
+
+// Runs the wired hierarchy on the MPI ranks this process was started with.
+// Rank 0 prints the ranks, the longest wall time and the events of all
+// ranks on one line
+int mpiRankBench(int *argc, char ***argv, uint32_t sectors, uint32_t apsPerSector, double intFreq, double simTime)
+{
+#ifdef NS3_MPI
+	GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DistributedSimulatorImpl"));
+	GlobalValue::Bind ("SchedulerType", StringValue ("ns3::CountingScheduler"));
+	MpiInterface::Enable (argc, argv);
+	uint32_t rank = MpiInterface::GetSystemId ();
+
+	// Same random streams on every rank and for every rank count
+	RngSeedManager::SetSeed (1);
+	RngSeedManager::SetRun (1);
+
+	SectorLayout layout;
+	layout.Generate(sectors, apsPerSector, 100, 1);
+
+	SectorTopologyHelper topology;
+	topology.SetPartitions(MpiInterface::GetSize ());
+	topology.Create(layout);
+	topology.ConnectWired();
+	installNdn(topology);
+
+	// Applications only on the nodes of this rank
+	NodeContainer servers;
+	NodeContainer aps;
+	for (int i = 0; i < topology.GetServerNodes().GetN(); i++)
+		if (topology.GetServerNodes().Get(i)->GetSystemId() == rank)
+			servers.Add(topology.GetServerNodes().Get(i));
+	for (int i = 0; i < topology.GetApNodes().GetN(); i++)
+		if (topology.GetApNodes().Get(i)->GetSystemId() == rank)
+			aps.Add(topology.GetApNodes().Get(i));
+
+	ndn::AppHelper producerHelper ("ns3::ndn::Producer");
+	producerHelper.SetPrefix ("/waseda/sato");
+	producerHelper.SetAttribute ("PayloadSize", StringValue ("1024"));
+	producerHelper.Install (servers);
+
+	ndn::AppHelper consumerHelper ("ns3::ndn::ConsumerCbr");
+	consumerHelper.SetPrefix ("/waseda/sato");
+	consumerHelper.SetAttribute ("Frequency", DoubleValue (intFreq));
+	consumerHelper.Install (aps);
+
+	CountingScheduler::Reset();
+	Simulator::Stop (Seconds (simTime));
+
+	double start = wallClock();
+	Simulator::Run ();
+	double wall = wallClock() - start;
+
+	Simulator::Destroy ();
+
+	unsigned long long events = CountingScheduler::GetExecuted();
+	unsigned long long allEvents;
+	double longest;
+	MPI_Reduce (&events, &allEvents, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+	MPI_Reduce (&wall, &longest, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+	if (rank == 0)
+		printf("%u %f %llu\n", MpiInterface::GetSize (), longest, allEvents);
+
+	MpiInterface::Disable ();
+	return 0;
+#else
+	cerr << "ERROR: ns-3 was built without MPI support!" << endl;
+	return 1;
+#endif
+}
+
+// Starts the mpirank benchmark under mpirun for several numbers of ranks
+int mpiBench(const string &program, const string &mpirun, const vector<uint32_t> &ranks,
+		uint32_t sectors, uint32_t apsPerSector, double intFreq, double simTime)
+{
+	printf("%8s %8s %12s %10s %12s %8s\n", "Ranks", "APs", "Events", "Wall (s)", "Events/s", "Speedup");
+
+	double base = 0;
+	for (int i = 0; i < ranks.size(); i++)
+	{
+		char command[1024];
+		sprintf(command, "%s -np %u %s --bench=mpirank --sectors=%u --apsPerSector=%u --intFreq=%f --simTime=%f",
+				mpirun.c_str(), ranks[i], program.c_str(), sectors, apsPerSector, intFreq, simTime);
+
+		FILE *out = popen(command, "r");
+		char line[256];
+		uint32_t size;
+		double wall;
+		unsigned long long events;
+		bool ok = out && fgets(line, sizeof(line), out) && sscanf(line, "%u %lf %llu", &size, &wall, &events) == 3;
+		if (out)
+			ok = (pclose(out) == 0) && ok;
+
+		if (!ok)
+		{
+			cerr << "ERROR: " << command << " failed" << endl;
+			return 1;
+		}
+
+		if (i == 0)
+			base = wall;
+
+		printf("%8u %8u %12llu %10.3f %12.0f %8.2f\n", size, sectors * apsPerSector, events, wall, events / wall, base / wall);
+		fflush(stdout);
+	}
+
+	return 0;
+}
+
+// Application firing the consumer trace HandoffRecorder follows, so the
+// recorder can be checked without a network
+class HandoffCheckApp : public ndn::App
+{
+public:
+	static TypeId GetTypeId()
+	{
+		static TypeId tid = TypeId ("HandoffCheckApp")
+			.SetParent<ndn::App> ()
+			.AddConstructor<HandoffCheckApp> ()
+			.AddTraceSource ("FirstInterestDataDelay", "Delay from the first Interest to the Data",
+					MakeTraceSourceAccessor (&HandoffCheckApp::m_firstInterestDataDelay));
+		return tid;
+	}
+
+	// A Data arrives, retxCount counting every transmission of its
+	// Interest as the ndnSIM consumers do
+	void Data(uint32_t seqno, Time delay, uint32_t retxCount)
+	{
+		m_firstInterestDataDelay(this, seqno, delay, retxCount, 1);
+	}
+
+private:
+	TracedCallback<Ptr<ndn::App>, uint32_t, Time, uint32_t, int32_t> m_firstInterestDataDelay;
+};
+
+// Keeps the rows written to it by column name
+class RowSink : public TraceSink
+{
+public:
+	virtual uint32_t AddColumn(const string &name, Type, Role)
+	{
+		m_names.push_back(name);
+		return m_names.size() - 1;
+	}
+
+	virtual void SetDouble(uint32_t column, double value)
+	{
+		m_row[m_names[column]] = value;
+	}
+
+	virtual void SetInteger(uint32_t column, int64_t value)
+	{
+		m_row[m_names[column]] = value;
+	}
+
+	virtual void SetString(uint32_t, const string &)
+	{
+	}
+
+	virtual void EndRow()
+	{
+		m_rows.push_back(m_row);
+	}
+
+	virtual void Close()
+	{
+	}
+
+	virtual bool IsGood() const
+	{
+		return true;
+	}
+
+	vector<string> m_names;
+	map<string, double> m_row;
+	vector<map<string, double> > m_rows;
+};
+
+// Checks the losses HandoffRecorder counts: a Data whose Interest was sent
+// once is no loss, one sent three times is a loss with two retransmissions
+int handoffBench()
+{
+	Ptr<Node> node = CreateObject<Node> ();
+	Ptr<HandoffCheckApp> app = CreateObject<HandoffCheckApp> ();
+	node->AddApplication(app);
+
+	boost::shared_ptr<RowSink> sink = boost::make_shared<RowSink> ();
+	HandoffRecorder::Install(NodeContainer(node), sink);
+
+	HandoffRecorder::Trigger(node, "ap-0", "ap-1");
+	app->Data(1, MilliSeconds(100), 1);
+
+	HandoffRecorder::Trigger(node, "ap-1", "ap-2");
+	app->Data(2, MilliSeconds(100), 1);
+	app->Data(3, MilliSeconds(200), 3);
+
+	HandoffRecorder::Destroy();
+	Simulator::Destroy();
+
+	double expected[2][2] = { { 0, 0 }, { 1, 2 } };
+	printf("%8s %8s %16s\n", "Handoff", "Lost", "Retransmissions");
+	int failed = sink->m_rows.size() != 2;
+	for (size_t i = 0; i < sink->m_rows.size() && i < 2; i++)
+	{
+		map<string, double> &row = sink->m_rows[i];
+		printf("%8u %8.0f %16.0f\n", (unsigned) i, row["Lost"], row["Retransmissions"]);
+		if (row["Lost"] != expected[i][0] || row["Retransmissions"] != expected[i][1])
+			failed = 1;
+	}
+
+	if (failed)
+		cerr << "ERROR: HandoffRecorder counted the losses wrong" << endl;
+	return failed;
+}
+
+int main (int argc, char *argv[])
+{
+	string bench = "topology";                    // Which benchmark to run
+	string apList = "54,5000,50000";              // Numbers of APs to build
+	uint32_t apsPerSector = 6;                    // Number of wireless access nodes in a sector
+	uint32_t mobile = 1;                          // Number of mobile terminals
+	bool wifi = true;                             // Include the Wifi cards in the topology benchmark
+	bool ndn = true;                              // Include the NDN stacks in the topology benchmark
+	string posFile = "./Data/rand-hex.txt";       // Layout for the channel benchmark
+	string channels = "yans,range,yans+dormant";  // Configurations to compare in the channel benchmark
+	double simTime = 60;                          // Simulated seconds for the channel benchmark
+	uint32_t rounds = 20;                         // Passes over all node pairs in the loss benchmark
+	double tolerance = 0.01;                      // Largest accepted loss difference in dB
+	uint32_t samples = 1000000;                   // Draws per distance in the fading benchmark
+	uint32_t sectors = 9;                         // Number of sectors in the wired benchmark
+	double intFreq = 10;                          // Interests per second per AP in the wired benchmark
+	uint32_t partitions = 4;                      // Partitions in the parallel benchmark
+	string workerList = "1,2,4";                  // Numbers of workers in the parallel benchmark
+	string rankList = "1,2,4,8,16";               // Numbers of MPI ranks in the mpi benchmark
+	string mpirun = "openmpirun";                 // MPI launcher for the mpi benchmark
+
+	CommandLine cmd;
+	cmd.AddValue ("bench", "Benchmark to run: topology, channel, loss, fading, wired, parallel, mpi, or handoff to check the handoff recorder", bench);
+	cmd.AddValue ("aps", "Comma separated numbers of APs to build", apList);
+	cmd.AddValue ("apsPerSector", "Number of wireless access nodes per sector", apsPerSector);
+	cmd.AddValue ("mobile", "Number of mobile terminals", mobile);
+	cmd.AddValue ("wifi", "Install Wifi cards in the topology benchmark", wifi);
+	cmd.AddValue ("ndn", "Install NDN stacks in the topology benchmark", ndn);
+	cmd.AddValue ("posfile", "Layout file for the channel benchmark", posFile);
+	cmd.AddValue ("channels", "Comma separated configurations to compare: a channel (yans, range, fast) with + separated options (dormant, cached, fastfading)", channels);
+	cmd.AddValue ("simTime", "Simulated seconds for the channel, wired, parallel and mpi benchmarks", simTime);
+	cmd.AddValue ("rounds", "Passes over all node pairs in the loss benchmark", rounds);
+	cmd.AddValue ("tolerance", "Largest accepted loss difference in dB for the loss benchmark", tolerance);
+	cmd.AddValue ("samples", "Draws per distance in the fading benchmark", samples);
+	cmd.AddValue ("sectors", "Number of sectors in the wired, parallel and mpi benchmarks", sectors);
+	cmd.AddValue ("intFreq", "Interests per second per AP in the wired, parallel and mpi benchmarks", intFreq);
+	cmd.AddValue ("partitions", "Partitions in the parallel benchmark", partitions);
+	cmd.AddValue ("workers", "Comma separated numbers of workers in the parallel benchmark", workerList);
+	cmd.AddValue ("ranks", "Comma separated numbers of MPI ranks in the mpi benchmark", rankList);
+	cmd.AddValue ("mpirun", "MPI launcher for the mpi benchmark", mpirun);
+	cmd.Parse (argc,argv);
+
+	if (bench == "topology")
+		return topologyBench(parseList(apList), apsPerSector, mobile, wifi, ndn);
+	else if (bench == "channel")
+		return channelBench(posFile, parseWords(channels), mobile, simTime);
+	else if (bench == "loss")
+		return lossBench(posFile, mobile, rounds, tolerance);
+	else if (bench == "fading")
+		return fadingBench(samples);
+	else if (bench == "wired")
+		return wiredBench(sectors, apsPerSector, intFreq, simTime);
+	else if (bench == "parallel")
+		return parallelBench(sectors, apsPerSector, intFreq, simTime, partitions, parseList(workerList));
+	else if (bench == "mpi")
+		return mpiBench(argv[0], mpirun, parseList(rankList), sectors, apsPerSector, intFreq, simTime);
+	else if (bench == "handoff")
+		return handoffBench();
+	else if (bench == "mpirank")
+		return mpiRankBench(&argc, &argv, sectors, apsPerSector, intFreq, simTime);
+
+	cerr << "ERROR: Unknown benchmark " << bench << endl;
+	return 1;
+}
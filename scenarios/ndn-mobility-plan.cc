@@ -0,0 +1,531 @@
+/* -*- Mode:C++; c-file-style:"gnu"; -*- */
+/*
+ * ndn-mobility-plan.cc
+ *  Space filling sweep designs over the parameters of a mobility scenario,
+ *  refined where a summary metric changes fastest
+ *
+ * Copyright (c) 2014 Waseda University, Sato Laboratory
+ *
+ *  ndn-mobility-plan is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  ndn-mobility-plan is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with ndn-mobility-plan.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Standard C++ modules
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// boost modules
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+// ns3 modules
+#include <ns3-dev/ns3/core-module.h>
+
+// Extension files
+#include "utils/run-launcher.h"
+
+using namespace ns3;
+using namespace std;
+
+namespace br = boost::random;
+
+char scenario[250] = "NDNMobilityPlan";
+
+NS_LOG_COMPONENT_DEFINE (scenario);
+
+// Number generator
+br::mt19937_64 gen;
+
+// A scenario argument and the range it is swept over
+struct Parameter
+{
+	string name;
+	string kind;                              // int, real, log, logint or choice
+	double lo;
+	double hi;
+	vector<string> choices;
+};
+
+// A design point, in the unit cube, and what running it gave
+struct PlanPoint
+{
+	vector<double> unit;
+	vector<string> values;
+	double metric;
+	bool ok;
+};
+
+// Splits a list of words
+vector<string> split(const string &list, char separator)
+{
+	vector<string> res;
+	istringstream is(list);
+	string item;
+
+	while (getline(is, item, separator))
+	{
+		res.push_back(item);
+	}
+
+	return res;
+}
+
+// Parses name:kind:lo:hi or name:choice:a|b|c, comma separated
+bool parseParameters(const string &list, vector<Parameter> &params)
+{
+	vector<string> items = split(list, ',');
+	for (int i = 0; i < items.size(); i++)
+	{
+		vector<string> fields = split(items[i], ':');
+		Parameter param;
+		if (fields.size() == 3 && fields[1] == "choice")
+		{
+			param.name = fields[0];
+			param.kind = fields[1];
+			param.choices = split(fields[2], '|');
+			param.lo = 0;
+			param.hi = param.choices.size();
+		}
+		else if (fields.size() == 4 && (fields[1] == "int" || fields[1] == "real" ||
+				fields[1] == "log" || fields[1] == "logint"))
+		{
+			param.name = fields[0];
+			param.kind = fields[1];
+			param.lo = atof(fields[2].c_str());
+			param.hi = atof(fields[3].c_str());
+			if (param.hi < param.lo || ((param.kind == "log" || param.kind == "logint") && param.lo <= 0))
+				return false;
+		}
+		else
+		{
+			return false;
+		}
+
+		if (param.kind == "choice" && param.choices.empty())
+			return false;
+		params.push_back(param);
+	}
+
+	return !params.empty();
+}
+
+// Maps a coordinate in [0, 1) to a value of the parameter
+string formatValue(const Parameter &param, double u)
+{
+	char buffer[64];
+
+	if (param.kind == "choice")
+		return param.choices[min<size_t>(u * param.choices.size(), param.choices.size() - 1)];
+	else if (param.kind == "int")
+		sprintf(buffer, "%d", (int) min(param.hi, floor(param.lo + u * (param.hi - param.lo + 1))));
+	else if (param.kind == "real")
+		sprintf(buffer, "%g", param.lo + u * (param.hi - param.lo));
+	else if (param.kind == "log")
+		sprintf(buffer, "%g", exp(log(param.lo) + u * (log(param.hi) - log(param.lo))));
+	else
+		sprintf(buffer, "%.0f", exp(log(param.lo) + u * (log(param.hi) - log(param.lo))));
+
+	return buffer;
+}
+
+// Latin hypercube of n points: every parameter range is cut into n strata
+// and every stratum holds one point. Of tries designs, the one whose
+// closest two points are furthest apart is kept
+vector<vector<double> > latinHypercube(uint32_t n, uint32_t dims, uint32_t tries)
+{
+	br::uniform_real_distribution<> uniform(0, 1);
+	vector<vector<double> > best;
+	double bestDistance = -1;
+
+	for (uint32_t t = 0; t < tries; t++)
+	{
+		vector<vector<double> > design(n, vector<double> (dims));
+		for (uint32_t d = 0; d < dims; d++)
+		{
+			vector<uint32_t> strata(n);
+			for (uint32_t i = 0; i < n; i++)
+				strata[i] = i;
+			for (uint32_t i = n; i > 1; i--)
+				swap(strata[i - 1], strata[(uint32_t) (uniform(gen) * i)]);
+
+			for (uint32_t i = 0; i < n; i++)
+				design[i][d] = (strata[i] + uniform(gen)) / n;
+		}
+
+		double closest = HUGE_VAL;
+		for (uint32_t i = 0; i < n; i++)
+			for (uint32_t j = i + 1; j < n; j++)
+			{
+				double distance = 0;
+				for (uint32_t d = 0; d < dims; d++)
+					distance += (design[i][d] - design[j][d]) * (design[i][d] - design[j][d]);
+				closest = min(closest, distance);
+			}
+
+		if (closest > bestDistance)
+		{
+			bestDistance = closest;
+			best = design;
+		}
+	}
+
+	return best;
+}
+
+// Points skip+1 to skip+n of the Sobol sequence, leaving out the origin,
+// with the Joe and Kuo direction numbers for the first 12 dimensions
+vector<vector<double> > sobol(uint32_t n, uint32_t dims, uint32_t skip)
+{
+	// Degree, polynomial coefficients and initial direction numbers of
+	// dimensions 2 to 12, the first one being the van der Corput sequence
+	static const uint32_t degree[11] = { 1, 2, 3, 3, 4, 4, 5, 5, 5, 5, 5 };
+	static const uint32_t poly[11] = { 0, 1, 1, 2, 1, 4, 2, 4, 7, 11, 13 };
+	static const uint32_t initial[11][5] = {
+		{ 1 }, { 1, 3 }, { 1, 3, 1 }, { 1, 1, 1 }, { 1, 1, 3, 3 }, { 1, 3, 5, 13 },
+		{ 1, 1, 5, 5, 17 }, { 1, 1, 5, 5, 5 }, { 1, 1, 7, 11, 19 }, { 1, 1, 5, 1, 1 },
+		{ 1, 1, 1, 3, 11 }
+	};
+	const uint32_t bits = 32;
+
+	vector<vector<uint32_t> > direction(dims, vector<uint32_t> (bits));
+	for (uint32_t i = 0; i < bits; i++)
+		direction[0][i] = 1u << (bits - 1 - i);
+
+	for (uint32_t d = 1; d < dims; d++)
+	{
+		uint32_t s = degree[d - 1];
+		uint32_t a = poly[d - 1];
+		for (uint32_t i = 0; i < s && i < bits; i++)
+			direction[d][i] = initial[d - 1][i] << (bits - 1 - i);
+		for (uint32_t i = s; i < bits; i++)
+		{
+			direction[d][i] = direction[d][i - s] ^ (direction[d][i - s] >> s);
+			for (uint32_t k = 1; k < s; k++)
+				direction[d][i] ^= ((a >> (s - 1 - k)) & 1) * direction[d][i - k];
+		}
+	}
+
+	// Gray code order, one XOR per point and dimension
+	vector<vector<double> > design;
+	vector<uint32_t> x(dims, 0);
+	for (uint32_t i = 1; i <= skip + n; i++)
+	{
+		uint32_t c = 0;
+		for (uint32_t v = i - 1; v & 1; v >>= 1)
+			c++;
+		for (uint32_t d = 0; d < dims; d++)
+			x[d] ^= direction[d][c];
+
+		if (i > skip)
+		{
+			vector<double> point(dims);
+			for (uint32_t d = 0; d < dims; d++)
+				point[d] = x[d] / 4294967296.0;
+			design.push_back(point);
+		}
+	}
+
+	return design;
+}
+
+// Starts the scenario for one point, its output going to the point log
+pid_t startPoint(const string &program, const vector<string> &args, const vector<Parameter> &params,
+		const PlanPoint &point, uint32_t index, const string &work)
+{
+	char buffer[250];
+	vector<string> argv = args;
+	for (int d = 0; d < params.size(); d++)
+		argv.push_back("--" + params[d].name + "=" + point.values[d]);
+	sprintf(buffer, "--summary=%s/point-%04u.summary", work.c_str(), index);
+	argv.push_back(buffer);
+
+	sprintf(buffer, "%s/point-%04u.log", work.c_str(), index);
+	return RunLauncher::Start(program, argv, buffer);
+}
+
+// Runs points first to end, at most jobs at a time, and appends each to
+// the results table as it finishes
+void runPoints(vector<PlanPoint> &points, uint32_t first, const string &program, const vector<string> &args,
+		const vector<Parameter> &params, const string &metric, uint32_t jobs, const string &work, ofstream &table)
+{
+	map<pid_t, uint32_t> running;
+	uint32_t next = first;
+
+	while (next < points.size() || !running.empty())
+	{
+		while (running.size() < jobs && next < points.size())
+		{
+			pid_t pid = startPoint(program, args, params, points[next], next, work);
+			if (pid < 0)
+			{
+				points[next++].ok = false;
+				continue;
+			}
+			running[pid] = next++;
+		}
+
+		int status;
+		pid_t pid = wait(&status);
+		if (pid < 0)
+			break;
+		if (running.find(pid) == running.end())
+			continue;
+
+		uint32_t index = running[pid];
+		running.erase(pid);
+
+		char path[250];
+		sprintf(path, "%s/point-%04u.summary", work.c_str(), index);
+		PlanPoint &point = points[index];
+		point.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0 && RunLauncher::ReadMetric(path, metric, point.metric);
+
+		table << index;
+		for (int d = 0; d < params.size(); d++)
+			table << "\t" << point.values[d];
+		if (point.ok)
+			table << "\t" << point.metric << endl;
+		else
+			table << "\tFAILED" << endl;
+
+		printf("%6u %12s\n", index, point.ok ? "done" : "FAILED");
+		fflush(stdout);
+	}
+}
+
+// Copies of a point with every combination of the values of the choice
+// parameters, in the middle of their share of the unit interval
+vector<PlanPoint> enumerateChoices(const PlanPoint &point, const vector<Parameter> &params)
+{
+	vector<PlanPoint> res(1, point);
+	for (int d = 0; d < params.size(); d++)
+	{
+		if (params[d].kind != "choice")
+			continue;
+
+		vector<PlanPoint> next;
+		for (int i = 0; i < res.size(); i++)
+		{
+			for (int c = 0; c < params[d].choices.size(); c++)
+			{
+				PlanPoint copy = res[i];
+				copy.unit[d] = (c + 0.5) / params[d].choices.size();
+				copy.values[d] = params[d].choices[c];
+				next.push_back(copy);
+			}
+		}
+		res.swap(next);
+	}
+
+	return res;
+}
+
+// Adds up to count points between neighbouring points whose metric differs
+// the most, relative to the range of the metric. Only the numeric
+// parameters are refined: neighbours are found over them, and the new
+// point, their midpoint, is run with every combination of the choices,
+// as halfway between two choices means nothing. Points whose arguments
+// are already in the plan are not added again
+uint32_t refine(vector<PlanPoint> &points, const vector<Parameter> &params, uint32_t neighbours, uint32_t count)
+{
+	double lo = HUGE_VAL;
+	double hi = -HUGE_VAL;
+	for (int i = 0; i < points.size(); i++)
+	{
+		if (!points[i].ok)
+			continue;
+		lo = min(lo, points[i].metric);
+		hi = max(hi, points[i].metric);
+	}
+	if (!(hi > lo))
+		return 0;
+
+	// Each point paired with its nearest finished neighbours
+	multimap<double, pair<uint32_t, uint32_t>, greater<double> > edges;
+	for (uint32_t i = 0; i < points.size(); i++)
+	{
+		if (!points[i].ok)
+			continue;
+
+		multimap<double, uint32_t> near;
+		for (uint32_t j = 0; j < points.size(); j++)
+		{
+			if (j == i || !points[j].ok)
+				continue;
+
+			double distance = 0;
+			for (int d = 0; d < params.size(); d++)
+				if (params[d].kind != "choice")
+					distance += (points[i].unit[d] - points[j].unit[d]) * (points[i].unit[d] - points[j].unit[d]);
+			near.insert(make_pair(distance, j));
+		}
+
+		uint32_t k = 0;
+		for (multimap<double, uint32_t>::iterator j = near.begin(); j != near.end() && k < neighbours; j++, k++)
+		{
+			if (i < j->second)
+				edges.insert(make_pair(fabs(points[i].metric - points[j->second].metric) / (hi - lo),
+						make_pair(i, j->second)));
+		}
+	}
+
+	set<vector<string> > seen;
+	for (int i = 0; i < points.size(); i++)
+		seen.insert(points[i].values);
+
+	uint32_t added = 0;
+	for (multimap<double, pair<uint32_t, uint32_t> >::iterator e = edges.begin();
+			e != edges.end() && added < count; e++)
+	{
+		PlanPoint point;
+		point.ok = false;
+		point.metric = 0;
+		for (int d = 0; d < params.size(); d++)
+		{
+			point.unit.push_back((points[e->second.first].unit[d] + points[e->second.second].unit[d]) / 2);
+			point.values.push_back(formatValue(params[d], point.unit[d]));
+		}
+
+		vector<PlanPoint> copies = enumerateChoices(point, params);
+		for (int i = 0; i < copies.size() && added < count; i++)
+		{
+			if (seen.insert(copies[i].values).second)
+			{
+				points.push_back(copies[i]);
+				added++;
+			}
+		}
+	}
+
+	return added;
+}
+
+int main (int argc, char *argv[])
+{
+	string scenarioName = "ndn-mobility-random";  // Scenario to run, next to this program
+	string scenarioArgs = "";                     // Fixed arguments for the scenario
+	string paramList = "mobile:int:1:4,csSize:logint:1000:10000000,mbps:log:0.05:1,retx:real:0.01:0.2";
+	string design = "lhs";                        // Initial design: lhs or sobol
+	uint32_t points = 32;                         // Points of the initial design
+	uint32_t tries = 20;                          // Latin hypercubes to pick the best from
+	uint32_t rounds = 0;                          // Refinement rounds
+	uint32_t perRound = 8;                        // Points added per refinement round
+	uint32_t neighbours = 4;                      // Neighbours compared per point when refining
+	string metric = "goodput";                    // Summary metric the refinement follows
+	uint32_t seed = 1;                            // Seed of the design
+	uint32_t jobs = 0;                            // Points run at the same time, 0 for one per core
+	string work = "results/plan";                 // Directory for the table, summaries and logs
+
+	CommandLine cmd;
+	cmd.AddValue ("scenario", "Scenario program to run, in the directory of this program", scenarioName);
+	cmd.AddValue ("args", "Space separated arguments for every point (--summary is added)", scenarioArgs);
+	cmd.AddValue ("params", "Comma separated name:int|real|log|logint:lo:hi or name:choice:a|b|c", paramList);
+	cmd.AddValue ("design", "Initial design: lhs (maximin Latin hypercube) or sobol", design);
+	cmd.AddValue ("points", "Points of the initial design", points);
+	cmd.AddValue ("tries", "Latin hypercubes drawn to keep the most spread out", tries);
+	cmd.AddValue ("rounds", "Refinement rounds after the initial design", rounds);
+	cmd.AddValue ("perRound", "Points added in each refinement round", perRound);
+	cmd.AddValue ("neighbours", "Nearest neighbours each point is compared with when refining", neighbours);
+	cmd.AddValue ("metric", "Summary metric to refine on: goodput, delay, retxShare or handoffs", metric);
+	cmd.AddValue ("seed", "Seed of the Latin hypercube", seed);
+	cmd.AddValue ("jobs", "Points run at the same time (0 for one per core)", jobs);
+	cmd.AddValue ("work", "Directory for the results table, summaries and logs", work);
+	cmd.Parse (argc,argv);
+
+	vector<Parameter> params;
+	if (!parseParameters(paramList, params))
+	{
+		cerr << "ERROR: Bad parameter list " << paramList << endl;
+		return 1;
+	}
+
+	if (design == "sobol" && params.size() > 12)
+	{
+		cerr << "ERROR: Sobol designs go up to 12 parameters!" << endl;
+		return 1;
+	}
+	else if (design != "sobol" && design != "lhs")
+	{
+		cerr << "ERROR: Unknown design " << design << endl;
+		return 1;
+	}
+
+	if (jobs == 0)
+		jobs = sysconf(_SC_NPROCESSORS_ONLN);
+
+	gen.seed(seed);
+
+	string self = argv[0];
+	size_t slash = self.rfind('/');
+	string program = (slash == string::npos ? string("./") : self.substr(0, slash + 1)) + scenarioName;
+	vector<string> args = split(scenarioArgs, ' ');
+	args.erase(remove(args.begin(), args.end(), string()), args.end());
+
+	if (!RunLauncher::CreateDirectories(work))
+	{
+		cerr << "ERROR: Could not create " << work << endl;
+		return 1;
+	}
+
+	vector<vector<double> > unit = (design == "sobol") ? sobol(points, params.size(), 0)
+			: latinHypercube(points, params.size(), max(tries, 1u));
+
+	vector<PlanPoint> plan;
+	for (int i = 0; i < unit.size(); i++)
+	{
+		PlanPoint point;
+		point.unit = unit[i];
+		point.ok = false;
+		point.metric = 0;
+		for (int d = 0; d < params.size(); d++)
+			point.values.push_back(formatValue(params[d], unit[i][d]));
+		plan.push_back(point);
+	}
+
+	ofstream table((work + "/plan.txt").c_str());
+	table << "point";
+	for (int d = 0; d < params.size(); d++)
+		table << "\t" << params[d].name;
+	table << "\t" << metric << endl;
+
+	printf("%6s %12s\n", "Point", "Status");
+	runPoints(plan, 0, program, args, params, metric, jobs, work, table);
+
+	for (uint32_t r = 0; r < rounds; r++)
+	{
+		uint32_t first = plan.size();
+		uint32_t added = refine(plan, params, neighbours, perRound);
+		printf("Refinement round %u: %u points\n", r + 1, added);
+		if (added == 0)
+			break;
+
+		runPoints(plan, first, program, args, params, metric, jobs, work, table);
+	}
+
+	uint32_t failed = 0;
+	for (int i = 0; i < plan.size(); i++)
+		if (!plan[i].ok)
+			failed++;
+
+	printf("%u points, %u failed, results in %s/plan.txt\n", (uint32_t) plan.size(), failed, work.c_str());
+	return failed ? 1 : 0;
+}
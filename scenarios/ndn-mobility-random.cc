@@ -29,6 +29,8 @@
 #include <iterator>
 #include <iostream>
 #include <map>
+#include <set>
+#include <sstream>
 #include <string>
 #include <sys/time.h>
 #include <vector>
@@ -36,6 +38,7 @@
 // Random modules
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_int_distribution.hpp>
@@ -48,6 +51,7 @@
 #include <ns3-dev/ns3/csma-module.h>
 #include <ns3-dev/ns3/core-module.h>
 #include <ns3-dev/ns3/mobility-module.h>
+#include <ns3-dev/ns3/mpi-interface.h>
 #include <ns3-dev/ns3/network-module.h>
 #include <ns3-dev/ns3/point-to-point-module.h>
 #include <ns3-dev/ns3/wifi-module.h>
@@ -59,6 +63,10 @@
 
 // Extension files
 // #include "minstrel-wifi-manager.h"
+#include "mobility/helper/mobility-scenario-helper.h"
+#include "mobility/helper/sector-topology-helper.h"
+#include "parallel/model/partition-interface.h"
+#include "utils/result-cache.h"
 
 using namespace ns3;
 using namespace boost;
@@ -94,36 +102,67 @@ double obtain_Num(double min, double max)
 	return dist(gen);
 }
 
-// Function to change the SSID of a Node, depending on distance
-void SetSSIDviaDistance(uint32_t mtId, Ptr<MobilityModel> node, std::map<std::string, Ptr<MobilityModel> > aps)
+// Nodes simulated by this rank. Applications and tracers on the nodes of
+// other MPI ranks would run and send packets a second time
+NodeContainer LocalNodes(const NodeContainer &nodes, bool mpi, uint32_t rank)
 {
-	char configbuf[250];
-	char buffer[250];
-
-	// This causes the device in mtId to change the SSID, forcing AP change
-	sprintf(configbuf, "/NodeList/%d/DeviceList/0/$ns3::WifiNetDevice/Mac/Ssid", mtId);
-
-	std::map<double, std::string> SsidDistance;
+	if (!mpi)
+		return nodes;
 
-	// Iterate through the map of seen Ssids
-	for (std::map<std::string, Ptr<MobilityModel> >::iterator ii=aps.begin(); ii!=aps.end(); ++ii)
+	NodeContainer local;
+	for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); i++)
 	{
-		// Calculate the distance from the AP to the node and save into the map
-		SsidDistance[node->GetDistanceFrom((*ii).second)] = (*ii).first;
+		if ((*i)->GetSystemId () == rank)
+			local.Add (*i);
 	}
+	return local;
+}
 
-	double distance = SsidDistance.begin()->first;
-	std::string ssid(SsidDistance.begin()->second);
-
-	sprintf(buffer, "Change to SSID %s at distance of %f", ssid.c_str(), distance);
-
-	NS_LOG_INFO(buffer);
+// Nodes with one of the comma separated roles, among the given ones. The
+// tracers connect to each node they are installed on, so the others cost
+// nothing while the simulation runs
+NodeContainer SelectTraced(const NodeContainer &nodes, const std::string &roles, const SectorTopologyHelper &topology,
+		const std::vector<uint32_t> &mobileNodeIds, const std::vector<uint32_t> &serverNodeIds)
+{
+	std::set<uint32_t> selected;
+	std::istringstream is(roles);
+	std::string role;
 
-	// Because the map sorts by std:less, the first position has the lowest distance
-	Config::Set(configbuf, SsidValue(ssid));
+	while (std::getline(is, role, ','))
+	{
+		NodeContainer group;
+		if (role == "all")
+			return nodes;
+		else if (role == "mobile")
+		{
+			selected.insert(mobileNodeIds.begin(), mobileNodeIds.end());
+			continue;
+		}
+		else if (role == "server")
+		{
+			selected.insert(serverNodeIds.begin(), serverNodeIds.end());
+			continue;
+		}
+		else if (role == "ap")
+			group = topology.GetApNodes ();
+		else if (role == "central")
+			group = topology.GetCentralNodes ();
+		else if (role == "first")
+			group = topology.GetFirstLevelNodes ();
+		else
+			NS_FATAL_ERROR ("Unknown node role " << role << " in --traceNodes");
+
+		for (NodeContainer::Iterator i = group.Begin (); i != group.End (); i++)
+			selected.insert((*i)->GetId ());
+	}
 
-	// Empty the maps
-	SsidDistance.clear();
+	NodeContainer res;
+	for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); i++)
+	{
+		if (selected.count((*i)->GetId ()))
+			res.Add (*i);
+	}
+	return res;
 }
 
 int main (int argc, char *argv[])
@@ -138,6 +177,16 @@ int main (int argc, char *argv[])
 	uint32_t yaxis = 100;                         // Size of the Y axis
 	double sec = 0.0;                             // Movement start
 	bool traceFiles = false;                      // Tells to run the simulation with traceFiles
+	bool binTrace = false;                        // Write the traces in the columnar binary format
+	bool aggTrace = false;                        // Write only the traces reduced over nodes and faces
+	bool asyncTrace = false;                      // Write the traces from a background thread
+	bool delayHist = false;                       // Trace the delays as per second histograms
+	double finePeriod = 0;                        // Trace period after SSID changes (0 for fixed periods)
+	double finePeriodWindow = 2;                  // Seconds traced at the fine period after an SSID change
+	double coarsePeriod = 0;                      // Trace period away from SSID changes (0 keeps 1 s and 0.5 s)
+	bool byClass = false;                         // Keep the node classes apart in the reduced traces
+	bool handoffTrace = false;                    // Record the disruption of every handoff
+	std::string traceNodes = "all";               // Roles of the nodes the tracers are installed on
 	bool smart = false;                           // Tells to run the simulation with SmartFlooding
 	bool bestr = false;                           // Tells to run the simulation with BestRoute
 	bool walk = true;                             // Do random walk at walking speed
@@ -150,6 +199,23 @@ int main (int argc, char *argv[])
 	int maxSeq = -1;                              // Maximum number of Data packets to request
 	double retxtime = 0.05;                       // How frequent Interest retransmission timeouts should be checked (seconds)
 	int csSize = 10000000;                        // How big the Content Store should be
+	std::string chPlan = "single";                // Wifi channel plan (single, sector, reuse)
+	uint32_t reuse = 3;                           // Reuse cluster size for the reuse channel plan
+	bool rangeCull = false;                       // Only deliver Wifi frames to cards within range
+	double maxRange = 0;                          // Wifi delivery range in meters (0 derives it)
+	bool dormant = false;                         // Suspend beacons of APs far from mobile terminals
+	double wakeRange = 250;                       // Distance in meters at which APs resume beacons
+	bool cachedLoss = false;                      // Cache the deterministic Wifi path loss
+	bool fastFading = false;                      // Draw Nakagami fading from pre-generated blocks
+	bool fastWifi = false;                        // Use the abstract range based wireless link
+	bool idealLinks = false;                      // Use queueless links for the wired hierarchy
+	uint32_t partitions = 1;                      // Partitions for the windowed simulator
+	uint32_t workers = 1;                         // Worker processes running the partitions
+	bool mpi = false;                             // Partition over MPI ranks (set by ./waf --mpi)
+	uint32_t seed = 1;                            // Seed of the random number generators
+	uint32_t run = 1;                             // Run number, the independent replication to simulate
+	bool cache = false;                           // Keep results in a directory named by the configuration
+	std::string summary;                          // File for the run summary metrics
 	//double deltaTime = 10;
         std::string nsTFile;                          // Name of the NS Trace file to use
 	char nsTDir[250] = "./Waypoints";           // Directory for the waypoint files
@@ -163,6 +229,16 @@ int main (int argc, char *argv[])
 	cmd.AddValue ("results", "Directory to place results", results);
 	cmd.AddValue ("start", "Starting second", sec);
 	cmd.AddValue ("trace", "Enable trace files", traceFiles);
+	cmd.AddValue ("binTrace", "Write the trace files in the columnar binary format (see ndn-trace-convert)", binTrace);
+	cmd.AddValue ("aggTrace", "Write the trace files summed (rates) or averaged (delays) over nodes per second and Type", aggTrace);
+	cmd.AddValue ("asyncTrace", "Format, compress and write the trace files in background threads", asyncTrace);
+	cmd.AddValue ("delayHist", "Trace the delays of each consumer as histograms every second instead of per Data packet", delayHist);
+	cmd.AddValue ("finePeriod", "Trace every this many seconds after each SSID change (0 for the fixed periods)", finePeriod);
+	cmd.AddValue ("fineWindow", "Seconds traced at finePeriod after each SSID change", finePeriodWindow);
+	cmd.AddValue ("coarsePeriod", "With finePeriod, trace every this many seconds away from SSID changes (0 keeps 1 s, 0.5 s for drops)", coarsePeriod);
+	cmd.AddValue ("handoffTrace", "With trace, write a binary record of the disruption of every handoff (convert with ndn-trace-convert)", handoffTrace);
+	cmd.AddValue ("byClass", "With aggTrace, reduce mobile, AP, core and server nodes separately", byClass);
+	cmd.AddValue ("traceNodes", "Comma separated roles of the traced nodes: mobile, ap, central, first, server or all", traceNodes);
 	cmd.AddValue ("smart", "Enable SmartFlooding forwarding", smart);
 	cmd.AddValue ("bestr", "Enable BestRoute forwarding", bestr);
 	cmd.AddValue ("csSize", "Number of Interests a Content Store can maintain", csSize);
@@ -173,10 +249,65 @@ int main (int argc, char *argv[])
 	cmd.AddValue ("mbps", "Data transmission rate for NDN App in MBps", MBps);
 	cmd.AddValue ("size", "Content size in MB (-1 is for no limit)", contentSize);
 	cmd.AddValue ("retx", "How frequent Interest retransmission timeouts should be checked in seconds", retxtime);
+	cmd.AddValue ("chplan", "Wifi channel plan: single, sector or reuse", chPlan);
+	cmd.AddValue ("reuse", "Reuse cluster size for the reuse channel plan (3, 4 or 7)", reuse);
+	cmd.AddValue ("rangeCull", "Only deliver Wifi frames to cards within range", rangeCull);
+	cmd.AddValue ("maxRange", "Wifi delivery range in meters for rangeCull (0 derives it from the card sensitivity, about 1.8 km, which culls nothing on a 1000 x 1000 m layout)", maxRange);
+	cmd.AddValue ("dormant", "Suspend beacons of APs with no mobile terminal near", dormant);
+	cmd.AddValue ("wakeRange", "Distance in meters at which dormant APs resume beacons", wakeRange);
+	cmd.AddValue ("cachedLoss", "Cache the deterministic Wifi path loss", cachedLoss);
+	cmd.AddValue ("fastFading", "Draw Nakagami fading from pre-generated gamma blocks", fastFading);
+	cmd.AddValue ("fastwifi", "Use an abstract range based wireless link instead of 802.11g", fastWifi);
+	cmd.AddValue ("idealLinks", "Use queueless single event links for the wired hierarchy", idealLinks);
+	cmd.AddValue ("partitions", "Partitions the wired hierarchy is split into (1 is the default simulator)", partitions);
+	cmd.AddValue ("workers", "Worker processes running the partitions", workers);
+	cmd.AddValue ("mpi", "Partition the wired hierarchy over the MPI ranks", mpi);
+	cmd.AddValue ("seed", "Seed of the random number generators", seed);
+	cmd.AddValue ("run", "Run number of the random number generators", run);
+	cmd.AddValue ("cache", "Place results in a directory named by a hash of the configuration and skip finished runs", cache);
+	cmd.AddValue ("summary", "Write goodput (Mbps), delay (ms), share of retransmitted Interests and handoffs of the run to this file", summary);
 	cmd.AddValue ("traceFile", "Directory containing Ns2 movement trace files (Usually created by Bonnmotion)", nsTDir);
 	//cmd.AddValue ("deltaTime", "time interval (s) between updates (default 100)", deltaTime);	
 	cmd.Parse (argc,argv);
 
+	// Random variables take their streams from these when created
+	RngSeedManager::SetSeed (seed);
+	RngSeedManager::SetRun (run);
+
+	// Rank of this process, every node of other ranks is only a placeholder
+	uint32_t rank = 0;
+
+	if (mpi)
+	{
+#ifdef NS3_MPI
+		GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DistributedSimulatorImpl"));
+		MpiInterface::Enable (&argc, &argv);
+		rank = MpiInterface::GetSystemId ();
+		partitions = MpiInterface::GetSize ();
+		workers = 1;
+#else
+		cerr << "ERROR: ns-3 was built without MPI support!" << endl;
+		return 1;
+#endif
+	}
+	else if (partitions > 1)
+	{
+		GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::PartitionSimulatorImpl"));
+	}
+	else if (workers > 1)
+	{
+		cerr << "ERROR: Workers need more than one partition!" << endl;
+		return 1;
+	}
+
+	// The reduced traces sum the rows of every node in a bin, so rates
+	// written every fine period would be counted once per row
+	if (aggTrace && finePeriod > 0)
+	{
+		cerr << "ERROR: finePeriod cannot be used with aggTrace!" << endl;
+		return 1;
+	}
+
 	if (! (car || walk))
 	{
 		cerr << "ERROR: Must choose a speed for random walk!" << endl;
@@ -246,7 +377,7 @@ int main (int argc, char *argv[])
 	}
 
 	 // What the NDN Data packet payload size is fixed to 1024 bytes
-	uint32_t payLoadsize = 1024;
+	uint32_t payLoadsize = MobilityScenarioHelper::PAYLOAD_SIZE;
 
 	// Give the content size, find out how many sequence numbers are necessary
 	if (contentSize > 0)
@@ -254,103 +385,116 @@ int main (int argc, char *argv[])
 		maxSeq = 1 + (((contentSize*1000000) - 1) / payLoadsize);
 	}
 
-	// How many Interests/second a producer creates
-	double intFreq = (MBps * 1000000) / payLoadsize;
+	// Everything the results depend on names the directory they go in,
+	// with the trace options choosing the files written. The partitions,
+	// workers, MPI and asyncTrace only change how the same run is computed
+	// and written, so they are left out
+	ResultCache resultCache (results);
+	resultCache.Add ("scenario", scenario);
+	resultCache.Add ("mobile", mobile);
+	resultCache.Add ("servers", servers);
+	resultCache.Add ("start", sec);
+	resultCache.Add ("smart", smart);
+	resultCache.Add ("bestr", bestr);
+	resultCache.Add ("csSize", csSize);
+	resultCache.Add ("walk", walk);
+	resultCache.Add ("car", car);
+	resultCache.Add ("endTime", endTime);
+	resultCache.Add ("mbps", MBps);
+	resultCache.Add ("size", contentSize);
+	resultCache.Add ("retx", retxtime);
+	resultCache.Add ("chplan", chPlan);
+	resultCache.Add ("reuse", reuse);
+	resultCache.Add ("rangeCull", rangeCull);
+	resultCache.Add ("maxRange", maxRange);
+	resultCache.Add ("dormant", dormant);
+	resultCache.Add ("wakeRange", wakeRange);
+	resultCache.Add ("cachedLoss", cachedLoss);
+	resultCache.Add ("fastFading", fastFading);
+	resultCache.Add ("fastwifi", fastWifi);
+	resultCache.Add ("idealLinks", idealLinks);
+	resultCache.Add ("seed", seed);
+	resultCache.Add ("run", run);
+	MobilityScenarioHelper::AddTraceOptions (resultCache, traceFiles, binTrace, aggTrace, byClass, delayHist,
+			finePeriod, finePeriodWindow, coarsePeriod, handoffTrace, traceNodes);
+	resultCache.AddAttributes ();
+
+	if (cache)
+	{
+		if (!resultCache.AddFile ("posfile", posFile) || !resultCache.AddFile ("traceFile", nsTFile))
+		{
+			cerr << "ERROR: Could not read " << posFile << " or " << nsTFile << endl;
+			return 1;
+		}
 
-	vector<double> centralXpos;
-	vector<double> centralYpos;
+		if (!resultCache.AddProgram ())
+		{
+			cerr << "ERROR: Could not read the program to key the results" << endl;
+			return 1;
+		}
+
+		if (resultCache.IsComplete ())
+		{
+			cout << "Results already in " << resultCache.GetPath () << endl;
+
+			// Hand out the summary of the finished run
+			if (!summary.empty ())
+			{
+				std::ifstream in ((resultCache.GetPath () + "/summary.txt").c_str ());
+				std::ofstream out (summary.c_str ());
+				out << in.rdbuf ();
+				if (!in || !out)
+				{
+					cerr << "ERROR: Could not copy the cached summary to " << summary << endl;
+					return 1;
+				}
+			}
+			return 0;
+		}
 
-	vector<double> wirelessXpos;
-	vector<double> wirelessYpos;
+		if (rank == 0 && !resultCache.Prepare ())
+		{
+			cerr << "ERROR: Could not create " << resultCache.GetPath () << endl;
+			return 1;
+		}
+
+		snprintf (results, sizeof (results), "%s", resultCache.GetPath ().c_str ());
+	}
 
 	NS_LOG_INFO ("------Attempting to read positions file------");
 
 	// Attempt to read the file with the position data
-	ifstream file;
-
-	file.open (posFile);
+	SectorLayout layout;
 
-	if (!file.is_open ()) {
+	if (!layout.Read (posFile)) {
 		cerr << "ERROR: Error opening file -> " << posFile << endl;
 		cerr << "ERROR: Please check position file before running simulation!" << endl;
 		return 1;
 	}
-	else {
-		// Attempt to read everything
-
-		string line;
-
-		// Get the size of the area to simulate
-		NS_LOG_INFO ("Reading X and Y axis");
 
-		getline(file, line);
-		istringstream xss(line);
-		xss >> xaxis;
+	xaxis = layout.GetXAxis ();
+	yaxis = layout.GetYAxis ();
+	sectors = layout.GetNSectors ();
+	aps = layout.GetApsPerSector ();
+	wnodes = layout.GetNAps ();
+
+	// Create the mobile terminals, central nodes, wireless access nodes,
+	// first level nodes and servers, and place the fixed nodes
+	SectorTopologyHelper topology;
+	topology.SetMobileTerminals (mobile);
+	topology.SetServers (servers);
+	topology.SetChannelPlan (SectorTopologyHelper::ParseChannelPlan (chPlan), reuse);
+	topology.SetRangeCulling (rangeCull, maxRange);
+	topology.SetDormantBeacons (dormant, wakeRange);
+	topology.SetCachedLoss (cachedLoss);
+	topology.SetFastFading (fastFading);
+	topology.SetFastWifi (fastWifi);
+	topology.SetIdealLinks (idealLinks);
+	topology.SetPartitions (partitions);
+	topology.Create (layout);
 
-		getline(file, line);
-		istringstream yss(line);
-		yss >> yaxis;
-
-		// Get the number of central nodes
-		NS_LOG_INFO ("Reading number of sectors");
-
-		getline(file, line);
-		istringstream sss(line);
-		sss >> sectors;
-
-		double tmpX;
-		double tmpY;
-
-		NS_LOG_INFO ("Reading sector positions");
-
-		// Read the position for each sector, save into vector
-		for (int i = 0; i < sectors; i++) {
-			getline(file, line, ',');
-			istringstream dxs(line);
-			dxs >> tmpX;
-
-			centralXpos.push_back(tmpX);
-
-			getline(file, line);
-			istringstream dys(line);
-			dys >> tmpY;
-
-			centralYpos.push_back(tmpY);
-		}
-
-		// Get the number of wireless nodes per sector
-		NS_LOG_INFO ("Reading number of wireless nodes per sector");
-		getline(file, line);
-		istringstream apss(line);
-		apss >> aps;
-
-		// Get the total number of wireless nodes in simulation
-		NS_LOG_INFO ("Reading number of wireless nodes in the simulation");
-		getline(file, line);
-		istringstream wnss(line);
-		wnss >> wnodes;
-
-		// Read the position for each wireless node, save into vectors
-		NS_LOG_INFO ("Reading wireless node positions");
-		for (int i = 0; i < wnodes; i++) {
-			getline(file, line, ',');
-			istringstream dxs(line);
-			dxs >> tmpX;
-
-			wirelessXpos.push_back(tmpX);
-
-			getline(file, line);
-			istringstream dys(line);
-			dys >> tmpY;
-
-			wirelessYpos.push_back(tmpY);
-		}
-	}
-
-	NS_LOG_INFO ("------Creating nodes------");
 	// Node definitions for mobile terminals (consumers)
-	NodeContainer mobileTerminalContainer;
-	mobileTerminalContainer.Create(mobile);
+	NodeContainer mobileTerminalContainer = topology.GetMobileTerminals ();
 
 	std::vector<uint32_t> mobileNodeIds;
 
@@ -360,95 +504,19 @@ int main (int argc, char *argv[])
 		mobileNodeIds.push_back(mobileTerminalContainer.Get (i)->GetId ());
 	}
 
-	// Central Nodes
-	NodeContainer centralContainer;
-	centralContainer.Create (sectors);
-
-	// Wireless access Nodes
-	NodeContainer wirelessContainer;
-	wirelessContainer.Create (wnodes);
-
-	// Separate the wireless nodes into sector specific containers
-	std::vector<NodeContainer> sectorNodes;
-
-	for (int i = 0; i < sectors; i++)
-	{
-		NodeContainer wireless;
-		for (int j = i*aps; j < aps + i*aps; j++)
-		{
-			wireless.Add(wirelessContainer.Get (j));
-		}
-		sectorNodes.push_back(wireless);
-	}
-
-	// Find out how many first level nodes we will have
-	// The +1 is for the server which will be attached to the first level nodes
-	int first = (sectors / 3) + 1;
-
-	// First level Nodes
-	NodeContainer firstLevel;
-	firstLevel.Create (first);
-
-	// Container for all NDN capable nodes
-	NodeContainer allNdnNodes;
-	allNdnNodes.Add (centralContainer);
-	allNdnNodes.Add (wirelessContainer);
-	allNdnNodes.Add (firstLevel);
-
-	// Container for all NDN capable nodes not in first level
-	NodeContainer lowerNdnNodes;
-	lowerNdnNodes.Add (centralContainer);
-	lowerNdnNodes.Add (wirelessContainer);
-
 	// Container for server (producer) nodes
-	NodeContainer serverNodes;
-	serverNodes.Create (servers);
+	NodeContainer serverNodes = topology.GetServerNodes ();
 
 	std::vector<uint32_t> serverNodeIds;
 
-	// Save all the mobile Node IDs
+	// Save all the server Node IDs
 	for (int i = 0; i < servers; i++)
 	{
 		serverNodeIds.push_back(serverNodes.Get (i)->GetId ());
 	}
 
-	// Container for all nodes without NDN specific capabilities
-	NodeContainer allUserNodes;
-	allUserNodes.Add (mobileTerminalContainer);
-	allUserNodes.Add (serverNodes);
-
 	// Make sure to seed our random
-	gen.seed (std::time (0) + (long long)getpid () << 32);
-
-	NS_LOG_INFO ("------Placing Central nodes-------");
-	MobilityHelper centralStations;
-
-	Ptr<ListPositionAllocator> initialCenter = CreateObject<ListPositionAllocator> ();
-
-	for (int i = 0; i < sectors; i++)
-	{
-		Vector pos (centralXpos[i], centralYpos[i], 0.0);
-		initialCenter->Add (pos);
-	}
-
-	centralStations.SetPositionAllocator(initialCenter);
-	centralStations.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
-	centralStations.Install(centralContainer);
-
-	NS_LOG_INFO ("------Placing wireless access nodes------");
-	MobilityHelper wirelessStations;
-
-	Ptr<ListPositionAllocator> initialWireless = CreateObject<ListPositionAllocator> ();
-
-	for (int i = 0; i < wnodes; i++)
-	{
-		Vector pos (wirelessXpos[i], wirelessYpos[i], 0.0);
-		initialWireless->Add (pos);
-	}
-
-	wirelessStations.SetPositionAllocator(initialWireless);
-	wirelessStations.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-	wirelessStations.Install(wirelessContainer);
+	gen.seed (((uint64_t) seed << 32) | run);
 
 	NS_LOG_INFO ("------Placing mobile node and determining direction and speed------");
 	MobilityHelper mobileStations;
@@ -496,306 +564,107 @@ string bounds = string(buffer);
 	mobileStations.Install(mobileTerminalContainer);
 */
 
-	// Connect Wireless Nodes to central nodes
-	// Because the simulation is using Wifi, PtP connections are 100Mbps
-	// with 5ms delay
-	NS_LOG_INFO("------Connecting Central nodes to wireless access nodes------");
-
-	vector <NetDeviceContainer> ptpWLANCenterDevices;
-
-	PointToPointHelper p2p_100mbps5ms;
-	p2p_100mbps5ms.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
-	p2p_100mbps5ms.SetChannelAttribute ("Delay", StringValue ("5ms"));
-
-	for (int i = 0; i < sectors; i++)
-	{
-		NetDeviceContainer ptpWirelessCenterDevices;
-
-		for (int j = 0; j < aps; j++)
-		{
-			ptpWirelessCenterDevices.Add (p2p_100mbps5ms.Install (centralContainer.Get (i), sectorNodes[i].Get (j) ));
-		}
-
-		ptpWLANCenterDevices.push_back (ptpWirelessCenterDevices);
-	}
-
-	// Connect the server to the lone core node
-	NetDeviceContainer ptpServerlowerNdnDevices;
-	ptpServerlowerNdnDevices.Add (p2p_100mbps5ms.Install (serverNodes.Get (0), firstLevel.Get (first-1)));
-
-	// Connect the center nodes to first level nodes
-	NS_LOG_INFO("Connecting Central Nodes amongst themselves");
-	vector <NetDeviceContainer> ptpCenterFirstDevices;
-
-	PointToPointHelper p2p_1Gbps2ms;
-	p2p_1Gbps2ms.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
-	p2p_1Gbps2ms.SetChannelAttribute ("Delay", StringValue ("2ms"));
-
-	for (int i = 0; i < first-1; i++)
-	{
-		NetDeviceContainer ptpCenterDevices;
-
-		for (int j = i; j < sectors; j+=(first-1))
-		{
-			ptpCenterDevices.Add (p2p_1Gbps2ms.Install (firstLevel.Get (i), centralContainer.Get (j)));
-		}
-
-		ptpCenterFirstDevices.push_back (ptpCenterDevices);
-	}
-
-	// Connect the first level nodes amongst themselves
-	NS_LOG_INFO("------Connecting First level nodes amongst themselves------");
-	NetDeviceContainer ptpFirstFirstDevices;
-
-	for (int i = 0; i < first; i++)
-	{
-		for (int j = i+1; j < first; j++)
-		{
-			ptpFirstFirstDevices.Add (p2p_1Gbps2ms.Install (firstLevel.Get (i), firstLevel.Get (j)));
-		}
-	}
-
-	NS_LOG_INFO ("------Creating Wireless cards------");
-
-	// Use the Wifi Helper to define the wireless interfaces for APs
-	WifiHelper wifi;
-	wifi.SetStandard(WIFI_PHY_STANDARD_80211g);
-	// The N standard is apparently not completely supported in NS-3
-	//wifi.setStandard(WIFI_PHY_STANDARD_80211n_2_4GHZ);
-	// The ConstantRateWifiManager only works with one rate, making issues
-	//wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager");
-	// The MinstrelWifiManager isn't working on the current version of NS-3
-	//wifi.SetRemoteStationManager ("ns3::MinstrelWifiManager");
-	wifi.SetRemoteStationManager ("ns3::ArfWifiManager");
-
-
-	YansWifiChannelHelper wifiChannel;
-	wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
-	wifiChannel.AddPropagationLoss ("ns3::ThreeLogDistancePropagationLossModel");
-	wifiChannel.AddPropagationLoss("ns3::NakagamiPropagationLossModel");
-
-	// All interfaces are placed on the same channel. Makes AP changes easy. Might
-	// have to be reconsidered for multiple mobile nodes
-	YansWifiPhyHelper wifiPhyHelper = YansWifiPhyHelper::Default ();
-	wifiPhyHelper.SetChannel (wifiChannel.Create ());
-	wifiPhyHelper.Set("TxPowerStart", DoubleValue(16.0206));
-	wifiPhyHelper.Set("TxPowerEnd", DoubleValue(1));
-
-	// Add a simple no QoS based card to the Wifi interfaces
-	NqosWifiMacHelper wifiMacHelper = NqosWifiMacHelper::Default ();
-
-	// Create SSIDs for all the APs
-	std::vector<Ssid> ssidV;
-
-	NS_LOG_INFO ("------Creating ssids for wireless cards------");
-
-	// We store the Wifi AP mobility models in a map, ordered by the ssid string. Will be easier to manage when
-	// calling the modified StaMApWifiMac
-	std::map<std::string, Ptr<MobilityModel> > apTerminalMobility;
-
-	for (int i = 0; i < wnodes; i++)
-	{
-		// Temporary string containing our SSID
-		std::string ssidtmp("ap-" + boost::lexical_cast<std::string>(i));
-
-		// Push the newly created SSID into a vector
-		ssidV.push_back (Ssid (ssidtmp));
-
-		// Get the mobility model for wnode i
-		Ptr<MobilityModel> tmp = (wirelessContainer.Get (i))->GetObject<MobilityModel> ();
-
-		// Store the information into our map
-		apTerminalMobility[ssidtmp] = tmp;
-	}
-
-	NS_LOG_INFO ("------Assigning mobile terminal wireless cards------");
-
-	NS_LOG_INFO ("Assigning AP wireless cards");
-	std::vector<NetDeviceContainer> wifiAPNetDevices;
-	for (int i = 0; i < wnodes; i++)
-	{
-		wifiMacHelper.SetType ("ns3::ApWifiMac",
-						   "Ssid", SsidValue (ssidV[i]),
-						   "BeaconGeneration", BooleanValue (true),
-						   "BeaconInterval", TimeValue (Seconds (0.102)));
-
-		wifiAPNetDevices.push_back (wifi.Install (wifiPhyHelper, wifiMacHelper, wirelessContainer.Get (i)));
-	}
-
-	// Create a Wifi station with a modified Station MAC.
-	wifiMacHelper.SetType("ns3::StaWifiMac",
-			"Ssid", SsidValue (ssidV[0]),
-			"ActiveProbing", BooleanValue (true));
-
-	NetDeviceContainer wifiMTNetDevices = wifi.Install (wifiPhyHelper, wifiMacHelper, mobileTerminalContainer);
-
-	// Using the same calculation from the Yans-wifi-Channel, we obtain the Mobility Models for the
-	// mobile node as well as all the Wifi capable nodes
-	Ptr<MobilityModel> mobileTerminalMobility = (mobileTerminalContainer.Get (0))->GetObject<MobilityModel> ();
-
-	std::vector<Ptr<MobilityModel> > mobileTerminalsMobility;
-
-	// Get the list of mobile node mobility models
-	for (int i = 0; i < mobile; i++)
-	{
-		mobileTerminalsMobility.push_back((mobileTerminalContainer.Get (i))->GetObject<MobilityModel> ());
-	}
-
-	char routeType[250];
-
-	// Now install content stores and the rest on the middle node. Leave
-	// out clients and the mobile node
-	NS_LOG_INFO ("------Installing NDN stack on routers------");
-	ndn::StackHelper ndnHelperRouters;
+	// Connect the wireless access nodes, central nodes, first level nodes
+	// and servers, then give the access nodes and mobile terminals their
+	// Wifi cards
+	topology.ConnectWired ();
+	topology.InstallWifi ();
 
 	// Decide what Forwarding strategy to use depending on user command line input
-	if (smart) {
-		sprintf(routeType, "%s", "smart");
-		NS_LOG_INFO ("NDN Utilizing SmartFlooding");
-		ndnHelperRouters.SetForwardingStrategy ("ns3::ndn::fw::SmartFlooding::PerOutFaceLimits", "Limit", "ns3::ndn::Limits::Window");
-	} else if (bestr) {
-		sprintf(routeType, "%s", "bestr");
-		NS_LOG_INFO ("NDN Utilizing BestRoute");
-		ndnHelperRouters.SetForwardingStrategy ("ns3::ndn::fw::BestRoute::PerOutFaceLimits", "Limit", "ns3::ndn::Limits::Window");
-	} else {
-		sprintf(routeType, "%s", "flood");
-		NS_LOG_INFO ("NDN Utilizing Flooding");
-		ndnHelperRouters.SetForwardingStrategy ("ns3::ndn::fw::Flooding::PerOutFaceLimits", "Limit", "ns3::ndn::Limits::Window");
-	}
-
-	// Set the Content Stores
-
-	sprintf(buffer, "%d", csSize);
-
-	ndnHelperRouters.SetContentStore ("ns3::ndn::cs::Freshness::Lru", "MaxSize", buffer);
-	ndnHelperRouters.SetDefaultRoutes (true);
-	// Install on ICN capable routers
-	ndnHelperRouters.Install (allNdnNodes);
-
-	// Create a NDN stack for the clients and mobile node
-	ndn::StackHelper ndnHelperUsers;
-	// These nodes have only one interface, so BestRoute forwarding makes sense
-	ndnHelperUsers.SetForwardingStrategy ("ns3::ndn::fw::BestRoute");
-	// No Content Stores are installed on these machines
-	ndnHelperUsers.SetContentStore ("ns3::ndn::cs::Nocache");
-	ndnHelperUsers.SetDefaultRoutes (true);
-	ndnHelperUsers.Install (allUserNodes);
+	const char *routeType = smart ? "smart" : (bestr ? "bestr" : "flood");
 
-	NS_LOG_INFO ("------Installing Producer Application------");
+	// Install the NDN stacks, the producers on the servers and the
+	// consumers on the mobile terminals
+	MobilityScenarioHelper scenarioHelper (topology);
+	scenarioHelper.InstallNdn (routeType, csSize);
 
-	sprintf(buffer, "Producer Payload size: %d", payLoadsize);
-	NS_LOG_INFO (buffer);
+	std::ostringstream times;
+	topology.PrintTimes (times);
+	NS_LOG_INFO ("Topology construction times:\n" << times.str ());
 
-	// Create the producer on the mobile node
-	ndn::AppHelper producerHelper ("ns3::ndn::Producer");
-	producerHelper.SetPrefix ("/waseda/sato");
-	producerHelper.SetAttribute ("StopTime", TimeValue (Seconds(endTime-1)));
-	// Payload size is in bytes
-	producerHelper.SetAttribute ("PayloadSize", UintegerValue(payLoadsize));
-	producerHelper.Install (serverNodes);
-
-	NS_LOG_INFO ("------Installing Consumer Application------");
-
-	sprintf(buffer, "Consumer Interest/s frequency: %f", intFreq);
-	NS_LOG_INFO (buffer);
-
-	// Create the consumer on the randomly selected node
-	ndn::AppHelper consumerHelper ("ns3::ndn::ConsumerCbr");
-	consumerHelper.SetPrefix ("/waseda/sato");
-	consumerHelper.SetAttribute ("Frequency", DoubleValue (intFreq));
-	consumerHelper.SetAttribute ("StartTime", TimeValue (Seconds(1)));
-	consumerHelper.SetAttribute ("StopTime", TimeValue (Seconds(endTime-1)));
-	consumerHelper.SetAttribute ("RetxTimer", TimeValue (Seconds(retxtime)));
-	if (maxSeq > 0)
-		consumerHelper.SetAttribute ("MaxSeq", IntegerValue(maxSeq));
-
-	consumerHelper.Install (mobileTerminalContainer);
+	scenarioHelper.InstallApplications (LocalNodes (serverNodes, mpi, rank), LocalNodes (mobileTerminalContainer, mpi, rank),
+			MBps, Seconds (endTime), Seconds (retxtime), maxSeq);
 
 	sprintf(buffer, "Ending time! %f", endTime);
 	NS_LOG_INFO(buffer);
 
+	// Everything above is shared by the workers, everything below is per worker
+	if (workers > 1)
+		PartitionInterface::Enable (workers);
+
 	// If the variable is set, print the trace files
 	if (traceFiles) {
 		// Filename
 		char filename[250];
 
-		// File ID
-		char fileId[250];
-
-		// Create the file identifier
-		sprintf(fileId, "%s-%02d-%03d-%03d.txt", routeType, mobile, servers, wnodes);
+		// Create the file identifier, each worker or rank traces its own nodes
+		if (workers > 1)
+			sprintf(buffer, "w%02d", PartitionInterface::GetWorker ());
+		else if (mpi)
+			sprintf(buffer, "r%02d", rank);
+		else
+			buffer[0] = 0;
+		std::string fileId = scenarioHelper.GetFileId (routeType, buffer);
 
-		sprintf(filename, "%s/%s-clients-%s", results, scenario, fileId);
+		// Print the client and server nodes to files
+		sprintf(filename, "%s/%s", results, scenario);
+		scenarioHelper.WriteNodeLists (filename, fileId);
 
-		std::ofstream clientFile;
-
-		clientFile.open (filename);
-		for (int i = 0; i < mobileNodeIds.size(); i++)
-		{
-			clientFile << mobileNodeIds[i] << std::endl;
-		}
+		NS_LOG_INFO ("Installing tracers");
+		NodeContainer local = (workers > 1) ? PartitionInterface::GetLocalNodes () : LocalNodes (NodeContainer::GetGlobal (), mpi, rank);
+
+		scenarioHelper.SetBinaryTraces (binTrace);
+		scenarioHelper.SetReducedTraces (aggTrace, byClass);
+		scenarioHelper.SetAsyncTraces (asyncTrace);
+		scenarioHelper.SetDelayHistograms (delayHist);
+		if (finePeriod > 0)
+			scenarioHelper.SetFineTracePeriods (Seconds (finePeriod), Seconds (finePeriodWindow), Seconds (coarsePeriod));
+		scenarioHelper.InstallTracers (SelectTraced (local, traceNodes, topology, mobileNodeIds, serverNodeIds), filename, fileId);
+
+		// One binary row per handoff of the local mobile terminals
+		if (handoffTrace)
+			scenarioHelper.InstallHandoffTrace (SelectTraced (local, "mobile", topology, mobileNodeIds, serverNodeIds), filename, fileId);
+	}
 
-		clientFile.close();
+	NS_LOG_INFO ("------Scheduling events - SSID changes------");
 
-		// Print server nodes to file
-		sprintf(filename, "%s/%s-servers-%s", results, scenario, fileId);
+	// Schedule AP Changes, checking every 100 m of movement
+	scenarioHelper.ScheduleApSelection (LocalNodes (mobileTerminalContainer, mpi, rank), 100.0 / finalspeed, endTime);
 
-		std::ofstream serverFile;
+	scenarioHelper.EnableSummary ();
 
-		serverFile.open (filename);
-		for (int i = 0; i < serverNodeIds.size(); i++)
-		{
-			serverFile << serverNodeIds[i] << std::endl;
-		}
+	NS_LOG_INFO ("------Ready for execution!------");
 
-		serverFile.close();
+	Simulator::Stop (Seconds (endTime));
+	Simulator::Run ();
+	Simulator::Destroy ();
 
-		NS_LOG_INFO ("Installing tracers");
-		// NDN Aggregate tracer
-		sprintf (filename, "%s/%s-aggregate-trace-%s", results, scenario, fileId);
-		ndn::L3AggregateTracer::InstallAll(filename, Seconds (1.0));
+	// Every trace file is closed before the results are marked complete
+	if (traceFiles)
+		MobilityScenarioHelper::DestroyTracers ();
 
-		// NDN L3 tracer
-		sprintf (filename, "%s/%s-rate-trace-%s", results, scenario, fileId);
-		ndn::L3RateTracer::InstallAll (filename, Seconds (1.0));
+	if (workers > 1)
+		PartitionInterface::Disable ();
 
-		// NDN App Tracer
-		sprintf (filename, "%s/%s-app-delays-%s", results, scenario, fileId);
-		ndn::AppDelayTracer::InstallAll (filename);
+#ifdef NS3_MPI
+	if (mpi)
+		MpiInterface::Disable ();
+#endif
 
-		// L2 Drop rate tracer
-		sprintf (filename, "%s/%s-drop-trace-%s", results, scenario, fileId);
-		L2RateTracer::InstallAll (filename, Seconds (0.5));
+	// The other workers and ranks have finished once Disable returns. The
+	// consumers all run in the first one
+	if (rank != 0)
+		return 0;
 
-		// Content Store tracer
-		sprintf (filename, "%s/%s-cs-trace-%s", results, scenario, fileId);
-		ndn::CsTracer::InstallAll (filename, Seconds (1));
+	if (!summary.empty () && !scenarioHelper.WriteSummary (summary, endTime - 2))
+	{
+		cerr << "ERROR: Could not write the summary to " << summary << endl;
+		return 1;
 	}
 
-	NS_LOG_INFO ("------Scheduling events - SSID changes------");
-
-	// Schedule AP Changes
-	double apsec = 0.0;
-	// How often should the AP check it's distance
-	double checkTime = 100.0 / finalspeed;
-	double j = apsec;
-
-	while ( j < endTime)
+	if (cache)
 	{
-		sprintf(buffer, "Running event at %f", j);
-		NS_LOG_INFO(buffer);
-
-		for (int i = 0; i < mobile; i++)
-		{
-			Simulator::Schedule (Seconds(j), &SetSSIDviaDistance, mobileNodeIds[i], mobileTerminalsMobility[i], apTerminalMobility);
-		}
-
-		j += checkTime;
+		scenarioHelper.WriteSummary (string (results) + "/summary.txt", endTime - 2);
+		resultCache.Complete ();
 	}
-
-	NS_LOG_INFO ("------Ready for execution!------");
-
-	Simulator::Stop (Seconds (endTime));
-	Simulator::Run ();
-	Simulator::Destroy ();
 }
@@ -0,0 +1,268 @@
+/* -*- Mode:C++; c-file-style:"gnu"; -*- */
+/*
+ * ndn-mobility-replicate.cc
+ *  Runs independent replications of a mobility scenario until the
+ *  confidence interval of a summary metric is narrow enough
+ *
+ * Copyright (c) 2014 Waseda University, Sato Laboratory
+ *
+ *  ndn-mobility-replicate is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  ndn-mobility-replicate is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with ndn-mobility-replicate.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Standard C++ modules
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// ns3 modules
+#include <ns3-dev/ns3/core-module.h>
+
+// Extension files
+#include "utils/run-launcher.h"
+
+using namespace ns3;
+using namespace std;
+
+char scenario[250] = "NDNMobilityReplicate";
+
+NS_LOG_COMPONENT_DEFINE (scenario);
+
+// Splits a space separated list of words
+vector<string> parseArgs(const string &list)
+{
+	vector<string> res;
+	istringstream is(list);
+	string item;
+
+	while (is >> item)
+	{
+		res.push_back(item);
+	}
+
+	return res;
+}
+
+// Two sided quantile of Student's t distribution with df degrees of
+// freedom: tabulated up to 9, from the normal quantile with the
+// Cornish-Fisher expansion above, which is within 0.05% from 10
+double studentT(double confidence, uint32_t df)
+{
+	static const double table[3][9] = {
+		{ 6.313752, 2.919986, 2.353363, 2.131847, 2.015048, 1.943180, 1.894579, 1.859548, 1.833113 },
+		{ 12.706205, 4.302653, 3.182446, 2.776445, 2.570582, 2.446912, 2.364624, 2.306004, 2.262157 },
+		{ 63.656741, 9.924843, 5.840909, 4.604095, 4.032143, 3.707428, 3.499483, 3.355387, 3.249836 }
+	};
+
+	int level;
+	double z;
+	if (confidence == 0.90)
+	{
+		level = 0;
+		z = 1.6448536;
+	}
+	else if (confidence == 0.99)
+	{
+		level = 2;
+		z = 2.5758293;
+	}
+	else
+	{
+		level = 1;
+		z = 1.9599640;
+	}
+
+	if (df < 10)
+		return table[level][df - 1];
+
+	double v = df;
+	double z3 = z * z * z;
+	double z5 = z3 * z * z;
+	double z7 = z5 * z * z;
+	return z + (z3 + z) / (4 * v)
+			+ (5 * z5 + 16 * z3 + 3 * z) / (96 * v * v)
+			+ (3 * z7 + 19 * z5 + 17 * z3 - 15 * z) / (384 * v * v * v);
+}
+
+// Starts the scenario for one run, its output going to the run log
+pid_t startRun(const string &program, const vector<string> &args, uint32_t run, const string &work)
+{
+	char buffer[250];
+	vector<string> argv = args;
+	sprintf(buffer, "--run=%u", run);
+	argv.push_back(buffer);
+	sprintf(buffer, "--summary=%s/run-%03u.summary", work.c_str(), run);
+	argv.push_back(buffer);
+
+	sprintf(buffer, "%s/run-%03u.log", work.c_str(), run);
+	return RunLauncher::Start(program, argv, buffer);
+}
+
+int main (int argc, char *argv[])
+{
+	string scenarioName = "ndn-mobility-random";  // Scenario to replicate, next to this program
+	string scenarioArgs = "";                     // Arguments for the scenario, except --run
+	string metric = "goodput";                    // Summary metric the stop rule watches
+	double precision = 0.05;                      // Largest accepted half-width
+	bool relative = true;                         // Half-width relative to the mean
+	double confidence = 0.95;                     // Confidence level: 0.90, 0.95 or 0.99
+	uint32_t minRuns = 3;                         // Runs before the stop rule applies
+	uint32_t maxRuns = 30;                        // Runs after which to stop anyway
+	uint32_t firstRun = 1;                        // Run number of the first replication
+	uint32_t jobs = 0;                            // Runs at the same time, 0 for one per core
+	string work = "results/replicate";            // Directory for the run summaries and logs
+
+	CommandLine cmd;
+	cmd.AddValue ("scenario", "Scenario program to replicate, in the directory of this program", scenarioName);
+	cmd.AddValue ("args", "Space separated arguments for the scenario (--run and --summary are added)", scenarioArgs);
+	cmd.AddValue ("metric", "Summary metric to watch: goodput, delay, retxShare or handoffs", metric);
+	cmd.AddValue ("precision", "Stop once the confidence interval half-width is below this", precision);
+	cmd.AddValue ("relative", "The precision is relative to the mean", relative);
+	cmd.AddValue ("confidence", "Confidence level of the interval: 0.90, 0.95 or 0.99", confidence);
+	cmd.AddValue ("minRuns", "Runs before the stop rule applies", minRuns);
+	cmd.AddValue ("maxRuns", "Largest number of runs", maxRuns);
+	cmd.AddValue ("firstRun", "Run number of the first replication", firstRun);
+	cmd.AddValue ("jobs", "Runs at the same time (0 for one per core)", jobs);
+	cmd.AddValue ("work", "Directory for the run summaries and logs", work);
+	cmd.Parse (argc,argv);
+
+	if (confidence != 0.90 && confidence != 0.95 && confidence != 0.99)
+	{
+		cerr << "ERROR: The confidence level must be 0.90, 0.95 or 0.99!" << endl;
+		return 1;
+	}
+
+	if (minRuns < 2 || maxRuns < minRuns)
+	{
+		cerr << "ERROR: Need at least 2 runs and maxRuns >= minRuns!" << endl;
+		return 1;
+	}
+
+	if (jobs == 0)
+		jobs = sysconf(_SC_NPROCESSORS_ONLN);
+
+	string self = argv[0];
+	size_t slash = self.rfind('/');
+	string program = (slash == string::npos ? string("./") : self.substr(0, slash + 1)) + scenarioName;
+	vector<string> args = parseArgs(scenarioArgs);
+
+	if (!RunLauncher::CreateDirectories(work))
+	{
+		cerr << "ERROR: Could not create " << work << endl;
+		return 1;
+	}
+
+	printf("%6s %12s %6s %12s %12s\n", "Run", metric.c_str(), "N", "Mean", "Half-width");
+
+	// The stop rule only looks at the runs up to the first unfinished one,
+	// so the result does not depend on which runs happen to end first
+	map<pid_t, uint32_t> running;
+	map<uint32_t, double> values;
+	uint32_t next = firstRun;
+	uint32_t prefix = 0;
+	double sum = 0;
+	double squares = 0;
+	double mean = 0;
+	double half = 0;
+	bool done = false;
+	int failed = 0;
+
+	while (!done)
+	{
+		while (running.size() < jobs && next < firstRun + maxRuns)
+		{
+			pid_t pid = startRun(program, args, next, work);
+			if (pid < 0)
+			{
+				cerr << "ERROR: Could not start run " << next << endl;
+				return 1;
+			}
+			running[pid] = next++;
+		}
+
+		if (running.empty())
+			break;
+
+		int status;
+		pid_t pid = wait(&status);
+		if (pid < 0)
+			break;
+		if (running.find(pid) == running.end())
+			continue;
+
+		uint32_t run = running[pid];
+		running.erase(pid);
+
+		char path[250];
+		sprintf(path, "%s/run-%03u.summary", work.c_str(), run);
+		double value;
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || !RunLauncher::ReadMetric(path, metric, value))
+		{
+			sprintf(path, "%s/run-%03u.log", work.c_str(), run);
+			cerr << "ERROR: Run " << run << " failed, see " << path << endl;
+			failed++;
+			done = true;
+			break;
+		}
+		values[run] = value;
+
+		// Take in the runs that now continue the finished prefix
+		while (values.count(firstRun + prefix))
+		{
+			double x = values[firstRun + prefix++];
+			sum += x;
+			squares += x * x;
+		}
+
+		mean = sum / prefix;
+		half = 0;
+		if (prefix > 1)
+		{
+			double variance = max(0.0, (squares - sum * sum / prefix) / (prefix - 1));
+			half = studentT(confidence, prefix - 1) * sqrt(variance / prefix);
+		}
+
+		printf("%6u %12.6f %6u %12.6f %12.6f\n", run, value, prefix, mean, half);
+		fflush(stdout);
+
+		double target = relative ? precision * fabs(mean) : precision;
+		if (prefix >= minRuns && half <= target)
+			done = true;
+		else if (prefix >= maxRuns)
+			done = true;
+	}
+
+	// Runs still going are not needed any more
+	for (map<pid_t, uint32_t>::iterator i = running.begin(); i != running.end(); i++)
+	{
+		kill(i->first, SIGTERM);
+		waitpid(i->first, 0, 0);
+	}
+
+	if (failed)
+		return 1;
+
+	double target = relative ? precision * fabs(mean) : precision;
+	printf("%s = %f +- %f (%.0f%% confidence) after %u runs, %s\n", metric.c_str(), mean, half,
+			confidence * 100, prefix, half <= target ? "precision reached" : "run limit reached");
+
+	return half <= target ? 0 : 2;
+}
@@ -0,0 +1,454 @@
+/* -*- Mode:C++; c-file-style:"gnu"; -*- */
+/*
+ * ndn-mobility-sweep.cc
+ *  Parameter sweeps of the random walk Wifi Mobile scenario, sharing the
+ *  topology construction between the sweep points
+ *
+ * Copyright (c) 2014 Waseda University, Sato Laboratory
+ *
+ *  ndn-mobility-sweep is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  ndn-mobility-sweep is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with ndn-mobility-sweep.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Standard C++ modules
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sched.h>
+#include <sstream>
+#include <string>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// ns3 modules
+#include <ns3-dev/ns3/core-module.h>
+#include <ns3-dev/ns3/mobility-module.h>
+#include <ns3-dev/ns3/network-module.h>
+
+// ndnSIM modules
+#include <ns3-dev/ns3/ndnSIM-module.h>
+
+// Extension files
+#include "mobility/helper/mobility-scenario-helper.h"
+#include "mobility/helper/sector-topology-helper.h"
+#include "utils/result-cache.h"
+
+using namespace ns3;
+using namespace std;
+
+char scenario[250] = "NDNMobilitySweep";
+
+// A point runs ndn-mobility-random, and its files are named as that
+// scenario names them so ndn-trace-merge and the graphs read them alike
+const char *traceScenario = "NDNMobilityRandom";
+
+NS_LOG_COMPONENT_DEFINE (scenario);
+
+// One combination of the swept parameters
+struct SweepPoint
+{
+	string strategy;
+	int csSize;
+	double mbps;
+	uint32_t run;
+	string results;
+};
+
+// Parameters shared by all the sweep points
+struct SweepConfig
+{
+	double endTime;
+	double retxtime;
+	double checkTime;
+	bool traceFiles;
+	bool binTrace;
+	bool aggTrace;
+	bool asyncTrace;
+	bool delayHist;
+	double finePeriod;
+	double fineWindow;
+	double coarsePeriod;
+	bool handoffTrace;
+};
+
+// Splits a comma separated list of words
+vector<string> parseWords(const string &list)
+{
+	vector<string> res;
+	istringstream is(list);
+	string item;
+
+	while (getline(is, item, ','))
+	{
+		res.push_back(item);
+	}
+
+	return res;
+}
+
+double wallClock()
+{
+	struct timeval t;
+	gettimeofday(&t, NULL);
+	return t.tv_sec + t.tv_usec * 1e-6;
+}
+
+// Keeps this process on one core, so concurrent points do not migrate
+void pinToCore(uint32_t core)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(core, &set);
+	if (sched_setaffinity(0, sizeof(set), &set) != 0)
+		NS_LOG_WARN ("Could not pin process " << getpid() << " to core " << core);
+}
+
+// Runs one sweep point on the topology built by the parent process. The
+// NDN stacks are installed here as the forwarding strategy and the
+// Content Store size are fixed when they are created
+int runPoint(SectorTopologyHelper &topology, const SweepPoint &point, const SweepConfig &config)
+{
+	MobilityScenarioHelper scenarioHelper (topology);
+	scenarioHelper.InstallNdn (point.strategy, point.csSize);
+	scenarioHelper.InstallApplications (topology.GetServerNodes (), topology.GetMobileTerminals (),
+			point.mbps, Seconds (config.endTime), Seconds (config.retxtime));
+
+	char prefix[250];
+	sprintf(prefix, "%s/%s", point.results.c_str(), traceScenario);
+
+	if (config.traceFiles)
+	{
+		std::string fileId = scenarioHelper.GetFileId (point.strategy);
+		scenarioHelper.WriteNodeLists (prefix, fileId);
+
+		scenarioHelper.SetBinaryTraces (config.binTrace);
+		scenarioHelper.SetReducedTraces (config.aggTrace);
+		scenarioHelper.SetAsyncTraces (config.asyncTrace);
+		scenarioHelper.SetDelayHistograms (config.delayHist);
+		if (config.finePeriod > 0)
+			scenarioHelper.SetFineTracePeriods (Seconds (config.finePeriod), Seconds (config.fineWindow), Seconds (config.coarsePeriod));
+		scenarioHelper.InstallTracers (NodeContainer::GetGlobal (), prefix, fileId);
+		if (config.handoffTrace)
+			scenarioHelper.InstallHandoffTrace (topology.GetMobileTerminals (), prefix, fileId);
+	}
+
+	scenarioHelper.ScheduleApSelection (topology.GetMobileTerminals (), config.checkTime, config.endTime);
+	scenarioHelper.EnableSummary ();
+
+	Simulator::Stop (Seconds (config.endTime));
+	Simulator::Run ();
+	Simulator::Destroy ();
+
+	if (config.traceFiles)
+		MobilityScenarioHelper::DestroyTracers ();
+
+	// The summary of the point, as ndn-mobility-random writes it in its
+	// result directory
+	return scenarioHelper.WriteSummary (point.results + "/summary.txt", config.endTime - 2) ? 0 : 1;
+}
+
+// Runs the points sharing one topology, at most jobs at a time, each in a
+// copy on write child of this process. A point is marked complete in the
+// cache once its process has exited, which closes its trace files
+int runPoints(SectorTopologyHelper &topology, const vector<SweepPoint> &points,
+		const vector<ResultCache> &caches, const SweepConfig &config, uint32_t jobs, uint32_t cores)
+{
+	vector<pid_t> slots(jobs, 0);
+	vector<double> started(jobs, 0);
+	vector<size_t> running(jobs, 0);
+	int failed = 0;
+
+	for (size_t next = 0, done = 0; done < points.size(); )
+	{
+		// Start points while there are free slots
+		size_t slot = find(slots.begin(), slots.end(), 0) - slots.begin();
+		if (next < points.size() && slot < jobs)
+		{
+			fflush(stdout);
+			pid_t pid = fork();
+			if (pid == 0)
+			{
+				pinToCore(slot % cores);
+				exit(runPoint(topology, points[next], config));
+			}
+			else if (pid < 0)
+			{
+				cerr << "ERROR: Could not fork sweep point " << next << endl;
+				return 1;
+			}
+
+			slots[slot] = pid;
+			started[slot] = wallClock();
+			running[slot] = next++;
+			continue;
+		}
+
+		int status;
+		pid_t pid = wait(&status);
+		if (pid < 0)
+			break;
+
+		slot = find(slots.begin(), slots.end(), pid) - slots.begin();
+		if (slot == jobs)
+			continue;
+
+		const SweepPoint &point = points[running[slot]];
+		bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0 && caches[running[slot]].Complete();
+		if (!ok)
+			failed++;
+
+		printf("%8s %10d %8.3f %6u %10.3f %s\n", point.strategy.c_str(), point.csSize, point.mbps,
+				point.run, wallClock() - started[slot], ok ? "ok" : "FAILED");
+		fflush(stdout);
+
+		slots[slot] = 0;
+		done++;
+	}
+
+	return failed ? 1 : 0;
+}
+
+int main (int argc, char *argv[])
+{
+	// These are our scenario arguments
+	uint32_t mobile = 1;                          // Number of mobile terminals
+	uint32_t servers = 1;                         // Number of servers in the network
+	bool walk = true;                             // Do random walk at walking speed
+	bool car = false;                             // Do random walk at car speed
+	string posFile = "./Data/rand-hex.txt";       // File including the positioning of the nodes
+	string nsTDir = "./Waypoints";                // Directory for the waypoint files
+	string strategies = "flood,smart,bestr";      // Forwarding strategies to sweep
+	string csSizes = "10000000";                  // Content Store sizes to sweep
+	string mbpsList = "0.15";                     // Application data rates in MB/s to sweep
+	uint32_t seed = 1;                            // Seed of the random number generators
+	string runs = "1";                            // Run numbers to sweep
+	string results = "results";                   // Directory holding the result cache
+	uint32_t jobs = 0;                            // Concurrent sweep points, 0 for one per core
+	SweepConfig config;
+	config.endTime = 800;
+	config.retxtime = 0.05;
+	config.traceFiles = true;
+	config.binTrace = false;
+	config.aggTrace = false;
+	config.asyncTrace = false;
+	config.delayHist = false;
+	config.finePeriod = 0;
+	config.fineWindow = 2;
+	config.coarsePeriod = 0;
+	config.handoffTrace = false;
+
+	CommandLine cmd;
+	cmd.AddValue ("mobile", "Number of mobile terminals in simulation", mobile);
+	cmd.AddValue ("servers", "Number of servers in the simulation", servers);
+	cmd.AddValue ("walk", "Enable random walk at walking speed", walk);
+	cmd.AddValue ("car", "Enable random walk at car speed", car);
+	cmd.AddValue ("posfile", "File containing positioning information", posFile);
+	cmd.AddValue ("traceFile", "Directory containing Ns2 movement trace files (Usually created by Bonnmotion)", nsTDir);
+	cmd.AddValue ("results", "Directory of the result cache, finished points are skipped", results);
+	cmd.AddValue ("endTime", "How long each simulation will last (Seconds)", config.endTime);
+	cmd.AddValue ("retx", "How frequent Interest retransmission timeouts should be checked in seconds", config.retxtime);
+	cmd.AddValue ("trace", "Enable trace files", config.traceFiles);
+	cmd.AddValue ("binTrace", "Write the trace files in the columnar binary format (see ndn-trace-convert)", config.binTrace);
+	cmd.AddValue ("aggTrace", "Write the trace files summed (rates) or averaged (delays) over nodes per second and Type", config.aggTrace);
+	cmd.AddValue ("asyncTrace", "Format, compress and write the trace files in background threads", config.asyncTrace);
+	cmd.AddValue ("delayHist", "Trace the delays of each consumer as histograms every second instead of per Data packet", config.delayHist);
+	cmd.AddValue ("finePeriod", "Trace every this many seconds after each SSID change (0 for the fixed periods)", config.finePeriod);
+	cmd.AddValue ("fineWindow", "Seconds traced at finePeriod after each SSID change", config.fineWindow);
+	cmd.AddValue ("coarsePeriod", "With finePeriod, trace every this many seconds away from SSID changes (0 keeps 1 s, 0.5 s for drops)", config.coarsePeriod);
+	cmd.AddValue ("handoffTrace", "With trace, write a binary record of the disruption of every handoff (convert with ndn-trace-convert)", config.handoffTrace);
+	cmd.AddValue ("strategies", "Comma separated forwarding strategies to sweep: flood, smart, bestr", strategies);
+	cmd.AddValue ("csSizes", "Comma separated Content Store sizes to sweep", csSizes);
+	cmd.AddValue ("mbps", "Comma separated data rates for NDN App in MBps to sweep", mbpsList);
+	cmd.AddValue ("seed", "Seed of the random number generators", seed);
+	cmd.AddValue ("runs", "Comma separated run numbers to sweep", runs);
+	cmd.AddValue ("jobs", "Sweep points run at the same time (0 for one per core)", jobs);
+	cmd.Parse (argc,argv);
+
+	if (! (car || walk) || mobile < 1 || mobile > 4)
+	{
+		cerr << "ERROR: Must choose a speed for random walk and 1 to 4 mobile terminals!" << endl;
+		return 1;
+	}
+
+	// The reduced traces sum the rows of every node in a bin, so rates
+	// written every fine period would be counted once per row
+	if (config.aggTrace && config.finePeriod > 0)
+	{
+		cerr << "ERROR: finePeriod cannot be used with aggTrace!" << endl;
+		return 1;
+	}
+
+	char buffer[250];
+	sprintf(buffer, "%s/%s_%u.ns_movements", nsTDir.c_str(), car ? "Car" : "Walk", mobile);
+	string nsTFile = buffer;
+	config.checkTime = 100.0 / (car ? 18.5 : 1.4);
+
+	uint32_t cores = sysconf(_SC_NPROCESSORS_ONLN);
+	if (jobs == 0)
+		jobs = cores;
+
+	// Points sharing a run number share a topology: random variables take
+	// their streams from the seed and run number when they are created
+	vector<string> runList = parseWords(runs);
+	vector<string> strategyList = parseWords(strategies);
+	vector<string> csList = parseWords(csSizes);
+	vector<string> rateList = parseWords(mbpsList);
+
+	for (size_t i = 0; i < strategyList.size(); i++)
+	{
+		if (!MobilityScenarioHelper::IsStrategy(strategyList[i]))
+		{
+			cerr << "ERROR: Unknown forwarding strategy " << strategyList[i] << endl;
+			return 1;
+		}
+	}
+
+	SectorLayout layout;
+	if (!layout.Read (posFile))
+	{
+		cerr << "ERROR: Error opening file -> " << posFile << endl;
+		return 1;
+	}
+
+	// The key of the points, without the swept parameters. It is built as
+	// ndn-mobility-random builds its own
+	ResultCache sweepCache (results);
+	sweepCache.Add ("scenario", scenario);
+	sweepCache.Add ("mobile", mobile);
+	sweepCache.Add ("servers", servers);
+	sweepCache.Add ("walk", walk);
+	sweepCache.Add ("car", car);
+	sweepCache.Add ("endTime", config.endTime);
+	sweepCache.Add ("retx", config.retxtime);
+	sweepCache.Add ("seed", seed);
+	MobilityScenarioHelper::AddTraceOptions (sweepCache, config.traceFiles, config.binTrace, config.aggTrace, false,
+			config.delayHist, config.finePeriod, config.fineWindow, config.coarsePeriod, config.handoffTrace, "all");
+	sweepCache.AddAttributes ();
+	if (!sweepCache.AddFile ("posfile", posFile) || !sweepCache.AddFile ("traceFile", nsTFile))
+	{
+		cerr << "ERROR: Could not read " << posFile << " or " << nsTFile << endl;
+		return 1;
+	}
+
+	if (!sweepCache.AddProgram ())
+	{
+		cerr << "ERROR: Could not read the program to key the results" << endl;
+		return 1;
+	}
+
+	printf("%8s %10s %8s %6s %10s\n", "Strategy", "CS", "MBps", "Run", "Wall (s)");
+
+	double start = wallClock();
+	double setup = 0;
+	int failed = 0;
+	uint32_t topologies = 0;
+	for (size_t r = 0; r < runList.size(); r++)
+	{
+		vector<SweepPoint> points;
+		vector<ResultCache> caches;
+		for (size_t i = 0; i < strategyList.size(); i++)
+			for (size_t j = 0; j < csList.size(); j++)
+				for (size_t k = 0; k < rateList.size(); k++)
+				{
+					SweepPoint point;
+					point.strategy = strategyList[i];
+					point.csSize = atoi(csList[j].c_str());
+					point.mbps = atof(rateList[k].c_str());
+					point.run = atoi(runList[r].c_str());
+
+					ResultCache cache = sweepCache;
+					cache.Add ("strategy", point.strategy);
+					cache.Add ("csSize", point.csSize);
+					cache.Add ("mbps", point.mbps);
+					cache.Add ("run", point.run);
+
+					// Finished points are skipped, interrupted ones run again
+					if (cache.IsComplete ())
+					{
+						printf("%8s %10d %8.3f %6u %10s cached\n", point.strategy.c_str(), point.csSize,
+								point.mbps, point.run, "-");
+						continue;
+					}
+
+					if (!cache.Prepare ())
+					{
+						cerr << "ERROR: Could not create " << cache.GetPath () << endl;
+						return 1;
+					}
+
+					point.results = cache.GetPath ();
+					points.push_back(point);
+					caches.push_back(cache);
+				}
+
+		if (points.empty())
+			continue;
+		topologies++;
+
+		// Each run number gets a fresh process to build its topology in, so
+		// node IDs and streams match a run of ndn-mobility-random
+		fflush(stdout);
+		int fds[2];
+		if (pipe(fds) != 0)
+		{
+			cerr << "ERROR: Could not create a pipe" << endl;
+			return 1;
+		}
+
+		pid_t pid = fork();
+		if (pid == 0)
+		{
+			close(fds[0]);
+			RngSeedManager::SetSeed (seed);
+			RngSeedManager::SetRun (points[0].run);
+
+			double built = wallClock();
+			SectorTopologyHelper topology;
+			topology.SetMobileTerminals (mobile);
+			topology.SetServers (servers);
+			topology.Create (layout);
+
+			Ns2MobilityHelper ns2 = Ns2MobilityHelper (nsTFile);
+			ns2.Install ();
+
+			topology.ConnectWired ();
+			topology.InstallWifi ();
+			built = wallClock() - built;
+			if (write(fds[1], &built, sizeof(built)) != sizeof(built))
+				exit(1);
+			close(fds[1]);
+
+			exit(runPoints(topology, points, caches, config, jobs, cores));
+		}
+		close(fds[1]);
+
+		double built = 0;
+		if (pid < 0 || read(fds[0], &built, sizeof(built)) != sizeof(built))
+			failed++;
+		close(fds[0]);
+		setup += built;
+
+		int status;
+		if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			failed++;
+	}
+
+	uint32_t total = runList.size() * strategyList.size() * csList.size() * rateList.size();
+	printf("%u points, %.3f s of setup for %u topologies, %.3f s in total\n", total, setup,
+			topologies, wallClock() - start);
+
+	return failed ? 1 : 0;
+}
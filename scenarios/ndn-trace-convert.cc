@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; -*- */
+/*
+ * ndn-trace-convert.cc
+ *  Converts columnar binary traces back to the text tables of the
+ *  ndnSIM tracers
+ *
+ * Copyright (c) 2014 Waseda University, Sato Laboratory
+ *
+ *  ndn-trace-convert is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  ndn-trace-convert is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with ndn-trace-convert.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Standard C++ modules
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ns3 modules
+#include <ns3-dev/ns3/core-module.h>
+
+// Extension files
+#include "utils/tracers/columnar-trace-reader.h"
+
+using namespace ns3;
+using namespace std;
+
+char scenario[250] = "NDNTraceConvert";
+
+NS_LOG_COMPONENT_DEFINE (scenario);
+
+// Writes one trace as text, to the output file or to standard output
+bool convert(const string &input, const string &output)
+{
+	ColumnarTraceReader reader(input);
+	if (!reader.IsGood())
+	{
+		cerr << "ERROR: " << input << " is not a columnar trace!" << endl;
+		return false;
+	}
+
+	ofstream file;
+	if (!output.empty())
+	{
+		file.open(output.c_str());
+		if (!file)
+		{
+			cerr << "ERROR: Could not write " << output << endl;
+			return false;
+		}
+	}
+	ostream &os = output.empty() ? cout : file;
+
+	reader.PrintHeader(os);
+	os << "\n";
+	while (reader.Next())
+	{
+		reader.PrintRow(os);
+		os << "\n";
+	}
+
+	if (!reader.IsGood())
+	{
+		cerr << "ERROR: " << input << " is damaged, converted up to the bad block" << endl;
+		return false;
+	}
+
+	os.flush();
+	return os.good();
+}
+
+int main (int argc, char *argv[])
+{
+	string input = "";       // Space separated list of .ntc traces
+	string output = "";      // Output file for a single trace
+	bool replace = false;    // Write each trace next to it without the .ntc suffix
+
+	CommandLine cmd;
+	cmd.AddValue ("input", "Space separated list of columnar traces to convert", input);
+	cmd.AddValue ("output", "Text file for a single trace (standard output if empty)", output);
+	cmd.AddValue ("inPlace", "Write each trace next to it, without the .ntc suffix", replace);
+	cmd.Parse (argc,argv);
+
+	vector<string> inputs;
+	istringstream is(input);
+	string item;
+	while (is >> item)
+		inputs.push_back(item);
+
+	if (inputs.empty() || (inputs.size() > 1 && !replace))
+	{
+		cerr << "ERROR: Give one trace with --input, or several with --inPlace!" << endl;
+		return 1;
+	}
+
+	int failed = 0;
+	for (int i = 0; i < inputs.size(); i++)
+	{
+		string target = output;
+		if (replace)
+		{
+			target = inputs[i];
+			if (target.size() > 4 && target.substr(target.size() - 4) == ".ntc")
+				target.erase(target.size() - 4);
+			else
+				target += ".txt";
+		}
+
+		if (!convert(inputs[i], target))
+			failed++;
+	}
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,251 @@
+/* -*- Mode:C++; c-file-style:"gnu"; -*- */
+/*
+ * ndn-trace-merge.cc
+ *  Summarizes the traces of many runs into one table, one series per
+ *  configuration and run, to compare them as the rate-tr-mobile scripts in
+ *  graphs do
+ *
+ * Copyright (c) 2014 Waseda University, Sato Laboratory
+ *
+ *  ndn-trace-merge is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  ndn-trace-merge is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with ndn-trace-merge.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Standard C++ modules
+#include <cstdlib>
+#include <fstream>
+#include <glob.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// ns3 modules
+#include <ns3-dev/ns3/core-module.h>
+
+// Extension files
+#include "utils/tracers/trace-summary.h"
+
+using namespace ns3;
+using namespace std;
+
+char scenario[250] = "NDNTraceMerge";
+
+NS_LOG_COMPONENT_DEFINE (scenario);
+
+// Columns holding the configuration, named as in the result files, and
+// the directory of the run, which is averaged over
+const char *configNames[] = { "Strategy", "Mobile", "Servers", "Wnodes", "Run" };
+const int configColumns = 5;
+
+vector<string> split(const string &list, char separator)
+{
+	vector<string> items;
+	istringstream is(list);
+	string item;
+	while (getline(is, item, separator))
+		if (!item.empty())
+			items.push_back(item);
+	return items;
+}
+
+// Reads the configuration from the %s-%02d-%03d-%03d part of a result
+// file name, and the run from its directory. The -wNN and -rNN parts of
+// parallel runs are left out, so the traces of all workers or ranks of a
+// run are pooled. Runs of the same configuration are kept apart by their
+// directory (--results, or the directory --cache picks for each run) and
+// averaged, as summing them would count their packets several times
+bool parseConfig(const string &path, string config[configColumns])
+{
+	size_t slash = path.find_last_of('/');
+	config[4] = (slash == string::npos) ? "." : path.substr(0, slash);
+
+	string name = path.substr(slash + 1);
+	name = name.substr(0, name.find('.'));
+	vector<string> parts = split(name, '-');
+
+	int last = (int) parts.size() - 1;
+	if (last >= 0 && parts[last].size() > 1 && (parts[last][0] == 'w' || parts[last][0] == 'r')
+			&& parts[last].find_first_not_of("0123456789", 1) == string::npos)
+		last--;
+	if (last < 3)
+		return false;
+
+	for (int i = 0; i < 3; i++)
+		if (parts[last - i].find_first_not_of("0123456789") != string::npos)
+			return false;
+
+	config[0] = parts[last - 3];
+	for (int i = 1; i < 4; i++)
+		config[i] = parts[last - 3 + i];
+	return true;
+}
+
+// Sets a summary up for the merged table
+bool setUp(TraceSummary &summary, const string &table, const vector<string> &nodes)
+{
+	if (!summary.SetTable(table, nodes))
+		return false;
+
+	// After the time and type groups, so the table is aligned by time
+	for (int i = 0; i < configColumns; i++)
+	{
+		summary.SetLabel(configNames[i], "");
+		summary.AddGroup(configNames[i]);
+	}
+
+	// One row per configuration, time and type: the mean of the runs,
+	// with the number of runs in a Runs column
+	summary.Average("Run", "Runs");
+	return true;
+}
+
+// One of the threads summarizing the result files, taking the next
+// file until none is left
+class MergeJob
+{
+public:
+	MergeJob(const vector<string> &files, volatile uint32_t *next)
+		: m_files(files), m_next(next), m_failed(false)
+	{
+	}
+
+	void Run()
+	{
+		while (true)
+		{
+			uint32_t i = __sync_fetch_and_add(m_next, 1);
+			if (i >= m_files.size())
+				break;
+
+			string config[configColumns];
+			if (!parseConfig(m_files[i], config))
+			{
+				m_errors.push_back(m_files[i] + " is not named as a result file");
+				m_failed = true;
+				continue;
+			}
+			for (int c = 0; c < configColumns; c++)
+				m_summary.SetLabel(configNames[c], config[c]);
+
+			if (!m_summary.Read(m_files[i], 1))
+			{
+				m_errors.push_back(m_summary.GetError());
+				m_failed = true;
+			}
+		}
+	}
+
+	const vector<string> &m_files;
+	volatile uint32_t *m_next;
+	TraceSummary m_summary;
+	vector<string> m_errors;
+	bool m_failed;
+};
+
+int main (int argc, char *argv[])
+{
+	string input = "";       // Space separated list of file patterns
+	string output = "";      // Output file for the table
+	string table = "rate";   // Which script's table to compute
+	string node = "";        // Comma separated list of nodes
+	uint32_t jobs = 0;       // Files read at the same time
+
+	CommandLine cmd;
+	cmd.AddValue ("input", "Space separated list of result file patterns, like \"results/*/*-rate-trace-*.txt\", each run in its own directory. The table averages the runs of each configuration", input);
+	cmd.AddValue ("output", "File for the merged table (standard output if empty)", output);
+	cmd.AddValue ("table", "Table to compute for each configuration: rate, int or app, as ndn-trace-summary", table);
+	cmd.AddValue ("node", "Comma separated list of nodes to summarize, as --node of the scripts", node);
+	cmd.AddValue ("jobs", "Files read at the same time (0 for one per core)", jobs);
+	cmd.Parse (argc,argv);
+
+	vector<string> files;
+	vector<string> patterns = split(input, ' ');
+	for (int i = 0; i < patterns.size(); i++)
+	{
+		glob_t found;
+		if (glob(patterns[i].c_str(), GLOB_TILDE, NULL, &found) == 0)
+			for (size_t f = 0; f < found.gl_pathc; f++)
+				files.push_back(found.gl_pathv[f]);
+		globfree(&found);
+	}
+
+	if (files.empty())
+	{
+		cerr << "ERROR: No result file matches --input!" << endl;
+		return 1;
+	}
+
+	vector<string> nodes = split(node, ',');
+	TraceSummary merged;
+	if (!setUp(merged, table, nodes))
+	{
+		cerr << "ERROR: Unknown table " << table << "!" << endl;
+		return 1;
+	}
+
+	if (jobs == 0)
+		jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	if (jobs > files.size())
+		jobs = files.size();
+
+	// Each job keeps only the summary of the files it read, pooled by
+	// configuration and run: memory grows with the runs, not the traces
+	volatile uint32_t next = 0;
+	vector<MergeJob *> work;
+	vector<Ptr<SystemThread> > threads;
+	for (uint32_t j = 0; j < jobs; j++)
+	{
+		work.push_back(new MergeJob(files, &next));
+		setUp(work[j]->m_summary, table, nodes);
+		threads.push_back(Create<SystemThread> (MakeCallback (&MergeJob::Run, work[j])));
+		threads[j]->Start();
+	}
+
+	bool failed = false;
+	for (uint32_t j = 0; j < jobs; j++)
+	{
+		threads[j]->Join();
+		for (int e = 0; e < work[j]->m_errors.size(); e++)
+			cerr << "ERROR: " << work[j]->m_errors[e] << endl;
+		if (!merged.Merge(work[j]->m_summary))
+		{
+			cerr << "ERROR: " << merged.GetError() << endl;
+			failed = true;
+		}
+		failed = failed || work[j]->m_failed;
+		delete work[j];
+	}
+
+	if (failed)
+		return 1;
+
+	NS_LOG_INFO ("Merged " << files.size() << " files");
+
+	if (output.empty())
+	{
+		merged.Print(cout);
+		return cout.good() ? 0 : 1;
+	}
+
+	ofstream file(output.c_str());
+	merged.Print(file);
+	file.close();
+	if (!file)
+	{
+		cerr << "ERROR: Could not write " << output << endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; -*- */
+/*
+ * ndn-trace-summary.cc
+ *  Computes the summary tables of the R scripts in graphs/ from the
+ *  text traces, without loading them in R
+ *
+ * Copyright (c) 2014 Waseda University, Sato Laboratory
+ *
+ *  ndn-trace-summary is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  ndn-trace-summary is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with ndn-trace-summary.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Standard C++ modules
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// ns3 modules
+#include <ns3-dev/ns3/core-module.h>
+
+// Extension files
+#include "utils/tracers/trace-summary.h"
+
+using namespace ns3;
+using namespace std;
+
+char scenario[250] = "NDNTraceSummary";
+
+NS_LOG_COMPONENT_DEFINE (scenario);
+
+vector<string> split(const string &list, char separator)
+{
+	vector<string> items;
+	istringstream is(list);
+	string item;
+	while (getline(is, item, separator))
+		if (!item.empty())
+			items.push_back(item);
+	return items;
+}
+
+int main (int argc, char *argv[])
+{
+	string input = "";       // Text trace to summarize
+	string output = "";      // Output file for the table
+	string table = "rate";   // Which script's table to compute
+	string node = "";        // Comma separated list of nodes
+	uint32_t threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+	CommandLine cmd;
+	cmd.AddValue ("input", "Text trace to summarize", input);
+	cmd.AddValue ("output", "File for the summary table (standard output if empty)", output);
+	cmd.AddValue ("table", "Table to compute: rate (rate-tr-j.R), int (int-tr-j.R) or app (app-data-j.R)", table);
+	cmd.AddValue ("node", "Comma separated list of nodes to summarize, as --node of the scripts", node);
+	cmd.AddValue ("threads", "Number of chunks of the trace read in parallel", threads);
+	cmd.Parse (argc,argv);
+
+	if (input.empty())
+	{
+		cerr << "ERROR: Give the trace to summarize with --input!" << endl;
+		return 1;
+	}
+
+	TraceSummary summary;
+	if (!summary.SetTable(table, split(node, ',')))
+	{
+		cerr << "ERROR: Unknown table " << table << "!" << endl;
+		return 1;
+	}
+
+	if (!summary.Read(input, threads))
+	{
+		cerr << "ERROR: " << summary.GetError() << endl;
+		return 1;
+	}
+
+	if (output.empty())
+	{
+		summary.Print(cout);
+		return cout.good() ? 0 : 1;
+	}
+
+	ofstream file(output.c_str());
+	summary.Print(file);
+	file.close();
+	if (!file)
+	{
+		cerr << "ERROR: Could not write " << output << endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; -*- */
+/*
+ * ndn-trace-window.cc
+ *  Extracts a time window of a text trace through an index kept next
+ *  to it, without reading the rest of the trace
+ *
+ * Copyright (c) 2014 Waseda University, Sato Laboratory
+ *
+ *  ndn-trace-window is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  ndn-trace-window is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero Public License
+ *  along with ndn-trace-window.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Standard C++ modules
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ns3 modules
+#include <ns3-dev/ns3/core-module.h>
+
+// Extension files
+#include "utils/tracers/trace-index.h"
+
+using namespace ns3;
+using namespace std;
+
+char scenario[250] = "NDNTraceWindow";
+
+NS_LOG_COMPONENT_DEFINE (scenario);
+
+vector<string> split(const string &list, char separator)
+{
+	vector<string> items;
+	istringstream is(list);
+	string item;
+	while (getline(is, item, separator))
+		if (!item.empty())
+			items.push_back(item);
+	return items;
+}
+
+int main (int argc, char *argv[])
+{
+	string input = "";       // Text trace to read
+	string output = "";      // Output file for the window
+	string node = "";        // Comma separated list of nodes
+	double from = 0;         // Window start
+	double to = -1;          // Window end
+	double bin = 1.0;        // Time bin of a new index
+	bool rebuild = false;    // Index the trace even if it has an index
+
+	CommandLine cmd;
+	cmd.AddValue ("input", "Text trace to extract from", input);
+	cmd.AddValue ("output", "File for the rows of the window (standard output if empty)", output);
+	cmd.AddValue ("from", "Start of the window in seconds", from);
+	cmd.AddValue ("to", "End of the window in seconds, included", to);
+	cmd.AddValue ("node", "Comma separated list of nodes to extract, all if empty", node);
+	cmd.AddValue ("bin", "Seconds per time bin when the trace is indexed", bin);
+	cmd.AddValue ("rebuild", "Index the trace again, even if its index is up to date", rebuild);
+	cmd.Parse (argc,argv);
+
+	if (input.empty())
+	{
+		cerr << "ERROR: Give the trace with --input!" << endl;
+		return 1;
+	}
+
+	// The index is built on the first query and kept for the next ones
+	TraceIndex index;
+	if (rebuild || !index.Load(input))
+	{
+		NS_LOG_INFO ("Indexing " << input);
+		if (!index.Build(input, bin))
+		{
+			cerr << "ERROR: " << index.GetError() << endl;
+			return 1;
+		}
+		if (!index.Save(input))
+			cerr << "WARNING: " << index.GetError() << ", the trace will be indexed again next time" << endl;
+	}
+
+	// With no --to the window is empty and only the header is written,
+	// which is enough to build the index ahead of the queries
+	ofstream file;
+	if (!output.empty())
+	{
+		file.open(output.c_str());
+		if (!file)
+		{
+			cerr << "ERROR: Could not write " << output << endl;
+			return 1;
+		}
+	}
+	ostream &os = output.empty() ? cout : file;
+
+	if (!index.Extract(input, from, to, split(node, ','), os))
+	{
+		cerr << "ERROR: " << index.GetError() << endl;
+		return 1;
+	}
+
+	NS_LOG_INFO ("Read " << index.GetBytesRead() << " bytes of " << input);
+	os.flush();
+	return os.good() ? 0 : 1;
+}